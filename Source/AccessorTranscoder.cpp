@@ -0,0 +1,301 @@
+#include "Globals.h"
+#include "AccessorTranscoder.h"
+
+#include "gltf_utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define ACCESSOR_TRANSCODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    template <typename T>
+    float componentToFloat(const uint8_t* p, bool normalized)
+    {
+        T v;
+        memcpy(&v, p, sizeof(T));
+
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, uint32_t>)
+        {
+            // UNSIGNED_INT cannot be normalized in glTF
+            return float(v);
+        }
+        else
+        {
+            if (!normalized)
+                return float(v);
+
+            const float scaled = float(v) / float(std::numeric_limits<T>::max());
+            if constexpr (std::is_signed_v<T>)
+                return std::max(scaled, -1.0f);
+            else
+                return scaled;
+        }
+    }
+
+    template <typename T>
+    void convertScalar(uint8_t* dst, size_t dstStride, uint32_t numComponents, const uint8_t* src, size_t srcStride, bool normalized, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float element[4];
+            for (uint32_t c = 0; c < numComponents; ++c)
+                element[c] = componentToFloat<T>(src + c * sizeof(T), normalized);
+
+            memcpy(dst, element, numComponents * sizeof(float));
+
+            dst += dstStride;
+            src += srcStride;
+        }
+    }
+
+#if ACCESSOR_TRANSCODER_SSE2
+    // Fixed-size moves per component count: no over-read past the element, no over-write into the next field.
+    // 64-bit halves go through movq, which has no alignment requirement.
+    void copyFloatsSse(uint8_t* dst, size_t dstStride, uint32_t numComponents, const uint8_t* src, size_t srcStride, size_t count)
+    {
+        switch (numComponents)
+        {
+        case 1:
+            for (size_t i = 0; i < count; ++i, dst += dstStride, src += srcStride)
+                _mm_store_ss(reinterpret_cast<float*>(dst), _mm_load_ss(reinterpret_cast<const float*>(src)));
+            break;
+
+        case 2:
+            for (size_t i = 0; i < count; ++i, dst += dstStride, src += srcStride)
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+            break;
+
+        case 3:
+            for (size_t i = 0; i < count; ++i, dst += dstStride, src += srcStride)
+            {
+                const __m128i xy = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+                const __m128 z = _mm_load_ss(reinterpret_cast<const float*>(src + 8));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), xy);
+                _mm_store_ss(reinterpret_cast<float*>(dst + 8), z);
+            }
+            break;
+
+        default:
+            for (size_t i = 0; i < count; ++i, dst += dstStride, src += srcStride)
+                _mm_storeu_ps(reinterpret_cast<float*>(dst), _mm_loadu_ps(reinterpret_cast<const float*>(src)));
+            break;
+        }
+    }
+
+    // Sign/zero extends the low components of packed to four int32 lanes
+    template <typename T>
+    __m128i widenToInt32(__m128i packed)
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            return _mm_unpacklo_epi16(_mm_unpacklo_epi8(packed, zero), zero);
+        }
+        else if constexpr (std::is_same_v<T, int8_t>)
+        {
+            const __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(packed, packed), 8);
+            return _mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16);
+        }
+        else if constexpr (std::is_same_v<T, uint16_t>)
+        {
+            return _mm_unpacklo_epi16(packed, _mm_setzero_si128());
+        }
+        else
+        {
+            return _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        }
+    }
+
+    template <typename T, uint32_t N, bool Normalized>
+    void convertIntegersSse(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t count)
+    {
+        // Divided, not multiplied by the reciprocal, so results match the scalar path bit for bit
+        const __m128 scale = _mm_set1_ps(float(std::numeric_limits<T>::max()));
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+
+        for (size_t i = 0; i < count; ++i, dst += dstStride, src += srcStride)
+        {
+            // At most 4 x 16 bits, read through a local so the element is never over-read
+            uint64_t bits = 0;
+            memcpy(&bits, src, N * sizeof(T));
+
+            __m128 values = _mm_cvtepi32_ps(widenToInt32<T>(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bits))));
+
+            if constexpr (Normalized)
+            {
+                values = _mm_div_ps(values, scale);
+                if constexpr (std::is_signed_v<T>)
+                    values = _mm_max_ps(values, minusOne);
+            }
+
+            if constexpr (N == 4)
+            {
+                _mm_storeu_ps(reinterpret_cast<float*>(dst), values);
+            }
+            else
+            {
+                if constexpr (N >= 2)
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_castps_si128(values));
+                else
+                    _mm_store_ss(reinterpret_cast<float*>(dst), values);
+
+                if constexpr (N == 3)
+                    _mm_store_ss(reinterpret_cast<float*>(dst + 8), _mm_movehl_ps(values, values));
+            }
+        }
+    }
+
+    template <typename T>
+    void convertIntegersSse(uint8_t* dst, size_t dstStride, uint32_t numComponents, const uint8_t* src, size_t srcStride, bool normalized, size_t count)
+    {
+        switch (numComponents * 2 + (normalized ? 1 : 0))
+        {
+        case 2: convertIntegersSse<T, 1, false>(dst, dstStride, src, srcStride, count); break;
+        case 3: convertIntegersSse<T, 1, true>(dst, dstStride, src, srcStride, count); break;
+        case 4: convertIntegersSse<T, 2, false>(dst, dstStride, src, srcStride, count); break;
+        case 5: convertIntegersSse<T, 2, true>(dst, dstStride, src, srcStride, count); break;
+        case 6: convertIntegersSse<T, 3, false>(dst, dstStride, src, srcStride, count); break;
+        case 7: convertIntegersSse<T, 3, true>(dst, dstStride, src, srcStride, count); break;
+        case 8: convertIntegersSse<T, 4, false>(dst, dstStride, src, srcStride, count); break;
+        default: convertIntegersSse<T, 4, true>(dst, dstStride, src, srcStride, count); break;
+        }
+    }
+#endif
+}
+
+size_t getAccessorComponentSize(int componentType)
+{
+    switch (componentType)
+    {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        return 1;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        return 2;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+bool transcodeToFloatScalar(float* dst, size_t dstStride, uint32_t dstComponents,
+    const uint8_t* src, size_t srcStride, const AccessorFormat& format, size_t count)
+{
+    const uint32_t numComponents = std::min(dstComponents, format.numComponents);
+    if (numComponents == 0 || numComponents > 4)
+        return false;
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+    switch (format.componentType)
+    {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:          convertScalar<float>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_BYTE:           convertScalar<int8_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  convertScalar<uint8_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:          convertScalar<int16_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: convertScalar<uint16_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   convertScalar<uint32_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    default:
+        return false;
+    }
+}
+
+bool transcodeToFloat(float* dst, size_t dstStride, uint32_t dstComponents,
+    const uint8_t* src, size_t srcStride, const AccessorFormat& format, size_t count)
+{
+#if ACCESSOR_TRANSCODER_SSE2
+    const uint32_t numComponents = std::min(dstComponents, format.numComponents);
+    if (numComponents == 0 || numComponents > 4)
+        return false;
+
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+    switch (format.componentType)
+    {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:          copyFloatsSse(out, dstStride, numComponents, src, srcStride, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_BYTE:           convertIntegersSse<int8_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  convertIntegersSse<uint8_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:          convertIntegersSse<int16_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: convertIntegersSse<uint16_t>(out, dstStride, numComponents, src, srcStride, format.normalized, count); return true;
+    default:
+        break;
+    }
+#endif
+
+    return transcodeToFloatScalar(dst, dstStride, dstComponents, src, srcStride, format, count);
+}
+
+bool transcodeIndices(uint32_t* dst, const uint8_t* src, size_t srcStride, int componentType, size_t count)
+{
+    size_t i = 0;
+
+    switch (componentType)
+    {
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+#if ACCESSOR_TRANSCODER_SSE2
+        if (srcStride == 1)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+            dst[i] = src[i * srcStride];
+        return true;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+#if ACCESSOR_TRANSCODER_SSE2
+        if (srcStride == 2)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(words, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(words, zero));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            uint16_t v;
+            memcpy(&v, src + i * srcStride, sizeof(v));
+            dst[i] = v;
+        }
+        return true;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        if (srcStride == 4)
+        {
+            if (count > 0)
+                memcpy(dst, src, count * sizeof(uint32_t));
+            return true;
+        }
+
+        for (; i < count; ++i)
+            memcpy(&dst[i], src + i * srcStride, sizeof(uint32_t));
+        return true;
+
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Element layout of a glTF accessor. componentType uses the TINYGLTF_COMPONENT_TYPE_* (GL) values.
+struct AccessorFormat
+{
+    int      componentType = 0;
+    uint32_t numComponents = 0;
+    bool     normalized = false;
+};
+
+// Converts count accessor elements to floats, following the glTF rules:
+// normalized integers map to [0, 1] / [-1, 1], plain integers (KHR_mesh_quantization) convert as is.
+// Writes min(dstComponents, format.numComponents) floats per element, the rest of dst is left untouched.
+// Strides are in bytes. Uses SSE2 when available.
+bool transcodeToFloat(float* dst, size_t dstStride, uint32_t dstComponents,
+    const uint8_t* src, size_t srcStride, const AccessorFormat& format, size_t count);
+
+// Plain C++ version of transcodeToFloat, the reference the SIMD paths must match
+bool transcodeToFloatScalar(float* dst, size_t dstStride, uint32_t dstComponents,
+    const uint8_t* src, size_t srcStride, const AccessorFormat& format, size_t count);
+
+// Widens UNSIGNED_BYTE / UNSIGNED_SHORT / UNSIGNED_INT indices to 32 bits
+bool transcodeIndices(uint32_t* dst, const uint8_t* src, size_t srcStride, int componentType, size_t count);
+
+// Size in bytes of one component, 0 for unknown types
+size_t getAccessorComponentSize(int componentType);
@@ -23,10 +23,16 @@
 #include "ModuleSamplers.h"
 #include "ModuleRingBuffer.h"
 
+#include "JobSystem.h"
+#include "ModuleStageGraph.h"
+
 Application::Application(int /*argc*/, wchar_t** /*argv*/, void* hWnd)
 {
     app = this;
 
+    // Created first so modules can already fan work out during init()
+    jobSystem = std::make_unique<JobSystem>(JobSystem::getDefaultWorkerCount());
+
     modules.push_back(new ModuleInput((HWND)hWnd));
     modules.push_back(d3d12 = new D3D12Module((HWND)hWnd));
     modules.push_back(timeManager = new TimeManager());
@@ -51,6 +57,9 @@ Application::~Application()
 
     modules.clear();
 
+    stageGraphs.clear();
+    jobSystem.reset();
+
     d3d12 = nullptr;
     ui = nullptr;
     timeManager = nullptr;
@@ -74,6 +83,9 @@ bool Application::init()
     if (ret && d3d12)
         d3d12->initImGui();
 
+    if (ret)
+        buildStageGraphs();
+
     lastTime = std::chrono::steady_clock::now();
     return ret;
 }
@@ -114,21 +126,24 @@ void Application::update()
 
     if (!paused)
     {
-        for (auto& m : modules) m->update();
+        for (auto& graph : stageGraphs)
+            jobSystem->execute(*graph);
+    }
 
-        if (d3d12) d3d12->preRender();
-        for (auto& m : modules)
-            if (m != d3d12) m->preRender();
+    updating = false;
+}
 
-        for (auto& m : modules)
-            if (m != d3d12) m->render();
+// One job graph per stage, D3D12Module framing the stages that record (see buildModuleStageGraph)
+void Application::buildStageGraphs()
+{
+    stageGraphs.clear();
 
-        for (auto& m : modules)
-            if (m != d3d12) m->postRender();
-        if (d3d12) d3d12->postRender();
+    for (uint32_t s = 0; s < uint32_t(ModuleStage::Count); ++s)
+    {
+        auto graph = std::make_unique<JobGraph>();
+        buildModuleStageGraph(*graph, ModuleStage(s), modules, d3d12);
+        stageGraphs.push_back(std::move(graph));
     }
-
-    updating = false;
 }
 
 bool Application::cleanUp()
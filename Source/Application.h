@@ -5,8 +5,11 @@
 #include <array>
 #include <vector>
 #include <chrono>
+#include <memory>
 
 class Module;
+class JobSystem;
+class JobGraph;
 class D3D12Module;
 class UIModule;
 class TimeManager;
@@ -47,6 +50,9 @@ public:
     ModuleTargetDescriptors* getTargetDescriptors() const { return targetDescriptors; }
     ModuleSamplers* getSamplers() const { return samplers; }
 
+    // Jobs
+    JobSystem* getJobSystem() const { return jobSystem.get(); }
+
     // Timing
     double getDeltaTimeSeconds() const { return elapsedSeconds; }
     uint64_t getElapsedMilis() const { return uint64_t(elapsedSeconds * 1000.0); }
@@ -59,8 +65,14 @@ private:
     enum { MAX_FPS_TICKS = 30 };
     using TickList = std::array<double, MAX_FPS_TICKS>;
 
+    void buildStageGraphs();
+
     std::vector<Module*> modules;
 
+    // One dependency graph per ModuleStage, rebuilt after init()
+    std::unique_ptr<JobSystem> jobSystem;
+    std::vector<std::unique_ptr<JobGraph>> stageGraphs;
+
     // Cached pointers
     D3D12Module* d3d12 = nullptr;
     UIModule* ui = nullptr;
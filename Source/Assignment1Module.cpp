@@ -141,7 +141,7 @@ bool Assignment1Module::init()
         if (!texture)
             return false;
 
-        textureTable = descriptors->allocTable();
+        textureTable = descriptors->allocTable(1);
         if (!textureTable)
             return false;
 
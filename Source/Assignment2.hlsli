@@ -24,4 +24,18 @@ cbuffer PerInstance : register(b2)
 
     uint hasDiffuseTex; // match C++ BOOL (4 bytes)
     float3 _piPad0; // padding to 16-byte
+
+    uint diffuseTexIndex; // index into the bound SRV array
+    uint3 _piPad1;
 };
+
+#ifdef INSTANCED
+// Assignment2Module::InstanceData: the root SRV starts at the draw's first instance, so SV_InstanceID indexes it
+struct InstanceData
+{
+    float4x4 modelMat;
+    float4x4 normalMat;
+};
+
+StructuredBuffer<InstanceData> instances : register(t0, space1);
+#endif
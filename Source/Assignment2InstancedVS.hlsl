@@ -0,0 +1,3 @@
+// Assignment2VS with the model and normal matrices read per instance (one draw per mesh and LOD)
+#define INSTANCED
+#include "Assignment2VS.hlsl"
@@ -1,826 +1,1486 @@
-// Assignment2Module.cpp
-#include "Globals.h"
-#include "Assignment2Module.h"
-
-#include "Application.h"
-#include "D3D12Module.h"
-#include "ModuleCamera.h"
-#include "ModuleShaderDescriptors.h"
-#include "ModuleSamplers.h"
-
-#include "DebugDrawPass.h"
-#include "ImGuiPass.h"
-#include "ReadData.h"
-
-#include "d3dx12.h"
-
-#include "imgui.h"
-#include "ImGuizmo.h"
-
-#include <filesystem>
-#include <string>
-#include <algorithm>
-#include <cmath>
-
-using namespace DirectX;
-namespace fs = std::filesystem;
-
-namespace
-{
-    // Store Scene image rect (screen coords) for ImGuizmo
-    static ImVec2 gSceneImgMin(0.0f, 0.0f);
-    static ImVec2 gSceneImgMax(0.0f, 0.0f);
-    static bool   gSceneImgValid = false;
-
-    fs::path GetExeDir()
-    {
-        wchar_t buf[MAX_PATH]{};
-        DWORD len = GetModuleFileNameW(nullptr, buf, MAX_PATH);
-        if (len == 0 || len >= MAX_PATH)
-            return fs::current_path();
-
-        fs::path p(buf);
-        return p.has_parent_path() ? p.parent_path() : fs::current_path();
-    }
-
-    bool FindUpwards(const fs::path& startDir, const fs::path& relativeFile, fs::path& outAbsFile, int maxLevels = 12)
-    {
-        fs::path dir = startDir;
-
-        for (int i = 0; i <= maxLevels; ++i)
-        {
-            fs::path candidate = dir / relativeFile;
-            if (fs::exists(candidate))
-            {
-                outAbsFile = fs::absolute(candidate);
-                return true;
-            }
-
-            if (!dir.has_parent_path())
-                break;
-
-            dir = dir.parent_path();
-        }
-
-        return false;
-    }
-
-    std::string ToGenericString(const fs::path& p)
-    {
-        return p.generic_string();
-    }
-
-    std::string EnsureTrailingSlash(std::string s)
-    {
-        if (!s.empty() && s.back() != '/')
-            s.push_back('/');
-        return s;
-    }
-
-    uint32_t ClampMin1(uint32_t v) { return (v == 0u) ? 1u : v; }
-
-    double UpdateAvgMs(double* history, int window, int& idx, int& count, double ms)
-    {
-        history[idx] = ms;
-        idx = (idx + 1) % window;
-        count = (count < window) ? (count + 1) : window;
-
-        double sum = 0.0;
-        for (int i = 0; i < count; ++i) sum += history[i];
-        return (count > 0) ? (sum / double(count)) : 0.0;
-    }
-
-    void UpdateCameraPivotToModel(ModuleCamera* cam, const Matrix& modelM)
-    {
-        if (!cam) return;
-        const Vector3 center(modelM._41, modelM._42, modelM._43);
-        cam->setFocusBounds(center, 2.5f);
-    }
-}
-
-// ---------------------------------------------------------
-// init
-// ---------------------------------------------------------
-bool Assignment2Module::init()
-{
-    bool ok = true;
-
-    ok &= createRootSignature();
-    ok &= createPipelineState();
-    ok &= loadModel();
-    ok &= createFrameBuffers();
-
-    if (ok)
-    {
-        UpdateCameraPivotToModel(app->getCamera(), model.getModelMatrix());
-
-        D3D12Module* d3d12 = app->getD3D12Module();
-
-        Microsoft::WRL::ComPtr<ID3D12Device4> device4;
-        if (FAILED(d3d12->getDevice()->QueryInterface(IID_PPV_ARGS(&device4))))
-            return false;
-
-        debugDrawPass = std::make_unique<DebugDrawPass>(device4.Get(), d3d12->getDrawCommandQueue());
-
-        const Vector4 clearCol(0.05f, 0.05f, 0.06f, 1.0f);
-        sceneRT = std::make_unique<RenderTexture>(
-            "SceneRT",
-            DXGI_FORMAT_R8G8B8A8_UNORM,
-            clearCol,
-            DXGI_FORMAT_D32_FLOAT,
-            1.0f,
-            false,
-            false
-        );
-
-        sceneRT->resize(1, 1);
-        lastSceneW = 1;
-        lastSceneH = 1;
-    }
-
-    return ok;
-}
-
-// ---------------------------------------------------------
-// cleanUp
-// ---------------------------------------------------------
-bool Assignment2Module::cleanUp()
-{
-    debugDrawPass.reset();
-
-    sceneRT.reset();
-    lastSceneW = 1;
-    lastSceneH = 1;
-
-    if (mvpBuffer && mvpMapped) { mvpBuffer->Unmap(0, nullptr); mvpMapped = nullptr; }
-    if (perFrameBuffer && perFrameMapped) { perFrameBuffer->Unmap(0, nullptr); perFrameMapped = nullptr; }
-    if (perInstanceBuffer && perInstanceMapped) { perInstanceBuffer->Unmap(0, nullptr); perInstanceMapped = nullptr; }
-
-    mvpBuffer.Reset();
-    perFrameBuffer.Reset();
-    perInstanceBuffer.Reset();
-
-    mvpStride = 0;
-    perFrameStride = 0;
-    perInstanceStride = 0;
-
-    pso.Reset();
-    rootSignature.Reset();
-
-    showAxis = false;
-    showGrid = true;
-    showGuizmo = true;
-    gizmoOperation = 0;
-
-    currentSampler = ModuleSamplers::Type::Linear_Wrap;
-
-    msIndex = 0;
-    msCount = 0;
-    for (int i = 0; i < kAvgWindow; ++i) msHistory[i] = 0.0;
-
-    return true;
-}
-
-// ---------------------------------------------------------
-// Helpers
-// ---------------------------------------------------------
-Matrix Assignment2Module::computeNormalMatrixSafe(const Matrix& modelM)
-{
-    Matrix m = modelM;
-    m._41 = 0.0f; m._42 = 0.0f; m._43 = 0.0f;
-
-    const float det = m.Determinant();
-    if (fabsf(det) < 1e-8f)
-        return Matrix::Identity;
-
-    return m.Invert();
-}
-
-// ---------------------------------------------------------
-// Step 1: ImGui (Scene TOP-LEFT smaller, Options TOP-RIGHT smaller) - only initial placement.
-// After that user can move/resize freely.
-// ---------------------------------------------------------
-void Assignment2Module::buildImGuiAndHandleResize(const Matrix& view, const Matrix& proj, uint32_t& outSceneW, uint32_t& outSceneH)
-{
-    ImGuiViewport* vp = ImGui::GetMainViewport();
-    const ImVec2 vpPos = vp ? vp->Pos : ImVec2(0, 0);
-    const ImVec2 vpSize = vp ? vp->Size : ImVec2(1280, 720);
-
-    const float pad = 8.0f;
-
-    // --- initial sizes: "half-ish" so you have free engine area to click
-    const float kInitFrac = 0.55f; // ~half
-    const float initOptionsW = 520.0f;
-
-    ImVec2 scenePos = ImVec2(vpPos.x + pad, vpPos.y + pad);
-    ImVec2 sceneSize = ImVec2(std::max(300.0f, vpSize.x * kInitFrac),
-        std::max(260.0f, vpSize.y * kInitFrac));
-
-    ImVec2 optPos = ImVec2(vpPos.x + vpSize.x - initOptionsW - pad, vpPos.y + pad);
-    ImVec2 optSize = ImVec2(initOptionsW,
-        std::max(260.0f, vpSize.y * kInitFrac));
-
-    // --- Scene window ---
-    ImGui::SetNextWindowPos(scenePos, ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(sceneSize, ImGuiCond_FirstUseEver);
-    ImGui::Begin("Scene"); // movable/resizable
-
-    ImVec2 avail = ImGui::GetContentRegionAvail();
-    avail.x = std::max(1.0f, avail.x);
-    avail.y = std::max(1.0f, avail.y);
-
-    const uint32_t w = ClampMin1((uint32_t)avail.x);
-    const uint32_t h = ClampMin1((uint32_t)avail.y);
-
-    if (sceneRT && (w != lastSceneW || h != lastSceneH))
-    {
-        if (D3D12Module* d3d12 = app->getD3D12Module())
-            d3d12->flush();
-
-        sceneRT->resize(w, h);
-        lastSceneW = w;
-        lastSceneH = h;
-    }
-
-    gSceneImgValid = false;
-
-    if (sceneRT && sceneRT->getSrvTableDesc())
-    {
-        const ImVec2 imgPos = ImGui::GetCursorScreenPos();
-        ImGui::Image((ImTextureID)sceneRT->getSrvHandle().ptr, avail);
-        ImGui::SetItemAllowOverlap();
-
-        gSceneImgMin = imgPos;
-        gSceneImgMax = ImVec2(imgPos.x + avail.x, imgPos.y + avail.y);
-        gSceneImgValid = (avail.x > 1.0f && avail.y > 1.0f);
-    }
-
-    ImGui::End();
-
-    // --- Options window ---
-    ImGui::SetNextWindowPos(optPos, ImGuiCond_FirstUseEver);
-    ImGui::SetNextWindowSize(optSize, ImGuiCond_FirstUseEver);
-    imGuiOptionsAndGizmo(view, proj);
-
-    outSceneW = lastSceneW;
-    outSceneH = lastSceneH;
-}
-
-// ---------------------------------------------------------
-// Options + Gizmo (Gizmo inside Scene rect)
-// ---------------------------------------------------------
-void Assignment2Module::imGuiOptionsAndGizmo(const Matrix& view, const Matrix& proj)
-{
-    const double dt = app ? app->getDeltaTimeSeconds() : 0.0;
-    const double ms = (dt > 0.0) ? (dt * 1000.0) : 0.0;
-    const double avgMs = UpdateAvgMs(msHistory, kAvgWindow, msIndex, msCount, ms);
-    const uint32_t fps = (dt > 0.0) ? uint32_t(1.0 / dt) : 0;
-
-    ImGui::Begin("Geometry Viewer Options"); // movable/resizable
-
-    ImGui::Separator();
-    ImGui::Text("FPS: [%u]. Avg. elapsed (Ms): [%g] ", fps, avgMs);
-    ImGui::Separator();
-
-    ImGui::Checkbox("Show grid", &showGrid);
-    ImGui::Checkbox("Show axis", &showAxis);
-    ImGui::Checkbox("Show guizmo", &showGuizmo);
-
-    ImGui::Text("Model loaded %s with %u meshes and %u materials",
-        model.getSrcFile().c_str(),
-        model.getNumMeshes(),
-        model.getNumMaterials());
-
-    for (const BasicMesh& mesh : model.getMeshes())
-    {
-        const uint32_t tris = (mesh.getNumIndices() > 0) ? (mesh.getNumIndices() / 3u) : (mesh.getNumVertices() / 3u);
-        ImGui::Text("Mesh %s with %u vertices and %u triangles",
-            mesh.getName().c_str(),
-            mesh.getNumVertices(),
-            tris);
-    }
-
-    Matrix objectMatrix = model.getModelMatrix();
-
-    ImGui::Separator();
-
-    if (ImGui::IsKeyPressed(ImGuiKey_T)) gizmoOperation = 0;
-    if (ImGui::IsKeyPressed(ImGuiKey_R)) gizmoOperation = 1;
-    if (ImGui::IsKeyPressed(ImGuiKey_S)) gizmoOperation = 2;
-
-    ImGui::RadioButton("Translate", &gizmoOperation, 0);
-    ImGui::SameLine();
-    ImGui::RadioButton("Rotate", &gizmoOperation, 1);
-    ImGui::SameLine();
-    ImGui::RadioButton("Scale", &gizmoOperation, 2);
-
-    float translation[3], rotation[3], scale[3];
-    ImGuizmo::DecomposeMatrixToComponents((float*)&objectMatrix, translation, rotation, scale);
-
-    bool transformChanged = false;
-    transformChanged |= ImGui::DragFloat3("Tr", translation, 0.1f);
-    transformChanged |= ImGui::DragFloat3("Rt", rotation, 0.1f);
-    transformChanged |= ImGui::DragFloat3("Sc", scale, 0.001f);
-
-    if (transformChanged)
-    {
-        ImGuizmo::RecomposeMatrixFromComponents(translation, rotation, scale, (float*)&objectMatrix);
-        model.setModelMatrix(objectMatrix);
-        UpdateCameraPivotToModel(app->getCamera(), objectMatrix);
-    }
-
-    if (ImGui::CollapsingHeader("Light", ImGuiTreeNodeFlags_DefaultOpen))
-    {
-        ImGui::DragFloat3("Light Direction", reinterpret_cast<float*>(&light.L), 0.1f, -1.0f, 1.0f);
-        ImGui::SameLine();
-        if (ImGui::SmallButton("Normalize"))
-            light.L.Normalize();
-
-        ImGui::ColorEdit3("Light Colour", reinterpret_cast<float*>(&light.Lc), ImGuiColorEditFlags_NoAlpha);
-        ImGui::ColorEdit3("Ambient Colour", reinterpret_cast<float*>(&light.Ac), ImGuiColorEditFlags_NoAlpha);
-    }
-
-    auto& mats = model.getMaterials();
-    for (size_t i = 0; i < mats.size(); ++i)
-    {
-        BasicMaterial& mat = mats[i];
-        if (mat.getMaterialType() != BasicMaterial::PHONG)
-            continue;
-
-        char header[256]{};
-        _snprintf_s(header, _countof(header), _TRUNCATE, "Material %s", mat.getName().c_str());
-
-        if (ImGui::CollapsingHeader(header, ImGuiTreeNodeFlags_DefaultOpen))
-        {
-            BasicMaterial::PhongMaterialData ph = mat.getPhongMaterial();
-            bool dirty = false;
-
-            dirty |= ImGui::ColorEdit3("Diffuse Colour (Cd)",
-                reinterpret_cast<float*>(&ph.diffuseColour),
-                ImGuiColorEditFlags_NoAlpha);
-
-            dirty |= ImGui::ColorEdit3("Specular Colour (F0)",
-                reinterpret_cast<float*>(&ph.specularColour),
-                ImGuiColorEditFlags_NoAlpha);
-
-            dirty |= ImGui::DragFloat("Shininess (n)", &ph.shininess, 1.0f, 1.0f, 2048.0f);
-
-            bool useTex = (ph.hasDiffuseTex != 0u);
-            if (ImGui::Checkbox("Use Texture", &useTex))
-            {
-                ph.hasDiffuseTex = useTex ? 1u : 0u;
-                dirty = true;
-            }
-
-            if (dirty)
-                mat.setPhongMaterial(ph);
-        }
-    }
-
-    ImGui::End();
-
-    if (!showGuizmo)
-        return;
-
-    if (!gSceneImgValid)
-        return;
-
-    ImGuizmo::SetOrthographic(false);
-    ImGuizmo::SetDrawlist(ImGui::GetForegroundDrawList());
-
-    const float x = gSceneImgMin.x;
-    const float y = gSceneImgMin.y;
-    const float w = gSceneImgMax.x - gSceneImgMin.x;
-    const float h = gSceneImgMax.y - gSceneImgMin.y;
-
-    ImGuizmo::SetRect(x, y, w, h);
-
-    ImGuizmo::OPERATION op = ImGuizmo::TRANSLATE;
-    if (gizmoOperation == 1) op = ImGuizmo::ROTATE;
-    if (gizmoOperation == 2) op = ImGuizmo::SCALE;
-
-    Matrix objectMatrix2 = model.getModelMatrix();
-
-    ImGuizmo::Manipulate(
-        (const float*)&view,
-        (const float*)&proj,
-        op,
-        ImGuizmo::LOCAL,
-        (float*)&objectMatrix2
-    );
-
-    if (ImGuizmo::IsUsing())
-    {
-        model.setModelMatrix(objectMatrix2);
-        UpdateCameraPivotToModel(app->getCamera(), objectMatrix2);
-    }
-}
-
-// ---------------------------------------------------------
-// render
-// ---------------------------------------------------------
-void Assignment2Module::render()
-{
-    D3D12Module* d3d12 = app->getD3D12Module();
-    if (!d3d12 || !sceneRT)
-        return;
-
-    ID3D12GraphicsCommandList* commandList = d3d12->getCommandList();
-    if (!commandList)
-        return;
-
-    Matrix view = Matrix::Identity;
-    Matrix proj = Matrix::Identity;
-
-    ImGuizmo::BeginFrame();
-
-    uint32_t sceneW = lastSceneW;
-    uint32_t sceneH = lastSceneH;
-
-    {
-        if (ModuleCamera* cam = app->getCamera())
-        {
-            cam->setAspectRatio((sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f);
-            view = cam->getViewMatrix();
-            proj = cam->getProjectionMatrix();
-        }
-        else
-        {
-            view = Matrix::CreateLookAt(Vector3(0.0f, 2.0f, 6.0f), Vector3::Zero, Vector3::Up);
-            proj = Matrix::CreatePerspectiveFieldOfView(
-                XM_PIDIV4,
-                (sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f,
-                0.1f, 1000.0f);
-        }
-        ImGuiIO& io = ImGui::GetIO();
-        io.ConfigWindowsMoveFromTitleBarOnly = true;
-
-        buildImGuiAndHandleResize(view, proj, sceneW, sceneH);
-
-        if (ModuleCamera* cam = app->getCamera())
-        {
-            cam->setAspectRatio((sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f);
-            view = cam->getViewMatrix();
-            proj = cam->getProjectionMatrix();
-        }
-    }
-
-    commandList->Reset(d3d12->getCommandAllocator(), pso.Get());
-
-    BEGIN_EVENT(commandList, "Assignment2 Frame");
-
-    const uint32_t frameSlot = (d3d12->getCurrentFrame() % kFramesInFlight);
-
-    // Update CBs
-    {
-        const Matrix mvp = (model.getModelMatrix() * view * proj).Transpose();
-        if (mvpMapped)
-        {
-            MVPData cb{};
-            cb.mvp = mvp;
-            memcpy(mvpMapped + (frameSlot * mvpStride), &cb, sizeof(cb));
-        }
-
-        if (perFrameMapped)
-        {
-            PerFrameData pf{};
-            pf.L = light.L;
-            pf.L.Normalize();
-            pf.Lc = light.Lc;
-            pf.Ac = light.Ac;
-
-            if (ModuleCamera* cam = app->getCamera())
-                pf.viewPos = cam->getPosition();
-            else
-                pf.viewPos = Vector3(0.0f, 2.0f, 6.0f);
-
-            memcpy(perFrameMapped + (frameSlot * perFrameStride), &pf, sizeof(pf));
-        }
-    }
-
-    commandList->SetGraphicsRootSignature(rootSignature.Get());
-
-    ID3D12DescriptorHeap* heaps[] =
-    {
-        app->getShaderDescriptors()->getHeap(),
-        app->getSamplers()->getHeap()
-    };
-    commandList->SetDescriptorHeaps(_countof(heaps), heaps);
-
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-    commandList->SetGraphicsRootConstantBufferView(
-        0, mvpBuffer->GetGPUVirtualAddress() + (frameSlot * mvpStride));
-
-    commandList->SetGraphicsRootConstantBufferView(
-        1, perFrameBuffer->GetGPUVirtualAddress() + (frameSlot * perFrameStride));
-
-    commandList->SetGraphicsRootDescriptorTable(
-        4, app->getSamplers()->getGPUHandle(currentSampler));
-
-    // Scene pass
-    {
-        BEGIN_EVENT(commandList, "Scene Pass -> RenderTexture");
-
-        sceneRT->beginRender(commandList);
-
-        const auto& meshes = model.getMeshes();
-        const auto& mats = model.getMaterials();
-        const size_t meshCount = std::max<size_t>(1, meshes.size());
-
-        for (size_t meshIdx = 0; meshIdx < meshes.size(); ++meshIdx)
-        {
-            const BasicMesh& mesh = meshes[meshIdx];
-            const int matIndex = mesh.getMaterialIndex();
-
-            if (matIndex < 0 || matIndex >= (int)mats.size())
-                continue;
-
-            const BasicMaterial& mat = mats[(size_t)matIndex];
-
-            if (perInstanceMapped)
-            {
-                PerInstanceData pi{};
-
-                const Matrix modelM = model.getModelMatrix();
-                const Matrix invNoTranslation = computeNormalMatrixSafe(modelM);
-
-                pi.modelMat = modelM.Transpose();
-                pi.normalMat = invNoTranslation.Transpose();
-                pi.material = mat.getPhongMaterial();
-
-                const size_t instanceOffset = (frameSlot * meshCount + meshIdx) * perInstanceStride;
-                memcpy(perInstanceMapped + instanceOffset, &pi, sizeof(pi));
-
-                commandList->SetGraphicsRootConstantBufferView(
-                    2, perInstanceBuffer->GetGPUVirtualAddress() + instanceOffset);
-            }
-
-            commandList->SetGraphicsRootDescriptorTable(
-                3, mat.getTexturesTableGPU());
-
-            mesh.draw(commandList);
-        }
-
-        // Debug draw
-        {
-            if (showGrid)
-                dd::xzSquareGrid(-50.0f, 50.0f, 0.0f, 1.0f, dd::colors::LightGray);
-
-            if (showAxis)
-                dd::axisTriad(ddConvert(Matrix::Identity), 0.1f, 1.0f);
-
-            if (debugDrawPass)
-                debugDrawPass->record(commandList, sceneW, sceneH, view, proj);
-        }
-
-        sceneRT->endRender(commandList);
-
-        END_EVENT(commandList);
-    }
-
-    // ImGui pass
-    {
-        BEGIN_EVENT(commandList, "ImGui Pass -> Backbuffer");
-
-        {
-            CD3DX12_RESOURCE_BARRIER barrier =
-                CD3DX12_RESOURCE_BARRIER::Transition(
-                    d3d12->getBackBuffer(),
-                    D3D12_RESOURCE_STATE_PRESENT,
-                    D3D12_RESOURCE_STATE_RENDER_TARGET);
-            commandList->ResourceBarrier(1, &barrier);
-        }
-
-        const unsigned winW = d3d12->getWindowWidth();
-        const unsigned winH = d3d12->getWindowHeight();
-
-        D3D12_VIEWPORT vp{ 0.0f, 0.0f, float(winW), float(winH), 0.0f, 1.0f };
-        D3D12_RECT sc{ 0, 0, LONG(winW), LONG(winH) };
-        commandList->RSSetViewports(1, &vp);
-        commandList->RSSetScissorRects(1, &sc);
-
-        D3D12_CPU_DESCRIPTOR_HANDLE rtv = d3d12->getRenderTargetDescriptor();
-        D3D12_CPU_DESCRIPTOR_HANDLE dsv = d3d12->getDepthStencilDescriptor();
-
-        commandList->OMSetRenderTargets(1, &rtv, FALSE, &dsv);
-
-        {
-            float clearColor[] = { 0.05f, 0.05f, 0.06f, 1.0f };
-            commandList->ClearRenderTargetView(rtv, clearColor, 0, nullptr);
-            commandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-        }
-
-        if (ImGuiPass* ui = d3d12->getImGuiPass())
-            ui->record(commandList);
-
-        {
-            CD3DX12_RESOURCE_BARRIER barrier =
-                CD3DX12_RESOURCE_BARRIER::Transition(
-                    d3d12->getBackBuffer(),
-                    D3D12_RESOURCE_STATE_RENDER_TARGET,
-                    D3D12_RESOURCE_STATE_PRESENT);
-            commandList->ResourceBarrier(1, &barrier);
-        }
-
-        END_EVENT(commandList);
-    }
-
-    END_EVENT(commandList);
-
-    if (SUCCEEDED(commandList->Close()))
-    {
-        ID3D12CommandList* lists[] = { commandList };
-        d3d12->getDrawCommandQueue()->ExecuteCommandLists(UINT(std::size(lists)), lists);
-    }
-}
-
-// ---------------------------------------------------------
-// createRootSignature
-// ---------------------------------------------------------
-bool Assignment2Module::createRootSignature()
-{
-    CD3DX12_ROOT_PARAMETER rootParameters[5] = {};
-    CD3DX12_DESCRIPTOR_RANGE srvRange;
-    CD3DX12_DESCRIPTOR_RANGE sampRange;
-
-    srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, BasicMaterial::SLOT_COUNT, 0); // t0
-    sampRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0);                    // s0
-
-    rootParameters[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);       // b0
-    rootParameters[1].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_ALL);          // b1
-    rootParameters[2].InitAsConstantBufferView(2, 0, D3D12_SHADER_VISIBILITY_ALL);          // b2
-    rootParameters[3].InitAsDescriptorTable(1, &srvRange, D3D12_SHADER_VISIBILITY_PIXEL);   // t0
-    rootParameters[4].InitAsDescriptorTable(1, &sampRange, D3D12_SHADER_VISIBILITY_PIXEL);  // s0
-
-    CD3DX12_ROOT_SIGNATURE_DESC desc;
-    desc.Init(
-        _countof(rootParameters), rootParameters,
-        0, nullptr,
-        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
-    );
-
-    Microsoft::WRL::ComPtr<ID3DBlob> blob;
-    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
-
-    if (FAILED(D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1, &blob, &errorBlob)))
-    {
-        if (errorBlob)
-            LOG("Assignment2Module RootSignature serialize error: %s", (const char*)errorBlob->GetBufferPointer());
-        return false;
-    }
-
-    HRESULT hr = app->getD3D12Module()->getDevice()->CreateRootSignature(
-        0, blob->GetBufferPointer(), blob->GetBufferSize(),
-        IID_PPV_ARGS(&rootSignature));
-
-    if (FAILED(hr))
-        return false;
-
-    rootSignature->SetName(L"Assignment2 RootSignature");
-    return true;
-}
-
-// ---------------------------------------------------------
-// createPipelineState
-// ---------------------------------------------------------
-bool Assignment2Module::createPipelineState()
-{
-    auto vs = DX::ReadData(L"Assignment2VS.cso");
-    auto ps = DX::ReadData(L"Assignment2PS.cso");
-
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
-    psoDesc.InputLayout = BasicMesh::getInputLayoutDesc();
-    psoDesc.pRootSignature = rootSignature.Get();
-    psoDesc.VS = { vs.data(), vs.size() };
-    psoDesc.PS = { ps.data(), ps.size() };
-    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-
-    psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
-    psoDesc.NumRenderTargets = 1;
-    psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
-
-    psoDesc.SampleDesc = { 1, 0 };
-    psoDesc.SampleMask = UINT_MAX;
-
-    psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
-    psoDesc.RasterizerState.FrontCounterClockwise = TRUE;
-
-    psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
-    psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
-
-    HRESULT hr = app->getD3D12Module()->getDevice()->CreateGraphicsPipelineState(
-        &psoDesc, IID_PPV_ARGS(&pso));
-
-    if (FAILED(hr))
-        return false;
-
-    pso->SetName(L"Assignment2 PSO");
-    return true;
-}
-
-// ---------------------------------------------------------
-// createFrameBuffers
-// ---------------------------------------------------------
-bool Assignment2Module::createFrameBuffers()
-{
-    ID3D12Device* device = app->getD3D12Module()->getDevice();
-    if (!device)
-        return false;
-
-    const size_t meshCount = std::max<size_t>(1, model.getMeshes().size());
-
-    mvpStride = alignUp(sizeof(MVPData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-    perFrameStride = alignUp(sizeof(PerFrameData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-    perInstanceStride = alignUp(sizeof(PerInstanceData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-
-    const size_t mvpTotal = mvpStride * kFramesInFlight;
-    const size_t perFrameTotal = perFrameStride * kFramesInFlight;
-    const size_t perInstanceTotal = perInstanceStride * kFramesInFlight * meshCount;
-
-    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-
-    // b0
-    {
-        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(mvpTotal);
-        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
-            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mvpBuffer))))
-            return false;
-
-        CD3DX12_RANGE readRange(0, 0);
-        if (FAILED(mvpBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mvpMapped))) || !mvpMapped)
-            return false;
-    }
-
-    // b1
-    {
-        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(perFrameTotal);
-        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
-            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&perFrameBuffer))))
-            return false;
-
-        CD3DX12_RANGE readRange(0, 0);
-        if (FAILED(perFrameBuffer->Map(0, &readRange, reinterpret_cast<void**>(&perFrameMapped))) || !perFrameMapped)
-            return false;
-    }
-
-    // b2
-    {
-        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(perInstanceTotal);
-        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
-            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&perInstanceBuffer))))
-            return false;
-
-        CD3DX12_RANGE readRange(0, 0);
-        if (FAILED(perInstanceBuffer->Map(0, &readRange, reinterpret_cast<void**>(&perInstanceMapped))) || !perInstanceMapped)
-            return false;
-    }
-
-    return true;
-}
-
-// ---------------------------------------------------------
-// loadModel
-// ---------------------------------------------------------
-bool Assignment2Module::loadModel()
-{
-    const fs::path candidates[] =
-    {
-        fs::path("Game") / "Assets" / "Models" / "Duck" / "duck.gltf",
-        fs::path("Game") / "Assets" / "Models" / "Duck" / "Duck.gltf",
-        fs::path("Assets") / "Models" / "Duck" / "duck.gltf",
-        fs::path("Assets") / "Models" / "Duck" / "Duck.gltf",
-    };
-
-    fs::path absGltf;
-    const fs::path cwd = fs::current_path();
-    const fs::path exeDir = GetExeDir();
-
-    bool found = false;
-
-    for (const fs::path& rel : candidates)
-    {
-        if (FindUpwards(cwd, rel, absGltf, 12) || FindUpwards(exeDir, rel, absGltf, 12))
-        {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found)
-    {
-        LOG("Assignment2Module: Could not find Duck.gltf (CWD=%s, EXE=%s)",
-            cwd.generic_string().c_str(),
-            exeDir.generic_string().c_str());
-        return false;
-    }
-
-    const fs::path absDir = absGltf.parent_path();
-    const std::string gltfPath = ToGenericString(absGltf);
-    const std::string basePath = EnsureTrailingSlash(ToGenericString(absDir));
-
-    model.load(gltfPath.c_str(), basePath.c_str(), BasicMaterial::PHONG);
-    model.scale() = Vector3(0.01f, 0.01f, 0.01f);
-
-    return model.getNumMeshes() > 0;
-}
+﻿// Assignment2Module.cpp
+#include "Globals.h"
+#include "Assignment2Module.h"
+
+#include "Application.h"
+#include "D3D12Module.h"
+#include "ModuleCamera.h"
+#include "ModuleResources.h"
+#include "ModuleShaderDescriptors.h"
+#include "ModuleSamplers.h"
+#include "JobSystem.h"
+#include "Timer.h"
+
+#include "DebugDrawPass.h"
+#include "ImGuiPass.h"
+#include "ReadData.h"
+
+#include "d3dx12.h"
+
+#include "imgui.h"
+#include "ImGuizmo.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace DirectX;
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Store Scene image rect (screen coords) for ImGuizmo
+    static ImVec2 gSceneImgMin(0.0f, 0.0f);
+    static ImVec2 gSceneImgMax(0.0f, 0.0f);
+    static bool   gSceneImgValid = false;
+
+    fs::path GetExeDir()
+    {
+        wchar_t buf[MAX_PATH]{};
+        DWORD len = GetModuleFileNameW(nullptr, buf, MAX_PATH);
+        if (len == 0 || len >= MAX_PATH)
+            return fs::current_path();
+
+        fs::path p(buf);
+        return p.has_parent_path() ? p.parent_path() : fs::current_path();
+    }
+
+    bool FindUpwards(const fs::path& startDir, const fs::path& relativeFile, fs::path& outAbsFile, int maxLevels = 12)
+    {
+        fs::path dir = startDir;
+
+        for (int i = 0; i <= maxLevels; ++i)
+        {
+            fs::path candidate = dir / relativeFile;
+            if (fs::exists(candidate))
+            {
+                outAbsFile = fs::absolute(candidate);
+                return true;
+            }
+
+            if (!dir.has_parent_path())
+                break;
+
+            dir = dir.parent_path();
+        }
+
+        return false;
+    }
+
+    std::string ToGenericString(const fs::path& p)
+    {
+        return p.generic_string();
+    }
+
+    std::string EnsureTrailingSlash(std::string s)
+    {
+        if (!s.empty() && s.back() != '/')
+            s.push_back('/');
+        return s;
+    }
+
+    uint32_t ClampMin1(uint32_t v) { return (v == 0u) ? 1u : v; }
+
+    // Level 0 plus every simplified level BasicMesh can build
+    constexpr uint32_t kLodsPerMesh = BasicMesh::kMaxLods + 1;
+
+    // RenderQueue pass of the scene draws; the debug draw and ImGui are recorded after the queue
+    constexpr uint32_t kScenePass = 0;
+
+    double UpdateAvgMs(double* history, int window, int& idx, int& count, double ms)
+    {
+        history[idx] = ms;
+        idx = (idx + 1) % window;
+        count = (count < window) ? (count + 1) : window;
+
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) sum += history[i];
+        return (count > 0) ? (sum / double(count)) : 0.0;
+    }
+
+    void UpdateCameraPivotToModel(ModuleCamera* cam, const Matrix& modelM)
+    {
+        if (!cam) return;
+        const Vector3 center(modelM._41, modelM._42, modelM._43);
+        cam->setFocusBounds(center, 2.5f);
+    }
+}
+
+// ---------------------------------------------------------
+// init
+// ---------------------------------------------------------
+bool Assignment2Module::init()
+{
+    bool ok = true;
+
+    ok &= createRootSignature();
+    ok &= createPipelineState();
+    ok &= loadModel();
+    ok &= createFrameBuffers();
+
+    if (ok)
+    {
+        UpdateCameraPivotToModel(app->getCamera(), model.getModelMatrix());
+
+        D3D12Module* d3d12 = app->getD3D12Module();
+
+        Microsoft::WRL::ComPtr<ID3D12Device4> device4;
+        if (FAILED(d3d12->getDevice()->QueryInterface(IID_PPV_ARGS(&device4))))
+            return false;
+
+        debugDrawPass = std::make_unique<DebugDrawPass>(device4.Get(), d3d12->getDrawCommandQueue());
+
+        const Vector4 clearCol(0.05f, 0.05f, 0.06f, 1.0f);
+        sceneRT = std::make_unique<RenderTexture>(
+            "SceneRT",
+            DXGI_FORMAT_R8G8B8A8_UNORM,
+            clearCol,
+            DXGI_FORMAT_UNKNOWN,    // depth is a frame graph transient
+            1.0f,
+            false,
+            false
+        );
+
+        sceneRT->resize(1, 1);
+        lastSceneW = 1;
+        lastSceneH = 1;
+    }
+
+    return ok;
+}
+
+// ---------------------------------------------------------
+// cleanUp
+// ---------------------------------------------------------
+bool Assignment2Module::cleanUp()
+{
+    debugDrawPass.reset();
+
+    frameGraph.release();
+    sceneRT.reset();
+    lastSceneW = 1;
+    lastSceneH = 1;
+
+    if (mvpBuffer && mvpMapped) { mvpBuffer->Unmap(0, nullptr); mvpMapped = nullptr; }
+    if (perFrameBuffer && perFrameMapped) { perFrameBuffer->Unmap(0, nullptr); perFrameMapped = nullptr; }
+    if (perInstanceBuffer && perInstanceMapped) { perInstanceBuffer->Unmap(0, nullptr); perInstanceMapped = nullptr; }
+    if (instanceDataBuffer && instanceDataMapped) { instanceDataBuffer->Unmap(0, nullptr); instanceDataMapped = nullptr; }
+
+    mvpBuffer.Reset();
+    perFrameBuffer.Reset();
+    perInstanceBuffer.Reset();
+    instanceDataBuffer.Reset();
+
+    mvpStride = 0;
+    perFrameStride = 0;
+    perInstanceStride = 0;
+    drawItemCapacity = 0;
+
+    for (auto& formatPso : pso)
+        formatPso.Reset();
+    for (auto& formatPso : instancedPso)
+        formatPso.Reset();
+    rootSignature.Reset();
+
+    showAxis = false;
+    showGrid = true;
+    showGuizmo = true;
+    gizmoOperation = 0;
+
+    currentSampler = ModuleSamplers::Type::Linear_Wrap;
+
+    msIndex = 0;
+    msCount = 0;
+    for (int i = 0; i < kAvgWindow; ++i) msHistory[i] = 0.0;
+
+    return true;
+}
+
+// ---------------------------------------------------------
+// Step 1: ImGui (Scene TOP-LEFT smaller, Options TOP-RIGHT smaller) - only initial placement.
+// After that user can move/resize freely.
+// ---------------------------------------------------------
+void Assignment2Module::buildImGuiAndHandleResize(const Matrix& view, const Matrix& proj, uint32_t& outSceneW, uint32_t& outSceneH)
+{
+    ImGuiViewport* vp = ImGui::GetMainViewport();
+    const ImVec2 vpPos = vp ? vp->Pos : ImVec2(0, 0);
+    const ImVec2 vpSize = vp ? vp->Size : ImVec2(1280, 720);
+
+    const float pad = 8.0f;
+
+    // --- initial sizes: "half-ish" so you have free engine area to click
+    const float kInitFrac = 0.55f; // ~half
+    const float initOptionsW = 520.0f;
+
+    ImVec2 scenePos = ImVec2(vpPos.x + pad, vpPos.y + pad);
+    ImVec2 sceneSize = ImVec2(std::max(300.0f, vpSize.x * kInitFrac),
+        std::max(260.0f, vpSize.y * kInitFrac));
+
+    ImVec2 optPos = ImVec2(vpPos.x + vpSize.x - initOptionsW - pad, vpPos.y + pad);
+    ImVec2 optSize = ImVec2(initOptionsW,
+        std::max(260.0f, vpSize.y * kInitFrac));
+
+    // --- Scene window ---
+    ImGui::SetNextWindowPos(scenePos, ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(sceneSize, ImGuiCond_FirstUseEver);
+    ImGui::Begin("Scene"); // movable/resizable
+
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    avail.x = std::max(1.0f, avail.x);
+    avail.y = std::max(1.0f, avail.y);
+
+    const uint32_t w = ClampMin1((uint32_t)avail.x);
+    const uint32_t h = ClampMin1((uint32_t)avail.y);
+
+    if (sceneRT && (w != lastSceneW || h != lastSceneH))
+    {
+        if (D3D12Module* d3d12 = app->getD3D12Module())
+            d3d12->flush();
+
+        sceneRT->resize(w, h);
+        lastSceneW = w;
+        lastSceneH = h;
+    }
+
+    gSceneImgValid = false;
+
+    if (sceneRT && sceneRT->getSrvTableDesc())
+    {
+        const ImVec2 imgPos = ImGui::GetCursorScreenPos();
+        ImGui::Image((ImTextureID)sceneRT->getSrvHandle().ptr, avail);
+        ImGui::SetItemAllowOverlap();
+
+        gSceneImgMin = imgPos;
+        gSceneImgMax = ImVec2(imgPos.x + avail.x, imgPos.y + avail.y);
+        gSceneImgValid = (avail.x > 1.0f && avail.y > 1.0f);
+    }
+
+    ImGui::End();
+
+    // --- Options window ---
+    ImGui::SetNextWindowPos(optPos, ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(optSize, ImGuiCond_FirstUseEver);
+    imGuiOptionsAndGizmo(view, proj);
+
+    outSceneW = lastSceneW;
+    outSceneH = lastSceneH;
+}
+
+// ---------------------------------------------------------
+// Options + Gizmo (Gizmo inside Scene rect)
+// ---------------------------------------------------------
+void Assignment2Module::imGuiOptionsAndGizmo(const Matrix& view, const Matrix& proj)
+{
+    const double dt = app ? app->getDeltaTimeSeconds() : 0.0;
+    const double ms = (dt > 0.0) ? (dt * 1000.0) : 0.0;
+    const double avgMs = UpdateAvgMs(msHistory, kAvgWindow, msIndex, msCount, ms);
+    const uint32_t fps = (dt > 0.0) ? uint32_t(1.0 / dt) : 0;
+
+    ImGui::Begin("Geometry Viewer Options"); // movable/resizable
+
+    ImGui::Separator();
+    ImGui::Text("FPS: [%u]. Avg. elapsed (Ms): [%g] ", fps, avgMs);
+    ImGui::Separator();
+
+    ImGui::Checkbox("Show grid", &showGrid);
+    ImGui::Checkbox("Show axis", &showAxis);
+    ImGui::Checkbox("Show guizmo", &showGuizmo);
+    ImGui::Checkbox("Bindless textures", &useBindless);
+    ImGui::Checkbox("Sort draws", &sortDraws);
+    ImGui::SameLine();
+    ImGui::Checkbox("Skip redundant state", &skipRedundantState);
+    ImGui::Text("State: %u root changes (%u descriptor tables), %u IA, %u PSO, %u redundant %s",
+        sceneStateStats.rootChanges, sceneStateStats.tableChanges, sceneStateStats.inputAssemblerChanges,
+        sceneStateStats.pipelineChanges, sceneStateStats.redundant, skipRedundantState ? "skipped" : "issued");
+    ImGui::Text("Render queue: %u draws, %u radix passes", renderQueue.size(), renderQueuePasses);
+
+    const FrameGraph::Stats& graphStats = frameGraph.getStats();
+    ImGui::Text("Frame graph: %u passes (%u culled), %u barriers in %u batches, %u transients in %.2f MB",
+        graphStats.passes, graphStats.culledPasses, graphStats.barriers, graphStats.batches, graphStats.transients,
+        double(graphStats.heapBytes) / (1024.0 * 1024.0));
+
+    ImGui::Checkbox("Parallel scene recording", &parallelRecording);
+    ImGui::SliderInt("Min draws per chunk", &minDrawsPerChunk, 1, 256);
+    const CommandListPool::Stats listStats = app->getD3D12Module()->getCommandListPool().getStats();
+    ImGui::Text("Scene chunks: %u, command lists: %u this frame, %u pooled, %u allocators",
+        lastDrawChunks, listStats.listsThisFrame, listStats.numLists, listStats.numAllocators);
+
+    ImGui::Checkbox("Mesh LODs", &useLods);
+    ImGui::SliderFloat("LOD error (px)", &lodErrorPixels, 0.25f, 16.0f, "%.2f");
+    ImGui::Checkbox("Meshlet culling", &useMeshletCulling);
+    ImGui::Checkbox("Frustum culling", &useFrustumCulling);
+    ImGui::Text("LOD: %u of %u triangles (%.0f%%)", lodTriangles, lodFullTriangles,
+        lodFullTriangles ? 100.0 * double(lodTriangles) / double(lodFullTriangles) : 100.0);
+    ImGui::Text("Meshlets: %u triangles culled, %u range draws", meshletCulledTriangles, meshletDraws);
+    ImGui::Text("Frustum: %u of %u mesh instances drawn, %u culled", uint32_t(visibleInstances.size()),
+        uint32_t(model.getMeshInstances().size() * copyOffsets.size()), frustumCulledInstances);
+
+    ImGui::Checkbox("Instanced drawing", &useInstancing);
+    bool copiesChanged = ImGui::SliderInt("Model copies", &numCopies, 1, kMaxCopies);
+    copiesChanged |= ImGui::DragFloat("Copy spacing", &copySpacing, 0.05f, 0.1f, 100.0f);
+    if (copiesChanged)
+        updateCopyOffsets();
+    ImGui::Text("Scene CPU: %.3f ms, %u draw calls (%u instanced batches)", sceneCpuMs, sceneDrawCalls,
+        useInstancing ? uint32_t(instanceBatches.size()) : 0u);
+
+    ImGui::Checkbox("Cache instance data", &useInstanceCache);
+    ImGui::Text("Instance data: packed %u times (%u instances last), %.1f KB uploaded this frame", packedVersion, repackedInstances,
+        double(instanceUploadBytes) / 1024.0);
+
+    ImGui::Text("Model loaded %s with %u meshes and %u materials",
+        model.getSrcFile().c_str(),
+        model.getNumMeshes(),
+        model.getNumMaterials());
+    ImGui::Text("Scene graph: %u nodes, %u mesh instances", model.getSceneGraph().size(), uint32_t(model.getMeshInstances().size()));
+
+    for (const BasicMesh& mesh : model.getMeshes())
+    {
+        const uint32_t tris = (mesh.getNumIndices() > 0) ? (mesh.getNumIndices() / 3u) : (mesh.getNumVertices() / 3u);
+        ImGui::Text("Mesh %s with %u vertices and %u triangles, %u LODs, %u meshlets",
+            mesh.getName().c_str(),
+            mesh.getNumVertices(),
+            tris,
+            mesh.getNumLods(),
+            uint32_t(mesh.getMeshlets().size()));
+    }
+
+    const BasicModel::LoadStats& loadStats = model.getLoadStats();
+    ImGui::Text("Load: %.2f ms (parse %.2f ms), %s, %.1f KB mapped / %.1f KB copied, peak working set %.1f MB",
+        loadStats.totalMs, loadStats.parseMs, loadStats.cooked ? "cooked" : (loadStats.binary ? "glb" : "gltf"),
+        double(loadStats.mappedBufferBytes) / 1024.0, double(loadStats.copiedBufferBytes) / 1024.0,
+        double(loadStats.peakWorkingSetBytes) / (1024.0 * 1024.0));
+    if (!loadStats.cooked && loadStats.decodeMs > 0.0)
+    {
+        ImGui::Text("Decode: %u primitives in %.2f ms on %u threads (%.0f primitives/s)",
+            loadStats.numPrimitives, loadStats.decodeMs, loadStats.decodeThreads,
+            double(loadStats.numPrimitives) * 1000.0 / loadStats.decodeMs);
+        ImGui::Text("LODs: %u levels simplified in %.2f ms", loadStats.numLods, loadStats.lodMs);
+    }
+    if (loadStats.cacheAfter.numTriangles > 0)
+    {
+        ImGui::Text("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            loadStats.cacheBefore.getAcmr(), loadStats.cacheAfter.getAcmr(),
+            loadStats.cacheBefore.getAtvr(), loadStats.cacheAfter.getAtvr());
+    }
+
+    const BasicModel::GeometryStats& geomStats = model.getGeometryStats();
+    ImGui::Text("Geometry: %u primitives in %u uploads (%.1f KB), %s indices, %u primitives split to fit 16 bits",
+        geomStats.numPrimitives, geomStats.numUploads, double(geomStats.uploadBytes) / 1024.0,
+        geomStats.use16BitIndices ? "16-bit" : "32-bit", loadStats.numSplitPrimitives);
+
+    const char* formatNames[uint32_t(BasicMesh::VertexFormat::Count)];
+    for (uint32_t f = 0; f < uint32_t(BasicMesh::VertexFormat::Count); ++f)
+        formatNames[f] = BasicMesh::getVertexFormatName(BasicMesh::VertexFormat(f));
+
+    ImGui::Combo("Vertex format", &vertexFormat, formatNames, int(std::size(formatNames)));
+    ImGui::Text("Vertices: %u B each, %.1f KB (%.1f KB as full vertices, %.0f%%), indices %.1f KB",
+        geomStats.vertexStride, double(geomStats.vertexBytes) / 1024.0, double(geomStats.fullVertexBytes) / 1024.0,
+        geomStats.fullVertexBytes ? 100.0 * double(geomStats.vertexBytes) / double(geomStats.fullVertexBytes) : 100.0,
+        double(geomStats.indexBytes) / 1024.0);
+
+    const BuddyAllocator::Stats heapStats = app->getShaderDescriptors()->getStats();
+    ImGui::Text("Descriptors: %u/%u used (%u tables), largest free block %u",
+        heapStats.allocatedUnits, heapStats.capacity, heapStats.numAllocations, heapStats.largestFreeBlock);
+    ImGui::Text("Fragmentation: internal %.1f%%, external %.1f%%",
+        heapStats.internalFragmentation * 100.0f, heapStats.externalFragmentation * 100.0f);
+
+    const UploadScheduler::Stats uploadStats = app->getResources()->getUploads().getStats();
+    ImGui::Text("Uploads: %llu in %llu submissions (%.1f per submission), stalls %.2f ms",
+        (unsigned long long)uploadStats.uploads, (unsigned long long)uploadStats.submissions,
+        uploadStats.getUploadsPerSubmission(), uploadStats.stallMs);
+
+    const GpuMemoryAllocator::Stats memStats = app->getResources()->getMemoryStats();
+    ImGui::Text("GPU memory: %.1f / %.1f MB budget, %u committed fallbacks",
+        double(memStats.currentUsageBytes) / (1024.0 * 1024.0), double(memStats.budgetBytes) / (1024.0 * 1024.0),
+        memStats.committedFallbacks);
+    for (size_t p = 0; p < size_t(GpuMemoryAllocator::Pool::Count); ++p)
+    {
+        const GpuMemoryAllocator::PoolStats& pool = memStats.pools[p];
+        ImGui::Text("  %s: %u heaps, %u resources, %.1f / %.1f MB, fragmentation %.1f%%",
+            GpuMemoryAllocator::getPoolName(GpuMemoryAllocator::Pool(p)), pool.numHeaps, pool.numResources,
+            double(pool.usedBytes) / (1024.0 * 1024.0), double(pool.reservedBytes) / (1024.0 * 1024.0),
+            pool.fragmentation * 100.0f);
+    }
+
+    Matrix objectMatrix = model.getModelMatrix();
+
+    ImGui::Separator();
+
+    if (ImGui::IsKeyPressed(ImGuiKey_T)) gizmoOperation = 0;
+    if (ImGui::IsKeyPressed(ImGuiKey_R)) gizmoOperation = 1;
+    if (ImGui::IsKeyPressed(ImGuiKey_S)) gizmoOperation = 2;
+
+    ImGui::RadioButton("Translate", &gizmoOperation, 0);
+    ImGui::SameLine();
+    ImGui::RadioButton("Rotate", &gizmoOperation, 1);
+    ImGui::SameLine();
+    ImGui::RadioButton("Scale", &gizmoOperation, 2);
+
+    float translation[3], rotation[3], scale[3];
+    ImGuizmo::DecomposeMatrixToComponents((float*)&objectMatrix, translation, rotation, scale);
+
+    bool transformChanged = false;
+    transformChanged |= ImGui::DragFloat3("Tr", translation, 0.1f);
+    transformChanged |= ImGui::DragFloat3("Rt", rotation, 0.1f);
+    transformChanged |= ImGui::DragFloat3("Sc", scale, 0.001f);
+
+    if (transformChanged)
+    {
+        ImGuizmo::RecomposeMatrixFromComponents(translation, rotation, scale, (float*)&objectMatrix);
+        model.setModelMatrix(objectMatrix);
+        UpdateCameraPivotToModel(app->getCamera(), objectMatrix);
+    }
+
+    if (ImGui::CollapsingHeader("Light", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::DragFloat3("Light Direction", reinterpret_cast<float*>(&light.L), 0.1f, -1.0f, 1.0f);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Normalize"))
+            light.L.Normalize();
+
+        ImGui::ColorEdit3("Light Colour", reinterpret_cast<float*>(&light.Lc), ImGuiColorEditFlags_NoAlpha);
+        ImGui::ColorEdit3("Ambient Colour", reinterpret_cast<float*>(&light.Ac), ImGuiColorEditFlags_NoAlpha);
+    }
+
+    auto& mats = model.getMaterials();
+    for (size_t i = 0; i < mats.size(); ++i)
+    {
+        BasicMaterial& mat = mats[i];
+        if (mat.getMaterialType() != BasicMaterial::PHONG)
+            continue;
+
+        char header[256]{};
+        _snprintf_s(header, _countof(header), _TRUNCATE, "Material %s", mat.getName().c_str());
+
+        if (ImGui::CollapsingHeader(header, ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            BasicMaterial::PhongMaterialData ph = mat.getPhongMaterial();
+            bool dirty = false;
+
+            dirty |= ImGui::ColorEdit3("Diffuse Colour (Cd)",
+                reinterpret_cast<float*>(&ph.diffuseColour),
+                ImGuiColorEditFlags_NoAlpha);
+
+            dirty |= ImGui::ColorEdit3("Specular Colour (F0)",
+                reinterpret_cast<float*>(&ph.specularColour),
+                ImGuiColorEditFlags_NoAlpha);
+
+            dirty |= ImGui::DragFloat("Shininess (n)", &ph.shininess, 1.0f, 1.0f, 2048.0f);
+
+            bool useTex = (ph.hasDiffuseTex != 0u);
+            if (ImGui::Checkbox("Use Texture", &useTex))
+            {
+                ph.hasDiffuseTex = useTex ? 1u : 0u;
+                dirty = true;
+            }
+
+            if (dirty)
+            {
+                mat.setPhongMaterial(ph);
+                ++materialVersion;
+            }
+        }
+    }
+
+    ImGui::End();
+
+    if (!showGuizmo)
+        return;
+
+    if (!gSceneImgValid)
+        return;
+
+    ImGuizmo::SetOrthographic(false);
+    ImGuizmo::SetDrawlist(ImGui::GetForegroundDrawList());
+
+    const float x = gSceneImgMin.x;
+    const float y = gSceneImgMin.y;
+    const float w = gSceneImgMax.x - gSceneImgMin.x;
+    const float h = gSceneImgMax.y - gSceneImgMin.y;
+
+    ImGuizmo::SetRect(x, y, w, h);
+
+    ImGuizmo::OPERATION op = ImGuizmo::TRANSLATE;
+    if (gizmoOperation == 1) op = ImGuizmo::ROTATE;
+    if (gizmoOperation == 2) op = ImGuizmo::SCALE;
+
+    Matrix objectMatrix2 = model.getModelMatrix();
+
+    ImGuizmo::Manipulate(
+        (const float*)&view,
+        (const float*)&proj,
+        op,
+        ImGuizmo::LOCAL,
+        (float*)&objectMatrix2
+    );
+
+    if (ImGuizmo::IsUsing())
+    {
+        model.setModelMatrix(objectMatrix2);
+        UpdateCameraPivotToModel(app->getCamera(), objectMatrix2);
+    }
+}
+
+// ---------------------------------------------------------
+// Scene recording (shared by the main list and the chunk lists)
+// ---------------------------------------------------------
+void Assignment2Module::bindSceneState(RenderStateCache& state, uint32_t frameSlot) const
+{
+    ID3D12GraphicsCommandList* commandList = state.getCommandList();
+
+    state.setRootSignature(rootSignature.Get());
+
+    ID3D12DescriptorHeap* heaps[] =
+    {
+        app->getShaderDescriptors()->getHeap(),
+        app->getSamplers()->getHeap()
+    };
+    commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+
+    state.setConstantBufferView(0, mvpBuffer->GetGPUVirtualAddress() + (frameSlot * mvpStride));
+    state.setConstantBufferView(1, perFrameBuffer->GetGPUVirtualAddress() + (frameSlot * perFrameStride));
+    state.setDescriptorTable(4, app->getSamplers()->getGPUHandle(currentSampler));
+
+    if (useBindless)
+        state.setDescriptorTable(3, app->getShaderDescriptors()->getBindlessTableGPU());
+}
+
+void Assignment2Module::updateCopyOffsets()
+{
+    const int count = std::max(1, numCopies);
+    const int side = int(std::ceil(std::sqrt(double(count))));
+    const float half = float(side - 1) * 0.5f;
+
+    copyOffsets.resize(size_t(count));
+    for (int i = 0; i < count; ++i)
+        copyOffsets[i] = Vector3((float(i % side) - half) * copySpacing, 0.0f, (float(i / side) - half) * copySpacing);
+
+    ++copyOffsetsVersion;
+}
+
+void Assignment2Module::packInstanceData()
+{
+    const auto& meshes = model.getMeshes();
+    const auto& instances = model.getMeshInstances();
+    const auto& mats = model.getMaterials();
+    const uint32_t numInstances = uint32_t(instances.size());
+    const size_t numItems = size_t(numInstances) * copyOffsets.size();
+
+    // A moved node only touches the items of its instances; anything else touches every item
+    const bool packAll = !useInstanceCache || packedMaterialVersion != materialVersion || packedCopiesVersion != copyOffsetsVersion ||
+        packedBindless != useBindless || instancePacker.getNumItems() != numItems;
+
+    // Instances only change with a load, which also bumps the transform version
+    if (packAll || packedTransformVersion != model.getTransformVersion() || instanceNodes.size() != numInstances)
+    {
+        instanceNodes.resize(numInstances);
+        lodFullTriangles = 0;
+
+        for (uint32_t i = 0; i < numInstances; ++i)
+        {
+            instanceNodes[i] = instances[i].node;
+            lodFullTriangles += (meshes[instances[i].mesh].getNumIndices() / 3u) * uint32_t(copyOffsets.size());
+        }
+    }
+
+    if (packAll)
+    {
+        instancePacker.invalidate();
+        frustumCuller.resize(uint32_t(numItems));
+
+        // Items first, then one material-only b2 per material for the instanced batches
+        packedInstances.assign((numItems + mats.size()) * perInstanceStride, 0u);
+
+        for (size_t m = 0; m < mats.size(); ++m)
+        {
+            PerInstanceData pi{};
+            pi.material = mats[m].getPhongMaterial();
+            pi.diffuseTexIndex = useBindless ? mats[m].getDiffuseTexIndex() : 0u;
+            memcpy(packedInstances.data() + (numItems + m) * perInstanceStride, &pi, sizeof(pi));
+        }
+    }
+
+    const std::vector<uint32_t>& repacked = instancePacker.update(model.getSceneGraph(), instanceNodes.data(), numInstances,
+        copyOffsets, model.getPositionDequantMatrix());
+
+    for (uint32_t i : repacked)
+    {
+        const BasicMesh& mesh = meshes[instances[i].mesh];
+        const int matIndex = mesh.getMaterialIndex();
+
+        for (size_t copy = 0; copy < copyOffsets.size(); ++copy)
+        {
+            const uint32_t item = uint32_t(copy * numInstances + i);
+            frustumCuller.setBounds(item, mesh.getBoundsMin(), mesh.getBoundsMax(), instancePacker.getItemWorld(item));
+
+            if (matIndex < 0 || matIndex >= int(mats.size()))
+                continue;
+
+            const InstanceData& data = instancePacker.getItemData(item);
+
+            PerInstanceData pi{};
+            pi.modelMat = data.modelMat;
+            pi.normalMat = data.normalMat;
+            pi.material = mats[matIndex].getPhongMaterial();
+            pi.diffuseTexIndex = useBindless ? mats[matIndex].getDiffuseTexIndex() : 0u;
+            memcpy(packedInstances.data() + size_t(item) * perInstanceStride, &pi, sizeof(pi));
+        }
+    }
+
+    repackedInstances = uint32_t(repacked.size());
+    packedTransformVersion = model.getTransformVersion();
+    packedMaterialVersion = materialVersion;
+    packedCopiesVersion = copyOffsetsVersion;
+    packedBindless = useBindless;
+    if (packAll || !repacked.empty())
+        ++packedVersion;
+}
+
+void Assignment2Module::prepareMeshDraws(const Matrix& view, const Matrix& proj, uint32_t viewportHeight, uint32_t frameSlot)
+{
+    // World matrices of the nodes moved since last frame (gizmo, UI)
+    model.updateTransforms();
+
+    const auto& meshes = model.getMeshes();
+    const auto& instances = model.getMeshInstances();
+    const size_t numInstances = instances.size();
+
+    if (copyOffsets.size() != size_t(std::max(1, numCopies)))
+        updateCopyOffsets();
+
+    const size_t numItems = numInstances * copyOffsets.size();
+
+    lodTriangles = 0;
+    meshletDraws = 0;
+    meshletCulledTriangles = 0;
+    sceneDrawCalls = 0;
+    instanceUploadBytes = 0;
+    instanceBatches.clear();
+
+    // The material b2s of the instanced draws follow the items
+    if (!ensureInstanceCapacity(numItems + model.getNumMaterials()))
+    {
+        visibleInstances.clear();
+        return;
+    }
+
+    // Worlds, bounds and packed constants only change with the transform version, the copies or the materials
+    const bool packedStale = !useInstanceCache || packedTransformVersion != model.getTransformVersion() ||
+        packedMaterialVersion != materialVersion || packedCopiesVersion != copyOffsetsVersion ||
+        packedBindless != useBindless || instancePacker.getNumItems() != numItems;
+
+    if (packedStale)
+        packInstanceData();
+
+    // Each frame slot keeps what it was last given: copy only when it holds an older packing
+    if (slotVersions[frameSlot] != packedVersion)
+    {
+        memcpy(perInstanceMapped + frameSlot * drawItemCapacity * perInstanceStride, packedInstances.data(), packedInstances.size());
+        slotVersions[frameSlot] = packedVersion;
+        instanceUploadBytes = packedInstances.size();
+    }
+
+    meshDraws.resize(numItems);
+
+    const Vector3 cameraPos = view.Invert().Translation();
+
+    // Whole items first: world bounds against the world frustum, four items per test
+    if (useFrustumCulling)
+    {
+        Vector4 worldPlanes[6];
+        ModuleCamera::extractFrustumPlanes(view * proj, worldPlanes);
+        frustumCuller.cull(worldPlanes, visibleInstances);
+    }
+    else
+    {
+        visibleInstances.resize(numItems);
+        for (size_t item = 0; item < numItems; ++item)
+            visibleInstances[item] = uint32_t(item);
+    }
+
+    frustumCulledInstances = uint32_t(numItems - visibleInstances.size());
+
+    // Compacted in place: only items that still draw something reach recordSceneDraws
+    size_t numVisible = 0;
+    for (uint32_t itemIdx : visibleInstances)
+    {
+        const BasicMesh& mesh = meshes[instances[itemIdx % numInstances].mesh];
+        const Matrix& world = instancePacker.getItemWorld(itemIdx);
+        MeshDraw& meshDraw = meshDraws[itemIdx];
+
+        meshDraw.lod = useLods ? mesh.selectLod(mesh.getPixelsPerUnit(world, view, proj, float(viewportHeight)), lodErrorPixels) : 0u;
+        // An instanced batch draws whole meshes: the per-item meshlet ranges would split it again
+        meshDraw.useRanges = !useInstancing && useMeshletCulling && meshDraw.lod == 0 && !mesh.getMeshlets().empty();
+        meshDraw.ranges.clear();
+
+        if (meshDraw.useRanges)
+        {
+            // Meshlet bounds are in mesh space: bring the frustum and the eye there instead of moving every meshlet
+            Vector4 planes[6];
+            ModuleCamera::extractFrustumPlanes(world * view * proj, planes);
+            const Vector3 eye = Vector3::Transform(cameraPos, world.Invert());
+
+            const uint32_t visible = mesh.cullMeshlets(planes, eye, meshDraw.ranges);
+            lodTriangles += visible;
+            meshletCulledTriangles += mesh.getNumIndices() / 3u - visible;
+            meshletDraws += uint32_t(meshDraw.ranges.size());
+            sceneDrawCalls += uint32_t(meshDraw.ranges.size());
+
+            // Every meshlet culled
+            if (meshDraw.ranges.empty())
+                continue;
+        }
+        else
+        {
+            lodTriangles += mesh.getLodNumIndices(meshDraw.lod) / 3u;
+            ++sceneDrawCalls;
+        }
+
+        visibleInstances[numVisible++] = itemIdx;
+    }
+
+    visibleInstances.resize(numVisible);
+
+    if (!useInstancing || !instanceDataMapped)
+        return;
+
+    // Counting sort of the visible items by mesh and LOD: one batch per non-empty key, in key order
+    const uint32_t numKeys = uint32_t(meshes.size()) * kLodsPerMesh;
+    batchStarts.assign(size_t(numKeys) + 1, 0u);
+
+    for (uint32_t itemIdx : visibleInstances)
+        ++batchStarts[instances[itemIdx % numInstances].mesh * kLodsPerMesh + meshDraws[itemIdx].lod + 1];
+
+    for (uint32_t key = 0; key < numKeys; ++key)
+    {
+        const uint32_t count = batchStarts[key + 1];
+        batchStarts[key + 1] = batchStarts[key] + count;
+
+        if (count > 0)
+        {
+            InstanceBatch batch;
+            batch.mesh = key / kLodsPerMesh;
+            batch.lod = key % kLodsPerMesh;
+            batch.firstInstance = batchStarts[key];
+            batch.numInstances = count;
+            instanceBatches.push_back(batch);
+        }
+    }
+
+    // Batch order depends on the camera, so the matrices are scattered every frame, from the packed copies.
+    // The upload heap is write-combined: write whole elements.
+    uint8_t* slotData = instanceDataMapped + frameSlot * drawItemCapacity * sizeof(InstanceData);
+
+    for (uint32_t itemIdx : visibleInstances)
+    {
+        const uint32_t slot = batchStarts[instances[itemIdx % numInstances].mesh * kLodsPerMesh + meshDraws[itemIdx].lod]++;
+        memcpy(slotData + slot * sizeof(InstanceData), &instancePacker.getItemData(itemIdx), sizeof(InstanceData));
+    }
+
+    sceneDrawCalls = uint32_t(instanceBatches.size());
+}
+
+void Assignment2Module::buildRenderQueue(const Matrix& view)
+{
+    const auto& meshes = model.getMeshes();
+    const auto& instances = model.getMeshInstances();
+    const uint32_t numMaterials = model.getNumMaterials();
+    const uint32_t pipeline = uint32_t(model.getVertexFormat()) + (useInstancing ? uint32_t(BasicMesh::VertexFormat::Count) : 0u);
+
+    renderQueue.clear();
+
+    if (useInstancing)
+    {
+        // A batch spans many depths: within a material and mesh it keeps the counting sort's LOD order
+        for (uint32_t batchIdx = 0; batchIdx < uint32_t(instanceBatches.size()); ++batchIdx)
+        {
+            const InstanceBatch& batch = instanceBatches[batchIdx];
+            const int matIndex = meshes[batch.mesh].getMaterialIndex();
+            if (matIndex >= 0 && uint32_t(matIndex) < numMaterials)
+                renderQueue.push(RenderQueue::makeKey(kScenePass, pipeline, uint32_t(matIndex), batch.mesh, 0.0f), batchIdx);
+        }
+    }
+    else
+    {
+        const size_t numInstances = instances.size();
+
+        for (uint32_t drawIdx = 0; drawIdx < uint32_t(visibleInstances.size()); ++drawIdx)
+        {
+            const uint32_t itemIdx = visibleInstances[drawIdx];
+            const uint32_t meshIdx = instances[itemIdx % numInstances].mesh;
+            const BasicMesh& mesh = meshes[meshIdx];
+            const int matIndex = mesh.getMaterialIndex();
+            if (matIndex < 0 || uint32_t(matIndex) >= numMaterials)
+                continue;
+
+            // Front to back inside each material and mesh, for early depth rejection
+            const Vector3 center = Vector3::Transform((mesh.getBoundsMin() + mesh.getBoundsMax()) * 0.5f, instancePacker.getItemWorld(itemIdx));
+            const float depth = Vector3::Transform(center, view).Length();
+
+            renderQueue.push(RenderQueue::makeKey(kScenePass, pipeline, uint32_t(matIndex), meshIdx, depth), itemIdx);
+        }
+    }
+
+    renderQueuePasses = sortDraws ? renderQueue.sort() : 0u;
+}
+
+void Assignment2Module::recordSceneDraws(RenderStateCache& state, uint32_t frameSlot, const DrawRange& range)
+{
+    if (useInstancing)
+    {
+        recordInstancedDraws(state, frameSlot, range);
+        return;
+    }
+
+    ID3D12GraphicsCommandList* commandList = state.getCommandList();
+
+    const auto& meshes = model.getMeshes();
+    const auto& instances = model.getMeshInstances();
+    const auto& mats = model.getMaterials();
+    const size_t numInstances = instances.size();
+
+    for (uint32_t queueIdx = range.begin; queueIdx < range.end; ++queueIdx)
+    {
+        const uint32_t itemIdx = renderQueue[queueIdx].payload;
+        const BasicMesh& mesh = meshes[instances[itemIdx % numInstances].mesh];
+        const BasicMaterial& mat = mats[size_t(mesh.getMaterialIndex())];
+
+        // The item's b2 was filled in prepareMeshDraws (or by an earlier frame with the same packing)
+        state.setConstantBufferView(2, perInstanceBuffer->GetGPUVirtualAddress() + (frameSlot * drawItemCapacity + itemIdx) * perInstanceStride);
+
+        if (!useBindless)
+            state.setDescriptorTable(3, mat.getTexturesTableGPU());
+
+        mesh.bindGeometry(state);
+
+        const MeshDraw& meshDraw = meshDraws[itemIdx];
+        if (meshDraw.useRanges)
+            mesh.drawRanges(commandList, meshDraw.ranges.data(), meshDraw.ranges.size());
+        else
+            mesh.draw(commandList, false, meshDraw.lod);
+    }
+}
+
+void Assignment2Module::recordInstancedDraws(RenderStateCache& state, uint32_t frameSlot, const DrawRange& range)
+{
+    ID3D12GraphicsCommandList* commandList = state.getCommandList();
+
+    const auto& meshes = model.getMeshes();
+    const auto& mats = model.getMaterials();
+    const size_t materialBase = instancePacker.getNumItems();
+
+    if (!instanceDataBuffer)
+        return;
+
+    for (uint32_t queueIdx = range.begin; queueIdx < range.end; ++queueIdx)
+    {
+        const InstanceBatch& batch = instanceBatches[renderQueue[queueIdx].payload];
+        const BasicMesh& mesh = meshes[batch.mesh];
+        const size_t matIndex = size_t(mesh.getMaterialIndex());
+
+        // b2 only carries the material here (packed after the items); the matrices come from the instance SRV
+        state.setConstantBufferView(2, perInstanceBuffer->GetGPUVirtualAddress() + (frameSlot * drawItemCapacity + materialBase + matIndex) * perInstanceStride);
+
+        // Starting the view at the batch's first element lets SV_InstanceID index it from 0
+        state.setShaderResourceView(5, instanceDataBuffer->GetGPUVirtualAddress() + (frameSlot * drawItemCapacity + batch.firstInstance) * sizeof(InstanceData));
+
+        if (!useBindless)
+            state.setDescriptorTable(3, mats[matIndex].getTexturesTableGPU());
+
+        mesh.bindGeometry(state);
+        mesh.draw(commandList, false, batch.lod, batch.numInstances);
+    }
+}
+
+// ---------------------------------------------------------
+// render
+// ---------------------------------------------------------
+void Assignment2Module::render()
+{
+    D3D12Module* d3d12 = app->getD3D12Module();
+    if (!d3d12 || !sceneRT)
+        return;
+
+    ID3D12GraphicsCommandList* commandList = d3d12->getCommandList();
+    if (!commandList)
+        return;
+
+    Matrix view = Matrix::Identity;
+    Matrix proj = Matrix::Identity;
+
+    ImGuizmo::BeginFrame();
+
+    uint32_t sceneW = lastSceneW;
+    uint32_t sceneH = lastSceneH;
+
+    {
+        if (ModuleCamera* cam = app->getCamera())
+        {
+            cam->setAspectRatio((sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f);
+            view = cam->getViewMatrix();
+            proj = cam->getProjectionMatrix();
+        }
+        else
+        {
+            view = Matrix::CreateLookAt(Vector3(0.0f, 2.0f, 6.0f), Vector3::Zero, Vector3::Up);
+            proj = Matrix::CreatePerspectiveFieldOfView(
+                XM_PIDIV4,
+                (sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f,
+                0.1f, 1000.0f);
+        }
+        ImGuiIO& io = ImGui::GetIO();
+        io.ConfigWindowsMoveFromTitleBarOnly = true;
+
+        buildImGuiAndHandleResize(view, proj, sceneW, sceneH);
+
+        if (ModuleCamera* cam = app->getCamera())
+        {
+            cam->setAspectRatio((sceneH > 0) ? (float(sceneW) / float(sceneH)) : 1.0f);
+            view = cam->getViewMatrix();
+            proj = cam->getProjectionMatrix();
+        }
+    }
+
+    // Vertex format picked in the options window: reload before anything is recorded with the old buffers
+    if (vertexFormat != appliedVertexFormat)
+    {
+        appliedVertexFormat = vertexFormat;
+        model.setVertexFormat(BasicMesh::VertexFormat(vertexFormat));
+        loadModel();
+
+        // The new buffers were created after preRender submitted this frame's copies
+        app->getResources()->flushUploads();
+    }
+
+    ID3D12PipelineState* scenePso = (useInstancing ? instancedPso : pso)[size_t(model.getVertexFormat())].Get();
+
+    const uint32_t frameSlot = (d3d12->getCurrentFrame() % kFramesInFlight);
+
+    Timer sceneTimer;
+    sceneTimer.start();
+
+    prepareMeshDraws(view, proj, sceneH, frameSlot);
+    buildRenderQueue(view);
+
+    sceneTimer.stop();
+
+    commandList->Reset(d3d12->getCommandAllocator(), scenePso);
+
+    BEGIN_EVENT(commandList, "Assignment2 Frame");
+
+    // Update CBs
+    {
+        if (mvpMapped)
+        {
+            MVPData cb{};
+            cb.viewProj = (view * proj).Transpose();
+            memcpy(mvpMapped + (frameSlot * mvpStride), &cb, sizeof(cb));
+        }
+
+        if (perFrameMapped)
+        {
+            PerFrameData pf{};
+            pf.L = light.L;
+            pf.L.Normalize();
+            pf.Lc = light.Lc;
+            pf.Ac = light.Ac;
+
+            if (ModuleCamera* cam = app->getCamera())
+                pf.viewPos = cam->getPosition();
+            else
+                pf.viewPos = Vector3(0.0f, 2.0f, 6.0f);
+
+            memcpy(perFrameMapped + (frameSlot * perFrameStride), &pf, sizeof(pf));
+        }
+    }
+
+    RenderStateCache state;
+    state.begin(commandList, scenePso, skipRedundantState);
+
+    bindSceneState(state, frameSlot);
+
+    // Lists submitted in order: setup, scene chunks, then debug draw + ImGui
+    std::vector<ID3D12CommandList*> submitLists;
+
+    // The graph places every transition and owns the scene depth buffer as a transient
+    frameGraph.reset();
+
+    FrameGraph::TextureDesc depthDesc;
+    depthDesc.width = sceneW;
+    depthDesc.height = sceneH;
+    depthDesc.format = DXGI_FORMAT_D32_FLOAT;
+    depthDesc.flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    depthDesc.clearValue.Format = DXGI_FORMAT_D32_FLOAT;
+    depthDesc.clearValue.DepthStencil.Depth = 1.0f;
+
+    D3D12_RESOURCE_STATES backBufferState = D3D12_RESOURCE_STATE_PRESENT;
+
+    const FrameGraph::ResourceHandle sceneColour = frameGraph.importResource("SceneRT", sceneRT->getTexture(), sceneRT->getTextureState());
+    const FrameGraph::ResourceHandle sceneDepth = frameGraph.createTexture("SceneRT_depth", depthDesc);
+    const FrameGraph::ResourceHandle backBuffer = frameGraph.importResource("BackBuffer", d3d12->getBackBuffer(), backBufferState);
+    frameGraph.setFinalState(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+
+    // Scene pass: records through commandList, which it may replace when the chunks close the setup list
+    const uint32_t scenePass = frameGraph.addPass("Scene Pass -> RenderTexture", [&](FrameGraph::Context& context)
+        {
+            const D3D12_CPU_DESCRIPTOR_HANDLE sceneDsv = frameGraph.getDsv(sceneDepth);
+
+            // The depth buffer may share memory with other transients: cleared before anything reads it
+            sceneRT->bindRenderTarget(commandList, sceneDsv);
+            sceneRT->clearRenderTarget(commandList);
+            commandList->ClearDepthStencilView(sceneDsv, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
+
+            CommandListPool& listPool = d3d12->getCommandListPool();
+            JobSystem* jobs = app->getJobSystem();
+
+            const uint32_t maxChunks = (parallelRecording && jobs) ? listPool.getNumThreads() : 1u;
+            partitionDraws(renderQueue.size(), maxChunks, uint32_t(std::max(1, minDrawsPerChunk)), drawChunks);
+
+            sceneTimer.start();
+
+            // Chunk lists in draw order; empty when the scene is recorded on the setup list
+            std::vector<ID3D12GraphicsCommandList*> chunkLists;
+            std::vector<RenderStateCache::Stats> chunkStats;
+
+            if (drawChunks.size() > 1)
+            {
+                const size_t numChunks = drawChunks.size();
+
+                chunkLists.assign(numChunks, nullptr);
+                chunkStats.assign(numChunks, RenderStateCache::Stats{});
+
+                std::atomic<uint32_t> failedChunks{ 0 };
+
+                // Each chunk starts from a fresh list and cache: root signature, heaps, targets and geometry are bound again
+                jobs->parallelFor(uint32_t(numChunks), 1, [&](uint32_t begin, uint32_t end)
+                    {
+                        for (uint32_t i = begin; i < end; ++i)
+                        {
+                            ID3D12GraphicsCommandList* chunkList = listPool.acquire(jobs->getThreadIndex(), scenePso);
+                            if (!chunkList)
+                            {
+                                failedChunks.fetch_add(1);
+                                continue;
+                            }
+
+                            BEGIN_EVENT(chunkList, "Scene Chunk");
+
+                            RenderStateCache chunkState;
+                            chunkState.begin(chunkList, scenePso, skipRedundantState);
+
+                            bindSceneState(chunkState, frameSlot);
+                            sceneRT->bindRenderTarget(chunkList, sceneDsv);
+
+                            recordSceneDraws(chunkState, frameSlot, drawChunks[i]);
+                            chunkStats[i] = chunkState.getStats();
+
+                            END_EVENT(chunkList);
+
+                            if (SUCCEEDED(chunkList->Close()))
+                                chunkLists[i] = chunkList;
+                            else
+                                failedChunks.fetch_add(1);
+                        }
+                    });
+
+                // A missing chunk would lose its draws: record the whole queue on the setup list instead, in order.
+                // The chunk lists recorded so far are not submitted and go back to the pool with the frame slot.
+                if (failedChunks.load() > 0)
+                {
+                    LOG("Assignment2Module: %u of %zu scene chunks could not be recorded, recording the scene on one list",
+                        failedChunks.load(), numChunks);
+
+                    partitionDraws(renderQueue.size(), 1, 1, drawChunks);
+                    chunkLists.clear();
+                }
+            }
+
+            RenderStateCache::Stats stateStats;
+
+            if (chunkLists.empty())
+            {
+                if (!drawChunks.empty())
+                    recordSceneDraws(state, frameSlot, drawChunks[0]);
+
+                stateStats = state.getStats();
+            }
+            else
+            {
+                stateStats = state.getStats();
+                for (const RenderStateCache::Stats& stats : chunkStats)
+                    stateStats.add(stats);
+            }
+
+            sceneTimer.stop();
+            sceneCpuMs = sceneTimer.readMs();
+
+            lastDrawChunks = uint32_t(drawChunks.size());
+            sceneStateStats = stateStats;
+
+            if (!chunkLists.empty())
+            {
+                // PIX events do not span lists: close the setup list here and continue in a new one
+                END_EVENT(commandList);
+                END_EVENT(commandList);
+
+                if (SUCCEEDED(commandList->Close()))
+                    submitLists.push_back(commandList);
+
+                submitLists.insert(submitLists.end(), chunkLists.begin(), chunkLists.end());
+
+                commandList = listPool.acquire(jobs->getThreadIndex(), nullptr);
+                if (!commandList)
+                {
+                    // Still submit what was recorded; the debug draw and ImGui pass are skipped this frame
+                    LOG("Assignment2Module: no command list left after the scene chunks, skipping debug draw and ImGui");
+                    d3d12->getDrawCommandQueue()->ExecuteCommandLists(UINT(submitLists.size()), submitLists.data());
+
+                    context.commandList = nullptr;
+                    return;
+                }
+
+                BEGIN_EVENT(commandList, "Assignment2 Frame");
+                BEGIN_EVENT(commandList, "Scene Pass -> RenderTexture");
+
+                d3d12->bindShaderVisibleHeaps(commandList);
+                sceneRT->bindRenderTarget(commandList, sceneDsv);
+            }
+
+            // Debug draw
+            {
+                if (showGrid)
+                    dd::xzSquareGrid(-50.0f, 50.0f, 0.0f, 1.0f, dd::colors::LightGray);
+
+                if (showAxis)
+                    dd::axisTriad(ddConvert(Matrix::Identity), 0.1f, 1.0f);
+
+                if (debugDrawPass)
+                    debugDrawPass->record(commandList, sceneW, sceneH, view, proj);
+            }
+
+            context.commandList = commandList;
+        });
+
+    frameGraph.write(scenePass, sceneColour, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    frameGraph.write(scenePass, sceneDepth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+    // ImGui pass: shows the scene texture in its window
+    const uint32_t imGuiPass = frameGraph.addPass("ImGui Pass -> Backbuffer", [&](FrameGraph::Context& context)
+        {
+            ID3D12GraphicsCommandList* uiList = context.commandList;
+
+            const unsigned winW = d3d12->getWindowWidth();
+            const unsigned winH = d3d12->getWindowHeight();
+
+            D3D12_VIEWPORT vp{ 0.0f, 0.0f, float(winW), float(winH), 0.0f, 1.0f };
+            D3D12_RECT sc{ 0, 0, LONG(winW), LONG(winH) };
+            uiList->RSSetViewports(1, &vp);
+            uiList->RSSetScissorRects(1, &sc);
+
+            D3D12_CPU_DESCRIPTOR_HANDLE rtv = d3d12->getRenderTargetDescriptor();
+            D3D12_CPU_DESCRIPTOR_HANDLE dsv = d3d12->getDepthStencilDescriptor();
+
+            uiList->OMSetRenderTargets(1, &rtv, FALSE, &dsv);
+
+            {
+                float clearColor[] = { 0.05f, 0.05f, 0.06f, 1.0f };
+                uiList->ClearRenderTargetView(rtv, clearColor, 0, nullptr);
+                uiList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+            }
+
+            if (ImGuiPass* ui = d3d12->getImGuiPass())
+                ui->record(uiList);
+        });
+
+    frameGraph.read(imGuiPass, sceneColour, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    frameGraph.write(imGuiPass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    ID3D12Device* device = d3d12->getDevice();
+    if (!frameGraph.compile(device) || !frameGraph.realize(device))
+    {
+        // No pass was recorded: submit the setup list alone
+        END_EVENT(commandList);
+        if (SUCCEEDED(commandList->Close()))
+            submitLists.push_back(commandList);
+
+        d3d12->getDrawCommandQueue()->ExecuteCommandLists(UINT(submitLists.size()), submitLists.data());
+
+        if (ImGuiPass* ui = d3d12->getImGuiPass())
+            ui->record(nullptr);
+        return;
+    }
+
+    commandList = frameGraph.execute(commandList);
+    if (!commandList)
+    {
+        if (ImGuiPass* ui = d3d12->getImGuiPass())
+            ui->record(nullptr);
+        return;
+    }
+
+    END_EVENT(commandList);
+
+    if (SUCCEEDED(commandList->Close()))
+        submitLists.push_back(commandList);
+
+    if (!submitLists.empty())
+        d3d12->getDrawCommandQueue()->ExecuteCommandLists(UINT(submitLists.size()), submitLists.data());
+}
+
+// ---------------------------------------------------------
+// createRootSignature
+// ---------------------------------------------------------
+bool Assignment2Module::createRootSignature()
+{
+    CD3DX12_ROOT_PARAMETER rootParameters[6] = {};
+    CD3DX12_DESCRIPTOR_RANGE srvRange;
+    CD3DX12_DESCRIPTOR_RANGE sampRange;
+
+    // Unbounded so the same table can be a material table or the whole heap (bindless)
+    srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0); // t0[]
+    sampRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, 1, 0);                    // s0
+
+    rootParameters[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_VERTEX);       // b0
+    rootParameters[1].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_ALL);          // b1
+    rootParameters[2].InitAsConstantBufferView(2, 0, D3D12_SHADER_VISIBILITY_ALL);          // b2
+    rootParameters[3].InitAsDescriptorTable(1, &srvRange, D3D12_SHADER_VISIBILITY_PIXEL);   // t0
+    rootParameters[4].InitAsDescriptorTable(1, &sampRange, D3D12_SHADER_VISIBILITY_PIXEL);  // s0
+    rootParameters[5].InitAsShaderResourceView(0, 1, D3D12_SHADER_VISIBILITY_VERTEX);       // t0, space1 (instanced VS)
+
+    CD3DX12_ROOT_SIGNATURE_DESC desc;
+    desc.Init(
+        _countof(rootParameters), rootParameters,
+        0, nullptr,
+        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
+    );
+
+    Microsoft::WRL::ComPtr<ID3DBlob> blob;
+    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+
+    if (FAILED(D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1, &blob, &errorBlob)))
+    {
+        if (errorBlob)
+            LOG("Assignment2Module RootSignature serialize error: %s", (const char*)errorBlob->GetBufferPointer());
+        return false;
+    }
+
+    HRESULT hr = app->getD3D12Module()->getDevice()->CreateRootSignature(
+        0, blob->GetBufferPointer(), blob->GetBufferSize(),
+        IID_PPV_ARGS(&rootSignature));
+
+    if (FAILED(hr))
+        return false;
+
+    rootSignature->SetName(L"Assignment2 RootSignature");
+    return true;
+}
+
+// ---------------------------------------------------------
+// createPipelineState
+// ---------------------------------------------------------
+bool Assignment2Module::createPipelineState()
+{
+    auto vs = DX::ReadData(L"Assignment2VS.cso");
+    auto packedVs = DX::ReadData(L"Assignment2PackedVS.cso");
+    auto instancedVs = DX::ReadData(L"Assignment2InstancedVS.cso");
+    auto packedInstancedVs = DX::ReadData(L"Assignment2PackedInstancedVS.cso");
+    auto ps = DX::ReadData(L"Assignment2PS.cso");
+
+    // One PSO per BasicMesh::VertexFormat and draw path, so switching never waits for a compile
+    for (uint32_t i = 0; i < 2 * uint32_t(BasicMesh::VertexFormat::Count); ++i)
+    {
+        const bool instanced = i >= uint32_t(BasicMesh::VertexFormat::Count);
+        const uint32_t f = i % uint32_t(BasicMesh::VertexFormat::Count);
+        const BasicMesh::VertexFormat format = BasicMesh::VertexFormat(f);
+        const bool full = (format == BasicMesh::VertexFormat::Full);
+        const std::vector<uint8_t>& formatVs = instanced ? (full ? instancedVs : packedInstancedVs) : (full ? vs : packedVs);
+        Microsoft::WRL::ComPtr<ID3D12PipelineState>& target = instanced ? instancedPso[f] : pso[f];
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
+        psoDesc.InputLayout = BasicMesh::getInputLayoutDesc(format);
+        psoDesc.pRootSignature = rootSignature.Get();
+        psoDesc.VS = { formatVs.data(), formatVs.size() };
+        psoDesc.PS = { ps.data(), ps.size() };
+        psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+        psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
+        psoDesc.NumRenderTargets = 1;
+        psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+
+        psoDesc.SampleDesc = { 1, 0 };
+        psoDesc.SampleMask = UINT_MAX;
+
+        psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+        psoDesc.RasterizerState.FrontCounterClockwise = TRUE;
+
+        psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+        psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+
+        HRESULT hr = app->getD3D12Module()->getDevice()->CreateGraphicsPipelineState(
+            &psoDesc, IID_PPV_ARGS(&target));
+
+        if (FAILED(hr))
+            return false;
+
+        const std::wstring name = std::wstring(instanced ? L"Assignment2 Instanced PSO (" : L"Assignment2 PSO (") + std::to_wstring(f) + L")";
+        target->SetName(name.c_str());
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------
+// createFrameBuffers
+// ---------------------------------------------------------
+bool Assignment2Module::createFrameBuffers()
+{
+    ID3D12Device* device = app->getD3D12Module()->getDevice();
+    if (!device)
+        return false;
+
+    mvpStride = alignUp(sizeof(MVPData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    perFrameStride = alignUp(sizeof(PerFrameData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    perInstanceStride = alignUp(sizeof(PerInstanceData), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+    const size_t mvpTotal = mvpStride * kFramesInFlight;
+    const size_t perFrameTotal = perFrameStride * kFramesInFlight;
+
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+
+    // b0
+    {
+        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(mvpTotal);
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&mvpBuffer))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(mvpBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mvpMapped))) || !mvpMapped)
+            return false;
+    }
+
+    // b1
+    {
+        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(perFrameTotal);
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&perFrameBuffer))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(perFrameBuffer->Map(0, &readRange, reinterpret_cast<void**>(&perFrameMapped))) || !perFrameMapped)
+            return false;
+    }
+
+    // b2 and the instance matrices grow with the draw items (ensureInstanceCapacity)
+    return ensureInstanceCapacity(std::max<size_t>(1, model.getMeshInstances().size()));
+}
+
+// ---------------------------------------------------------
+// ensureInstanceCapacity
+// ---------------------------------------------------------
+bool Assignment2Module::ensureInstanceCapacity(size_t numItems)
+{
+    if (numItems <= drawItemCapacity && perInstanceMapped && instanceDataMapped)
+        return true;
+
+    ID3D12Device* device = app->getD3D12Module()->getDevice();
+    if (!device)
+        return false;
+
+    // Doubling keeps the copy slider from recreating the buffers on every step
+    const size_t capacity = std::max(numItems, drawItemCapacity * 2);
+
+    // The GPU may still read last frame's slot from the old buffers
+    ModuleResources* resources = app->getResources();
+    if (perInstanceBuffer && perInstanceMapped) { perInstanceBuffer->Unmap(0, nullptr); perInstanceMapped = nullptr; }
+    if (instanceDataBuffer && instanceDataMapped) { instanceDataBuffer->Unmap(0, nullptr); instanceDataMapped = nullptr; }
+    if (perInstanceBuffer) resources->deferRelease(perInstanceBuffer);
+    if (instanceDataBuffer) resources->deferRelease(instanceDataBuffer);
+    drawItemCapacity = 0;
+
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+
+    // b2
+    {
+        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(perInstanceStride * kFramesInFlight * capacity);
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&perInstanceBuffer))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(perInstanceBuffer->Map(0, &readRange, reinterpret_cast<void**>(&perInstanceMapped))) || !perInstanceMapped)
+            return false;
+    }
+
+    // t0, space1
+    {
+        CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(InstanceData) * kFramesInFlight * capacity);
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+            D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&instanceDataBuffer))))
+            return false;
+
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(instanceDataBuffer->Map(0, &readRange, reinterpret_cast<void**>(&instanceDataMapped))) || !instanceDataMapped)
+            return false;
+    }
+
+    drawItemCapacity = capacity;
+
+    // New buffers: every slot needs the packed data again
+    for (uint32_t& version : slotVersions)
+        version = 0;
+
+    return true;
+}
+
+// ---------------------------------------------------------
+// loadModel
+// ---------------------------------------------------------
+bool Assignment2Module::loadModel()
+{
+    const fs::path candidates[] =
+    {
+        fs::path("Game") / "Assets" / "Models" / "Duck" / "duck.gltf",
+        fs::path("Game") / "Assets" / "Models" / "Duck" / "Duck.gltf",
+        fs::path("Assets") / "Models" / "Duck" / "duck.gltf",
+        fs::path("Assets") / "Models" / "Duck" / "Duck.gltf",
+    };
+
+    fs::path absGltf;
+    const fs::path cwd = fs::current_path();
+    const fs::path exeDir = GetExeDir();
+
+    bool found = false;
+
+    for (const fs::path& rel : candidates)
+    {
+        if (FindUpwards(cwd, rel, absGltf, 12) || FindUpwards(exeDir, rel, absGltf, 12))
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        LOG("Assignment2Module: Could not find Duck.gltf (CWD=%s, EXE=%s)",
+            cwd.generic_string().c_str(),
+            exeDir.generic_string().c_str());
+        return false;
+    }
+
+    const fs::path absDir = absGltf.parent_path();
+    const std::string gltfPath = ToGenericString(absGltf);
+    const std::string basePath = EnsureTrailingSlash(ToGenericString(absDir));
+
+    // The glTF nodes carry the model's own scale (0.01 for the duck)
+    model.load(gltfPath.c_str(), basePath.c_str(), BasicMaterial::PHONG);
+
+    // New materials and instances: every item is packed again
+    ++materialVersion;
+
+    return model.getNumMeshes() > 0;
+}
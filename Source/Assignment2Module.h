@@ -1,15 +1,22 @@
-#pragma once
+﻿#pragma once
 
 #include "Module.h"
 #include "ModuleSamplers.h"
 
 #include "BasicModel.h"
 #include "RenderTexture.h"
+#include "ParallelRecording.h"
+#include "FrustumCuller.h"
+#include "InstancePacker.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+#include "FrameGraph.h"
 
 #include <d3d12.h>
 #include <wrl.h>
 #include <memory>
 #include <cstdint>
+#include <vector>
 
 class DebugDrawPass;
 
@@ -27,15 +34,26 @@ private:
     bool createRootSignature();
     bool createPipelineState();
     bool createFrameBuffers();
+    bool ensureInstanceCapacity(size_t numItems);
     bool loadModel();
+    void updateCopyOffsets();
+    void prepareMeshDraws(const Matrix& view, const Matrix& proj, uint32_t viewportHeight, uint32_t frameSlot);
+    void buildRenderQueue(const Matrix& view);
+
+    void bindSceneState(RenderStateCache& state, uint32_t frameSlot) const;
+    void recordSceneDraws(RenderStateCache& state, uint32_t frameSlot, const DrawRange& range);
+    void recordInstancedDraws(RenderStateCache& state, uint32_t frameSlot, const DrawRange& range);
+    void packInstanceData();
 
     void buildImGuiAndHandleResize(const Matrix& view, const Matrix& proj, uint32_t& outSceneW, uint32_t& outSceneH);
     void imGuiOptionsAndGizmo(const Matrix& view, const Matrix& proj);
-    static Matrix computeNormalMatrixSafe(const Matrix& model);
 
 private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
-    Microsoft::WRL::ComPtr<ID3D12PipelineState> pso;
+    // Indexed by BasicMesh::VertexFormat
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> pso[size_t(BasicMesh::VertexFormat::Count)];
+    // Same, with the VS reading the model matrices from the instance SRV (t0, space1)
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> instancedPso[size_t(BasicMesh::VertexFormat::Count)];
 
     BasicModel model;
 
@@ -43,9 +61,10 @@ private:
     uint32_t lastSceneW = 1;
     uint32_t lastSceneH = 1;
 
+    // The per-instance model matrix moves vertices to world space first
     struct MVPData
     {
-        Matrix mvp;
+        Matrix viewProj;
     };
 
     struct PerFrameData
@@ -68,8 +87,13 @@ private:
         Matrix modelMat;
         Matrix normalMat;
         BasicMaterial::PhongMaterialData material;
+
+        uint32_t diffuseTexIndex = 0; // into the t0 SRV array
+        uint32_t _pad0[3] = {};
     };
 
+    using InstanceData = InstancePacker::InstanceData;
+
     struct Light
     {
         Vector3 L = Vector3(-0.7f, -0.14f, -0.7f);
@@ -93,6 +117,12 @@ private:
     uint8_t* perInstanceMapped = nullptr;
     size_t   perInstanceStride = 0;
 
+    Microsoft::WRL::ComPtr<ID3D12Resource> instanceDataBuffer;
+    uint8_t* instanceDataMapped = nullptr;
+
+    // Draw items (mesh instances times copies) each frame slot of b2 and the instance buffer has room for
+    size_t drawItemCapacity = 0;
+
     std::unique_ptr<DebugDrawPass> debugDrawPass;
 
     bool showAxis = false;
@@ -103,6 +133,100 @@ private:
 
     ModuleSamplers::Type currentSampler = ModuleSamplers::Type::Linear_Wrap;
 
+    // Bind the whole shader heap once per frame and index textures from PerInstanceData
+    bool useBindless = true;
+
+    // State set in the last scene pass, all lists together
+    RenderStateCache::Stats sceneStateStats;
+
+    // BasicMesh::VertexFormat of the model's vertex buffer; changing it reloads the model
+    int vertexFormat = int(BasicMesh::VertexFormat::Full);
+    int appliedVertexFormat = int(BasicMesh::VertexFormat::Full);
+
+    // Per-instance LOD from its projected size (BasicMesh::selectLod), within lodErrorPixels on screen
+    bool  useLods = true;
+    float lodErrorPixels = 1.0f;
+    uint32_t lodTriangles = 0;       // drawn this frame, after LODs and meshlet culling
+    uint32_t lodFullTriangles = 0;
+
+    // Level 0 draws only the meshlets inside the camera frustum and not facing away (BasicMesh::cullMeshlets)
+    bool useMeshletCulling = true;
+    uint32_t meshletDraws = 0;
+    uint32_t meshletCulledTriangles = 0;
+
+    // What each mesh instance draws this frame, decided before recording so the chunks only read it
+    struct MeshDraw
+    {
+        uint32_t lod = 0;
+        bool useRanges = false;
+        std::vector<BasicMesh::IndexRange> ranges;
+    };
+    std::vector<MeshDraw> meshDraws;
+
+    // Draw items whose world bounds reach the camera frustum, compacted before recording
+    bool useFrustumCulling = true;
+    FrustumCuller frustumCuller;
+    std::vector<uint32_t> visibleInstances;
+    uint32_t frustumCulledInstances = 0;
+
+    // The model drawn numCopies times on a centred XZ grid; draw item = copy * meshInstances + instance
+    int   numCopies = 1;
+    float copySpacing = 2.0f;
+    std::vector<Vector3> copyOffsets;
+
+    // Visible items with the same mesh and LOD share one DrawIndexedInstanced; their matrices are
+    // consecutive in instanceDataBuffer from firstInstance on
+    struct InstanceBatch
+    {
+        uint32_t mesh = 0;
+        uint32_t lod = 0;
+        uint32_t firstInstance = 0;
+        uint32_t numInstances = 0;
+    };
+    bool useInstancing = true;
+    std::vector<InstanceBatch> instanceBatches;
+    std::vector<uint32_t> batchStarts;       // counting sort scratch, per mesh and LOD
+
+    // CPU time of prepareMeshDraws plus recording the scene, and the draw calls it issued
+    double   sceneCpuMs = 0.0;
+    uint32_t sceneDrawCalls = 0;
+
+    // Per-item worlds, bounds and packed b2 contents. A moved node repacks only the items of its mesh instances
+    // (InstancePacker); copies, materials or the bindless switch repack everything. Each frame slot of b2 keeps
+    // its copy across frames and is refreshed when it holds an older packedVersion.
+    bool useInstanceCache = true;
+    InstancePacker instancePacker;               // worlds and instanced path matrices, scattered per frame in batch order
+    std::vector<uint32_t> instanceNodes;         // scene graph node per mesh instance
+    std::vector<uint8_t> packedInstances;        // perInstanceStride each: the items, then one per material
+    uint32_t materialVersion = 0;                // bumped by material edits in the options window
+    uint32_t copyOffsetsVersion = 0;
+    uint32_t packedTransformVersion = 0;
+    uint32_t packedMaterialVersion = 0;
+    uint32_t packedCopiesVersion = 0;
+    bool     packedBindless = true;
+    uint32_t packedVersion = 0;
+    uint32_t repackedInstances = 0;              // by the last packInstanceData
+    uint32_t slotVersions[kFramesInFlight] = {}; // 0: nothing uploaded yet
+    size_t   instanceUploadBytes = 0;            // this frame
+
+    static constexpr int kMaxCopies = 10000;
+
+    // Every scene draw (visible item or instanced batch) by sort key; the chunks record ranges of it.
+    // With sortDraws off the queue keeps the culling order, with skipRedundantState off every bind is issued.
+    bool sortDraws = true;
+    bool skipRedundantState = true;
+    RenderQueue renderQueue;
+    uint32_t renderQueuePasses = 0;
+
+    // Scene and ImGui passes, declared again every frame; the transient heap and resources persist
+    FrameGraph frameGraph;
+
+    // Split the scene draws into chunks recorded on JobSystem threads into pooled command lists
+    bool parallelRecording = true;
+    int  minDrawsPerChunk = 16;
+    std::vector<DrawRange> drawChunks;
+    uint32_t lastDrawChunks = 0;
+
     static constexpr int kAvgWindow = 60;
     double msHistory[kAvgWindow] = {};
     int    msIndex = 0;
@@ -1,6 +1,7 @@
-#include "Exercise7.hlsli"
+#include "Assignment2.hlsli"
 
-Texture2D diffuseTex : register(t0);
+// Bindless: whole shader heap; per-table: the material table (diffuseTexIndex = 0)
+Texture2D textures[] : register(t0);
 SamplerState diffuseSamp : register(s0);
 
 float3 FresnelSchlick(float3 F0, float dotNL)
@@ -13,7 +14,7 @@ float4 main(float3 worldPos : POSITION, float3 normal : NORMAL, float2 coord : T
 {
     float3 Cd = diffuseColour.rgb;
     if (hasDiffuseTex != 0)
-        Cd *= diffuseTex.Sample(diffuseSamp, coord).rgb;
+        Cd *= textures[diffuseTexIndex].Sample(diffuseSamp, coord).rgb;
 
     float3 N = normalize(normal);
 
@@ -0,0 +1,3 @@
+// Assignment2PackedVS with the model and normal matrices read per instance (one draw per mesh and LOD)
+#define INSTANCED
+#include "Assignment2PackedVS.hlsl"
@@ -0,0 +1,58 @@
+#include "Assignment2.hlsli"
+
+// Same as Assignment2VS for BasicMesh::PackedVertex / QuantizedVertex.
+// Quantized positions arrive in [0, 1]: the C++ side folds the dequantisation into modelMat.
+
+cbuffer MVP : register(b0)
+{
+    float4x4 viewProj;
+};
+
+struct VSOut
+{
+    float3 worldPos : POSITION;
+    float3 normal : NORMAL;
+    float2 texCoord : TEXCOORD;
+    float4 position : SV_POSITION;
+};
+
+// Inverse of VertexPacking::encodeOctahedral (R16G16_SNORM already gives [-1, 1])
+float3 decodeOctahedral(float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy -= t * (step(0.0f, n.xy) * 2.0f - 1.0f);
+    return normalize(n);
+}
+
+// Inverse of VertexPacking::encodeTangent: xyz + handedness in w
+float4 decodeTangent(uint2 packed)
+{
+    float2 e = float2(packed.x / 65535.0f, (packed.y >> 1) / 32767.0f) * 2.0f - 1.0f;
+    return float4(decodeOctahedral(e), (packed.y & 1u) ? -1.0f : 1.0f);
+}
+
+VSOut main(float3 position : POSITION, float2 texCoord : TEXCOORD, float2 normalOct : NORMAL, uint instanceId : SV_InstanceID)
+{
+    VSOut o;
+
+#ifdef INSTANCED
+    // PerInstance only holds the material of the batch here
+    const float4x4 model = instances[instanceId].modelMat;
+    const float4x4 normalModel = instances[instanceId].normalMat;
+#else
+    const float4x4 model = modelMat;
+    const float4x4 normalModel = normalMat;
+#endif
+
+    float4 world = mul(float4(position, 1.0f), model);
+    o.worldPos = world.xyz;
+
+    // normalMat is expected to be inverse-transpose(modelMat) (uploaded already)
+    o.normal = mul(decodeOctahedral(normalOct), (float3x3) normalModel);
+
+    o.texCoord = texCoord;
+    o.position = mul(world, viewProj);
+
+    return o;
+}
@@ -1,8 +1,8 @@
-#include "Exercise7.hlsli"
+#include "Assignment2.hlsli"
 
 cbuffer MVP : register(b0)
 {
-    float4x4 mvp;
+    float4x4 viewProj;
 };
 
 struct VSOut
@@ -13,18 +13,27 @@ struct VSOut
     float4 position : SV_POSITION;
 };
 
-VSOut main(float3 position : POSITION, float2 texCoord : TEXCOORD, float3 normal : NORMAL)
+VSOut main(float3 position : POSITION, float2 texCoord : TEXCOORD, float3 normal : NORMAL, uint instanceId : SV_InstanceID)
 {
     VSOut o;
 
-    float4 world = mul(float4(position, 1.0f), modelMat);
+#ifdef INSTANCED
+    // PerInstance only holds the material of the batch here
+    const float4x4 model = instances[instanceId].modelMat;
+    const float4x4 normalModel = instances[instanceId].normalMat;
+#else
+    const float4x4 model = modelMat;
+    const float4x4 normalModel = normalMat;
+#endif
+
+    float4 world = mul(float4(position, 1.0f), model);
     o.worldPos = world.xyz;
 
     // normalMat is expected to be inverse-transpose(modelMat) (uploaded already)
-    o.normal = mul(normal, (float3x3) normalMat);
+    o.normal = mul(normal, (float3x3) normalModel);
 
     o.texCoord = texCoord;
-    o.position = mul(float4(position, 1.0f), mvp);
+    o.position = mul(world, viewProj);
 
     return o;
 }
@@ -74,27 +74,45 @@ void BasicMaterial::releaseResources()
     }
 
     texturesTable.reset();
+    diffuseTexIndex = 0;
+}
+
+BasicMaterial::Desc BasicMaterial::describe(const tinygltf::Model& model, const tinygltf::Material& material)
+{
+    Desc desc;
+    desc.name = material.name.empty() ? "gltf_material" : material.name;
+    desc.baseColour = GetBaseColorFactor(material);
+
+    if (!TryGetBaseColorTextureURI(model, material, desc.diffuseTexture))
+        desc.diffuseTexture.clear();
+
+    return desc;
 }
 
 void BasicMaterial::load(const tinygltf::Model& model,
     const tinygltf::Material& material,
     Type type,
     const char* basePath)
+{
+    load(describe(model, material), type, basePath);
+}
+
+void BasicMaterial::load(const Desc& desc, Type type, const char* basePath)
 {
     releaseResources();
 
     materialType = type;
-    name = material.name.empty() ? "gltf_material" : material.name;
+    name = desc.name;
 
     // Fill defaults from glTF baseColorFactor
     phong = {};
-    phong.diffuseColour = GetBaseColorFactor(material);
+    phong.diffuseColour = desc.baseColour;
     phong.specularColour = Vector3(0.04f, 0.04f, 0.04f);
     phong.shininess = 64.0f;
 
     // Try load baseColor texture
-    std::string uri;
-    if (app && TryGetBaseColorTextureURI(model, material, uri))
+    const std::string& uri = desc.diffuseTexture;
+    if (app && !uri.empty())
     {
         ModuleResources* res = app->getResources();
 
@@ -142,7 +160,9 @@ void BasicMaterial::rebuildDescriptorTable()
         return;
 
     // Always allocate a table so the draw code can bind it unconditionally
-    texturesTable = descs->allocTable();
+    texturesTable = descs->allocTable(SLOT_COUNT);
+    if (!texturesTable)
+        return;
 
     // Slot 0 only
     if (textures[0])
@@ -154,4 +174,6 @@ void BasicMaterial::rebuildDescriptorTable()
         // Robust: bind a valid null SRV
         texturesTable.createNullTexture2DSRV(0);
     }
+
+    diffuseTexIndex = texturesTable.getHeapIndex(0);
 }
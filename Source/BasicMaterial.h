@@ -37,6 +37,14 @@ public:
         Vector3  _pad0 = Vector3::Zero;                          // padding to 16-byte
     };
 
+    // What a material needs from the source asset; also stored in cooked models
+    struct Desc
+    {
+        std::string name = "gltf_material";
+        Vector4     baseColour = Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+        std::string diffuseTexture;   // relative to basePath, empty if none
+    };
+
 public:
     BasicMaterial() = default;
     ~BasicMaterial();
@@ -52,6 +60,10 @@ public:
         Type type,
         const char* basePath);
 
+    void load(const Desc& desc, Type type, const char* basePath);
+
+    static Desc describe(const tinygltf::Model& model, const tinygltf::Material& material);
+
     void releaseResources();
 
     const std::string& getName() const { return name; }
@@ -64,6 +76,9 @@ public:
     // SRV table handle (used by Exercise6/7 root param t0)
     D3D12_GPU_DESCRIPTOR_HANDLE getTexturesTableGPU() const { return texturesTable.getGPUHandle(); }
 
+    // Diffuse SRV index in the shader heap (bindless path)
+    uint32_t getDiffuseTexIndex() const { return diffuseTexIndex; }
+
 private:
     void rebuildDescriptorTable();
     void enforceTextureFlags();
@@ -76,6 +91,7 @@ private:
     std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, SLOT_COUNT> textures = {};
 
     ShaderTableDesc texturesTable; // allocated from ModuleShaderDescriptors
+    uint32_t diffuseTexIndex = 0;
 
     PhongMaterialData phong = {};
 };
@@ -1,12 +1,16 @@
 #include "Globals.h"
 #include "BasicMesh.h"
 
-#include "Application.h"
-#include "ModuleResources.h"
-
 #include "gltf_utils.h"
+#include "VertexPacking.h"
+#include "RenderStateCache.h"
+
+#include <DirectXPackedVector.h>
 
 #include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
 
 const D3D12_INPUT_ELEMENT_DESC BasicMesh::inputLayout[numVertexAttribs] =
 {
@@ -19,7 +23,7 @@ const D3D12_INPUT_ELEMENT_DESC BasicMesh::inputLayout[numVertexAttribs] =
     { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, normal),
       D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
 
-    { "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, tangent),
+    { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, tangent),
       D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
 };
 
@@ -28,12 +32,58 @@ const D3D12_INPUT_LAYOUT_DESC BasicMesh::inputLayoutDesc =
     &inputLayout[0], UINT(std::size(inputLayout))
 };
 
-BasicMesh::~BasicMesh()
+const D3D12_INPUT_ELEMENT_DESC BasicMesh::packedInputLayout[numVertexAttribs] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(PackedVertex, position),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, offsetof(PackedVertex, texCoord0),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, offsetof(PackedVertex, normal),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "TANGENT", 0, DXGI_FORMAT_R16G16_UINT, 0, offsetof(PackedVertex, tangent),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+
+const D3D12_INPUT_ELEMENT_DESC BasicMesh::quantizedInputLayout[numVertexAttribs] =
+{
+    { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, offsetof(QuantizedVertex, position),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, offsetof(QuantizedVertex, texCoord0),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, offsetof(QuantizedVertex, normal),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+
+    { "TANGENT", 0, DXGI_FORMAT_R16G16_UINT, 0, offsetof(QuantizedVertex, tangent),
+      D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+};
+
+const D3D12_INPUT_LAYOUT_DESC BasicMesh::packedInputLayoutDesc =
 {
-    clean();
+    &packedInputLayout[0], UINT(std::size(packedInputLayout))
+};
+
+const D3D12_INPUT_LAYOUT_DESC BasicMesh::quantizedInputLayoutDesc =
+{
+    &quantizedInputLayout[0], UINT(std::size(quantizedInputLayout))
+};
+
+static_assert(sizeof(BasicMesh::PackedVertex) == 24, "PackedVertex layout");
+static_assert(sizeof(BasicMesh::QuantizedVertex) == 20, "QuantizedVertex layout");
+
+namespace
+{
+    // Meshes this small gain nothing from LODs
+    constexpr size_t kMinLodTriangles = 64;
+    // A level is dropped unless it keeps at most this fraction of the indices of the one before
+    constexpr float kMaxLodRatio = 0.85f;
 }
 
-void BasicMesh::load(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const tinygltf::Primitive& primitive)
+void BasicMesh::load(const tinygltf::Model& model, const GltfBuffers& buffers, const tinygltf::Mesh& mesh, const tinygltf::Primitive& primitive)
 {
     name = mesh.name.empty() ? "gltf_primitive" : mesh.name;
 
@@ -41,53 +91,19 @@ void BasicMesh::load(const tinygltf::Model& model, const tinygltf::Mesh& mesh, c
     if (itPos == primitive.attributes.end())
         return;
 
-    ModuleResources* resources = app->getResources();
-
     const tinygltf::Accessor& posAcc = model.accessors[itPos->second];
     numVertices = uint32_t(posAcc.count);
 
     vertices = std::make_unique<Vertex[]>(numVertices);
     uint8_t* vertexData = reinterpret_cast<uint8_t*>(vertices.get());
 
-    loadAccessorData(vertexData + offsetof(Vertex, position), sizeof(Vector3), sizeof(Vertex), numVertices, model, itPos->second);
-    loadAccessorData(vertexData + offsetof(Vertex, texCoord0), sizeof(Vector2), sizeof(Vertex), numVertices, model, primitive.attributes, "TEXCOORD_0");
-    loadAccessorData(vertexData + offsetof(Vertex, normal), sizeof(Vector3), sizeof(Vertex), numVertices, model, primitive.attributes, "NORMAL");
+    // Any component type is accepted: normalized UVs/normals and quantized positions (KHR_mesh_quantization) included
+    loadAccessorFloats(reinterpret_cast<float*>(vertexData + offsetof(Vertex, position)), 3, sizeof(Vertex), numVertices, model, buffers, itPos->second);
+    loadAccessorFloats(reinterpret_cast<float*>(vertexData + offsetof(Vertex, texCoord0)), 2, sizeof(Vertex), numVertices, model, buffers, primitive.attributes, "TEXCOORD_0");
+    loadAccessorFloats(reinterpret_cast<float*>(vertexData + offsetof(Vertex, normal)), 3, sizeof(Vertex), numVertices, model, buffers, primitive.attributes, "NORMAL");
 
-    // glTF tangents are commonly VEC4 (xyz + w sign). Try VEC3 first, then fallback to VEC4.
-    const bool tangentAsVec3 = loadAccessorData(vertexData + offsetof(Vertex, tangent), sizeof(Vector3), sizeof(Vertex), numVertices, model, primitive.attributes, "TANGENT");
-    if (!tangentAsVec3)
-    {
-        std::vector<Vector4> tangents4;
-        tangents4.resize(numVertices);
-
-        const bool tangentAsVec4 = loadAccessorData(
-            reinterpret_cast<uint8_t*>(tangents4.data()),
-            sizeof(Vector4),
-            sizeof(Vector4),
-            numVertices,
-            model,
-            primitive.attributes,
-            "TANGENT"
-        );
-
-        if (tangentAsVec4)
-        {
-            for (uint32_t i = 0; i < numVertices; ++i)
-            {
-                const Vector4& t = tangents4[i];
-                vertices[i].tangent = Vector3(t.x, t.y, t.z * t.w);
-            }
-        }
-        // If no tangent was loaded, we keep the default tangent (UnitX).
-    }
-
-    vertexBuffer = resources->createDefaultBuffer(vertices.get(), numVertices * sizeof(Vertex), name.c_str());
-    if (!vertexBuffer)
-        return;
-
-    vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
-    vertexBufferView.StrideInBytes = sizeof(Vertex);
-    vertexBufferView.SizeInBytes = numVertices * sizeof(Vertex);
+    // glTF tangents are VEC4 (xyz + handedness); a VEC3 tangent keeps w = 1, a missing one stays UnitX
+    loadAccessorFloats(reinterpret_cast<float*>(vertexData + offsetof(Vertex, tangent)), 4, sizeof(Vertex), numVertices, model, buffers, primitive.attributes, "TANGENT");
 
     // Indices (optional)
     if (primitive.indices >= 0)
@@ -99,44 +115,369 @@ void BasicMesh::load(const tinygltf::Model& model, const tinygltf::Mesh& mesh, c
             indAcc.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE,
             "Unsupported index format");
 
-        static const DXGI_FORMAT formats[3] = { DXGI_FORMAT_R8_UINT, DXGI_FORMAT_R16_UINT, DXGI_FORMAT_R32_UINT };
-
-        indexElementSize = tinygltf::GetComponentSizeInBytes(indAcc.componentType);
         numIndices = uint32_t(indAcc.count);
+        indices = std::make_unique<uint32_t[]>(numIndices);
 
-        indices = std::make_unique<uint8_t[]>(numIndices * indexElementSize);
-        loadAccessorData(indices.get(), indexElementSize, indexElementSize, numIndices, model, primitive.indices);
-
-        indexBuffer = resources->createDefaultBuffer(indices.get(), numIndices * indexElementSize, name.c_str());
-        if (indexBuffer)
+        if (!loadAccessorIndices(indices.get(), numIndices, model, buffers, primitive.indices))
         {
-            indexBufferView.BufferLocation = indexBuffer->GetGPUVirtualAddress();
-            indexBufferView.Format = formats[indexElementSize >> 1];
-            indexBufferView.SizeInBytes = numIndices * indexElementSize;
+            indices.reset();
+            numIndices = 0;
         }
     }
 
     materialIndex = primitive.material;
+    updateBounds();
+}
+
+void BasicMesh::importPrimitive(const tinygltf::Model& model, const GltfBuffers& buffers, const tinygltf::Mesh& mesh,
+    const tinygltf::Primitive& primitive, bool optimizeMesh, std::vector<BasicMesh>& parts, ImportStats& stats)
+{
+    stats = ImportStats{};
+
+    load(model, buffers, mesh, primitive);
+
+    if (optimizeMesh)
+        optimize(stats.cacheBefore, stats.cacheAfter);
+
+    // After optimize, so each part keeps its share of the optimised order
+    split(MeshOptimizer::kMax16BitVertices, parts);
+
+    const auto lodStart = std::chrono::steady_clock::now();
+
+    if (parts.empty())
+        stats.numLods = buildLods();
+
+    for (BasicMesh& part : parts)
+        stats.numLods += part.buildLods();
+
+    stats.lodMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lodStart).count();
+
+    if (parts.empty())
+        buildMeshlets();
+
+    for (BasicMesh& part : parts)
+        part.buildMeshlets();
+}
+
+bool BasicMesh::optimize(MeshOptimizer::VertexCacheStats& before, MeshOptimizer::VertexCacheStats& after)
+{
+    if (!vertices || !indices || numIndices < 3 || numIndices % 3 != 0)
+        return false;
+
+    before = MeshOptimizer::analyzeVertexCache(indices.get(), numIndices, numVertices);
+
+    if (!MeshOptimizer::optimizeVertexCache(indices.get(), numIndices, numVertices))
+        return false;
+
+    MeshOptimizer::optimizeOverdraw(indices.get(), numIndices, reinterpret_cast<const float*>(&vertices[0].position), sizeof(Vertex), numVertices);
+    MeshOptimizer::optimizeVertexFetch(vertices.get(), numVertices, sizeof(Vertex), indices.get(), numIndices);
+
+    after = MeshOptimizer::analyzeVertexCache(indices.get(), numIndices, numVertices);
+    return true;
 }
 
-void BasicMesh::draw(ID3D12GraphicsCommandList* commandList) const
+uint32_t BasicMesh::buildLods(uint32_t maxLods, float maxRelativeError)
 {
-    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+    lods.clear();
+    lodIndices.clear();
+
+    if (!vertices || !indices || numIndices < 3 || numIndices % 3 != 0)
+        return 0;
+
+    const float maxError = maxRelativeError * (boundsMax - boundsMin).Length() * 0.5f;
+    if (maxError <= 0.0f)
+        return 0;
+
+    // Each level is simplified from the previous one, so errors add up along the chain
+    std::vector<uint32_t> source(indices.get(), indices.get() + numIndices);
+    std::vector<uint32_t> level(numIndices);
+    float error = 0.0f;
+
+    for (uint32_t l = 0; l < maxLods; ++l)
+    {
+        const size_t sourceTriangles = source.size() / 3;
+        if (sourceTriangles < kMinLodTriangles)
+            break;
+
+        float levelError = 0.0f;
+        const size_t count = MeshOptimizer::simplify(level.data(), source.data(), source.size(),
+            reinterpret_cast<const float*>(&vertices[0].position), sizeof(Vertex), numVertices,
+            (sourceTriangles / 2) * 3, maxError - error, &levelError);
+
+        // Not worth an extra range in the index buffer
+        if (count == 0 || float(count) > float(source.size()) * kMaxLodRatio)
+            break;
 
-    if (indexBuffer)
+        MeshOptimizer::optimizeVertexCache(level.data(), count, numVertices);
+        error += levelError;
+
+        lods.push_back(Lod{ numIndices + uint32_t(lodIndices.size()), uint32_t(count), error });
+        lodIndices.insert(lodIndices.end(), level.begin(), level.begin() + count);
+        source.assign(level.begin(), level.begin() + count);
+    }
+
+    return uint32_t(lods.size());
+}
+
+bool BasicMesh::buildMeshlets()
+{
+    meshlets.clear();
+
+    if (!vertices || !indices || numIndices < 3)
+        return false;
+
+    return MeshOptimizer::buildMeshlets(indices.get(), numIndices, reinterpret_cast<const float*>(&vertices[0].position), sizeof(Vertex),
+        numVertices, meshlets);
+}
+
+uint32_t BasicMesh::cullMeshlets(const Vector4 planes[6], const Vector3& eye, std::vector<IndexRange>& ranges) const
+{
+    ranges.clear();
+
+    const float (*planeArray)[4] = reinterpret_cast<const float (*)[4]>(planes);
+    uint32_t numTriangles = 0;
+
+    for (const MeshOptimizer::Meshlet& meshlet : meshlets)
+    {
+        if (MeshOptimizer::isMeshletCulled(meshlet, planeArray, &eye.x))
+            continue;
+
+        if (!ranges.empty() && ranges.back().firstIndex + ranges.back().numIndices == meshlet.firstIndex)
+            ranges.back().numIndices += meshlet.numIndices;
+        else
+            ranges.push_back(IndexRange{ meshlet.firstIndex, meshlet.numIndices });
+
+        numTriangles += meshlet.numIndices / 3;
+    }
+
+    return numTriangles;
+}
+
+uint32_t BasicMesh::selectLod(float pixelsPerUnit, float maxErrorPixels) const
+{
+    for (uint32_t lod = uint32_t(lods.size()); lod > 0; --lod)
     {
-        commandList->IASetIndexBuffer(&indexBufferView);
-        commandList->DrawIndexedInstanced(numIndices, 1, 0, 0, 0);
+        if (lods[lod - 1].error * pixelsPerUnit <= maxErrorPixels)
+            return lod;
     }
+
+    return 0;
+}
+
+float BasicMesh::getPixelsPerUnit(const Matrix& world, const Matrix& view, const Matrix& proj, float viewportHeight) const
+{
+    const Vector3 center = Vector3::Transform((boundsMin + boundsMax) * 0.5f, world);
+    const float scale = std::max(world.Right().Length(), std::max(world.Up().Length(), world.Backward().Length()));
+    const float radius = (boundsMax - boundsMin).Length() * 0.5f * scale;
+
+    const float distance = Vector3::Transform(center, view).Length();
+    if (distance <= radius)
+        return FLT_MAX;
+
+    // proj._22 is cot(fovY / 2) for a perspective projection
+    return scale * proj._22 * 0.5f * viewportHeight / distance;
+}
+
+bool BasicMesh::split(uint32_t maxVertices, std::vector<BasicMesh>& parts) const
+{
+    parts.clear();
+
+    // Non-indexed meshes are drawn without the index buffer, so their vertex count does not matter
+    if (!vertices || !indices || numVertices <= maxVertices)
+        return false;
+
+    std::vector<MeshOptimizer::MeshPart> meshParts;
+    if (!MeshOptimizer::splitByVertexLimit(indices.get(), numIndices, numVertices, maxVertices, meshParts))
+        return false;
+
+    parts.resize(meshParts.size());
+    for (size_t p = 0; p < meshParts.size(); ++p)
+    {
+        const MeshOptimizer::MeshPart& src = meshParts[p];
+        BasicMesh& part = parts[p];
+
+        part.name = name;
+        part.materialIndex = materialIndex;
+        part.numVertices = uint32_t(src.vertices.size());
+        part.numIndices = uint32_t(src.indices.size());
+
+        part.vertices = std::make_unique<Vertex[]>(part.numVertices);
+        for (uint32_t v = 0; v < part.numVertices; ++v)
+            part.vertices[v] = vertices[src.vertices[v]];
+
+        part.indices = std::make_unique<uint32_t[]>(part.numIndices);
+        std::copy(src.indices.begin(), src.indices.end(), part.indices.get());
+
+        part.updateBounds();
+    }
+
+    // No LODs or meshlets: they index the original vertices (see the header)
+
+    return true;
+}
+
+void BasicMesh::loadPacked(const std::string& newName, uint32_t newNumVertices, uint32_t newNumIndices, int newMaterialIndex,
+    const Vector3& newBoundsMin, const Vector3& newBoundsMax,
+    const std::vector<Lod>& newLods, const std::vector<MeshOptimizer::Meshlet>& newMeshlets)
+{
+    name = newName;
+    numVertices = newNumVertices;
+    numIndices = newNumIndices;
+    materialIndex = newMaterialIndex;
+    boundsMin = newBoundsMin;
+    boundsMax = newBoundsMax;
+
+    vertices.reset();
+    indices.reset();
+
+    lods = newLods;
+    lodIndices.clear();
+    meshlets = newMeshlets;
+}
+
+void BasicMesh::updateBounds()
+{
+    boundsMin = Vector3::Zero;
+    boundsMax = Vector3::Zero;
+
+    if (!vertices || numVertices == 0)
+        return;
+
+    boundsMin = vertices[0].position;
+    boundsMax = vertices[0].position;
+    for (uint32_t v = 1; v < numVertices; ++v)
+    {
+        boundsMin = Vector3::Min(boundsMin, vertices[v].position);
+        boundsMax = Vector3::Max(boundsMax, vertices[v].position);
+    }
+}
+
+void BasicMesh::setGeometry(const D3D12_VERTEX_BUFFER_VIEW& vbView, const D3D12_INDEX_BUFFER_VIEW& ibView, uint32_t newBaseVertex, uint32_t newFirstIndex)
+{
+    vertexBufferView = vbView;
+    indexBufferView = ibView;
+    baseVertex = newBaseVertex;
+    firstIndex = newFirstIndex;
+}
+
+void BasicMesh::bindGeometry(RenderStateCache& state) const
+{
+    if (vertexBufferView.SizeInBytes == 0)
+        return;
+
+    state.setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    state.setVertexBuffer(vertexBufferView);
+
+    if (numIndices > 0)
+        state.setIndexBuffer(indexBufferView);
+}
+
+void BasicMesh::draw(ID3D12GraphicsCommandList* commandList, bool bindBuffers, uint32_t lod, uint32_t numInstances) const
+{
+    if (vertexBufferView.SizeInBytes == 0)
+        return;
+
+    if (bindBuffers)
+    {
+        commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+
+        if (numIndices > 0)
+            commandList->IASetIndexBuffer(&indexBufferView);
+    }
+
+    if (numIndices > 0 && lod > 0 && lod <= lods.size())
+        commandList->DrawIndexedInstanced(lods[lod - 1].numIndices, numInstances, firstIndex + lods[lod - 1].firstIndex, INT(baseVertex), 0);
+    else if (numIndices > 0)
+        commandList->DrawIndexedInstanced(numIndices, numInstances, firstIndex, INT(baseVertex), 0);
     else
+        commandList->DrawInstanced(numVertices, numInstances, baseVertex, 0);
+}
+
+void BasicMesh::drawRanges(ID3D12GraphicsCommandList* commandList, const IndexRange* ranges, size_t numRanges) const
+{
+    if (vertexBufferView.SizeInBytes == 0 || numIndices == 0)
+        return;
+
+    for (size_t i = 0; i < numRanges; ++i)
+        commandList->DrawIndexedInstanced(ranges[i].numIndices, 1, firstIndex + ranges[i].firstIndex, INT(baseVertex), 0);
+}
+
+const D3D12_INPUT_LAYOUT_DESC& BasicMesh::getInputLayoutDesc(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Packed:          return packedInputLayoutDesc;
+    case VertexFormat::PackedQuantized: return quantizedInputLayoutDesc;
+    default:                            return inputLayoutDesc;
+    }
+}
+
+uint32_t BasicMesh::getVertexStride(VertexFormat format)
+{
+    switch (format)
     {
-        commandList->DrawInstanced(numVertices, 1, 0, 0);
+    case VertexFormat::Packed:          return sizeof(PackedVertex);
+    case VertexFormat::PackedQuantized: return sizeof(QuantizedVertex);
+    default:                            return sizeof(Vertex);
     }
 }
 
-void BasicMesh::clean()
+const char* BasicMesh::getVertexFormatName(VertexFormat format)
 {
-    vertexBuffer.Reset();
-    indexBuffer.Reset();
+    switch (format)
+    {
+    case VertexFormat::Packed:          return "packed";
+    case VertexFormat::PackedQuantized: return "packed + quantized positions";
+    default:                            return "full";
+    }
+}
+
+void BasicMesh::packVertices(const Vertex* src, size_t count, VertexFormat format,
+    const Vector3& boundsMin, const Vector3& boundsMax, uint8_t* dst)
+{
+    if (format == VertexFormat::Full)
+    {
+        if (count > 0)
+            memcpy(dst, src, count * sizeof(Vertex));
+        return;
+    }
+
+    const Vector3 extent = boundsMax - boundsMin;
+
+    // Fields shared by both packed layouts
+    auto packCommon = [](const Vertex& v, uint16_t texCoord0[2], int16_t normal[2], uint16_t tangent[2])
+        {
+            texCoord0[0] = DirectX::PackedVector::XMConvertFloatToHalf(v.texCoord0.x);
+            texCoord0[1] = DirectX::PackedVector::XMConvertFloatToHalf(v.texCoord0.y);
+
+            const float n[3] = { v.normal.x, v.normal.y, v.normal.z };
+            VertexPacking::encodeOctahedral(n, normal);
+
+            const float t[3] = { v.tangent.x, v.tangent.y, v.tangent.z };
+            VertexPacking::encodeTangent(t, v.tangent.w, tangent);
+        };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vertex& v = src[i];
+
+        if (format == VertexFormat::Packed)
+        {
+            PackedVertex out;
+            out.position = v.position;
+            packCommon(v, out.texCoord0, out.normal, out.tangent);
+            memcpy(dst + i * sizeof(PackedVertex), &out, sizeof(out));
+        }
+        else
+        {
+            QuantizedVertex out;
+            out.position[0] = VertexPacking::quantizeUnorm16(v.position.x, boundsMin.x, extent.x);
+            out.position[1] = VertexPacking::quantizeUnorm16(v.position.y, boundsMin.y, extent.y);
+            out.position[2] = VertexPacking::quantizeUnorm16(v.position.z, boundsMin.z, extent.z);
+            out.position[3] = 0xFFFFu;
+            packCommon(v, out.texCoord0, out.normal, out.tangent);
+            memcpy(dst + i * sizeof(QuantizedVertex), &out, sizeof(out));
+        }
+    }
 }
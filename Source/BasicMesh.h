@@ -2,10 +2,15 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <d3d12.h>
 #include <wrl.h>
 
+#include "MeshOptimizer.h"
+
 namespace tinygltf { class Model; struct Mesh; struct Primitive; }
+struct GltfBufferSpan;
+class RenderStateCache;
 
 class BasicMesh
 {
@@ -15,12 +20,66 @@ public:
         Vector3 position = Vector3::Zero;
         Vector2 texCoord0 = Vector2::Zero;
         Vector3 normal = Vector3::UnitZ;
-        Vector3 tangent = Vector3::UnitX;
+        Vector4 tangent = Vector4(1.0f, 0.0f, 0.0f, 1.0f); // xyz + handedness
+    };
+
+    // Layout of the vertex buffer BasicModel uploads. Packed formats need Assignment2PackedVS.
+    enum class VertexFormat : uint32_t
+    {
+        Full,            // Vertex, 48 bytes
+        Packed,          // PackedVertex, 24 bytes
+        PackedQuantized, // QuantizedVertex, 20 bytes; positions are relative to the model bounds
+        Count
     };
 
+    // Half UVs, octahedral normal and tangent (see VertexPacking)
+    struct PackedVertex
+    {
+        Vector3  position;      // R32G32B32_FLOAT
+        uint16_t texCoord0[2];  // R16G16_FLOAT
+        int16_t  normal[2];     // R16G16_SNORM
+        uint16_t tangent[2];    // R16G16_UINT, handedness in bit 0 of y
+    };
+
+    struct QuantizedVertex
+    {
+        uint16_t position[4];   // R16G16B16A16_UNORM in [boundsMin, boundsMax], w = 1
+        uint16_t texCoord0[2];
+        int16_t  normal[2];
+        uint16_t tangent[2];
+    };
+
+    // Per-primitive figures of importPrimitive, summed into BasicModel::LoadStats
+    struct ImportStats
+    {
+        MeshOptimizer::VertexCacheStats cacheBefore;
+        MeshOptimizer::VertexCacheStats cacheAfter;
+        uint32_t numLods = 0;
+        double   lodMs = 0.0;
+    };
+
+    // Coarser index list over the same vertices (see buildLods)
+    struct Lod
+    {
+        uint32_t firstIndex = 0;  // relative to the mesh's first index; level 0 takes [0, getNumIndices())
+        uint32_t numIndices = 0;
+        float    error = 0.0f;    // how far the surface may have moved, in mesh units
+    };
+
+    // Part of the index list, relative to the mesh's first index
+    struct IndexRange
+    {
+        uint32_t firstIndex = 0;
+        uint32_t numIndices = 0;
+    };
+
+    // Levels built besides the full mesh, and how far they may stray as a fraction of the mesh radius
+    static constexpr uint32_t kMaxLods = 4;
+    static constexpr float kMaxLodRelativeError = 0.05f;
+
 public:
     BasicMesh() = default;
-    ~BasicMesh();
+    ~BasicMesh() = default;
 
     BasicMesh(const BasicMesh&) = delete;
     BasicMesh& operator=(const BasicMesh&) = delete;
@@ -28,43 +87,127 @@ public:
     BasicMesh(BasicMesh&&) noexcept = default;
     BasicMesh& operator=(BasicMesh&&) noexcept = default;
 
-    void load(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const tinygltf::Primitive& primitive);
+    // CPU data only: BasicModel packs every mesh into its shared vertex/index buffers
+    // Accessors are read through buffers (see GltfFile), which may point into a file mapping
+    void load(const tinygltf::Model& model, const std::vector<GltfBufferSpan>& buffers, const tinygltf::Mesh& mesh, const tinygltf::Primitive& primitive);
+
+    // The CPU work BasicModel runs on a job per primitive: load, optimize when asked, split into 16-bit parts, then
+    // LODs and meshlets for the mesh or, when it was split, for each part. Needs no device, so it is safe on any thread.
+    void importPrimitive(const tinygltf::Model& model, const std::vector<GltfBufferSpan>& buffers, const tinygltf::Mesh& mesh,
+        const tinygltf::Primitive& primitive, bool optimizeMesh, std::vector<BasicMesh>& parts, ImportStats& stats);
+
+    // Import-time reordering of the CPU data: triangles for the post-transform cache, then for overdraw,
+    // then vertices in first-use order. Indexed triangle lists only; before/after come from the cache simulator.
+    bool optimize(MeshOptimizer::VertexCacheStats& before, MeshOptimizer::VertexCacheStats& after);
+
+    // Simplifies the mesh (MeshOptimizer::simplify) into up to maxLods levels, each aiming at half the triangles
+    // of the one before. Stops early when a level barely shrinks or would exceed maxRelativeError.
+    uint32_t buildLods(uint32_t maxLods = kMaxLods, float maxRelativeError = kMaxLodRelativeError);
+
+    // Cuts level 0 into MeshOptimizer::Meshlet runs with culling bounds. Needs the CPU copy.
+    bool buildMeshlets();
+
+    // Meshes referencing more than maxVertices vertices are cut into parts that fit 16-bit indices
+    // (see MeshOptimizer::splitByVertexLimit). Returns false, leaving parts empty, when no split is needed.
+    // Parts hold level 0 only: this mesh's LODs and meshlets index its own vertices and are not carried over,
+    // so call buildLods and buildMeshlets on each part (importPrimitive does).
+    bool split(uint32_t maxVertices, std::vector<BasicMesh>& parts) const;
+
+    // Metadata only, for geometry that is uploaded already packed (cooked models): no CPU copy is kept
+    void loadPacked(const std::string& name, uint32_t numVertices, uint32_t numIndices, int materialIndex,
+        const Vector3& boundsMin, const Vector3& boundsMax,
+        const std::vector<Lod>& lods = {}, const std::vector<MeshOptimizer::Meshlet>& meshlets = {});
 
     const std::string& getName() const { return name; }
 
     uint32_t getNumVertices() const { return numVertices; }
     uint32_t getNumIndices() const { return numIndices; }
 
+    const Vertex* getVertices() const { return vertices.get(); }
+    const uint32_t* getIndices() const { return indices.get(); }
+
+    // Level 0 is the full mesh. Coarser levels follow level 0 in the index buffer; getLodIndices holds their CPU copy.
+    uint32_t getNumLods() const { return 1 + uint32_t(lods.size()); }
+    uint32_t getLodNumIndices(uint32_t lod) const { return (lod == 0 || lod > lods.size()) ? numIndices : lods[lod - 1].numIndices; }
+    float getLodError(uint32_t lod) const { return (lod == 0 || lod > lods.size()) ? 0.0f : lods[lod - 1].error; }
+    const std::vector<Lod>& getLods() const { return lods; }
+    const std::vector<uint32_t>& getLodIndices() const { return lodIndices; }
+
+    const std::vector<MeshOptimizer::Meshlet>& getMeshlets() const { return meshlets; }
+
+    // Level 0 ranges whose meshlets are inside the frustum and not facing away from eye, both in mesh space.
+    // Consecutive survivors share a range. Returns the triangles kept.
+    uint32_t cullMeshlets(const Vector4 planes[6], const Vector3& eye, std::vector<IndexRange>& ranges) const;
+
+    // Coarsest level whose error stays within maxErrorPixels when one mesh unit covers pixelsPerUnit pixels
+    uint32_t selectLod(float pixelsPerUnit, float maxErrorPixels) const;
+    // Pixels per mesh unit at the bounding sphere under world (FLT_MAX with the camera inside it)
+    float getPixelsPerUnit(const Matrix& world, const Matrix& view, const Matrix& proj, float viewportHeight) const;
+
     int getMaterialIndex() const { return materialIndex; }
 
-    void draw(ID3D12GraphicsCommandList* commandList) const;
+    // Mesh-space box around the vertices (zero for an empty mesh)
+    const Vector3& getBoundsMin() const { return boundsMin; }
+    const Vector3& getBoundsMax() const { return boundsMax; }
+
+    // Location inside the shared buffers
+    void setGeometry(const D3D12_VERTEX_BUFFER_VIEW& vbView, const D3D12_INDEX_BUFFER_VIEW& ibView, uint32_t baseVertex, uint32_t firstIndex);
+
+    uint32_t getBaseVertex() const { return baseVertex; }
+    uint32_t getFirstIndex() const { return firstIndex; }
+
+    // Topology and buffers through the cache, which drops them when the previous mesh used the same buffers
+    void bindGeometry(RenderStateCache& state) const;
+    // bindBuffers = false when the shared buffers are already bound (BasicModel::bindGeometry)
+    void draw(ID3D12GraphicsCommandList* commandList, bool bindBuffers = true, uint32_t lod = 0, uint32_t numInstances = 1) const;
+    // One draw per range, with the shared buffers already bound
+    void drawRanges(ID3D12GraphicsCommandList* commandList, const IndexRange* ranges, size_t numRanges) const;
 
     static const D3D12_INPUT_LAYOUT_DESC& getInputLayoutDesc() { return inputLayoutDesc; }
+    static const D3D12_INPUT_LAYOUT_DESC& getInputLayoutDesc(VertexFormat format);
+    static uint32_t getVertexStride(VertexFormat format);
+    static const char* getVertexFormatName(VertexFormat format);
+
+    // Converts count vertices to format (Full is a plain copy). Quantized positions are clamped to the bounds.
+    static void packVertices(const Vertex* src, size_t count, VertexFormat format,
+        const Vector3& boundsMin, const Vector3& boundsMax, uint8_t* dst);
 
 private:
-    void clean();
+    void updateBounds();
 
 private:
     using VertexArray = std::unique_ptr<Vertex[]>;
-    using IndexArray = std::unique_ptr<uint8_t[]>;
+    using IndexArray = std::unique_ptr<uint32_t[]>;
 
     std::string name;
 
     uint32_t numVertices = 0;
     uint32_t numIndices = 0;
-    uint32_t indexElementSize = 0;
     int32_t  materialIndex = -1;
 
+    Vector3 boundsMin = Vector3::Zero;
+    Vector3 boundsMax = Vector3::Zero;
+
     VertexArray vertices;
-    IndexArray  indices;
+    IndexArray  indices;   // widened to 32 bits on load, packed by BasicModel
 
-    Microsoft::WRL::ComPtr<ID3D12Resource> vertexBuffer;
-    D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
+    std::vector<Lod> lods;            // coarser levels only
+    std::vector<uint32_t> lodIndices;
+
+    std::vector<MeshOptimizer::Meshlet> meshlets;  // level 0 only
+
+    uint32_t baseVertex = 0;
+    uint32_t firstIndex = 0;
 
-    Microsoft::WRL::ComPtr<ID3D12Resource> indexBuffer;
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
     D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
 
     static const uint32_t numVertexAttribs = 4;
     static const D3D12_INPUT_ELEMENT_DESC inputLayout[numVertexAttribs];
     static const D3D12_INPUT_LAYOUT_DESC inputLayoutDesc;
+
+    static const D3D12_INPUT_ELEMENT_DESC packedInputLayout[numVertexAttribs];
+    static const D3D12_INPUT_ELEMENT_DESC quantizedInputLayout[numVertexAttribs];
+    static const D3D12_INPUT_LAYOUT_DESC packedInputLayoutDesc;
+    static const D3D12_INPUT_LAYOUT_DESC quantizedInputLayoutDesc;
 };
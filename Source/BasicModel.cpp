@@ -1,51 +1,31 @@
 #include "Globals.h"
 #include "BasicModel.h"
 
+#include "Application.h"
+#include "ModuleResources.h"
+#include "JobSystem.h"
+#include "GltfFile.h"
+#include "CookedModel.h"
+#include "MappedFile.h"
+
 #include <string>
 #include <cmath>
 #include <cfloat>
 #include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <fstream>
 
-#pragma warning(push)
-#pragma warning(disable : 4018)
-#pragma warning(disable : 4267)
-#include "tiny_gltf.h"
-#pragma warning(pop)
+#include <psapi.h>
 
 using namespace DirectX;
 
 namespace
 {
-    inline float degToRad(float deg) { return deg * (XM_PI / 180.0f); }
-    inline float radToDeg(float rad) { return rad * (180.0f / XM_PI); }
-
-    static Vector3 quatToEulerDeg(const XMFLOAT4& qf)
-    {
-        const float x = qf.x;
-        const float y = qf.y;
-        const float z = qf.z;
-        const float w = qf.w;
-
-        // roll (Z)
-        const float sinr_cosp = 2.0f * (w * x + y * z);
-        const float cosr_cosp = 1.0f - 2.0f * (x * x + y * y);
-        const float roll = std::atan2(sinr_cosp, cosr_cosp);
-
-        // pitch (X)
-        const float sinp = 2.0f * (w * y - z * x);
-        float pitch = 0.0f;
-        if (std::fabs(sinp) >= 1.0f)
-            pitch = std::copysign(XM_PIDIV2, sinp);
-        else
-            pitch = std::asin(sinp);
+    constexpr uint32_t kVertexFormatFlags = CookedModel::FLAG_PACKED_VERTICES | CookedModel::FLAG_QUANTIZED_POSITIONS;
 
-        // yaw (Y)
-        const float siny_cosp = 2.0f * (w * z + x * y);
-        const float cosy_cosp = 1.0f - 2.0f * (y * y + z * z);
-        const float yaw = std::atan2(siny_cosp, cosy_cosp);
-
-        return Vector3(radToDeg(pitch), radToDeg(yaw), radToDeg(roll));
-    }
+    // Decode tasks per thread when a model has more primitives than that
+    constexpr uint32_t kDecodeTasksPerThread = 4;
 
     static bool readAccessorMinMaxVec3(const tinygltf::Accessor& acc, Vector3& outMin, Vector3& outMax)
     {
@@ -66,7 +46,7 @@ namespace
         return false;
     }
 
-    static bool computeAccessorMinMaxVec3FromBuffer(const tinygltf::Model& model, const tinygltf::Accessor& acc, Vector3& outMin, Vector3& outMax)
+    static bool computeAccessorMinMaxVec3FromBuffer(const tinygltf::Model& model, const GltfBuffers& buffers, const tinygltf::Accessor& acc, Vector3& outMin, Vector3& outMax)
     {
         if (acc.type != TINYGLTF_TYPE_VEC3)
             return false;
@@ -76,18 +56,18 @@ namespace
             return false;
 
         const tinygltf::BufferView& bv = model.bufferViews[acc.bufferView];
-        if (bv.buffer < 0 || bv.buffer >= (int)model.buffers.size())
+        if (bv.buffer < 0 || bv.buffer >= (int)buffers.size())
             return false;
 
-        const tinygltf::Buffer& buf = model.buffers[bv.buffer];
+        const GltfBufferSpan& buf = buffers[bv.buffer];
         const size_t byteStride = (bv.byteStride > 0) ? size_t(bv.byteStride) : sizeof(float) * 3;
 
         const size_t start = size_t(bv.byteOffset) + size_t(acc.byteOffset);
         const size_t needed = start + (size_t(acc.count) - 1) * byteStride + sizeof(float) * 3;
-        if (needed > buf.data.size())
+        if (needed > buf.size)
             return false;
 
-        const uint8_t* base = buf.data.data() + start;
+        const uint8_t* base = buf.data + start;
 
         Vector3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
         Vector3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
@@ -111,7 +91,7 @@ namespace
         return true;
     }
 
-    static bool tryGetPrimitivePositionBounds(const tinygltf::Model& model, const tinygltf::Primitive& prim, Vector3& outMin, Vector3& outMax)
+    static bool tryGetPrimitivePositionBounds(const tinygltf::Model& model, const GltfBuffers& buffers, const tinygltf::Primitive& prim, Vector3& outMin, Vector3& outMax)
     {
         auto it = prim.attributes.find("POSITION");
         if (it == prim.attributes.end())
@@ -126,17 +106,34 @@ namespace
         if (readAccessorMinMaxVec3(acc, outMin, outMax))
             return true;
 
-        return computeAccessorMinMaxVec3FromBuffer(model, acc, outMin, outMax);
+        return computeAccessorMinMaxVec3FromBuffer(model, buffers, acc, outMin, outMax);
     }
 }
 
+BasicModel::BasicModel()
+{
+    sceneGraph.addNode(SceneGraph::kNoParent, Vector3::Zero, Quaternion::Identity, Vector3::One);
+}
+
+BasicModel::~BasicModel()
+{
+    releaseGeometryBuffers();
+}
+
 void BasicModel::load(const char* fileName, const char* basePath, BasicMaterial::Type materialType)
 {
-    tinygltf::TinyGLTF gltfContext;
-    tinygltf::Model model;
+    const auto loadStart = std::chrono::steady_clock::now();
+
+    if (useCookedModels && loadCooked(fileName, basePath, materialType))
+    {
+        finishLoad(loadStart);
+        return;
+    }
+
+    GltfFile file;
     std::string error, warning;
 
-    const bool loadOk = gltfContext.LoadASCIIFromFile(&model, &error, &warning, fileName);
+    const bool loadOk = file.load(fileName, zeroCopyBuffers, error, warning);
 
     if (!warning.empty())
         LOG("glTF warning: %s", warning.c_str());
@@ -151,6 +148,7 @@ void BasicModel::load(const char* fileName, const char* basePath, BasicMaterial:
 
     materials.clear();
     meshes.clear();
+    releaseGeometryBuffers();
 
     // Reset bounds
     hasBounds = false;
@@ -159,53 +157,478 @@ void BasicModel::load(const char* fileName, const char* basePath, BasicMaterial:
     localBoundsCenter = Vector3(0.0f, 0.0f, 0.0f);
     localBoundsRadius = 1.0f;
 
-    loadMaterials(model, basePath, materialType);
-    loadMeshes(model);
+    const GltfFile::Stats& fileStats = file.getStats();
+
+    loadStats = {};
+    loadStats.binary = fileStats.binary;
+    loadStats.zeroCopy = fileStats.zeroCopy;
+    loadStats.fileBytes = fileStats.fileBytes;
+    loadStats.mappedBufferBytes = fileStats.mappedBufferBytes;
+    loadStats.copiedBufferBytes = fileStats.copiedBufferBytes;
+    loadStats.parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+    std::vector<BasicMaterial::Desc> materialDescs;
+    describeMaterials(file.getModel(), materialDescs);
+
+    materials.resize(materialDescs.size());
+    for (size_t i = 0; i < materialDescs.size(); ++i)
+        materials[i].load(materialDescs[i], materialType, basePath);
 
-    // Reset TRS
-    t = Vector3(0.0f, 0.0f, 0.0f);
-    rDeg = Vector3(0.0f, 0.0f, 0.0f);
-    s = Vector3(1.0f, 1.0f, 1.0f);
+    loadMeshes(file.getModel(), file.getBuffers());
+    buildSceneGraph(file.getModel());
 
-    dirtyTransform = true;
+    PackedGeometry packed;
+    packGeometry(packed);
+    createGeometryBuffers(packed);
+
+    if (useCookedModels)
+        writeCooked(srcFile.c_str(), materialDescs, packed, file.getDependencies());
+
+    finishLoad(loadStart);
 }
 
-void BasicModel::loadMeshes(const tinygltf::Model& model)
+bool BasicModel::cook(const char* fileName, BasicMesh::VertexFormat format)
 {
-    size_t primitiveCount = 0;
-    for (const tinygltf::Mesh& m : model.meshes)
-        primitiveCount += m.primitives.size();
+    GltfFile file;
+    std::string error, warning;
 
-    meshes.reserve(primitiveCount);
+    if (!file.load(fileName, true, error, warning))
+    {
+        LOG("Error cooking %s: %s", fileName ? fileName : "(null)", error.c_str());
+        return false;
+    }
 
-    Vector3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
-    Vector3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
-    bool any = false;
+    // CPU side only: no materials or GPU buffers are created
+    BasicModel model;
+    model.setVertexFormat(format);
+    model.loadMeshes(file.getModel(), file.getBuffers());
+    model.buildSceneGraph(file.getModel());
+
+    std::vector<BasicMaterial::Desc> materialDescs;
+    describeMaterials(file.getModel(), materialDescs);
+
+    PackedGeometry packed;
+    model.packGeometry(packed);
+
+    return model.writeCooked(fileName, materialDescs, packed, file.getDependencies());
+}
+
+std::string BasicModel::getCookedPath(const char* fileName)
+{
+    return std::string(fileName ? fileName : "") + ".cmdl";
+}
+
+bool BasicModel::loadCooked(const char* fileName, const char* basePath, BasicMaterial::Type materialType)
+{
+    const auto loadStart = std::chrono::steady_clock::now();
+    const std::string cookedPath = getCookedPath(fileName);
+
+    MappedFile blob;
+    if (!blob.open(cookedPath.c_str()))
+        return false;
+
+    CookedModel::Contents contents;
+    if (!CookedModel::read(blob.getData(), blob.getSize(), BasicMesh::getVertexStride(vertexFormat), contents) ||
+        (contents.flags & kVertexFormatFlags) != getVertexFormatFlags(vertexFormat))
+    {
+        LOG("Cooked model %s is invalid, from another version or vertex format, loading glTF", cookedPath.c_str());
+        return false;
+    }
+
+    if (!CookedModel::isCurrent(fileName, contents))
+    {
+        LOG("Cooked model %s is stale, loading glTF", cookedPath.c_str());
+        return false;
+    }
+
+    const auto parseEnd = std::chrono::steady_clock::now();
+
+    srcFile = fileName;
+
+    materials.clear();
+    meshes.clear();
+    releaseGeometryBuffers();
+
+    hasBounds = (contents.flags & CookedModel::FLAG_HAS_BOUNDS) != 0;
+    localBoundsMin = Vector3(contents.boundsMin);
+    localBoundsMax = Vector3(contents.boundsMax);
+    localBoundsCenter = Vector3(contents.boundsCenter);
+    localBoundsRadius = contents.boundsRadius;
+
+    materials.resize(contents.materials.size());
+    for (size_t i = 0; i < contents.materials.size(); ++i)
+    {
+        const CookedModel::Material& src = contents.materials[i];
+
+        BasicMaterial::Desc desc;
+        desc.name = src.name;
+        desc.baseColour = Vector4(src.baseColour);
+        desc.diffuseTexture = src.diffuseTexture;
+
+        materials[i].load(desc, materialType, basePath);
+    }
+
+    std::vector<uint32_t> baseVertices(contents.meshes.size());
+    std::vector<uint32_t> firstIndices(contents.meshes.size());
+
+    meshes.resize(contents.meshes.size());
+    for (size_t i = 0; i < contents.meshes.size(); ++i)
+    {
+        const CookedModel::Mesh& src = contents.meshes[i];
+
+        std::vector<BasicMesh::Lod> lods(src.lods.size());
+        for (size_t l = 0; l < lods.size(); ++l)
+            lods[l] = BasicMesh::Lod{ src.lods[l].firstIndex, src.lods[l].numIndices, src.lods[l].error };
+
+        meshes[i].loadPacked(src.name, src.numVertices, src.numIndices, src.materialIndex,
+            Vector3(src.boundsMin), Vector3(src.boundsMax), lods, src.meshlets);
+
+        baseVertices[i] = src.baseVertex;
+        firstIndices[i] = src.firstIndex;
+    }
+
+    // Cooked nodes are in preorder already, parents relative to the model root
+    meshGroupOffsets = contents.meshGroupOffsets;
+
+    sceneGraph.clear();
+    sceneGraph.reserve(uint32_t(contents.nodes.size()) + 1);
+    sceneGraph.addNode(SceneGraph::kNoParent, Vector3::Zero, Quaternion::Identity, Vector3::One);
+
+    for (const CookedModel::Node& node : contents.nodes)
+    {
+        if (node.hasMatrix)
+            sceneGraph.addNode(node.parent + 1, Matrix(node.matrix), node.mesh);
+        else
+            sceneGraph.addNode(node.parent + 1, Vector3(node.translation), Quaternion(node.rotation), Vector3(node.scale), node.mesh);
+    }
+
+    // Uploaded straight from the mapping
+    createGeometryBuffers(contents.vertices, contents.vertexBytes, contents.vertexStride, contents.indices, contents.indexBytes,
+        (contents.flags & CookedModel::FLAG_16BIT_INDICES) != 0, baseVertices.data(), firstIndices.data());
+
+    loadStats = {};
+    loadStats.cooked = true;
+    loadStats.zeroCopy = true;
+    loadStats.fileBytes = blob.getSize();
+    loadStats.mappedBufferBytes = contents.vertexBytes + contents.indexBytes;
+    loadStats.parseMs = std::chrono::duration<double, std::milli>(parseEnd - loadStart).count();
+    loadStats.numPrimitives = uint32_t(contents.meshes.size());
+
+    return true;
+}
+
+bool BasicModel::writeCooked(const char* fileName, const std::vector<BasicMaterial::Desc>& materialDescs,
+    const PackedGeometry& packed, const std::vector<std::string>& dependencies) const
+{
+    CookedModel::Contents contents;
+
+    bool sourcesOk = false;
+    contents.sourceHash = CookedModel::hashSources(fileName, dependencies, sourcesOk);
+    if (!sourcesOk)
+        return false;
+
+    contents.flags = (packed.use16BitIndices ? CookedModel::FLAG_16BIT_INDICES : 0u) | (hasBounds ? CookedModel::FLAG_HAS_BOUNDS : 0u) |
+        getVertexFormatFlags(vertexFormat);
+    contents.vertexStride = packed.vertexStride;
+
+    memcpy(contents.boundsMin, &localBoundsMin, sizeof(contents.boundsMin));
+    memcpy(contents.boundsMax, &localBoundsMax, sizeof(contents.boundsMax));
+    memcpy(contents.boundsCenter, &localBoundsCenter, sizeof(contents.boundsCenter));
+    contents.boundsRadius = localBoundsRadius;
+
+    contents.meshes.resize(meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        CookedModel::Mesh& dst = contents.meshes[i];
+        dst.name = meshes[i].getName();
+        dst.materialIndex = meshes[i].getMaterialIndex();
+        dst.numVertices = meshes[i].getNumVertices();
+        dst.numIndices = meshes[i].getNumIndices();
+        dst.baseVertex = packed.baseVertices[i];
+        dst.firstIndex = packed.firstIndices[i];
+
+        for (const BasicMesh::Lod& lod : meshes[i].getLods())
+            dst.lods.push_back(CookedModel::Lod{ lod.firstIndex, lod.numIndices, lod.error });
+
+        dst.meshlets = meshes[i].getMeshlets();
+        memcpy(dst.boundsMin, &meshes[i].getBoundsMin(), sizeof(dst.boundsMin));
+        memcpy(dst.boundsMax, &meshes[i].getBoundsMax(), sizeof(dst.boundsMax));
+    }
+
+    // Everything under the model root; the root's own transform is not part of the asset
+    contents.nodes.resize(sceneGraph.size() - 1);
+    for (uint32_t i = 1; i < sceneGraph.size(); ++i)
+    {
+        CookedModel::Node& dst = contents.nodes[i - 1];
+        dst.parent = sceneGraph.getParent(i) - 1;
+        dst.mesh = sceneGraph.getMesh(i);
+        memcpy(dst.translation, &sceneGraph.getTranslation(i), sizeof(dst.translation));
+        memcpy(dst.rotation, &sceneGraph.getRotation(i), sizeof(dst.rotation));
+        memcpy(dst.scale, &sceneGraph.getScale(i), sizeof(dst.scale));
+
+        if (sceneGraph.hasLocalMatrix(i))
+        {
+            const Matrix local = sceneGraph.getLocalMatrix(i);
+            dst.hasMatrix = 1;
+            memcpy(dst.matrix, &local, sizeof(dst.matrix));
+        }
+    }
+
+    contents.meshGroupOffsets = meshGroupOffsets;
+
+    contents.materials.resize(materialDescs.size());
+    for (size_t i = 0; i < materialDescs.size(); ++i)
+    {
+        CookedModel::Material& dst = contents.materials[i];
+        dst.name = materialDescs[i].name;
+        memcpy(dst.baseColour, &materialDescs[i].baseColour, sizeof(dst.baseColour));
+        dst.diffuseTexture = materialDescs[i].diffuseTexture;
+    }
+
+    contents.dependencies = dependencies;
+
+    contents.vertices = packed.vertices.data();
+    contents.vertexBytes = packed.vertices.size();
+    contents.indices = packed.indices.data();
+    contents.indexBytes = packed.indices.size();
+
+    std::vector<uint8_t> blob;
+    CookedModel::write(contents, blob);
+
+    // Write next to the source and swap in, so a half-written blob is never picked up
+    const std::string cookedPath = getCookedPath(fileName);
+    const std::string tempPath = cookedPath + ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(blob.data()), std::streamsize(blob.size())))
+        {
+            LOG("Cannot write cooked model %s", tempPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cookedPath, ec);
+    if (ec)
+    {
+        LOG("Cannot write cooked model %s: %s", cookedPath.c_str(), ec.message().c_str());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+void BasicModel::finishLoad(std::chrono::steady_clock::time_point loadStart)
+{
+    loadStats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+    PROCESS_MEMORY_COUNTERS memCounters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &memCounters, sizeof(memCounters)))
+        loadStats.peakWorkingSetBytes = memCounters.PeakWorkingSetSize;
+
+    LOG("Loaded %s (%s, %s) in %.2f ms (parse %.2f ms, decode %u primitives in %.2f ms on %u threads), %.1f KB mapped, %.1f KB copied",
+        srcFile.c_str(), loadStats.cooked ? "cooked" : (loadStats.binary ? "glb" : "gltf"), loadStats.zeroCopy ? "zero-copy" : "copied",
+        loadStats.totalMs, loadStats.parseMs, loadStats.numPrimitives, loadStats.decodeMs, loadStats.decodeThreads,
+        double(loadStats.mappedBufferBytes) / 1024.0, double(loadStats.copiedBufferBytes) / 1024.0);
+
+    if (!loadStats.cooked)
+        LOG("LODs: %u levels simplified in %.2f ms (summed over tasks)", loadStats.numLods, loadStats.lodMs);
+
+    LOG("Geometry: %u meshes (%u primitives split for 16-bit indices), %s indices, %.1f KB index buffer",
+        uint32_t(meshes.size()), loadStats.numSplitPrimitives, geometryStats.use16BitIndices ? "16-bit" : "32-bit",
+        double(geometryStats.indexBytes) / 1024.0);
+
+    if (loadStats.cacheAfter.numTriangles > 0)
+    {
+        LOG("Vertex cache (FIFO %u): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            MeshOptimizer::kSimulatedCacheSize,
+            loadStats.cacheBefore.getAcmr(), loadStats.cacheAfter.getAcmr(),
+            loadStats.cacheBefore.getAtvr(), loadStats.cacheAfter.getAtvr());
+    }
+
+    // Reset the model transform; the glTF nodes keep theirs
+    sceneGraph.setLocal(kRootNode, Vector3::Zero, Quaternion::Identity, Vector3::One);
+    sceneGraph.update();
+
+    buildMeshInstances();
+    ++transformVersion;
+
+    loadStats.numNodes = sceneGraph.size();
+    loadStats.numInstances = uint32_t(meshInstances.size());
+
+    LOG("Scene graph: %u nodes, %u mesh instances", loadStats.numNodes, loadStats.numInstances);
+}
+
+void BasicModel::buildSceneGraph(const tinygltf::Model& model)
+{
+    sceneGraph.clear();
+    sceneGraph.reserve(uint32_t(model.nodes.size()) + 1);
+    sceneGraph.addNode(SceneGraph::kNoParent, Vector3::Zero, Quaternion::Identity, Vector3::One);
+
+    sceneGraph.importGltf(model, int32_t(kRootNode));
+
+    bool anyMesh = false;
+    for (uint32_t i = 0; i < sceneGraph.size() && !anyMesh; ++i)
+        anyMesh = sceneGraph.getMesh(i) != SceneGraph::kNoMesh;
+
+    // Meshes nobody places would not be drawn at all: show each once at the model root
+    if (!anyMesh)
+    {
+        for (size_t m = 0; m < model.meshes.size(); ++m)
+            sceneGraph.addNode(int32_t(kRootNode), Vector3::Zero, Quaternion::Identity, Vector3::One, int32_t(m));
+    }
+}
 
+void BasicModel::buildMeshInstances()
+{
+    meshInstances.clear();
+
+    const int32_t numGroups = int32_t(meshGroupOffsets.size()) - 1;
+
+    for (uint32_t node = 0; node < sceneGraph.size(); ++node)
+    {
+        const int32_t group = sceneGraph.getMesh(node);
+        if (group < 0 || group >= numGroups)
+            continue;
+
+        for (uint32_t m = meshGroupOffsets[group]; m < meshGroupOffsets[group + 1]; ++m)
+            meshInstances.push_back(MeshInstance{ m, node });
+    }
+}
+
+void BasicModel::loadMeshes(const tinygltf::Model& model, const GltfBuffers& buffers)
+{
+    struct PrimitiveRef
+    {
+        const tinygltf::Mesh* mesh;
+        const tinygltf::Primitive* primitive;
+    };
+
+    std::vector<PrimitiveRef> primitives;
     for (const tinygltf::Mesh& m : model.meshes)
     {
         for (const tinygltf::Primitive& p : m.primitives)
+            primitives.push_back(PrimitiveRef{ &m, &p });
+    }
+
+    const uint32_t numPrimitives = uint32_t(primitives.size());
+
+    // Each primitive decodes into its own slot, bounds are merged afterwards in primitive order
+    meshes.resize(numPrimitives);
+    std::vector<Vector3> primitiveMin(numPrimitives);
+    std::vector<Vector3> primitiveMax(numPrimitives);
+    std::vector<uint8_t> primitiveHasBounds(numPrimitives, 0);
+    std::vector<std::vector<BasicMesh>> primitiveParts(numPrimitives);
+    std::vector<BasicMesh::ImportStats> importStats(numPrimitives);
+
+    auto decode = [&](uint32_t begin, uint32_t end)
         {
-            // Build mesh
-            BasicMesh mesh;
-            mesh.load(model, m, p);
-            meshes.push_back(std::move(mesh));
-
-            // Accumulate local bounds from POSITION
-            Vector3 pMin, pMax;
-            if (tryGetPrimitivePositionBounds(model, p, pMin, pMax))
+            for (uint32_t i = begin; i < end; ++i)
             {
-                any = true;
+                meshes[i].importPrimitive(model, buffers, *primitives[i].mesh, *primitives[i].primitive, optimizeMeshes,
+                    primitiveParts[i], importStats[i]);
+
+                primitiveHasBounds[i] = tryGetPrimitivePositionBounds(model, buffers, *primitives[i].primitive, primitiveMin[i], primitiveMax[i]) ? 1 : 0;
+            }
+        };
+
+    JobSystem* jobs = (parallelDecode && app) ? app->getJobSystem() : nullptr;
+
+    const auto decodeStart = std::chrono::steady_clock::now();
+
+    if (jobs && jobs->getNumWorkers() > 0)
+    {
+        // One task per primitive, batched only when there are many more primitives than threads
+        const uint32_t grain = std::max(1u, numPrimitives / (jobs->getNumThreads() * kDecodeTasksPerThread));
+        jobs->parallelFor(numPrimitives, grain, decode);
+        loadStats.decodeThreads = jobs->getNumThreads();
+    }
+    else
+    {
+        decode(0, numPrimitives);
+        loadStats.decodeThreads = 1;
+    }
+
+    loadStats.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
+    loadStats.numPrimitives = numPrimitives;
+
+    loadStats.numLods = 0;
+    loadStats.lodMs = 0.0;
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+    {
+        loadStats.numLods += importStats[i].numLods;
+        loadStats.lodMs += importStats[i].lodMs;
+    }
+
+    // Meshes per glTF mesh after the split, so nodes can find theirs
+    meshGroupOffsets.assign(model.meshes.size() + 1, 0);
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+    {
+        const size_t group = size_t(primitives[i].mesh - model.meshes.data());
+        meshGroupOffsets[group + 1] += primitiveParts[i].empty() ? 1u : uint32_t(primitiveParts[i].size());
+    }
+
+    for (size_t g = 1; g < meshGroupOffsets.size(); ++g)
+        meshGroupOffsets[g] += meshGroupOffsets[g - 1];
+
+    // Replace split primitives by their parts so the whole model can use 16-bit indices
+    loadStats.numSplitPrimitives = 0;
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+        loadStats.numSplitPrimitives += primitiveParts[i].empty() ? 0u : 1u;
 
-                mn.x = std::min(mn.x, pMin.x);
-                mn.y = std::min(mn.y, pMin.y);
-                mn.z = std::min(mn.z, pMin.z);
+    if (loadStats.numSplitPrimitives > 0)
+    {
+        std::vector<BasicMesh> splitMeshes;
+        splitMeshes.reserve(meshes.size() + loadStats.numSplitPrimitives);
 
-                mx.x = std::max(mx.x, pMax.x);
-                mx.y = std::max(mx.y, pMax.y);
-                mx.z = std::max(mx.z, pMax.z);
+        for (uint32_t i = 0; i < numPrimitives; ++i)
+        {
+            if (primitiveParts[i].empty())
+            {
+                splitMeshes.push_back(std::move(meshes[i]));
+                continue;
             }
+
+            for (BasicMesh& part : primitiveParts[i])
+                splitMeshes.push_back(std::move(part));
         }
+
+        meshes = std::move(splitMeshes);
+    }
+
+    // Totals over every optimised primitive, so big meshes weigh more
+    loadStats.cacheBefore = {};
+    loadStats.cacheAfter = {};
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+    {
+        loadStats.cacheBefore.numTriangles += importStats[i].cacheBefore.numTriangles;
+        loadStats.cacheBefore.numVertices += importStats[i].cacheBefore.numVertices;
+        loadStats.cacheBefore.numTransforms += importStats[i].cacheBefore.numTransforms;
+        loadStats.cacheAfter.numTriangles += importStats[i].cacheAfter.numTriangles;
+        loadStats.cacheAfter.numVertices += importStats[i].cacheAfter.numVertices;
+        loadStats.cacheAfter.numTransforms += importStats[i].cacheAfter.numTransforms;
+    }
+
+    Vector3 mn(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    bool any = false;
+
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+    {
+        if (!primitiveHasBounds[i])
+            continue;
+
+        any = true;
+
+        mn.x = std::min(mn.x, primitiveMin[i].x);
+        mn.y = std::min(mn.y, primitiveMin[i].y);
+        mn.z = std::min(mn.z, primitiveMin[i].z);
+
+        mx.x = std::max(mx.x, primitiveMax[i].x);
+        mx.y = std::max(mx.y, primitiveMax[i].y);
+        mx.z = std::max(mx.z, primitiveMax[i].z);
     }
 
     if (any)
@@ -230,72 +653,140 @@ void BasicModel::loadMeshes(const tinygltf::Model& model)
     }
 }
 
-void BasicModel::loadMaterials(const tinygltf::Model& model, const char* basePath, BasicMaterial::Type materialType)
+void BasicModel::packGeometry(PackedGeometry& out) const
 {
-    materials.resize(model.materials.size());
+    ::packGeometry(meshes, vertexFormat, localBoundsMin, localBoundsMax, out);
+}
 
-    for (size_t i = 0; i < model.materials.size(); ++i)
-        materials[i].load(model, model.materials[i], materialType, basePath);
+void BasicModel::createGeometryBuffers(const PackedGeometry& packed)
+{
+    createGeometryBuffers(packed.vertices.data(), packed.vertices.size(), packed.vertexStride,
+        packed.indices.data(), packed.indices.size(), packed.use16BitIndices,
+        packed.baseVertices.data(), packed.firstIndices.data());
 }
 
-Vector3& BasicModel::translation()
+void BasicModel::createGeometryBuffers(const void* vertexData, size_t vertexBytes, uint32_t vertexStride, const void* indexData, size_t indexBytes,
+    bool use16BitIndices, const uint32_t* baseVertices, const uint32_t* firstIndices)
 {
-    dirtyTransform = true;
-    return t;
+    geometryStats = {};
+    geometryStats.numPrimitives = uint32_t(meshes.size());
+    geometryStats.use16BitIndices = use16BitIndices;
+    geometryStats.vertexFormat = vertexFormat;
+    geometryStats.vertexStride = vertexStride;
+    geometryStats.vertexBytes = vertexBytes;
+    geometryStats.indexBytes = indexBytes;
+    geometryStats.fullVertexBytes = (vertexStride > 0) ? (vertexBytes / vertexStride) * sizeof(BasicMesh::Vertex) : 0;
+
+    if (vertexBytes == 0)
+        return;
+
+    ModuleResources* resources = app->getResources();
+
+    const std::string baseName = srcFile.empty() ? std::string("model") : std::filesystem::path(srcFile).stem().string();
+
+    vertexBuffer = resources->createDefaultBuffer(vertexData, vertexBytes, (baseName + "_VB").c_str());
+    if (!vertexBuffer)
+        return;
+
+    ++geometryStats.numUploads;
+    geometryStats.uploadBytes += vertexBytes;
+
+    vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
+    vertexBufferView.StrideInBytes = vertexStride;
+    vertexBufferView.SizeInBytes = UINT(vertexBytes);
+
+    if (indexBytes > 0)
+    {
+        indexBuffer = resources->createDefaultBuffer(indexData, indexBytes, (baseName + "_IB").c_str());
+        if (indexBuffer)
+        {
+            ++geometryStats.numUploads;
+            geometryStats.uploadBytes += indexBytes;
+
+            indexBufferView.BufferLocation = indexBuffer->GetGPUVirtualAddress();
+            indexBufferView.Format = use16BitIndices ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+            indexBufferView.SizeInBytes = UINT(indexBytes);
+        }
+    }
+
+    for (size_t m = 0; m < meshes.size(); ++m)
+        meshes[m].setGeometry(vertexBufferView, indexBufferView, baseVertices[m], firstIndices[m]);
 }
 
-Vector3& BasicModel::rotationDeg()
+uint32_t BasicModel::getVertexFormatFlags(BasicMesh::VertexFormat format)
 {
-    dirtyTransform = true;
-    return rDeg;
+    switch (format)
+    {
+    case BasicMesh::VertexFormat::Packed:          return CookedModel::FLAG_PACKED_VERTICES;
+    case BasicMesh::VertexFormat::PackedQuantized: return CookedModel::FLAG_PACKED_VERTICES | CookedModel::FLAG_QUANTIZED_POSITIONS;
+    default:                                       return 0;
+    }
 }
 
-Vector3& BasicModel::scale()
+Matrix BasicModel::getPositionDequantMatrix() const
 {
-    dirtyTransform = true;
-    return s;
+    if (geometryStats.vertexFormat != BasicMesh::VertexFormat::PackedQuantized)
+        return Matrix::Identity;
+
+    // Positions come in as [0, 1] per axis: scale to the bounds extent, then move to the bounds min
+    return Matrix::CreateScale(localBoundsMax - localBoundsMin) * Matrix::CreateTranslation(localBoundsMin);
 }
 
-const Matrix& BasicModel::getModelMatrix() const
+void BasicModel::releaseGeometryBuffers()
 {
-    rebuildTransformIfNeeded();
-    return modelMatrix;
+    ModuleResources* resources = app ? app->getResources() : nullptr;
+    if (resources)
+    {
+        resources->deferRelease(vertexBuffer);
+        resources->deferRelease(indexBuffer);
+    }
+
+    vertexBuffer.Reset();
+    indexBuffer.Reset();
+    vertexBufferView = {};
+    indexBufferView = {};
 }
 
-void BasicModel::setModelMatrix(const Matrix& m)
+void BasicModel::bindGeometry(ID3D12GraphicsCommandList* commandList) const
 {
-    modelMatrix = m;
-    dirtyTransform = false;
+    if (!vertexBuffer)
+        return;
 
-    XMVECTOR scaleV, rotQ, transV;
-    const XMMATRIX xm = (XMMATRIX)m;
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
 
-    if (XMMatrixDecompose(&scaleV, &rotQ, &transV, xm))
-    {
-        XMFLOAT3 sc; XMStoreFloat3(&sc, scaleV);
-        XMFLOAT3 tr; XMStoreFloat3(&tr, transV);
-        XMFLOAT4 rq; XMStoreFloat4(&rq, rotQ);
+    if (indexBuffer)
+        commandList->IASetIndexBuffer(&indexBufferView);
+}
 
-        s = Vector3(sc.x, sc.y, sc.z);
-        t = Vector3(tr.x, tr.y, tr.z);
-        rDeg = quatToEulerDeg(rq);
-    }
+void BasicModel::describeMaterials(const tinygltf::Model& model, std::vector<BasicMaterial::Desc>& out)
+{
+    out.resize(model.materials.size());
+
+    for (size_t i = 0; i < model.materials.size(); ++i)
+        out[i] = BasicMaterial::describe(model, model.materials[i]);
 }
 
-void BasicModel::rebuildTransformIfNeeded() const
+uint32_t BasicModel::updateTransforms()
 {
-    if (!dirtyTransform)
-        return;
+    const uint32_t numUpdated = sceneGraph.update();
+    if (numUpdated > 0)
+        ++transformVersion;
 
-    const Matrix S = Matrix::CreateScale(s);
+    return numUpdated;
+}
 
-    const Matrix R = Matrix::CreateFromYawPitchRoll(
-        degToRad(rDeg.y),
-        degToRad(rDeg.x),
-        degToRad(rDeg.z));
+Matrix BasicModel::getModelMatrix() const
+{
+    return sceneGraph.getLocalMatrix(kRootNode);
+}
 
-    const Matrix T = Matrix::CreateTranslation(t);
+void BasicModel::setModelMatrix(const Matrix& m)
+{
+    Matrix decomposed = m;
 
-    modelMatrix = S * R * T;
-    dirtyTransform = false;
+    Vector3 scale, translation;
+    Quaternion rotation;
+    if (decomposed.Decompose(scale, rotation, translation))
+        sceneGraph.setLocal(kRootNode, translation, rotation, scale);
 }
@@ -3,38 +3,132 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <chrono>
+#include <d3d12.h>
+#include <wrl.h>
 
 #include "MathUtils.h"
 #include "BasicMesh.h"
+#include "PackedGeometry.h"
 #include "BasicMaterial.h"
+#include "SceneGraph.h"
 
 namespace tinygltf { class Model; }
+struct GltfBufferSpan;
 
 class BasicModel
 {
 public:
-    BasicModel() = default;
-    ~BasicModel() = default;
+    struct GeometryStats
+    {
+        uint32_t numUploads = 0;        // buffer uploads issued for geometry
+        uint64_t uploadBytes = 0;
+        uint32_t numPrimitives = 0;
+        bool     use16BitIndices = false;
+
+        // Memory footprint of the shared buffers
+        BasicMesh::VertexFormat vertexFormat = BasicMesh::VertexFormat::Full;
+        uint32_t vertexStride = 0;
+        uint64_t vertexBytes = 0;
+        uint64_t indexBytes = 0;
+        uint64_t fullVertexBytes = 0;   // the same vertices as BasicMesh::Vertex
+    };
+
+    struct LoadStats
+    {
+        bool     cooked = false;          // read from the .cmdl blob next to the source
+        bool     binary = false;          // .glb
+        bool     zeroCopy = false;        // buffers read straight from file mappings
+        uint64_t fileBytes = 0;
+        uint64_t mappedBufferBytes = 0;
+        uint64_t copiedBufferBytes = 0;
+        double   parseMs = 0.0;           // file + JSON, or blob validation + source hash
+        double   decodeMs = 0.0;          // accessors to vertices/indices (glTF only)
+        uint32_t decodeThreads = 0;
+        uint32_t numPrimitives = 0;
+        uint32_t numSplitPrimitives = 0;  // over MeshOptimizer::kMax16BitVertices, cut into several meshes
+        uint32_t numLods = 0;             // coarser levels over all meshes (BasicMesh::buildLods)
+        uint32_t numNodes = 0;            // scene graph, model root included
+        uint32_t numInstances = 0;        // mesh instances placed by the nodes
+        double   lodMs = 0.0;             // simplification time, summed over the decode tasks
+        MeshOptimizer::VertexCacheStats cacheBefore; // as exported, summed over optimised primitives
+        MeshOptimizer::VertexCacheStats cacheAfter;
+        double   totalMs = 0.0;           // parse, materials, meshes and GPU buffers
+        uint64_t peakWorkingSetBytes = 0; // process peak after the load
+    };
+
+    // One mesh drawn at one scene graph node; a glTF mesh used by several nodes gives several instances
+    struct MeshInstance
+    {
+        uint32_t mesh = 0;
+        uint32_t node = 0;
+    };
+
+    // Scene graph node holding the model transform; the glTF nodes hang under it
+    static constexpr uint32_t kRootNode = 0;
 
+public:
+    BasicModel();
+    ~BasicModel();
+
+    BasicModel(const BasicModel&) = delete;
+    BasicModel& operator=(const BasicModel&) = delete;
+
+    // .gltf or .glb; buffers are memory-mapped instead of copied unless setZeroCopyBuffers(false).
+    // With cooked models enabled, <fileName>.cmdl is used when its source hash still matches,
+    // otherwise the glTF is loaded and the blob (re)written.
     void load(const char* fileName, const char* basePath, BasicMaterial::Type materialType);
 
+    // Writes <fileName>.cmdl without touching the GPU, for cooking assets ahead of time
+    static bool cook(const char* fileName, BasicMesh::VertexFormat format = BasicMesh::VertexFormat::Full);
+    static std::string getCookedPath(const char* fileName);
+
+    void setZeroCopyBuffers(bool enable) { zeroCopyBuffers = enable; }
+    void setUseCookedModels(bool enable) { useCookedModels = enable; }
+    // Decodes glTF primitives on the JobSystem workers, one task per primitive
+    void setParallelDecode(bool enable) { parallelDecode = enable; }
+    // Vertex cache / overdraw / vertex fetch reordering at import (BasicMesh::optimize)
+    void setOptimizeMeshes(bool enable) { optimizeMeshes = enable; }
+    // Vertex buffer layout for the next load(); draw packed formats with BasicMesh::getInputLayoutDesc(format)
+    void setVertexFormat(BasicMesh::VertexFormat format) { vertexFormat = format; }
+    BasicMesh::VertexFormat getVertexFormat() const { return geometryStats.vertexFormat; }
+    const LoadStats& getLoadStats() const { return loadStats; }
+
     uint32_t getNumMeshes() const { return (uint32_t)meshes.size(); }
     uint32_t getNumMaterials() const { return (uint32_t)materials.size(); }
 
     const std::vector<BasicMesh>& getMeshes() const { return meshes; }
+
+    // Binds the shared vertex/index buffers once; then draw meshes with mesh.draw(commandList, false)
+    void bindGeometry(ID3D12GraphicsCommandList* commandList) const;
+    const GeometryStats& getGeometryStats() const { return geometryStats; }
+
+    // Maps quantized positions back to local space; prepend it to the model matrix (identity for other formats)
+    Matrix getPositionDequantMatrix() const;
     std::vector<BasicMaterial>& getMaterials() { return materials; }
     const std::vector<BasicMaterial>& getMaterials() const { return materials; }
 
-    // TRS (degrees)
-    Vector3& translation();
-    Vector3& rotationDeg();   // Euler degrees
-    Vector3& scale();
+    // Model transform (the root node's local TRS)
+    void setTranslation(const Vector3& translation) { sceneGraph.setTranslation(kRootNode, translation); }
+    void setRotation(const Quaternion& rotation) { sceneGraph.setRotation(kRootNode, rotation); }
+    void setScale(const Vector3& scale) { sceneGraph.setScale(kRootNode, scale); }
 
-    const Matrix& getModelMatrix() const;
+    Matrix getModelMatrix() const;
 
     // Needed for ImGuizmo workflow
     void setModelMatrix(const Matrix& m);
 
+    // Node hierarchy from the glTF scene; call updateTransforms() once per frame before reading world matrices
+    const SceneGraph& getSceneGraph() const { return sceneGraph; }
+    SceneGraph& getSceneGraph() { return sceneGraph; }
+    uint32_t updateTransforms();
+    // Changes whenever updateTransforms() moved a node or a load replaced the instances, so per-instance
+    // data derived from the world matrices can be kept until it does
+    uint32_t getTransformVersion() const { return transformVersion; }
+
+    const std::vector<MeshInstance>& getMeshInstances() const { return meshInstances; }
+    const Matrix& getInstanceWorld(const MeshInstance& instance) const { return sceneGraph.getWorld(instance.node); }
+
     const std::string& getSrcFile() const { return srcFile; }
 
     // Local-space bounds (from glTF POSITION accessors)
@@ -42,11 +136,25 @@ public:
     float getLocalBoundsRadius() const { return localBoundsRadius; }
     bool hasLocalBounds() const { return hasBounds; }
 
-private:
-    void loadMeshes(const tinygltf::Model& model);
-    void loadMaterials(const tinygltf::Model& model, const char* basePath, BasicMaterial::Type materialType);
 
-    void rebuildTransformIfNeeded() const;
+private:
+    void loadMeshes(const tinygltf::Model& model, const std::vector<GltfBufferSpan>& buffers);
+    void packGeometry(PackedGeometry& out) const;
+    void createGeometryBuffers(const PackedGeometry& packed);
+    void createGeometryBuffers(const void* vertexData, size_t vertexBytes, uint32_t vertexStride, const void* indexData, size_t indexBytes,
+        bool use16BitIndices, const uint32_t* baseVertices, const uint32_t* firstIndices);
+    void releaseGeometryBuffers();
+    static void describeMaterials(const tinygltf::Model& model, std::vector<BasicMaterial::Desc>& out);
+
+    bool loadCooked(const char* fileName, const char* basePath, BasicMaterial::Type materialType);
+    bool writeCooked(const char* fileName, const std::vector<BasicMaterial::Desc>& materialDescs,
+        const PackedGeometry& packed, const std::vector<std::string>& dependencies) const;
+    static uint32_t getVertexFormatFlags(BasicMesh::VertexFormat format);
+    void finishLoad(std::chrono::steady_clock::time_point loadStart);
+
+    // Model root plus the glTF nodes, or one node per glTF mesh when the file has none
+    void buildSceneGraph(const tinygltf::Model& model);
+    void buildMeshInstances();
 
 private:
     std::vector<BasicMaterial> materials;
@@ -54,12 +162,27 @@ private:
 
     std::string srcFile;
 
-    Vector3 t = Vector3(0.0f, 0.0f, 0.0f);
-    Vector3 rDeg = Vector3(0.0f, 0.0f, 0.0f);
-    Vector3 s = Vector3(1.0f, 1.0f, 1.0f);
+    // Every mesh packed into one vertex buffer and one index buffer
+    Microsoft::WRL::ComPtr<ID3D12Resource> vertexBuffer;
+    Microsoft::WRL::ComPtr<ID3D12Resource> indexBuffer;
+    D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
+    D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+
+    GeometryStats geometryStats;
+
+    bool zeroCopyBuffers = true;
+    bool useCookedModels = true;
+    bool parallelDecode = true;
+    bool optimizeMeshes = true;
+    BasicMesh::VertexFormat vertexFormat = BasicMesh::VertexFormat::Full;
+    LoadStats loadStats;
+
+    SceneGraph sceneGraph;
+    std::vector<MeshInstance> meshInstances;
+    uint32_t transformVersion = 0;
 
-    mutable bool   dirtyTransform = true;
-    mutable Matrix modelMatrix = Matrix::Identity;
+    // First BasicMesh of every glTF mesh plus the end: split primitives give several meshes per glTF mesh
+    std::vector<uint32_t> meshGroupOffsets;
 
     // Local bounds cached on load()
     bool    hasBounds = false;
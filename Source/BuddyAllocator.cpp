@@ -0,0 +1,192 @@
+#include "Globals.h"
+#include "BuddyAllocator.h"
+
+#include <algorithm>
+
+uint32_t BuddyAllocator::roundUpPow2(uint32_t v)
+{
+    if (v <= 1)
+        return 1;
+
+    --v;
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return v + 1;
+}
+
+uint8_t BuddyAllocator::orderForSize(uint32_t size)
+{
+    uint32_t blockSize = roundUpPow2(size);
+    uint8_t order = 0;
+
+    while (blockSize > 1)
+    {
+        blockSize >>= 1;
+        ++order;
+    }
+
+    return order;
+}
+
+void BuddyAllocator::init(uint32_t newCapacity)
+{
+    _ASSERTE(newCapacity > 0 && (newCapacity & (newCapacity - 1)) == 0 && "Capacity must be a power of two");
+
+    capacity = newCapacity;
+    maxOrder = orderForSize(capacity);
+
+    freeHeads.assign(size_t(maxOrder) + 1, NONE);
+    freeOrder.assign(capacity, NO_ORDER);
+    allocOrder.assign(capacity, NO_ORDER);
+    requested.assign(capacity, 0);
+    next.assign(capacity, NONE);
+    prev.assign(capacity, NONE);
+
+    numAllocations = 0;
+    allocatedUnits = 0;
+    requestedUnits = 0;
+
+    pushFree(0, maxOrder);
+}
+
+void BuddyAllocator::reset()
+{
+    if (capacity > 0)
+        init(capacity);
+}
+
+uint32_t BuddyAllocator::allocate(uint32_t size)
+{
+    if (size == 0 || size > capacity)
+        return INVALID_OFFSET;
+
+    const uint8_t order = orderForSize(size);
+
+    uint8_t found = order;
+    while (found <= maxOrder && freeHeads[found] == NONE)
+        ++found;
+
+    if (found > maxOrder)
+        return INVALID_OFFSET;
+
+    const uint32_t offset = freeHeads[found];
+    removeFree(offset);
+
+    // Split down, giving the upper halves back to the free lists
+    while (found > order)
+    {
+        --found;
+        pushFree(offset + (1u << found), found);
+    }
+
+    allocOrder[offset] = order;
+    requested[offset] = size;
+
+    ++numAllocations;
+    allocatedUnits += (1u << order);
+    requestedUnits += size;
+
+    return offset;
+}
+
+void BuddyAllocator::free(uint32_t offset)
+{
+    _ASSERTE(isAllocated(offset) && "Freeing an unallocated block");
+    if (!isAllocated(offset))
+        return;
+
+    uint8_t order = allocOrder[offset];
+
+    --numAllocations;
+    allocatedUnits -= (1u << order);
+    requestedUnits -= requested[offset];
+
+    allocOrder[offset] = NO_ORDER;
+    requested[offset] = 0;
+
+    while (order < maxOrder)
+    {
+        const uint32_t buddy = offset ^ (1u << order);
+        if (freeOrder[buddy] != order)
+            break;
+
+        removeFree(buddy);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    pushFree(offset, order);
+}
+
+uint32_t BuddyAllocator::getBlockSize(uint32_t offset) const
+{
+    return isAllocated(offset) ? (1u << allocOrder[offset]) : 0u;
+}
+
+uint32_t BuddyAllocator::getRequestedSize(uint32_t offset) const
+{
+    return isAllocated(offset) ? requested[offset] : 0u;
+}
+
+BuddyAllocator::Stats BuddyAllocator::getStats() const
+{
+    Stats stats;
+    stats.capacity = capacity;
+    stats.numAllocations = numAllocations;
+    stats.allocatedUnits = allocatedUnits;
+    stats.requestedUnits = requestedUnits;
+
+    for (int order = int(maxOrder); order >= 0 && !freeHeads.empty(); --order)
+    {
+        for (uint32_t it = freeHeads[size_t(order)]; it != NONE; it = next[it])
+        {
+            ++stats.numFreeBlocks;
+            stats.freeUnits += (1u << order);
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, 1u << order);
+        }
+    }
+
+    if (allocatedUnits > 0)
+        stats.internalFragmentation = 1.0f - float(requestedUnits) / float(allocatedUnits);
+
+    if (stats.freeUnits > 0)
+        stats.externalFragmentation = 1.0f - float(stats.largestFreeBlock) / float(stats.freeUnits);
+
+    if (capacity > 0)
+        stats.occupancy = float(allocatedUnits) / float(capacity);
+
+    return stats;
+}
+
+void BuddyAllocator::pushFree(uint32_t offset, uint8_t order)
+{
+    freeOrder[offset] = order;
+    prev[offset] = NONE;
+    next[offset] = freeHeads[order];
+
+    if (freeHeads[order] != NONE)
+        prev[freeHeads[order]] = offset;
+
+    freeHeads[order] = offset;
+}
+
+void BuddyAllocator::removeFree(uint32_t offset)
+{
+    const uint8_t order = freeOrder[offset];
+    _ASSERTE(order != NO_ORDER);
+
+    if (prev[offset] != NONE)
+        next[prev[offset]] = next[offset];
+    else
+        freeHeads[order] = next[offset];
+
+    if (next[offset] != NONE)
+        prev[next[offset]] = prev[offset];
+
+    freeOrder[offset] = NO_ORDER;
+    next[offset] = NONE;
+    prev[offset] = NONE;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Binary buddy allocator over an abstract range [0, capacity) (capacity is a power of two).
+// Requests are rounded up to the next power of two; freeing merges a block with its buddy while both are free.
+// Works on offsets only, so it can manage descriptor heaps, GPU memory or plain CPU memory.
+class BuddyAllocator
+{
+public:
+    static constexpr uint32_t INVALID_OFFSET = UINT32_MAX;
+
+    struct Stats
+    {
+        uint32_t capacity = 0;
+        uint32_t numAllocations = 0;
+        uint32_t allocatedUnits = 0;   // sum of rounded block sizes
+        uint32_t requestedUnits = 0;   // sum of requested sizes
+        uint32_t freeUnits = 0;
+        uint32_t numFreeBlocks = 0;
+        uint32_t largestFreeBlock = 0;
+
+        // 1 - requested / allocated: space lost to power-of-two rounding
+        float internalFragmentation = 0.0f;
+        // 1 - largestFreeBlock / freeUnits: free space that can't serve the biggest request
+        float externalFragmentation = 0.0f;
+        float occupancy = 0.0f;
+    };
+
+public:
+    BuddyAllocator() = default;
+    explicit BuddyAllocator(uint32_t capacity) { init(capacity); }
+
+    void init(uint32_t capacity);
+    void reset();
+
+    uint32_t allocate(uint32_t size);
+    void free(uint32_t offset);
+
+    bool isAllocated(uint32_t offset) const { return offset < capacity && allocOrder[offset] != NO_ORDER; }
+    uint32_t getBlockSize(uint32_t offset) const;
+    uint32_t getRequestedSize(uint32_t offset) const;
+
+    uint32_t getCapacity() const { return capacity; }
+    Stats getStats() const;
+
+    static uint32_t roundUpPow2(uint32_t v);
+
+private:
+    static constexpr uint8_t NO_ORDER = 0xFF;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    static uint8_t orderForSize(uint32_t size);
+
+    void pushFree(uint32_t offset, uint8_t order);
+    void removeFree(uint32_t offset);
+
+private:
+    uint32_t capacity = 0;
+    uint8_t  maxOrder = 0;
+
+    // Per order: head of the free block list
+    std::vector<uint32_t> freeHeads;
+
+    // Per unit offset (only meaningful at block starts)
+    std::vector<uint8_t>  freeOrder;    // order if a free block starts here
+    std::vector<uint8_t>  allocOrder;   // order if an allocated block starts here
+    std::vector<uint32_t> requested;    // requested size of the allocated block
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> prev;
+
+    uint32_t numAllocations = 0;
+    uint32_t allocatedUnits = 0;
+    uint32_t requestedUnits = 0;
+};
@@ -0,0 +1,107 @@
+#include "Globals.h"
+#include "CommandListPool.h"
+
+#include <algorithm>
+
+bool CommandListPool::init(ID3D12Device* newDevice, uint32_t newNumSlots, uint32_t newNumThreads)
+{
+    if (!newDevice)
+        return false;
+
+    device = newDevice;
+    numSlots = std::max(1u, newNumSlots);
+    numThreads = std::max(1u, newNumThreads);
+    currentSlot = 0;
+
+    allocators.resize(size_t(numSlots) * numThreads);
+    for (auto& allocator : allocators)
+    {
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator))))
+            return false;
+    }
+
+    lists.clear();
+    recycler.init(numSlots);
+
+    return true;
+}
+
+void CommandListPool::cleanUp()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    lists.clear();
+    allocators.clear();
+    recycler.init(numSlots);
+    device.Reset();
+}
+
+void CommandListPool::beginFrame(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    _ASSERTE(slot < numSlots);
+    currentSlot = slot;
+
+    for (uint32_t t = 0; t < numThreads; ++t)
+    {
+        if (ID3D12CommandAllocator* allocator = allocators[size_t(slot) * numThreads + t].Get())
+            allocator->Reset();
+    }
+
+    recycler.beginFrame(slot);
+}
+
+ID3D12GraphicsCommandList* CommandListPool::acquire(uint32_t threadIndex, ID3D12PipelineState* initialState)
+{
+    _ASSERTE(threadIndex < numThreads);
+    if (threadIndex >= numThreads)
+        return nullptr;
+
+    ID3D12CommandAllocator* allocator = nullptr;
+    ID3D12GraphicsCommandList* list = nullptr;
+    bool isNew = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!device)
+            return nullptr;
+
+        allocator = allocators[size_t(currentSlot) * numThreads + threadIndex].Get();
+
+        const uint32_t index = recycler.acquire(isNew);
+        if (isNew)
+        {
+            // Created open, recording into the allocator it was created with
+            Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> created;
+            if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator, initialState, IID_PPV_ARGS(&created))))
+                return nullptr;
+
+            created->SetName(L"CommandListPool List");
+
+            _ASSERTE(index == lists.size());
+            lists.push_back(std::move(created));
+        }
+
+        list = lists[index].Get();
+    }
+
+    if (!isNew && FAILED(list->Reset(allocator, initialState)))
+        return nullptr;
+
+    return list;
+}
+
+CommandListPool::Stats CommandListPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const CommandListRecycler::Stats recyclerStats = recycler.getStats();
+
+    Stats stats;
+    stats.numLists = recyclerStats.numLists;
+    stats.numAllocators = uint32_t(allocators.size());
+    stats.listsThisFrame = recyclerStats.numAcquired;
+    return stats;
+}
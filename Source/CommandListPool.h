@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ParallelRecording.h"
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// DIRECT command lists for parallel recording.
+// Every frame slot has one allocator per JobSystem thread, so threads never share an allocator while
+// recording; the allocators of a slot are reset in beginFrame(), after the GPU finished that slot.
+// A thread may record several lists one after the other, as long as each is closed before the next acquire.
+class CommandListPool
+{
+public:
+    struct Stats
+    {
+        uint32_t numLists = 0;
+        uint32_t numAllocators = 0;
+        uint32_t listsThisFrame = 0;
+    };
+
+public:
+    CommandListPool() = default;
+    ~CommandListPool() = default;
+
+    CommandListPool(const CommandListPool&) = delete;
+    CommandListPool& operator=(const CommandListPool&) = delete;
+
+    bool init(ID3D12Device* device, uint32_t numSlots, uint32_t numThreads);
+    void cleanUp();
+
+    // The GPU must be done with everything recorded the last time this slot was used
+    void beginFrame(uint32_t slot);
+
+    // Open list recording with the calling thread's allocator. Thread-safe.
+    ID3D12GraphicsCommandList* acquire(uint32_t threadIndex, ID3D12PipelineState* initialState = nullptr);
+
+    uint32_t getNumThreads() const { return numThreads; }
+    Stats getStats() const;
+
+private:
+    mutable std::mutex mutex;
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device;
+
+    // [slot * numThreads + thread]
+    std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> allocators;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists;
+
+    CommandListRecycler recycler;
+
+    uint32_t numSlots = 0;
+    uint32_t numThreads = 0;
+    uint32_t currentSlot = 0;
+};
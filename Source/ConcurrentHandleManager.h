@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cassert>
+
+// Lock-free variant of HandleManager, safe to alloc/free from several threads at once.
+// Same 32-bit Handle = [8-bit generation | 24-bit index] packing.
+// The free list head is a tagged index: [32-bit ABA tag | 32-bit index] swapped with a single 64-bit CAS.
+template <size_t Capacity>
+class ConcurrentHandleManager
+{
+    static_assert(Capacity < (1u << 24), "Capacity must fit in 24 bits");
+    using Handle = uint32_t;
+
+    struct Node
+    {
+        std::atomic<uint32_t> link{ 0 };  // free: next free index, allocated: self index
+        std::atomic<uint8_t>  gen{ 0 };   // generation for allocated nodes
+    };
+
+public:
+    ConcurrentHandleManager()
+    {
+        for (uint32_t i = 0; i < uint32_t(Capacity); ++i)
+        {
+            nodes[i].link.store(i + 1, std::memory_order_relaxed);
+            nodes[i].gen.store(0, std::memory_order_relaxed);
+        }
+
+        // Slot 0 is reserved as invalid.
+        if (Capacity > 0)
+            nodes[0].link.store(uint32_t(Capacity), std::memory_order_relaxed);
+
+        const uint32_t first = (Capacity > 1) ? 1u : uint32_t(Capacity);
+        freeHead.store(packHead(first, 0), std::memory_order_relaxed);
+        freeCount.store((Capacity > 1) ? uint32_t(Capacity - 1) : 0u, std::memory_order_relaxed);
+    }
+
+    ConcurrentHandleManager(const ConcurrentHandleManager&) = delete;
+    ConcurrentHandleManager& operator=(const ConcurrentHandleManager&) = delete;
+
+    Handle allocHandle()
+    {
+        uint64_t head = freeHead.load(std::memory_order_acquire);
+        uint32_t idx = 0;
+
+        for (;;)
+        {
+            idx = headIndex(head);
+            if (idx >= Capacity)
+            {
+                assert(false && "Out of handles");
+                return 0;
+            }
+
+            // May read a stale link if another thread pops idx first; the tag makes that CAS fail.
+            const uint32_t next = nodes[idx].link.load(std::memory_order_relaxed);
+            const uint64_t newHead = packHead(next, headTag(head) + 1);
+
+            if (freeHead.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire))
+                break;
+        }
+
+        uint8_t gen = 0;
+        while (gen == 0)
+            gen = uint8_t(genCounter.fetch_add(1, std::memory_order_relaxed) + 1);
+
+        // gen first: validHandle() only trusts gen once link == idx is visible
+        nodes[idx].gen.store(gen, std::memory_order_relaxed);
+        nodes[idx].link.store(idx, std::memory_order_release);
+
+        freeCount.fetch_sub(1, std::memory_order_relaxed);
+
+        return pack(idx, gen);
+    }
+
+    void freeHandle(Handle handle)
+    {
+        assert(validHandle(handle) && "Invalid handle");
+
+        const uint32_t idx = unpackIndex(handle);
+        uint64_t head = freeHead.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            nodes[idx].link.store(headIndex(head), std::memory_order_relaxed);
+            const uint64_t newHead = packHead(idx, headTag(head) + 1);
+
+            if (freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_acquire))
+                break;
+        }
+
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool validHandle(Handle handle) const
+    {
+        if (handle == 0)
+            return false;
+
+        const uint32_t idx = unpackIndex(handle);
+        const uint8_t gen = unpackGen(handle);
+
+        if (idx == 0 || idx >= Capacity)
+            return false;
+
+        return nodes[idx].link.load(std::memory_order_acquire) == idx &&
+            nodes[idx].gen.load(std::memory_order_relaxed) == gen;
+    }
+
+    uint32_t indexFromHandle(Handle handle) const
+    {
+        assert(validHandle(handle));
+        return unpackIndex(handle);
+    }
+
+    size_t getSize() const { return Capacity; }
+    size_t getFreeCount() const { return freeCount.load(std::memory_order_relaxed); }
+
+private:
+    static Handle pack(uint32_t index, uint8_t gen)
+    {
+        return (uint32_t(gen) << 24) | (index & 0x00FFFFFFu);
+    }
+
+    static uint32_t unpackIndex(Handle handle)
+    {
+        return handle & 0x00FFFFFFu;
+    }
+
+    static uint8_t unpackGen(Handle handle)
+    {
+        return uint8_t((handle >> 24) & 0xFFu);
+    }
+
+    static uint64_t packHead(uint32_t index, uint32_t tag)
+    {
+        return (uint64_t(tag) << 32) | uint64_t(index);
+    }
+
+    static uint32_t headIndex(uint64_t head) { return uint32_t(head & 0xFFFFFFFFu); }
+    static uint32_t headTag(uint64_t head) { return uint32_t(head >> 32); }
+
+private:
+    std::array<Node, Capacity> nodes;
+    std::atomic<uint64_t> freeHead{ 0 };
+    std::atomic<uint32_t> freeCount{ 0 };
+    std::atomic<uint32_t> genCounter{ 0 };
+};
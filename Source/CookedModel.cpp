@@ -0,0 +1,419 @@
+#include "Globals.h"
+#include "CookedModel.h"
+
+#include "MappedFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+namespace
+{
+    constexpr size_t kSectionAlignment = 16;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+
+        uint32_t flags;
+        uint32_t vertexStride;
+        uint32_t numMeshes;
+        uint32_t numMaterials;
+
+        uint32_t numDependencies;
+        uint32_t numLods;
+        uint32_t numMeshlets;
+        uint32_t numNodes;
+        uint32_t numMeshGroups;
+        uint32_t _pad0;
+        uint64_t stringsSize;
+
+        float boundsMin[3];
+        float boundsMax[3];
+        float boundsCenter[3];
+        float boundsRadius;
+
+        uint64_t meshesOffset;
+        uint64_t lodsOffset;
+        uint64_t meshletsOffset;
+        uint64_t nodesOffset;
+        uint64_t meshGroupsOffset;
+        uint64_t materialsOffset;
+        uint64_t dependenciesOffset;
+        uint64_t stringsOffset;
+        uint64_t verticesOffset;
+        uint64_t vertexBytes;
+        uint64_t indicesOffset;
+        uint64_t indexBytes;
+    };
+
+    static_assert(std::is_trivially_copyable<MeshOptimizer::Meshlet>::value, "Meshlets are stored as is");
+    static_assert(std::is_trivially_copyable<CookedModel::Node>::value, "Nodes are stored as is");
+
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct MeshRecord
+    {
+        StringRef name;
+        int32_t  materialIndex;
+        uint32_t numVertices;
+        uint32_t numIndices;
+        uint32_t baseVertex;
+        uint32_t firstIndex;
+        uint32_t firstLod;
+        uint32_t numLods;
+        uint32_t firstMeshlet;
+        uint32_t numMeshlets;
+        float    boundsMin[3];
+        float    boundsMax[3];
+    };
+
+    struct LodRecord
+    {
+        uint32_t firstIndex;
+        uint32_t numIndices;
+        float    error;
+        uint32_t _pad0;
+    };
+
+    struct MaterialRecord
+    {
+        StringRef name;
+        StringRef diffuseTexture;
+        float baseColour[4];
+    };
+
+    size_t alignSection(size_t offset)
+    {
+        return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+    }
+
+    StringRef addString(std::string& strings, const std::string& s)
+    {
+        StringRef ref{ uint32_t(strings.size()), uint32_t(s.size()) };
+        strings += s;
+        return ref;
+    }
+
+    template <typename T>
+    void put(std::vector<uint8_t>& out, uint64_t offset, const T* items, size_t count)
+    {
+        if (count > 0)
+            memcpy(out.data() + offset, items, sizeof(T) * count);
+    }
+
+    bool inRange(uint64_t offset, uint64_t bytes, size_t size)
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+}
+
+void CookedModel::write(const Contents& contents, std::vector<uint8_t>& out)
+{
+    std::string strings;
+
+    std::vector<MeshRecord> meshes(contents.meshes.size());
+    std::vector<LodRecord> lods;
+    std::vector<MeshOptimizer::Meshlet> meshlets;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        const Mesh& src = contents.meshes[i];
+        meshes[i] = MeshRecord{ addString(strings, src.name), src.materialIndex, src.numVertices, src.numIndices, src.baseVertex, src.firstIndex,
+            uint32_t(lods.size()), uint32_t(src.lods.size()), uint32_t(meshlets.size()), uint32_t(src.meshlets.size()),
+            { src.boundsMin[0], src.boundsMin[1], src.boundsMin[2] }, { src.boundsMax[0], src.boundsMax[1], src.boundsMax[2] } };
+
+        for (const Lod& lod : src.lods)
+            lods.push_back(LodRecord{ lod.firstIndex, lod.numIndices, lod.error, 0 });
+
+        meshlets.insert(meshlets.end(), src.meshlets.begin(), src.meshlets.end());
+    }
+
+    std::vector<MaterialRecord> materials(contents.materials.size());
+    for (size_t i = 0; i < materials.size(); ++i)
+    {
+        const Material& src = contents.materials[i];
+        materials[i].name = addString(strings, src.name);
+        materials[i].diffuseTexture = addString(strings, src.diffuseTexture);
+        memcpy(materials[i].baseColour, src.baseColour, sizeof(src.baseColour));
+    }
+
+    std::vector<StringRef> dependencies(contents.dependencies.size());
+    for (size_t i = 0; i < dependencies.size(); ++i)
+        dependencies[i] = addString(strings, contents.dependencies[i]);
+
+    Header header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.sourceHash = contents.sourceHash;
+    header.flags = contents.flags;
+    header.vertexStride = contents.vertexStride;
+    header.numMeshes = uint32_t(meshes.size());
+    header.numMaterials = uint32_t(materials.size());
+    header.numDependencies = uint32_t(dependencies.size());
+    header.numLods = uint32_t(lods.size());
+    header.numMeshlets = uint32_t(meshlets.size());
+    header.numNodes = uint32_t(contents.nodes.size());
+    header.numMeshGroups = uint32_t(contents.meshGroupOffsets.size());
+    header.stringsSize = strings.size();
+
+    memcpy(header.boundsMin, contents.boundsMin, sizeof(header.boundsMin));
+    memcpy(header.boundsMax, contents.boundsMax, sizeof(header.boundsMax));
+    memcpy(header.boundsCenter, contents.boundsCenter, sizeof(header.boundsCenter));
+    header.boundsRadius = contents.boundsRadius;
+
+    size_t cursor = alignSection(sizeof(Header));
+    header.meshesOffset = cursor;
+    cursor = alignSection(cursor + sizeof(MeshRecord) * meshes.size());
+    header.lodsOffset = cursor;
+    cursor = alignSection(cursor + sizeof(LodRecord) * lods.size());
+    header.meshletsOffset = cursor;
+    cursor = alignSection(cursor + sizeof(MeshOptimizer::Meshlet) * meshlets.size());
+    header.nodesOffset = cursor;
+    cursor = alignSection(cursor + sizeof(Node) * contents.nodes.size());
+    header.meshGroupsOffset = cursor;
+    cursor = alignSection(cursor + sizeof(uint32_t) * contents.meshGroupOffsets.size());
+    header.materialsOffset = cursor;
+    cursor = alignSection(cursor + sizeof(MaterialRecord) * materials.size());
+    header.dependenciesOffset = cursor;
+    cursor = alignSection(cursor + sizeof(StringRef) * dependencies.size());
+    header.stringsOffset = cursor;
+    cursor = alignSection(cursor + strings.size());
+    header.verticesOffset = cursor;
+    header.vertexBytes = contents.vertexBytes;
+    cursor = alignSection(cursor + contents.vertexBytes);
+    header.indicesOffset = cursor;
+    header.indexBytes = contents.indexBytes;
+    cursor += contents.indexBytes;
+
+    out.assign(cursor, 0);
+
+    put(out, 0, &header, 1);
+    put(out, header.meshesOffset, meshes.data(), meshes.size());
+    put(out, header.lodsOffset, lods.data(), lods.size());
+    put(out, header.meshletsOffset, meshlets.data(), meshlets.size());
+    put(out, header.nodesOffset, contents.nodes.data(), contents.nodes.size());
+    put(out, header.meshGroupsOffset, contents.meshGroupOffsets.data(), contents.meshGroupOffsets.size());
+    put(out, header.materialsOffset, materials.data(), materials.size());
+    put(out, header.dependenciesOffset, dependencies.data(), dependencies.size());
+    put(out, header.stringsOffset, strings.data(), strings.size());
+    put(out, header.verticesOffset, contents.vertices, contents.vertexBytes);
+    put(out, header.indicesOffset, contents.indices, contents.indexBytes);
+}
+
+bool CookedModel::read(const uint8_t* data, size_t size, uint32_t expectedVertexStride, Contents& contents)
+{
+    if (!data || size < sizeof(Header))
+        return false;
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != MAGIC || header.version != VERSION || header.vertexStride != expectedVertexStride)
+        return false;
+
+    if (!inRange(header.meshesOffset, uint64_t(sizeof(MeshRecord)) * header.numMeshes, size) ||
+        !inRange(header.lodsOffset, uint64_t(sizeof(LodRecord)) * header.numLods, size) ||
+        !inRange(header.meshletsOffset, uint64_t(sizeof(MeshOptimizer::Meshlet)) * header.numMeshlets, size) ||
+        !inRange(header.nodesOffset, uint64_t(sizeof(Node)) * header.numNodes, size) ||
+        !inRange(header.meshGroupsOffset, uint64_t(sizeof(uint32_t)) * header.numMeshGroups, size) ||
+        !inRange(header.materialsOffset, uint64_t(sizeof(MaterialRecord)) * header.numMaterials, size) ||
+        !inRange(header.dependenciesOffset, uint64_t(sizeof(StringRef)) * header.numDependencies, size) ||
+        !inRange(header.stringsOffset, header.stringsSize, size) ||
+        !inRange(header.verticesOffset, header.vertexBytes, size) ||
+        !inRange(header.indicesOffset, header.indexBytes, size))
+        return false;
+
+    const char* strings = reinterpret_cast<const char*>(data + header.stringsOffset);
+    bool stringsOk = true;
+
+    auto getString = [&](const StringRef& ref)
+        {
+            if (uint64_t(ref.offset) + ref.length > header.stringsSize)
+            {
+                stringsOk = false;
+                return std::string();
+            }
+            return std::string(strings + ref.offset, ref.length);
+        };
+
+    const uint64_t numVertices = header.vertexBytes / header.vertexStride;
+    const uint64_t numIndices = header.indexBytes / ((header.flags & FLAG_16BIT_INDICES) ? 2u : 4u);
+
+    contents = {};
+    contents.meshes.resize(header.numMeshes);
+    for (uint32_t i = 0; i < header.numMeshes; ++i)
+    {
+        MeshRecord record;
+        memcpy(&record, data + header.meshesOffset + sizeof(MeshRecord) * i, sizeof(record));
+
+        if (uint64_t(record.baseVertex) + record.numVertices > numVertices ||
+            uint64_t(record.firstIndex) + record.numIndices > numIndices ||
+            uint64_t(record.firstLod) + record.numLods > header.numLods ||
+            uint64_t(record.firstMeshlet) + record.numMeshlets > header.numMeshlets ||
+            record.materialIndex >= int32_t(header.numMaterials))
+            return false;
+
+        Mesh& mesh = contents.meshes[i];
+        mesh.name = getString(record.name);
+        mesh.materialIndex = record.materialIndex;
+        mesh.numVertices = record.numVertices;
+        mesh.numIndices = record.numIndices;
+        mesh.baseVertex = record.baseVertex;
+        mesh.firstIndex = record.firstIndex;
+        memcpy(mesh.boundsMin, record.boundsMin, sizeof(mesh.boundsMin));
+        memcpy(mesh.boundsMax, record.boundsMax, sizeof(mesh.boundsMax));
+
+        mesh.lods.resize(record.numLods);
+        for (uint32_t l = 0; l < record.numLods; ++l)
+        {
+            LodRecord lod;
+            memcpy(&lod, data + header.lodsOffset + sizeof(LodRecord) * (size_t(record.firstLod) + l), sizeof(lod));
+
+            if (uint64_t(record.firstIndex) + lod.firstIndex + lod.numIndices > numIndices)
+                return false;
+
+            mesh.lods[l] = Lod{ lod.firstIndex, lod.numIndices, lod.error };
+        }
+
+        mesh.meshlets.resize(record.numMeshlets);
+        if (record.numMeshlets > 0)
+        {
+            memcpy(mesh.meshlets.data(), data + header.meshletsOffset + sizeof(MeshOptimizer::Meshlet) * size_t(record.firstMeshlet),
+                sizeof(MeshOptimizer::Meshlet) * record.numMeshlets);
+        }
+
+        for (const MeshOptimizer::Meshlet& meshlet : mesh.meshlets)
+        {
+            if (uint64_t(meshlet.firstIndex) + meshlet.numIndices > record.numIndices)
+                return false;
+        }
+    }
+
+    contents.meshGroupOffsets.resize(header.numMeshGroups);
+    if (header.numMeshGroups > 0)
+        memcpy(contents.meshGroupOffsets.data(), data + header.meshGroupsOffset, sizeof(uint32_t) * header.numMeshGroups);
+
+    for (uint32_t g = 0; g < header.numMeshGroups; ++g)
+    {
+        if (contents.meshGroupOffsets[g] > header.numMeshes || (g > 0 && contents.meshGroupOffsets[g] < contents.meshGroupOffsets[g - 1]))
+            return false;
+    }
+
+    contents.nodes.resize(header.numNodes);
+    if (header.numNodes > 0)
+        memcpy(contents.nodes.data(), data + header.nodesOffset, sizeof(Node) * header.numNodes);
+
+    // Preorder: a node's parent is still on the path from the root to the previous node
+    std::vector<int32_t> path;
+    for (uint32_t i = 0; i < header.numNodes; ++i)
+    {
+        const Node& node = contents.nodes[i];
+        if (node.mesh < -1 || (node.mesh >= 0 && uint32_t(node.mesh) + 1 >= header.numMeshGroups))
+            return false;
+
+        while (!path.empty() && path.back() != node.parent)
+            path.pop_back();
+
+        if (node.parent != -1 && path.empty())
+            return false;
+
+        path.push_back(int32_t(i));
+    }
+
+    contents.materials.resize(header.numMaterials);
+    for (uint32_t i = 0; i < header.numMaterials; ++i)
+    {
+        MaterialRecord record;
+        memcpy(&record, data + header.materialsOffset + sizeof(MaterialRecord) * i, sizeof(record));
+
+        Material& material = contents.materials[i];
+        material.name = getString(record.name);
+        material.diffuseTexture = getString(record.diffuseTexture);
+        memcpy(material.baseColour, record.baseColour, sizeof(material.baseColour));
+    }
+
+    contents.dependencies.resize(header.numDependencies);
+    for (uint32_t i = 0; i < header.numDependencies; ++i)
+    {
+        StringRef ref;
+        memcpy(&ref, data + header.dependenciesOffset + sizeof(StringRef) * i, sizeof(ref));
+        contents.dependencies[i] = getString(ref);
+    }
+
+    if (!stringsOk)
+        return false;
+
+    contents.sourceHash = header.sourceHash;
+    contents.flags = header.flags;
+    contents.vertexStride = header.vertexStride;
+
+    memcpy(contents.boundsMin, header.boundsMin, sizeof(contents.boundsMin));
+    memcpy(contents.boundsMax, header.boundsMax, sizeof(contents.boundsMax));
+    memcpy(contents.boundsCenter, header.boundsCenter, sizeof(contents.boundsCenter));
+    contents.boundsRadius = header.boundsRadius;
+
+    contents.vertices = data + header.verticesOffset;
+    contents.vertexBytes = size_t(header.vertexBytes);
+    contents.indices = data + header.indicesOffset;
+    contents.indexBytes = size_t(header.indexBytes);
+
+    return true;
+}
+
+uint64_t CookedModel::hash(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+
+    return h;
+}
+
+uint64_t CookedModel::hashSources(const char* fileName, const std::vector<std::string>& dependencies, bool& ok)
+{
+    ok = true;
+
+    MappedFile source;
+    if (!source.open(fileName))
+    {
+        ok = false;
+        return 0;
+    }
+
+    uint64_t sourceHash = hash(source.getData(), source.getSize());
+
+    const std::filesystem::path baseDir = std::filesystem::path(fileName).parent_path();
+    for (const std::string& dependency : dependencies)
+    {
+        MappedFile file;
+        if (!file.open((baseDir / dependency).string().c_str()))
+        {
+            ok = false;
+            return 0;
+        }
+
+        sourceHash = hash(dependency.data(), dependency.size(), sourceHash);
+        sourceHash = hash(file.getData(), file.getSize(), sourceHash);
+    }
+
+    return sourceHash;
+}
+
+bool CookedModel::isCurrent(const char* fileName, const Contents& contents)
+{
+    bool ok = false;
+    const uint64_t sourceHash = hashSources(fileName, contents.dependencies, ok);
+
+    return ok && sourceHash == contents.sourceHash;
+}
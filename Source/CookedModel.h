@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MeshOptimizer.h"
+
+// Engine-native model blob: the packed vertex/index arrays exactly as BasicModel uploads them, per-mesh
+// ranges, the node hierarchy, material descriptions, local bounds and a hash of the source files it was cooked from.
+// Sections are 16-byte aligned so the blob can be used in place from a file mapping.
+// Bump VERSION whenever the layout, BasicMesh::Vertex or the glTF decoding changes.
+class CookedModel
+{
+public:
+    static constexpr uint32_t MAGIC = 0x4C444D43;  // "CMDL"
+    static constexpr uint32_t VERSION = 10;
+
+    enum Flags : uint32_t
+    {
+        FLAG_16BIT_INDICES = 1u << 0,
+        FLAG_HAS_BOUNDS = 1u << 1,
+        FLAG_PACKED_VERTICES = 1u << 2,     // BasicMesh::PackedVertex / QuantizedVertex
+        FLAG_QUANTIZED_POSITIONS = 1u << 3  // positions relative to the bounds
+    };
+
+    // BasicMesh::Lod
+    struct Lod
+    {
+        uint32_t firstIndex = 0;  // relative to the mesh's firstIndex
+        uint32_t numIndices = 0;
+        float    error = 0.0f;
+    };
+
+    struct Mesh
+    {
+        std::string name;
+        int32_t  materialIndex = -1;
+        uint32_t numVertices = 0;
+        uint32_t numIndices = 0;
+        uint32_t baseVertex = 0;
+        uint32_t firstIndex = 0;
+        float    boundsMin[3] = {};
+        float    boundsMax[3] = {};
+        std::vector<Lod> lods;    // coarser levels, after level 0 in the index data
+        std::vector<MeshOptimizer::Meshlet> meshlets;  // over level 0, stored as is
+    };
+
+    // SceneGraph node below the model root, in preorder; stored as is
+    struct Node
+    {
+        int32_t parent = -1;      // -1 for children of the model root
+        int32_t mesh = -1;        // glTF mesh, see Contents::meshGroupOffsets
+        float   translation[3] = {};
+        float   rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float   scale[3] = { 1.0f, 1.0f, 1.0f };
+        int32_t hasMatrix = 0;    // local transform is matrix, TRS only its decomposition (SceneGraph::hasLocalMatrix)
+        float   matrix[16] = {};
+    };
+
+    struct Material
+    {
+        std::string name;
+        float       baseColour[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        std::string diffuseTexture;
+    };
+
+    // Everything written to / read from a blob. Vertex and index data are views, not copies.
+    struct Contents
+    {
+        uint64_t sourceHash = 0;
+        uint32_t flags = 0;
+        uint32_t vertexStride = 0;
+
+        float boundsMin[3] = {};
+        float boundsMax[3] = {};
+        float boundsCenter[3] = {};
+        float boundsRadius = 1.0f;
+
+        std::vector<Mesh> meshes;
+        std::vector<Node> nodes;
+        std::vector<uint32_t> meshGroupOffsets;  // first mesh of every glTF mesh, plus the end
+        std::vector<Material> materials;
+        std::vector<std::string> dependencies;  // source files besides the glTF itself (e.g. .bin), relative
+
+        const uint8_t* vertices = nullptr;
+        size_t vertexBytes = 0;
+        const uint8_t* indices = nullptr;
+        size_t indexBytes = 0;
+    };
+
+public:
+    // Serialises contents into out
+    static void write(const Contents& contents, std::vector<uint8_t>& out);
+
+    // Validates the blob; vertex/index views point into data, which must outlive contents
+    static bool read(const uint8_t* data, size_t size, uint32_t expectedVertexStride, Contents& contents);
+
+    // FNV-1a 64, chainable through seed
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+    // Hash of fileName and of its dependencies (relative to it), as stored in Contents::sourceHash.
+    // ok is false when one of the files cannot be read.
+    static uint64_t hashSources(const char* fileName, const std::vector<std::string>& dependencies, bool& ok);
+
+    // The blob was cooked from what fileName and its dependencies hold now
+    static bool isCurrent(const char* fileName, const Contents& contents);
+};
@@ -5,6 +5,7 @@
 #include "ModuleShaderDescriptors.h"
 #include "ModuleSamplers.h"
 #include "Application.h"
+#include "JobSystem.h"
 #include <algorithm>
 
 D3D12Module::D3D12Module(HWND wnd) : hWnd(wnd)
@@ -66,7 +67,9 @@ void D3D12Module::initImGui()
     if (!descriptors || !descriptors->getHeap())
         return;
 
-    imguiDescTable = descriptors->allocTable();
+    imguiDescTable = descriptors->allocTable(1);
+    if (!imguiDescTable)
+        return;
 
     imgui = std::make_unique<ImGuiPass>(
         device.Get(),
@@ -89,6 +92,9 @@ bool D3D12Module::cleanUp()
     // Keep safe even if called multiple times
     shutdownImGui();
 
+    flush();
+    commandListPool.cleanUp();
+
     if (drawEvent)
         CloseHandle(drawEvent);
     drawEvent = nullptr;
@@ -117,6 +123,7 @@ void D3D12Module::preRender()
     frameValues[currentBackBufferIdx] = frameIndex;
 
     commandAllocators[currentBackBufferIdx]->Reset();
+    commandListPool.beginFrame(currentBackBufferIdx);
 
     if (imgui)
         imgui->startFrame();
@@ -399,6 +406,10 @@ bool D3D12Module::createCommandList()
         commandAllocators[0].Get(), nullptr, IID_PPV_ARGS(&commandList)));
 
     ok = ok && SUCCEEDED(commandList->Close());
+
+    const uint32_t numThreads = (app && app->getJobSystem()) ? app->getJobSystem()->getNumThreads() : 1u;
+    ok = ok && commandListPool.init(device.Get(), kBufferCount, numThreads);
+
     return ok;
 }
 
@@ -2,6 +2,7 @@
 
 #include "Module.h"
 #include "ShaderTableDesc.h"
+#include "CommandListPool.h"
 
 #include <dxgi1_6.h>
 #include <cstdint>
@@ -31,11 +32,15 @@ public:
     bool isMinimized() const { return minimized; }
 
     ID3D12Device* getDevice() { return device.Get(); }
+    IDXGIFactory6* getFactory() { return factory.Get(); }
     ID3D12GraphicsCommandList* getCommandList() { return commandList.Get(); }
     ID3D12CommandAllocator* getCommandAllocator() { return commandAllocators[currentBackBufferIdx].Get(); }
     ID3D12Resource* getBackBuffer() { return backBuffers[currentBackBufferIdx].Get(); }
     ID3D12CommandQueue* getDrawCommandQueue() { return drawCommandQueue.Get(); }
 
+    // Extra DIRECT lists for recording in parallel; allocators are recycled per back buffer
+    CommandListPool& getCommandListPool() { return commandListPool; }
+
     unsigned getWindowWidth() const { return windowWidth; }
     unsigned getWindowHeight() const { return windowHeight; }
 
@@ -89,6 +94,7 @@ private:
 
     ComPtr<ID3D12CommandAllocator> commandAllocators[kBufferCount];
     ComPtr<ID3D12GraphicsCommandList> commandList;
+    CommandListPool commandListPool;
     ComPtr<ID3D12CommandQueue> drawCommandQueue;
 
     ComPtr<ID3D12Fence> drawFence;
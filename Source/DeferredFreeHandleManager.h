@@ -1,20 +1,28 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <cstdint>
 #include <cassert>
 
 #include "HandleManager.h"
 
-template <size_t Capacity>
+// Retired handles are kept in a ring of per-frame buckets (frame % NumBuckets), each bucket an intrusive
+// doubly linked list indexed by handle index. A bitset flags pending indices, so deferRelease() and the
+// per-bucket work in collectGarbage() are O(1) per handle instead of scanning every pending entry.
+template <size_t Capacity, size_t NumBuckets = 8>
 class DeferredFreeHandleManager
 {
+    static_assert(NumBuckets > 0 && NumBuckets < 256, "Bucket index must fit in 8 bits");
     using Handle = uint32_t;
 
-    struct DeferredItem
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Bucket
     {
         uint64_t frame = 0;
-        Handle handle = 0;
+        uint32_t head = NONE;
+        uint32_t count = 0;
     };
 
 public:
@@ -26,52 +34,140 @@ public:
 
     size_t getSize() const { return handles.getSize(); }
     size_t getFreeCount() const { return handles.getFreeCount(); }
+    size_t getPendingCount() const { return pendingCount; }
 
     void deferRelease(Handle handle, uint64_t currentFrame)
     {
         assert(handles.validHandle(handle) && "Invalid handle");
 
-        for (size_t i = 0; i < pendingCount; ++i)
+        const uint32_t idx = handles.indexFromHandle(handle);
+        const uint8_t b = uint8_t(currentFrame % NumBuckets);
+        Bucket& bucket = buckets[b];
+
+        // A bucket still holding an older frame (no collect for a whole ring turn) is relabelled to the
+        // newer frame: its handles are released later than needed, never earlier.
+        if (bucket.count == 0 || bucket.frame < currentFrame)
+            bucket.frame = currentFrame;
+
+        if (pending[idx])
         {
-            if (pending[i].handle == handle)
-            {
-                pending[i].frame = currentFrame;
+            if (pendingBucket[idx] == b)
                 return;
-            }
+
+            unlink(idx);
         }
 
-        assert(pendingCount < Capacity && "Deferred list overflow");
-        pending[pendingCount++] = { currentFrame, handle };
+        link(idx, b, handle);
     }
 
     void collectGarbage(uint64_t lastCompletedFrame)
     {
-        for (size_t i = 0; i < pendingCount; )
+        collectGarbage(lastCompletedFrame, [](Handle) {});
+    }
+
+    // onFree(handle) is called right before each handle goes back to the free list
+    template <typename OnFree>
+    void collectGarbage(uint64_t lastCompletedFrame, OnFree&& onFree)
+    {
+        if (pendingCount == 0)
+            return;
+
+        for (uint8_t b = 0; b < uint8_t(NumBuckets); ++b)
         {
-            if (pending[i].frame <= lastCompletedFrame)
-            {
-                handles.freeHandle(pending[i].handle);
-                --pendingCount;
-                pending[i] = pending[pendingCount];
-            }
-            else
-            {
-                ++i;
-            }
+            if (buckets[b].count > 0 && buckets[b].frame <= lastCompletedFrame)
+                releaseBucket(b, onFree);
         }
     }
 
     void forceCollectGarbage()
     {
-        for (size_t i = 0; i < pendingCount; ++i)
-            handles.freeHandle(pending[i].handle);
+        forceCollectGarbage([](Handle) {});
+    }
+
+    template <typename OnFree>
+    void forceCollectGarbage(OnFree&& onFree)
+    {
+        for (uint8_t b = 0; b < uint8_t(NumBuckets); ++b)
+        {
+            if (buckets[b].count > 0)
+                releaseBucket(b, onFree);
+        }
+    }
+
+private:
+    void link(uint32_t idx, uint8_t b, Handle handle)
+    {
+        Bucket& bucket = buckets[b];
+
+        pendingHandle[idx] = handle;
+        pendingBucket[idx] = b;
+        pendingPrev[idx] = NONE;
+        pendingNext[idx] = bucket.head;
+
+        if (bucket.head != NONE)
+            pendingPrev[bucket.head] = idx;
+
+        bucket.head = idx;
+        ++bucket.count;
+
+        pending.set(idx);
+        ++pendingCount;
+    }
+
+    void unlink(uint32_t idx)
+    {
+        Bucket& bucket = buckets[pendingBucket[idx]];
+
+        const uint32_t prev = pendingPrev[idx];
+        const uint32_t next = pendingNext[idx];
+
+        if (prev != NONE)
+            pendingNext[prev] = next;
+        else
+            bucket.head = next;
+
+        if (next != NONE)
+            pendingPrev[next] = prev;
+
+        --bucket.count;
+
+        pending.reset(idx);
+        --pendingCount;
+    }
+
+    template <typename OnFree>
+    void releaseBucket(uint8_t b, OnFree& onFree)
+    {
+        Bucket& bucket = buckets[b];
+
+        for (uint32_t idx = bucket.head; idx != NONE; )
+        {
+            const uint32_t next = pendingNext[idx];
+            const Handle handle = pendingHandle[idx];
+
+            pending.reset(idx);
+            --pendingCount;
 
-        pendingCount = 0;
+            onFree(handle);
+            handles.freeHandle(handle);
+
+            idx = next;
+        }
+
+        bucket.head = NONE;
+        bucket.count = 0;
     }
 
 private:
     HandleManager<Capacity> handles;
 
-    std::array<DeferredItem, Capacity> pending{};
+    std::array<Bucket, NumBuckets> buckets{};
+
+    std::array<uint32_t, Capacity> pendingNext{};
+    std::array<uint32_t, Capacity> pendingPrev{};
+    std::array<Handle, Capacity>   pendingHandle{};
+    std::array<uint8_t, Capacity>  pendingBucket{};
+    std::bitset<Capacity>          pending;
+
     size_t pendingCount = 0;
 };
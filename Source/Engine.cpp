@@ -7,8 +7,10 @@
 #include "Engine.h"
 
 #include "Application.h"
+#include "BasicModel.h"
 
 #include <shellapi.h>
+#include <filesystem>
 
 #include "dxgidebug.h"
 #include "D3D12Module.h"
@@ -33,6 +35,7 @@ ATOM                MyRegisterClass(HINSTANCE hInstance);
 BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
 INT_PTR CALLBACK    About(HWND, UINT, WPARAM, LPARAM);
+int                 CookModels(int argc, wchar_t** argv);
 
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     _In_opt_ HINSTANCE hPrevInstance,
@@ -42,6 +45,10 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
 
+    // Offline cooking: no window, no device
+    if (__argc > 1 && wcscmp(__wargv[1], L"--cook") == 0)
+        return CookModels(__argc - 2, __wargv + 2);
+
     // Initialize global strings
     LoadStringW(hInstance, IDS_APP_TITLE, szTitle, MAX_LOADSTRING);
     LoadStringW(hInstance, IDC_ENGINEDX, szWindowClass, MAX_LOADSTRING);
@@ -92,6 +99,40 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     return (int)msg.wParam;
 }
 
+//
+//  FUNCTION: CookModels(int, wchar_t**)
+//
+//  PURPOSE: Writes the .cmdl of every glTF named on the command line:
+//           Engine.exe --cook [--format full|packed|quantized] <file.gltf|file.glb>...
+//           The format applies to the files after it and must match the one the model is loaded with.
+//           Returns the number of files that could not be cooked.
+//
+int CookModels(int argc, wchar_t** argv)
+{
+    BasicMesh::VertexFormat format = BasicMesh::VertexFormat::Full;
+    int failed = 0;
+
+    for (int i = 0; i < argc; ++i)
+    {
+        if (wcscmp(argv[i], L"--format") == 0 && i + 1 < argc)
+        {
+            const std::wstring name = argv[++i];
+            format = name == L"packed" ? BasicMesh::VertexFormat::Packed :
+                name == L"quantized" ? BasicMesh::VertexFormat::PackedQuantized : BasicMesh::VertexFormat::Full;
+            continue;
+        }
+
+        const std::string fileName = std::filesystem::path(argv[i]).string();
+        const bool cooked = BasicModel::cook(fileName.c_str(), format);
+
+        LOG("%s %s (%s vertices)", cooked ? "Cooked" : "Could not cook", BasicModel::getCookedPath(fileName.c_str()).c_str(),
+            BasicMesh::getVertexFormatName(format));
+        failed += cooked ? 0 : 1;
+    }
+
+    return failed;
+}
+
 //
 //  FUNCTION: MyRegisterClass()
 //
@@ -61,7 +61,7 @@ bool Exercise4Module::init()
             return false;
 
         // NEW API: allocate a table and write SRV into slot 0 (t0)
-        textureTable = descriptors->allocTable();
+        textureTable = descriptors->allocTable(1);
         if (!textureTable)
             return false;
 
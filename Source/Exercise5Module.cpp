@@ -576,7 +576,7 @@ bool Exercise5Module::loadModel()
 
     model.load(gltfPath.c_str(), basePath.c_str(), BasicMaterial::PHONG);
 
-    model.scale() = Vector3(0.01f, 0.01f, 0.01f);
+    model.setScale(Vector3(0.01f, 0.01f, 0.01f));
 
     return model.getNumMeshes() > 0;
 }
@@ -804,7 +804,7 @@ bool Exercise7Module::loadModel()
     const std::string basePath = EnsureTrailingSlash(ToGenericString(absDir));
 
     model.load(gltfPath.c_str(), basePath.c_str(), BasicMaterial::PHONG);
-    model.scale() = Vector3(0.01f, 0.01f, 0.01f);
+    model.setScale(Vector3(0.01f, 0.01f, 0.01f));
 
     return model.getNumMeshes() > 0;
 }
@@ -0,0 +1,556 @@
+#include "Globals.h"
+#include "FrameGraph.h"
+
+#include <algorithm>
+
+namespace
+{
+    const D3D12_RESOURCE_STATES kWriteStates = D3D12_RESOURCE_STATES(
+        D3D12_RESOURCE_STATE_RENDER_TARGET | D3D12_RESOURCE_STATE_UNORDERED_ACCESS | D3D12_RESOURCE_STATE_DEPTH_WRITE |
+        D3D12_RESOURCE_STATE_STREAM_OUT | D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_RESOLVE_DEST);
+
+    bool isReadState(D3D12_RESOURCE_STATES state) { return (state & kWriteStates) == 0; }
+    bool isWriteState(D3D12_RESOURCE_STATES state) { return (state & kWriteStates) == state && state != 0 && (state & (state - 1)) == 0; }
+
+    uint32_t bytesPerPixel(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 16;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+            return 8;
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_D16_UNORM:
+            return 2;
+        case DXGI_FORMAT_R8_UNORM:
+            return 1;
+        default:
+            return 4;
+        }
+    }
+}
+
+void FrameGraph::reset()
+{
+    passes.clear();
+    resources.clear();
+    finalBarriers.clear();
+    numTransients = 0;
+    compiled = false;
+    stats = Stats();
+}
+
+FrameGraph::ResourceHandle FrameGraph::importResource(const char* name, ID3D12Resource* resource, D3D12_RESOURCE_STATES& trackedState)
+{
+    Resource imported;
+    imported.name = name;
+    imported.imported = true;
+    imported.external = resource;
+    imported.trackedState = &trackedState;
+
+    resources.push_back(std::move(imported));
+    compiled = false;
+
+    return ResourceHandle(resources.size() - 1);
+}
+
+void FrameGraph::setFinalState(ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+    _ASSERTE(resource < resources.size() && resources[resource].imported);
+
+    resources[resource].hasFinalState = true;
+    resources[resource].finalState = state;
+    compiled = false;
+}
+
+FrameGraph::ResourceHandle FrameGraph::createTexture(const char* name, const TextureDesc& desc)
+{
+    _ASSERTE(desc.flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL));
+
+    Resource transient;
+    transient.name = name;
+    transient.desc = desc;
+    transient.transientIndex = numTransients++;
+
+    resources.push_back(std::move(transient));
+    compiled = false;
+
+    return ResourceHandle(resources.size() - 1);
+}
+
+uint32_t FrameGraph::addPass(const char* name, ExecuteFn execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    passes.push_back(std::move(pass));
+    compiled = false;
+
+    return uint32_t(passes.size() - 1);
+}
+
+FrameGraph::Access& FrameGraph::findAccess(uint32_t pass, ResourceHandle resource)
+{
+    _ASSERTE(pass < passes.size() && resource < resources.size());
+
+    for (Access& access : passes[pass].accesses)
+    {
+        if (access.resource == resource)
+            return access;
+    }
+
+    Access access;
+    access.resource = resource;
+    passes[pass].accesses.push_back(access);
+
+    return passes[pass].accesses.back();
+}
+
+void FrameGraph::read(uint32_t pass, ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+    _ASSERTE(isReadState(state) || state == D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+    // Reading what the pass also writes happens in the write state (depth test with depth writes,
+    // read-modify-write through a UAV)
+    Access& access = findAccess(pass, resource);
+    access.read = true;
+    if (!access.write)
+        access.state = D3D12_RESOURCE_STATES(access.state | state);
+
+    compiled = false;
+}
+
+void FrameGraph::write(uint32_t pass, ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+    _ASSERTE(isWriteState(state));
+
+    Access& access = findAccess(pass, resource);
+    _ASSERTE(!access.write || access.state == state);
+    access.write = true;
+    access.state = state;
+
+    compiled = false;
+}
+
+void FrameGraph::setSideEffect(uint32_t pass)
+{
+    _ASSERTE(pass < passes.size());
+
+    passes[pass].sideEffect = true;
+    compiled = false;
+}
+
+uint32_t FrameGraph::addResolvePass(const char* name, ResourceHandle src, ResourceHandle dst, DXGI_FORMAT format)
+{
+    const uint32_t pass = addPass(name, [this, src, dst, format](Context& context)
+        {
+            context.commandList->ResolveSubresource(getResource(dst), 0, getResource(src), 0, format);
+        });
+
+    read(pass, src, D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+    write(pass, dst, D3D12_RESOURCE_STATE_RESOLVE_DEST);
+
+    return pass;
+}
+
+bool FrameGraph::compile(ID3D12Device* device)
+{
+    finalBarriers.clear();
+    stats = Stats();
+    stats.passes = uint32_t(passes.size());
+
+    for (Pass& pass : passes)
+        pass.barriers.clear();
+
+    for (Resource& resource : resources)
+    {
+        resource.firstPass = kInvalidPass;
+        resource.lastPass = kInvalidPass;
+        resource.offset = 0;
+    }
+
+    cullPasses();
+    planBarriers();
+    placeTransients(device);
+
+    for (const Pass& pass : passes)
+    {
+        stats.barriers += uint32_t(pass.barriers.size());
+        stats.batches += pass.barriers.empty() ? 0u : 1u;
+    }
+
+    stats.barriers += uint32_t(finalBarriers.size());
+    stats.batches += finalBarriers.empty() ? 0u : 1u;
+
+    compiled = true;
+    return true;
+}
+
+void FrameGraph::cullPasses()
+{
+    // Backwards from the roots: a pass is needed when it writes an import, has a side effect or writes
+    // something a later needed pass reads. Its own writes then stop being needed from earlier passes.
+    std::vector<uint8_t> needed(resources.size(), 0);
+
+    for (uint32_t i = uint32_t(passes.size()); i-- > 0;)
+    {
+        Pass& pass = passes[i];
+
+        bool live = pass.sideEffect;
+        for (const Access& access : pass.accesses)
+        {
+            if (access.write && (resources[access.resource].imported || needed[access.resource]))
+                live = true;
+        }
+
+        pass.culled = !live;
+        if (!live)
+        {
+            ++stats.culledPasses;
+            continue;
+        }
+
+        for (const Access& access : pass.accesses)
+        {
+            if (access.write)
+                needed[access.resource] = 0;
+        }
+
+        for (const Access& access : pass.accesses)
+        {
+            if (access.read)
+                needed[access.resource] = 1;
+        }
+    }
+}
+
+void FrameGraph::planBarriers()
+{
+    struct Use
+    {
+        uint32_t pass;
+        D3D12_RESOURCE_STATES state;
+        bool write;
+    };
+
+    // Live uses grouped by resource, in pass order (counting sort)
+    std::vector<uint32_t> firstUse(resources.size() + 1, 0);
+    for (const Pass& pass : passes)
+    {
+        if (pass.culled)
+            continue;
+
+        for (const Access& access : pass.accesses)
+            ++firstUse[access.resource + 1];
+    }
+
+    for (size_t i = 1; i < firstUse.size(); ++i)
+        firstUse[i] += firstUse[i - 1];
+
+    std::vector<Use> uses(firstUse.back());
+    std::vector<uint32_t> cursor(firstUse.begin(), firstUse.end() - 1);
+
+    for (uint32_t i = 0; i < uint32_t(passes.size()); ++i)
+    {
+        if (passes[i].culled)
+            continue;
+
+        for (const Access& access : passes[i].accesses)
+            uses[cursor[access.resource]++] = { i, access.state, access.write || !isReadState(access.state) };
+    }
+
+    for (ResourceHandle r = 0; r < ResourceHandle(resources.size()); ++r)
+    {
+        Resource& resource = resources[r];
+
+        const uint32_t begin = firstUse[r];
+        const uint32_t end = firstUse[r + 1];
+
+        D3D12_RESOURCE_STATES current = resource.imported ? *resource.trackedState : D3D12_RESOURCE_STATE_COMMON;
+
+        if (begin != end)
+        {
+            resource.firstPass = uses[begin].pass;
+            resource.lastPass = uses[end - 1].pass;
+        }
+
+        for (uint32_t u = begin; u < end;)
+        {
+            // A write needs its own state; a run of reads shares one transition to the union of theirs
+            D3D12_RESOURCE_STATES target = uses[u].state;
+            uint32_t next = u + 1;
+
+            if (!uses[u].write)
+            {
+                _ASSERTE(resource.imported || u != begin);   // transient read before anything wrote it
+
+                while (next < end && !uses[next].write)
+                    target = D3D12_RESOURCE_STATES(target | uses[next++].state);
+            }
+
+            // Transients start in their first state: created there, or moved by execute() when cached
+            if (u == begin && !resource.imported)
+            {
+                resource.initialState = target;
+                current = target;
+            }
+
+            Barrier barrier;
+            barrier.resource = r;
+
+            if (current == target || (!uses[u].write && isReadState(current) && (current & target) == target))
+            {
+                // Unordered access after unordered access still has to wait for the earlier writes
+                if (uses[u].write && target == D3D12_RESOURCE_STATE_UNORDERED_ACCESS && u != begin && uses[u - 1].write)
+                {
+                    barrier.type = Barrier::Type::Uav;
+                    passes[uses[u].pass].barriers.push_back(barrier);
+                }
+            }
+            else
+            {
+                barrier.type = Barrier::Type::Transition;
+                barrier.stateBefore = current;
+                barrier.stateAfter = target;
+                passes[uses[u].pass].barriers.push_back(barrier);
+
+                current = target;
+            }
+
+            u = next;
+        }
+
+        if (resource.imported)
+        {
+            resource.initialState = *resource.trackedState;
+
+            if (resource.hasFinalState && current != resource.finalState)
+            {
+                Barrier barrier;
+                barrier.resource = r;
+                barrier.stateBefore = current;
+                barrier.stateAfter = resource.finalState;
+                finalBarriers.push_back(barrier);
+            }
+        }
+    }
+}
+
+D3D12_RESOURCE_DESC FrameGraph::toResourceDesc(const TextureDesc& desc)
+{
+    D3D12_RESOURCE_DESC resourceDesc = {};
+    resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    resourceDesc.Width = desc.width;
+    resourceDesc.Height = desc.height;
+    resourceDesc.DepthOrArraySize = 1;
+    resourceDesc.MipLevels = 1;
+    resourceDesc.Format = desc.format;
+    resourceDesc.SampleDesc.Count = desc.sampleCount;
+    resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    resourceDesc.Flags = desc.flags;
+    return resourceDesc;
+}
+
+void FrameGraph::placeTransients(ID3D12Device* device)
+{
+    std::vector<ResourceHandle> order;
+    order.reserve(numTransients);
+
+    heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    for (ResourceHandle r = 0; r < ResourceHandle(resources.size()); ++r)
+    {
+        Resource& resource = resources[r];
+        if (resource.imported || resource.firstPass == kInvalidPass)
+            continue;
+
+        if (device)
+        {
+            const D3D12_RESOURCE_DESC resourceDesc = toResourceDesc(resource.desc);
+            const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+            resource.size = info.SizeInBytes;
+            resource.alignment = info.Alignment;
+        }
+        else
+        {
+            resource.alignment = (resource.desc.sampleCount > 1) ? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+                : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+            resource.size = alignUp(uint64_t(resource.desc.width) * resource.desc.height * resource.desc.sampleCount *
+                bytesPerPixel(resource.desc.format), resource.alignment);
+        }
+
+        heapAlignment = std::max(heapAlignment, resource.alignment);
+        stats.unaliasedBytes += resource.size;
+        order.push_back(r);
+    }
+
+    stats.transients = uint32_t(order.size());
+
+    std::sort(order.begin(), order.end(), [this](ResourceHandle a, ResourceHandle b)
+        {
+            return resources[a].firstPass != resources[b].firstPass ? resources[a].firstPass < resources[b].firstPass : a < b;
+        });
+
+    // First fit among the transients alive at the same time
+    std::vector<std::pair<uint64_t, uint64_t>> busy;
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        Resource& resource = resources[order[i]];
+
+        busy.clear();
+        for (size_t j = 0; j < i; ++j)
+        {
+            const Resource& other = resources[order[j]];
+            if (other.lastPass >= resource.firstPass)
+                busy.push_back({ other.offset, other.offset + other.size });
+        }
+
+        std::sort(busy.begin(), busy.end());
+
+        uint64_t offset = 0;
+        for (const auto& range : busy)
+        {
+            if (alignUp(offset, resource.alignment) + resource.size <= range.first)
+                break;
+
+            offset = std::max(offset, range.second);
+        }
+
+        resource.offset = alignUp(offset, resource.alignment);
+        stats.heapBytes = std::max(stats.heapBytes, resource.offset + resource.size);
+    }
+
+    // Memory shared with another transient (earlier in this frame, or later in the last one) is
+    // activated with an aliasing barrier at the first use
+    for (ResourceHandle r : order)
+    {
+        const Resource& resource = resources[r];
+
+        bool aliased = false;
+        uint32_t numBefore = 0;
+        ResourceHandle before = kInvalidResource;
+
+        for (ResourceHandle o : order)
+        {
+            const Resource& other = resources[o];
+            if (o == r || other.offset >= resource.offset + resource.size || resource.offset >= other.offset + other.size)
+                continue;
+
+            aliased = true;
+            if (other.lastPass < resource.firstPass)
+            {
+                ++numBefore;
+                before = o;
+            }
+        }
+
+        if (!aliased)
+            continue;
+
+        Barrier barrier;
+        barrier.type = Barrier::Type::Aliasing;
+        barrier.resource = r;
+        barrier.aliasBefore = (numBefore == 1) ? before : kInvalidResource;
+
+        // Aliasing barriers go first in the batch, the transitions of the new resource follow them
+        std::vector<Barrier>& batch = passes[resource.firstPass].barriers;
+        auto it = batch.begin();
+        while (it != batch.end() && it->type == Barrier::Type::Aliasing)
+            ++it;
+        batch.insert(it, barrier);
+
+        ++stats.aliasingBarriers;
+    }
+}
+
+std::string FrameGraph::getStateName(D3D12_RESOURCE_STATES state)
+{
+    static const struct { D3D12_RESOURCE_STATES state; const char* name; } kNames[] =
+    {
+        { D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, "VERTEX_AND_CONSTANT_BUFFER" },
+        { D3D12_RESOURCE_STATE_INDEX_BUFFER, "INDEX_BUFFER" },
+        { D3D12_RESOURCE_STATE_RENDER_TARGET, "RENDER_TARGET" },
+        { D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "UNORDERED_ACCESS" },
+        { D3D12_RESOURCE_STATE_DEPTH_WRITE, "DEPTH_WRITE" },
+        { D3D12_RESOURCE_STATE_DEPTH_READ, "DEPTH_READ" },
+        { D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, "NON_PIXEL_SHADER_RESOURCE" },
+        { D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, "PIXEL_SHADER_RESOURCE" },
+        { D3D12_RESOURCE_STATE_STREAM_OUT, "STREAM_OUT" },
+        { D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, "INDIRECT_ARGUMENT" },
+        { D3D12_RESOURCE_STATE_COPY_DEST, "COPY_DEST" },
+        { D3D12_RESOURCE_STATE_COPY_SOURCE, "COPY_SOURCE" },
+        { D3D12_RESOURCE_STATE_RESOLVE_DEST, "RESOLVE_DEST" },
+        { D3D12_RESOURCE_STATE_RESOLVE_SOURCE, "RESOLVE_SOURCE" },
+    };
+
+    if (state == D3D12_RESOURCE_STATE_COMMON)
+        return "COMMON";
+
+    std::string name;
+    for (const auto& entry : kNames)
+    {
+        if ((state & entry.state) == entry.state)
+        {
+            if (!name.empty())
+                name += '|';
+            name += entry.name;
+        }
+    }
+
+    return name;
+}
+
+std::string FrameGraph::describe() const
+{
+    std::string text;
+
+    auto describeBatch = [this, &text](const std::vector<Barrier>& batch)
+        {
+            for (const Barrier& barrier : batch)
+            {
+                const std::string& name = resources[barrier.resource].name;
+
+                switch (barrier.type)
+                {
+                case Barrier::Type::Aliasing:
+                    text += "  alias " + (barrier.aliasBefore != kInvalidResource ? resources[barrier.aliasBefore].name : std::string("*")) +
+                        " -> " + name + "\n";
+                    break;
+                case Barrier::Type::Transition:
+                    text += "  " + name + ": " + getStateName(barrier.stateBefore) + " -> " + getStateName(barrier.stateAfter) + "\n";
+                    break;
+                case Barrier::Type::Uav:
+                    text += "  uav " + name + "\n";
+                    break;
+                }
+            }
+        };
+
+    for (const Pass& pass : passes)
+    {
+        text += pass.name + (pass.culled ? " (culled)\n" : "\n");
+        describeBatch(pass.barriers);
+    }
+
+    text += "final\n";
+    describeBatch(finalBarriers);
+
+    return text;
+}
+
+ID3D12Resource* FrameGraph::getResource(ResourceHandle resource) const
+{
+    _ASSERTE(resource < resources.size());
+
+    const Resource& entry = resources[resource];
+    if (entry.imported)
+        return entry.external;
+
+    return (entry.transientIndex < realized.size()) ? realized[entry.transientIndex].resource.Get() : nullptr;
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "RenderTargetDesc.h"
+#include "DepthStencilDesc.h"
+
+// Passes declare the virtual resources they read and write and the state they need them in. compile():
+//  - culls the passes whose results nobody uses (writing an import or setSideEffect() keeps a pass),
+//  - gives each transient the lifetime [first, last live use] and places the transients that are never
+//    alive together at overlapping offsets of one heap,
+//  - plans one barrier batch per pass: aliasing barriers for reused memory, then the transitions.
+//    Consecutive reads of a resource share one transition to the union of their states.
+// compile() needs no device and links without the Application (Tests checks it against golden barrier lists);
+// realize() creates the heap and the placed resources (kept while the graph does not change), execute() issues
+// the batches and runs the live passes. Those two are in FrameGraphGpu.cpp.
+// Transients are created in their first-use state and hold garbage after aliasing: the first pass writing
+// one must clear it (or overwrite every pixel).
+class FrameGraph
+{
+public:
+    using ResourceHandle = uint32_t;
+    static constexpr ResourceHandle kInvalidResource = UINT32_MAX;
+    static constexpr uint32_t kInvalidPass = UINT32_MAX;
+
+    struct TextureDesc
+    {
+        uint32_t width = 1;
+        uint32_t height = 1;
+        DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        uint32_t sampleCount = 1;
+        D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;  // RT or DS: the heap only takes those
+        D3D12_CLEAR_VALUE clearValue = {};                                     // Format UNKNOWN: none
+    };
+
+    // A pass may close the list and continue in another one (parallel recording), or set it to null to
+    // abort the frame after submitting what it recorded: execute() then stops and returns null.
+    struct Context
+    {
+        ID3D12GraphicsCommandList* commandList = nullptr;
+    };
+    using ExecuteFn = std::function<void(Context&)>;
+
+    struct Barrier
+    {
+        enum class Type : uint8_t { Aliasing, Transition, Uav };
+
+        Type type = Type::Transition;
+        ResourceHandle resource = kInvalidResource;
+        ResourceHandle aliasBefore = kInvalidResource;    // aliasing: last transient in that memory, or any
+        D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_COMMON;
+    };
+
+    struct Stats
+    {
+        uint32_t passes = 0;
+        uint32_t culledPasses = 0;
+        uint32_t transients = 0;          // used by live passes
+        uint32_t barriers = 0;
+        uint32_t batches = 0;             // ResourceBarrier calls
+        uint32_t aliasingBarriers = 0;
+        uint64_t heapBytes = 0;
+        uint64_t unaliasedBytes = 0;      // every transient in memory of its own
+    };
+
+public:
+    FrameGraph() = default;
+
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // Forgets the passes and resources of the last frame; realized memory stays for the next one
+    void reset();
+    // Frees the heap and the placed resources right away: the GPU must be idle (module cleanUp)
+    void release();
+
+    // trackedState is read at compile() and receives the state the resource is left in by execute()
+    ResourceHandle importResource(const char* name, ID3D12Resource* resource, D3D12_RESOURCE_STATES& trackedState);
+    // Transition the import to this state once every pass ran (the back buffer back to PRESENT)
+    void setFinalState(ResourceHandle resource, D3D12_RESOURCE_STATES state);
+    ResourceHandle createTexture(const char* name, const TextureDesc& desc);
+
+    uint32_t addPass(const char* name, ExecuteFn execute);
+    void read(uint32_t pass, ResourceHandle resource, D3D12_RESOURCE_STATES state);
+    // state must be a writable one: RENDER_TARGET, DEPTH_WRITE, UNORDERED_ACCESS, COPY_DEST or RESOLVE_DEST
+    void write(uint32_t pass, ResourceHandle resource, D3D12_RESOURCE_STATES state);
+    void setSideEffect(uint32_t pass);
+
+    // Resolves the multisampled src into dst
+    uint32_t addResolvePass(const char* name, ResourceHandle src, ResourceHandle dst, DXGI_FORMAT format);
+
+    // Without a device the transient sizes are estimated from the format
+    bool compile(ID3D12Device* device = nullptr);
+    bool realize(ID3D12Device* device);
+    // Returns the list recording continues in, null if a pass aborted the frame
+    ID3D12GraphicsCommandList* execute(ID3D12GraphicsCommandList* commandList);
+
+    // Valid during execute()
+    ID3D12Resource* getResource(ResourceHandle resource) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE getRtv(ResourceHandle resource) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE getDsv(ResourceHandle resource) const;
+
+    // Valid after compile()
+    bool isCulled(uint32_t pass) const { return passes[pass].culled; }
+    const std::vector<Barrier>& getBarriers(uint32_t pass) const { return passes[pass].barriers; }
+    const std::vector<Barrier>& getFinalBarriers() const { return finalBarriers; }
+    uint64_t getHeapOffset(ResourceHandle resource) const { return resources[resource].offset; }
+    const Stats& getStats() const { return stats; }
+
+    // Every batch, one barrier per line; the golden lists of the tests are written in this form
+    std::string describe() const;
+
+    // "RENDER_TARGET", "PIXEL_SHADER_RESOURCE|NON_PIXEL_SHADER_RESOURCE", ...
+    static std::string getStateName(D3D12_RESOURCE_STATES state);
+
+private:
+    struct Access
+    {
+        ResourceHandle resource = kInvalidResource;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        bool read = false;
+        bool write = false;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFn execute;
+        std::vector<Access> accesses;
+        bool sideEffect = false;
+
+        bool culled = false;
+        std::vector<Barrier> barriers;    // issued before the pass
+    };
+
+    struct Resource
+    {
+        std::string name;
+        TextureDesc desc;
+        bool imported = false;
+        ID3D12Resource* external = nullptr;
+        D3D12_RESOURCE_STATES* trackedState = nullptr;
+        bool hasFinalState = false;
+        D3D12_RESOURCE_STATES finalState = D3D12_RESOURCE_STATE_COMMON;
+        uint32_t transientIndex = 0;
+
+        uint32_t firstPass = kInvalidPass;
+        uint32_t lastPass = kInvalidPass;
+        D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON;
+        uint64_t size = 0;
+        uint64_t alignment = 0;
+        uint64_t offset = 0;
+    };
+
+    // Placed resource of one transient, reused while its desc and offset stay the same
+    struct Realized
+    {
+        TextureDesc desc;
+        uint64_t offset = 0;
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        bool fresh = false;               // new memory: needs an aliasing barrier at its first use
+        RenderTargetDesc rtv;
+        DepthStencilDesc dsv;
+    };
+
+    struct RetiredHeap
+    {
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+        unsigned frame = 0;
+    };
+
+    static D3D12_RESOURCE_DESC toResourceDesc(const TextureDesc& desc);
+
+    Access& findAccess(uint32_t pass, ResourceHandle resource);
+    void cullPasses();
+    void planBarriers();
+    void placeTransients(ID3D12Device* device);
+    void retireHeap();
+
+private:
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<Barrier> finalBarriers;
+    uint32_t numTransients = 0;
+    uint64_t heapAlignment = 0;
+    bool compiled = false;
+    Stats stats;
+
+    Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+    uint64_t heapCapacity = 0;
+    uint64_t heapCapacityAlignment = 0;
+    std::vector<Realized> realized;           // by transientIndex
+    std::vector<RetiredHeap> retiredHeaps;
+};
@@ -0,0 +1,304 @@
+#include "Globals.h"
+#include "FrameGraph.h"
+
+#include "Application.h"
+#include "D3D12Module.h"
+#include "ModuleResources.h"
+#include "ModuleTargetDescriptors.h"
+
+#include "d3dx12.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Placed resources and recording; the declaration side and compile() are in FrameGraph.cpp
+
+namespace
+{
+    bool sameDesc(const FrameGraph::TextureDesc& a, const FrameGraph::TextureDesc& b)
+    {
+        return a.width == b.width && a.height == b.height && a.format == b.format && a.sampleCount == b.sampleCount &&
+            a.flags == b.flags && a.clearValue.Format == b.clearValue.Format &&
+            memcmp(a.clearValue.Color, b.clearValue.Color, sizeof(a.clearValue.Color)) == 0;
+    }
+}
+
+void FrameGraph::release()
+{
+    realized.clear();
+    retiredHeaps.clear();
+    heap.Reset();
+    heapCapacity = 0;
+    heapCapacityAlignment = 0;
+}
+
+void FrameGraph::retireHeap()
+{
+    ModuleResources* moduleResources = app->getResources();
+
+    for (Realized& entry : realized)
+    {
+        if (entry.resource)
+            moduleResources->deferRelease(entry.resource);
+    }
+
+    realized.clear();
+
+    if (heap)
+    {
+        RetiredHeap retired;
+        retired.heap = heap;
+        retired.frame = app->getD3D12Module()->getCurrentFrame();
+        retiredHeaps.push_back(std::move(retired));
+    }
+
+    heap.Reset();
+    heapCapacity = 0;
+    heapCapacityAlignment = 0;
+}
+
+bool FrameGraph::realize(ID3D12Device* device)
+{
+    _ASSERTE(compiled);
+
+    const unsigned completed = app->getD3D12Module()->getLastCompletedFrame();
+    for (size_t i = 0; i < retiredHeaps.size();)
+    {
+        if (retiredHeaps[i].frame <= completed)
+        {
+            retiredHeaps[i] = std::move(retiredHeaps.back());
+            retiredHeaps.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (stats.heapBytes == 0)
+        return true;
+
+    // The heap only grows: a graph that fits keeps its memory and its placed resources
+    if (!heap || heapCapacity < stats.heapBytes || heapCapacityAlignment < heapAlignment)
+    {
+        retireHeap();
+
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = stats.heapBytes;
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heapDesc.Alignment = heapAlignment;
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+        if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap))))
+        {
+            LOG("FrameGraph: failed to create a %llu byte transient heap", (unsigned long long)stats.heapBytes);
+            return false;
+        }
+
+        heap->SetName(L"FrameGraph Transients");
+        heapCapacity = stats.heapBytes;
+        heapCapacityAlignment = heapAlignment;
+    }
+
+    if (realized.size() < numTransients)
+        realized.resize(numTransients);
+
+    ModuleResources* moduleResources = app->getResources();
+    ModuleTargetDescriptors* targetDescriptors = app->getTargetDescriptors();
+
+    // Memory of a transient skipped this frame may be taken by others: it is activated again when used
+    std::vector<uint8_t> used(realized.size(), 0);
+
+    for (const Resource& resource : resources)
+    {
+        if (resource.imported || resource.firstPass == kInvalidPass)
+            continue;
+
+        used[resource.transientIndex] = 1;
+
+        Realized& entry = realized[resource.transientIndex];
+        if (entry.resource && entry.offset == resource.offset && sameDesc(entry.desc, resource.desc))
+            continue;
+
+        if (entry.resource)
+            moduleResources->deferRelease(entry.resource);
+
+        entry.rtv.reset();
+        entry.dsv.reset();
+
+        const D3D12_RESOURCE_DESC resourceDesc = toResourceDesc(resource.desc);
+        const D3D12_CLEAR_VALUE* clearValue = (resource.desc.clearValue.Format != DXGI_FORMAT_UNKNOWN) ? &resource.desc.clearValue : nullptr;
+
+        if (FAILED(device->CreatePlacedResource(heap.Get(), resource.offset, &resourceDesc, resource.initialState, clearValue,
+            IID_PPV_ARGS(&entry.resource))))
+        {
+            LOG("FrameGraph: failed to place transient '%s'", resource.name.c_str());
+            return false;
+        }
+
+        const std::wstring name(resource.name.begin(), resource.name.end());
+        entry.resource->SetName(name.c_str());
+
+        entry.desc = resource.desc;
+        entry.offset = resource.offset;
+        entry.state = resource.initialState;
+        entry.fresh = true;
+
+        if (resource.desc.flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET)
+            entry.rtv = targetDescriptors->createRT(entry.resource.Get());
+        if (resource.desc.flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+            entry.dsv = targetDescriptors->createDS(entry.resource.Get());
+    }
+
+    for (size_t i = 0; i < realized.size(); ++i)
+    {
+        if (!used[i])
+            realized[i].fresh = true;
+    }
+
+    return true;
+}
+
+ID3D12GraphicsCommandList* FrameGraph::execute(ID3D12GraphicsCommandList* commandList)
+{
+    _ASSERTE(compiled);
+
+    // States as they really are: imports from their owners, cached transients from the last frame
+    std::vector<D3D12_RESOURCE_STATES> current(resources.size());
+    for (size_t r = 0; r < resources.size(); ++r)
+    {
+        const Resource& resource = resources[r];
+
+        if (resource.imported)
+            current[r] = *resource.trackedState;
+        else if (resource.firstPass != kInvalidPass)
+            current[r] = realized[resource.transientIndex].state;
+    }
+
+    std::vector<D3D12_RESOURCE_BARRIER> batch;
+
+    auto addBarriers = [&](const std::vector<Barrier>& barriers, uint32_t pass)
+        {
+            for (const Barrier& barrier : barriers)
+            {
+                if (barrier.type == Barrier::Type::Aliasing)
+                {
+                    ID3D12Resource* before = (barrier.aliasBefore != kInvalidResource) ? getResource(barrier.aliasBefore) : nullptr;
+                    batch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, getResource(barrier.resource)));
+                }
+            }
+
+            // Transients first used here: new memory is activated, and a cached one left in another
+            // state by the last frame is moved back to the state the plan starts it in
+            for (const Access& access : passes[pass].accesses)
+            {
+                const Resource& resource = resources[access.resource];
+                if (resource.imported || resource.firstPass != pass)
+                    continue;
+
+                Realized& entry = realized[resource.transientIndex];
+                if (entry.fresh)
+                {
+                    entry.fresh = false;
+
+                    const bool planned = std::any_of(barriers.begin(), barriers.end(), [&access](const Barrier& barrier)
+                        {
+                            return barrier.type == Barrier::Type::Aliasing && barrier.resource == access.resource;
+                        });
+
+                    if (!planned)
+                        batch.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, entry.resource.Get()));
+                }
+
+                if (current[access.resource] != resource.initialState)
+                {
+                    batch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(entry.resource.Get(), current[access.resource], resource.initialState));
+                    current[access.resource] = resource.initialState;
+                }
+            }
+
+            for (const Barrier& barrier : barriers)
+            {
+                if (barrier.type == Barrier::Type::Uav)
+                {
+                    batch.push_back(CD3DX12_RESOURCE_BARRIER::UAV(getResource(barrier.resource)));
+                }
+                else if (barrier.type == Barrier::Type::Transition && current[barrier.resource] != barrier.stateAfter)
+                {
+                    batch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(getResource(barrier.resource), current[barrier.resource], barrier.stateAfter));
+                    current[barrier.resource] = barrier.stateAfter;
+                }
+            }
+        };
+
+    Context context;
+    context.commandList = commandList;
+
+    for (uint32_t i = 0; i < uint32_t(passes.size()); ++i)
+    {
+        const Pass& pass = passes[i];
+        if (pass.culled)
+            continue;
+
+        batch.clear();
+        addBarriers(pass.barriers, i);
+
+        if (!batch.empty())
+            context.commandList->ResourceBarrier(UINT(batch.size()), batch.data());
+
+        BEGIN_EVENT(context.commandList, pass.name.c_str());
+
+        if (pass.execute)
+            pass.execute(context);
+
+        // Aborted: the pass submitted what it had, nothing else is recorded this frame
+        if (!context.commandList)
+            break;
+
+        END_EVENT(context.commandList);
+    }
+
+    if (context.commandList)
+    {
+        batch.clear();
+        for (const Barrier& barrier : finalBarriers)
+        {
+            if (current[barrier.resource] != barrier.stateAfter)
+            {
+                batch.push_back(CD3DX12_RESOURCE_BARRIER::Transition(getResource(barrier.resource), current[barrier.resource], barrier.stateAfter));
+                current[barrier.resource] = barrier.stateAfter;
+            }
+        }
+
+        if (!batch.empty())
+            context.commandList->ResourceBarrier(UINT(batch.size()), batch.data());
+    }
+
+    for (size_t r = 0; r < resources.size(); ++r)
+    {
+        const Resource& resource = resources[r];
+
+        if (resource.imported)
+            *resource.trackedState = current[r];
+        else if (resource.firstPass != kInvalidPass)
+            realized[resource.transientIndex].state = current[r];
+    }
+
+    return context.commandList;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE FrameGraph::getRtv(ResourceHandle resource) const
+{
+    _ASSERTE(resource < resources.size() && !resources[resource].imported);
+
+    const Realized& entry = realized[resources[resource].transientIndex];
+    return entry.rtv ? entry.rtv.getCPUHandle() : D3D12_CPU_DESCRIPTOR_HANDLE{ 0 };
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE FrameGraph::getDsv(ResourceHandle resource) const
+{
+    _ASSERTE(resource < resources.size() && !resources[resource].imported);
+
+    const Realized& entry = realized[resources[resource].transientIndex];
+    return entry.dsv ? entry.dsv.getCPUHandle() : D3D12_CPU_DESCRIPTOR_HANDLE{ 0 };
+}
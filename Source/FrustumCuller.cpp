@@ -0,0 +1,176 @@
+#include "Globals.h"
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_CULLER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Signed distance of the centre plus the box's projected radius |n|.e; the box is out when this is < 0
+    // Same operation order as the SSE path so both agree bit for bit
+    bool isInside(const Vector4 planes[6], float sx, float sy, float sz, float r, float bx, float by, float bz, float ex, float ey, float ez)
+    {
+        for (int p = 0; p < 6; ++p)
+        {
+            const Vector4& pl = planes[p];
+
+            const float ds = pl.x * sx + pl.y * sy + pl.z * sz + pl.w;
+            if (!(ds + r >= 0.0f))
+                return false;
+
+            const float db = pl.x * bx + pl.y * by + pl.z * bz + pl.w + (std::fabs(pl.x) * ex + std::fabs(pl.y) * ey + std::fabs(pl.z) * ez);
+            if (!(db >= 0.0f))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+void FrustumCuller::extractPlanes(const Matrix& viewProj, Vector4 planes[6])
+{
+    // Row vectors: clip = p * viewProj, so each clip coordinate is a column (Gribb & Hartmann)
+    const Vector4 c0(viewProj._11, viewProj._21, viewProj._31, viewProj._41);
+    const Vector4 c1(viewProj._12, viewProj._22, viewProj._32, viewProj._42);
+    const Vector4 c2(viewProj._13, viewProj._23, viewProj._33, viewProj._43);
+    const Vector4 c3(viewProj._14, viewProj._24, viewProj._34, viewProj._44);
+
+    planes[0] = c3 + c0; // left
+    planes[1] = c3 - c0; // right
+    planes[2] = c3 + c1; // bottom
+    planes[3] = c3 - c1; // top
+    planes[4] = c2;      // near (D3D depth starts at 0)
+    planes[5] = c3 - c2; // far
+
+    for (int i = 0; i < 6; ++i)
+    {
+        const float length = Vector3(planes[i].x, planes[i].y, planes[i].z).Length();
+        if (length > 0.0f)
+            planes[i] /= length;
+    }
+}
+
+void FrustumCuller::resize(uint32_t newCount)
+{
+    count = newCount;
+
+    const size_t padded = (size_t(count) + 3) & ~size_t(3);
+    for (std::vector<float>* v : { &sphereX, &sphereY, &sphereZ, &sphereRadius, &boxX, &boxY, &boxZ, &extentX, &extentY, &extentZ })
+        v->assign(padded, 0.0f);
+}
+
+void FrustumCuller::setBounds(uint32_t index, const Vector3& sphereCenter, float radius, const Vector3& boxCenter, const Vector3& boxExtents)
+{
+    _ASSERTE(index < count);
+
+    sphereX[index] = sphereCenter.x;
+    sphereY[index] = sphereCenter.y;
+    sphereZ[index] = sphereCenter.z;
+    sphereRadius[index] = radius;
+
+    boxX[index] = boxCenter.x;
+    boxY[index] = boxCenter.y;
+    boxZ[index] = boxCenter.z;
+    extentX[index] = boxExtents.x;
+    extentY[index] = boxExtents.y;
+    extentZ[index] = boxExtents.z;
+}
+
+void FrustumCuller::setBounds(uint32_t index, const Vector3& localMin, const Vector3& localMax, const Matrix& world)
+{
+    const Vector3 localCenter = (localMin + localMax) * 0.5f;
+    const Vector3 localExtents = (localMax - localMin) * 0.5f;
+
+    // Arvo: world extents are |M| applied to the local extents (row vectors, so rows are the axes)
+    const Vector3 center = Vector3::Transform(localCenter, world);
+    const Vector3 extents(
+        std::fabs(world._11) * localExtents.x + std::fabs(world._21) * localExtents.y + std::fabs(world._31) * localExtents.z,
+        std::fabs(world._12) * localExtents.x + std::fabs(world._22) * localExtents.y + std::fabs(world._32) * localExtents.z,
+        std::fabs(world._13) * localExtents.x + std::fabs(world._23) * localExtents.y + std::fabs(world._33) * localExtents.z);
+
+    // Circumsphere of the local box, scaled by the largest axis scale
+    const float scale = std::max({ Vector3(world._11, world._12, world._13).Length(),
+                                   Vector3(world._21, world._22, world._23).Length(),
+                                   Vector3(world._31, world._32, world._33).Length() });
+
+    setBounds(index, center, localExtents.Length() * scale, center, extents);
+}
+
+uint32_t FrustumCuller::cullScalar(const Vector4 planes[6], std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (isInside(planes, sphereX[i], sphereY[i], sphereZ[i], sphereRadius[i], boxX[i], boxY[i], boxZ[i], extentX[i], extentY[i], extentZ[i]))
+            visible.push_back(i);
+    }
+
+    return uint32_t(visible.size());
+}
+
+uint32_t FrustumCuller::cull(const Vector4 planes[6], std::vector<uint32_t>& visible) const
+{
+#if FRUSTUM_CULLER_SSE2
+    visible.clear();
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    __m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        px[p] = _mm_set1_ps(planes[p].x);
+        py[p] = _mm_set1_ps(planes[p].y);
+        pz[p] = _mm_set1_ps(planes[p].z);
+        pw[p] = _mm_set1_ps(planes[p].w);
+        ax[p] = _mm_and_ps(px[p], absMask);
+        ay[p] = _mm_and_ps(py[p], absMask);
+        az[p] = _mm_and_ps(pz[p], absMask);
+    }
+
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        const __m128 sx = _mm_loadu_ps(&sphereX[i]);
+        const __m128 sy = _mm_loadu_ps(&sphereY[i]);
+        const __m128 sz = _mm_loadu_ps(&sphereZ[i]);
+        const __m128 r = _mm_loadu_ps(&sphereRadius[i]);
+        const __m128 bx = _mm_loadu_ps(&boxX[i]);
+        const __m128 by = _mm_loadu_ps(&boxY[i]);
+        const __m128 bz = _mm_loadu_ps(&boxZ[i]);
+        const __m128 ex = _mm_loadu_ps(&extentX[i]);
+        const __m128 ey = _mm_loadu_ps(&extentY[i]);
+        const __m128 ez = _mm_loadu_ps(&extentZ[i]);
+
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 ds = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], sx), _mm_mul_ps(py[p], sy)), _mm_mul_ps(pz[p], sz)), pw[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(ds, r), zero));
+
+            __m128 db = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], bx), _mm_mul_ps(py[p], by)), _mm_mul_ps(pz[p], bz)), pw[p]);
+            __m128 pr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(db, pr), zero));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        if (count - i < 4)
+            mask &= (1 << (count - i)) - 1;
+
+        for (uint32_t k = 0; mask != 0; ++k, mask >>= 1)
+        {
+            if (mask & 1)
+                visible.push_back(i + k);
+        }
+    }
+
+    return uint32_t(visible.size());
+#else
+    return cullScalar(planes, visible);
+#endif
+}
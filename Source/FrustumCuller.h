@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// World bounding spheres and boxes of many objects kept as structure-of-arrays, so six frustum planes
+// can be tested against four objects at a time (SSE2). cullScalar is the reference the SSE path matches.
+// Planes are ax + by + cz + d >= 0 inside and normalised, as extractPlanes makes them.
+class FrustumCuller
+{
+public:
+    // Gribb & Hartmann planes in the space viewProj starts from (see ModuleCamera::extractFrustumPlanes)
+    static void extractPlanes(const Matrix& viewProj, Vector4 planes[6]);
+
+    void resize(uint32_t count);
+    uint32_t size() const { return count; }
+
+    void setBounds(uint32_t index, const Vector3& sphereCenter, float sphereRadius, const Vector3& boxCenter, const Vector3& boxExtents);
+    // Box from local min/max under an affine world matrix; the sphere is the box's circumsphere
+    void setBounds(uint32_t index, const Vector3& localMin, const Vector3& localMax, const Matrix& world);
+
+    // Replaces visible with the indices, in order, of the objects whose sphere and box both reach the frustum
+    uint32_t cull(const Vector4 planes[6], std::vector<uint32_t>& visible) const;
+    uint32_t cullScalar(const Vector4 planes[6], std::vector<uint32_t>& visible) const;
+
+private:
+    uint32_t count = 0;
+
+    // Padded to a multiple of 4; the padding is never reported visible
+    std::vector<float> sphereX, sphereY, sphereZ, sphereRadius;
+    std::vector<float> boxX, boxY, boxZ, extentX, extentY, extentZ;
+};
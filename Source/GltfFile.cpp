@@ -0,0 +1,248 @@
+#include "Globals.h"
+#include "GltfFile.h"
+
+#include "json.hpp"
+
+#include <filesystem>
+#include <unordered_set>
+
+namespace
+{
+    constexpr uint32_t kGlbMagic = 0x46546C67;     // "glTF"
+    constexpr uint32_t kGlbChunkJson = 0x4E4F534A; // "JSON"
+    constexpr uint32_t kGlbChunkBin = 0x004E4942;  // "BIN\0"
+
+    // Smallest buffer tinygltf accepts in place of a mapped one (it rejects empty data URIs)
+    constexpr const char* kPlaceholderUri = "data:application/octet-stream;base64,AA==";
+
+    uint32_t readU32(const uint8_t* p)
+    {
+        uint32_t v = 0;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // Materials load their textures from the image URI, tinygltf's decoded pixels are never used
+    bool skipImageData(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*)
+    {
+        return true;
+    }
+}
+
+bool GltfFile::load(const char* fileName, bool zeroCopy, std::string& error, std::string& warning)
+{
+    model = tinygltf::Model();
+    buffers.clear();
+    dependencies.clear();
+    externalFiles.clear();
+    stats = {};
+
+    if (!file.open(fileName))
+    {
+        error = "cannot open file";
+        return false;
+    }
+
+    stats.fileBytes = file.getSize();
+    stats.binary = file.getSize() >= 12 && readU32(file.getData()) == kGlbMagic;
+
+    if (stats.binary)
+    {
+        if (!parseGlb(file.getData(), file.getSize(), error))
+            return false;
+    }
+    else
+    {
+        json = reinterpret_cast<const char*>(file.getData());
+        jsonSize = file.getSize();
+        binChunk = nullptr;
+        binChunkSize = 0;
+    }
+
+    const std::string baseDir = std::filesystem::path(fileName).parent_path().string();
+
+    if (zeroCopy && loadZeroCopy(baseDir, error, warning))
+        return true;
+
+    error.clear();
+    warning.clear();
+    model = tinygltf::Model();
+    buffers.clear();
+    dependencies.clear();
+    externalFiles.clear();
+
+    return loadCopied(baseDir, error, warning);
+}
+
+bool GltfFile::parseGlb(const uint8_t* bytes, size_t size, std::string& error)
+{
+    // Header: magic, version, length. Then chunks: length, type, data (JSON first, optional BIN)
+    const uint32_t version = readU32(bytes + 4);
+    const uint32_t length = readU32(bytes + 8);
+
+    if (version != 2 || length > size || length < 20)
+    {
+        error = "invalid GLB header";
+        return false;
+    }
+
+    const uint32_t jsonLength = readU32(bytes + 12);
+    if (readU32(bytes + 16) != kGlbChunkJson || size_t(20) + jsonLength > length)
+    {
+        error = "invalid GLB JSON chunk";
+        return false;
+    }
+
+    json = reinterpret_cast<const char*>(bytes + 20);
+    jsonSize = jsonLength;
+    binChunk = nullptr;
+    binChunkSize = 0;
+
+    const size_t binHeader = size_t(20) + jsonLength;
+    if (binHeader + 8 <= length && readU32(bytes + binHeader + 4) == kGlbChunkBin)
+    {
+        const uint32_t binLength = readU32(bytes + binHeader);
+        if (binHeader + 8 + binLength > length)
+        {
+            error = "invalid GLB BIN chunk";
+            return false;
+        }
+
+        binChunk = bytes + binHeader + 8;
+        binChunkSize = binLength;
+    }
+
+    return true;
+}
+
+bool GltfFile::loadZeroCopy(const std::string& baseDir, std::string& error, std::string& warning)
+{
+    nlohmann::json doc = nlohmann::json::parse(json, json + jsonSize, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object())
+        return false;
+
+    auto docBuffers = doc.find("buffers");
+    if (docBuffers == doc.end() || !docBuffers->is_array())
+        return false;
+
+    // tinygltf decodes images stored in buffer views from Buffer::data, so those buffers stay copied
+    std::unordered_set<size_t> imageBuffers;
+    auto docImages = doc.find("images");
+    auto docViews = doc.find("bufferViews");
+    if (docImages != doc.end() && docImages->is_array() && docViews != doc.end() && docViews->is_array())
+    {
+        for (const auto& image : *docImages)
+        {
+            const int64_t view = image.value("bufferView", int64_t(-1));
+            if (view >= 0 && size_t(view) < docViews->size())
+                imageBuffers.insert(size_t((*docViews)[size_t(view)].value("buffer", int64_t(0))));
+        }
+    }
+
+    const size_t numBuffers = docBuffers->size();
+    std::vector<GltfBufferSpan> mapped(numBuffers);
+
+    for (size_t i = 0; i < numBuffers; ++i)
+    {
+        nlohmann::json& buffer = (*docBuffers)[i];
+        if (!buffer.is_object())
+            return false;
+
+        const uint64_t byteLength = buffer.value("byteLength", uint64_t(0));
+        const std::string uri = buffer.value("uri", std::string());
+
+        if (imageBuffers.count(i) != 0)
+        {
+            // Loaded as plain .gltf below, so a BIN chunk buffer needs the copying path
+            if (uri.empty())
+                return false;
+
+            if (uri.compare(0, 5, "data:") != 0)
+                dependencies.push_back(uri);
+            continue;
+        }
+
+        if (uri.empty())
+        {
+            if (!binChunk || byteLength > binChunkSize)
+                return false;
+
+            mapped[i] = GltfBufferSpan{ binChunk, size_t(byteLength) };
+        }
+        else if (uri.compare(0, 5, "data:") == 0 || uri.find('%') != std::string::npos)
+        {
+            // Base64 and percent-encoded URIs are left to tinygltf
+            if (uri.compare(0, 5, "data:") != 0)
+                dependencies.push_back(uri);
+            continue;
+        }
+        else
+        {
+            dependencies.push_back(uri);
+
+            MappedFile external;
+            if (!external.open((std::filesystem::path(baseDir) / uri).string().c_str()) || external.getSize() < byteLength)
+                continue;
+
+            mapped[i] = GltfBufferSpan{ external.getData(), size_t(byteLength) };
+            externalFiles.push_back(std::move(external));
+        }
+
+        buffer["uri"] = kPlaceholderUri;
+        buffer["byteLength"] = 1;
+    }
+
+    const std::string rewritten = doc.dump();
+
+    tinygltf::TinyGLTF gltfContext;
+    gltfContext.SetImageLoader(skipImageData, nullptr);
+
+    if (!gltfContext.LoadASCIIFromString(&model, &error, &warning, rewritten.c_str(), unsigned(rewritten.size()), baseDir))
+        return false;
+
+    buffers.resize(model.buffers.size());
+    for (size_t i = 0; i < model.buffers.size(); ++i)
+    {
+        if (i < numBuffers && mapped[i].data)
+        {
+            // Drop the placeholder byte so nothing reads it by mistake
+            model.buffers[i].data.clear();
+            buffers[i] = mapped[i];
+            stats.mappedBufferBytes += mapped[i].size;
+        }
+        else
+        {
+            buffers[i] = GltfBufferSpan{ model.buffers[i].data.data(), model.buffers[i].data.size() };
+            stats.copiedBufferBytes += model.buffers[i].data.size();
+        }
+    }
+
+    stats.zeroCopy = stats.mappedBufferBytes > 0;
+    return true;
+}
+
+bool GltfFile::loadCopied(const std::string& baseDir, std::string& error, std::string& warning)
+{
+    tinygltf::TinyGLTF gltfContext;
+    gltfContext.SetImageLoader(skipImageData, nullptr);
+
+    const bool ok = stats.binary
+        ? gltfContext.LoadBinaryFromMemory(&model, &error, &warning, file.getData(), unsigned(file.getSize()), baseDir)
+        : gltfContext.LoadASCIIFromString(&model, &error, &warning, json, unsigned(jsonSize), baseDir);
+
+    if (!ok)
+        return false;
+
+    buffers.resize(model.buffers.size());
+    for (size_t i = 0; i < model.buffers.size(); ++i)
+    {
+        buffers[i] = GltfBufferSpan{ model.buffers[i].data.data(), model.buffers[i].data.size() };
+        stats.copiedBufferBytes += model.buffers[i].data.size();
+
+        const std::string& uri = model.buffers[i].uri;
+        if (!uri.empty() && uri.compare(0, 5, "data:") != 0)
+            dependencies.push_back(uri);
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "gltf_utils.h"
+
+#include <string>
+#include <vector>
+
+// A parsed .gltf/.glb (detected by the GLB magic, not the extension).
+// With zeroCopy, buffers that live in the GLB BIN chunk or in external .bin files are not copied into
+// tinygltf::Buffer::data: the files stay mapped and getBuffers() points straight into the mappings.
+// Embedded data URIs and buffers used by images are still decoded by tinygltf.
+// Keep the GltfFile alive while reading accessors.
+class GltfFile
+{
+public:
+    struct Stats
+    {
+        bool     binary = false;
+        bool     zeroCopy = false;      // at least one buffer read from a mapping
+        uint64_t fileBytes = 0;
+        uint64_t mappedBufferBytes = 0;
+        uint64_t copiedBufferBytes = 0; // held by tinygltf
+    };
+
+public:
+    GltfFile() = default;
+
+    GltfFile(const GltfFile&) = delete;
+    GltfFile& operator=(const GltfFile&) = delete;
+
+    bool load(const char* fileName, bool zeroCopy, std::string& error, std::string& warning);
+
+    const tinygltf::Model& getModel() const { return model; }
+    const GltfBuffers& getBuffers() const { return buffers; }
+    const Stats& getStats() const { return stats; }
+
+    // External files the buffers were read from, relative to the glTF (data URIs excluded)
+    const std::vector<std::string>& getDependencies() const { return dependencies; }
+
+private:
+    bool parseGlb(const uint8_t* bytes, size_t size, std::string& error);
+    bool loadZeroCopy(const std::string& baseDir, std::string& error, std::string& warning);
+    bool loadCopied(const std::string& baseDir, std::string& error, std::string& warning);
+
+private:
+    tinygltf::Model model;
+    GltfBuffers buffers;
+    std::vector<std::string> dependencies;
+
+    MappedFile file;
+    std::vector<MappedFile> externalFiles;
+
+    // Views into 'file'
+    const char* json = nullptr;
+    size_t jsonSize = 0;
+    const uint8_t* binChunk = nullptr;
+    size_t binChunkSize = 0;
+
+    Stats stats;
+};
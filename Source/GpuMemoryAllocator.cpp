@@ -0,0 +1,270 @@
+#include "Globals.h"
+#include "GpuMemoryAllocator.h"
+
+#include "d3dx12.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr uint64_t kBigPageSize = uint64_t(64) << 20;   // 64 MB
+    constexpr uint64_t kSmallPageSize = uint64_t(4) << 20;  // 4 MB
+    constexpr uint64_t kSmallBufferLimit = uint64_t(64) << 10;
+
+    constexpr const char* kPoolNames[] = { "Buffers", "Small buffers", "Textures", "Render targets" };
+}
+
+bool GpuMemoryAllocator::init(ID3D12Device* newDevice, IDXGIAdapter3* newAdapter)
+{
+    if (!newDevice)
+        return false;
+
+    device = newDevice;
+    adapter = newAdapter;
+    committedFallbacks = 0;
+
+    return true;
+}
+
+void GpuMemoryAllocator::cleanUp()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Resources still referenced elsewhere keep their heap alive through their own reference
+    placements.clear();
+    released.clear();
+
+    for (auto& poolPages : pages)
+        poolPages.clear();
+
+    adapter.Reset();
+    device.Reset();
+}
+
+const char* GpuMemoryAllocator::getPoolName(Pool pool)
+{
+    return (pool < Pool::Count) ? kPoolNames[size_t(pool)] : "";
+}
+
+GpuMemoryAllocator::Pool GpuMemoryAllocator::selectPool(const D3D12_RESOURCE_DESC& desc, uint64_t size)
+{
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+        return (size <= kSmallBufferLimit) ? Pool::SmallBuffers : Pool::Buffers;
+
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+        return Pool::RenderTargets;
+
+    return Pool::Textures;
+}
+
+uint64_t GpuMemoryAllocator::getPageSize(Pool pool)
+{
+    return (pool == Pool::SmallBuffers) ? kSmallPageSize : kBigPageSize;
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> GpuMemoryAllocator::createResource(
+    const D3D12_RESOURCE_DESC& desc,
+    D3D12_HEAP_TYPE heapType,
+    D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* clearValue)
+{
+    if (!device)
+        return nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+
+    // Small textures can use 4 KB placement instead of 64 KB
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+
+    if (placedDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && placedDesc.SampleDesc.Count <= 1 &&
+        !(placedDesc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)))
+    {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = device->GetResourceAllocationInfo(0, 1, &placedDesc);
+
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            placedDesc.Alignment = 0;
+            info = device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        }
+    }
+    else
+    {
+        info = device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+
+    const Pool pool = selectPool(placedDesc, info.SizeInBytes);
+
+    // Only DEFAULT resources are placed; big ones get a heap of their own
+    if (heapType != D3D12_HEAP_TYPE_DEFAULT || info.SizeInBytes == UINT64_MAX || info.SizeInBytes > getPageSize(pool) / 2)
+    {
+        CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, initialState, clearValue, IID_PPV_ARGS(&resource))))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++committedFallbacks;
+        return resource;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    HeapPage* page = nullptr;
+    uint64_t offset = OffsetAllocator::INVALID_OFFSET;
+
+    for (auto& candidate : pages[size_t(pool)])
+    {
+        offset = candidate->ranges.allocate(info.SizeInBytes, info.Alignment);
+        if (offset != OffsetAllocator::INVALID_OFFSET)
+        {
+            page = candidate.get();
+            break;
+        }
+    }
+
+    if (!page)
+    {
+        page = addPage(pool);
+        if (!page)
+            return nullptr;
+
+        offset = page->ranges.allocate(info.SizeInBytes, info.Alignment);
+        if (offset == OffsetAllocator::INVALID_OFFSET)
+            return nullptr;
+    }
+
+    if (FAILED(device->CreatePlacedResource(page->heap.Get(), offset, &placedDesc, initialState, clearValue, IID_PPV_ARGS(&resource))))
+    {
+        page->ranges.free(offset);
+        return nullptr;
+    }
+
+    Placement& placement = placements[resource.Get()];
+    placement.resource = resource;
+    placement.pool = pool;
+    placement.page = page;
+    placement.offset = offset;
+
+    return resource;
+}
+
+GpuMemoryAllocator::HeapPage* GpuMemoryAllocator::addPage(Pool pool)
+{
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = getPageSize(pool);
+    heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+    heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    switch (pool)
+    {
+    case Pool::Buffers:
+    case Pool::SmallBuffers:
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        break;
+    case Pool::Textures:
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+        break;
+    default:
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+        break;
+    }
+
+    auto page = std::make_unique<HeapPage>();
+    if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&page->heap))))
+        return nullptr;
+
+    page->heap->SetName(L"GpuMemoryAllocator Page");
+    page->ranges.init(heapDesc.SizeInBytes);
+
+    pages[size_t(pool)].push_back(std::move(page));
+    return pages[size_t(pool)].back().get();
+}
+
+void GpuMemoryAllocator::release(ID3D12Resource* resource, uint64_t frame)
+{
+    if (!resource)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = placements.find(resource);
+    if (it == placements.end())
+        return;
+
+    it->second.releaseFrame = frame;
+    released.push_back(std::move(it->second));
+    placements.erase(it);
+}
+
+void GpuMemoryAllocator::collectGarbage(uint64_t lastCompletedFrame)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (size_t i = 0; i < released.size();)
+    {
+        if (released[i].releaseFrame > lastCompletedFrame)
+        {
+            ++i;
+            continue;
+        }
+
+        released[i].resource.Reset();
+        released[i].page->ranges.free(released[i].offset);
+
+        released[i] = std::move(released.back());
+        released.pop_back();
+    }
+
+    // Keep one page per pool around to avoid heap churn
+    for (auto& poolPages : pages)
+    {
+        for (size_t i = 1; i < poolPages.size();)
+        {
+            if (poolPages[i]->ranges.isEmpty())
+                poolPages.erase(poolPages.begin() + i);
+            else
+                ++i;
+        }
+    }
+}
+
+GpuMemoryAllocator::Stats GpuMemoryAllocator::getStats() const
+{
+    Stats stats;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (size_t p = 0; p < size_t(Pool::Count); ++p)
+        {
+            PoolStats& poolStats = stats.pools[p];
+            poolStats.numHeaps = uint32_t(pages[p].size());
+
+            for (const auto& page : pages[p])
+            {
+                const OffsetAllocator::Stats pageStats = page->ranges.getStats();
+                poolStats.reservedBytes += pageStats.capacity;
+                poolStats.usedBytes += pageStats.usedBytes;
+                poolStats.numResources += pageStats.numAllocations;
+                poolStats.largestFreeBlock = std::max(poolStats.largestFreeBlock, pageStats.largestFreeBlock);
+                poolStats.fragmentation = std::max(poolStats.fragmentation, pageStats.externalFragmentation);
+            }
+        }
+
+        stats.committedFallbacks = committedFallbacks;
+    }
+
+    if (adapter)
+    {
+        DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+        if (SUCCEEDED(adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+        {
+            stats.budgetBytes = info.Budget;
+            stats.currentUsageBytes = info.CurrentUsage;
+        }
+    }
+
+    return stats;
+}
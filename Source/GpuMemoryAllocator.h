@@ -0,0 +1,109 @@
+#pragma once
+
+#include "OffsetAllocator.h"
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Places DEFAULT-heap resources inside large ID3D12Heap pages instead of one implicit heap per resource.
+// Pages are grouped in pools (heap tier 1 keeps buffers, textures and RT/DS textures in separate heaps);
+// small buffers get their own pool of smaller pages so they do not fragment the big buffer pages.
+// The allocator keeps a reference to every placed resource until its owner calls release() with the frame
+// that last uses it (ModuleResources::deferRelease does); collectGarbage() frees the range once that frame
+// completed. A placed resource dropped without release() keeps its range until cleanUp().
+class GpuMemoryAllocator
+{
+public:
+    enum class Pool : uint8_t
+    {
+        Buffers = 0,
+        SmallBuffers,
+        Textures,
+        RenderTargets,
+        Count
+    };
+
+    struct PoolStats
+    {
+        uint32_t numHeaps = 0;
+        uint32_t numResources = 0;
+        uint64_t reservedBytes = 0;
+        uint64_t usedBytes = 0;
+        uint64_t largestFreeBlock = 0;
+        float    fragmentation = 0.0f;   // worst external fragmentation among pages
+    };
+
+    struct Stats
+    {
+        PoolStats pools[size_t(Pool::Count)];
+        uint32_t committedFallbacks = 0; // resources too big for a page, or not DEFAULT heap
+        uint64_t budgetBytes = 0;        // from QueryVideoMemoryInfo (local segment)
+        uint64_t currentUsageBytes = 0;
+    };
+
+public:
+    GpuMemoryAllocator() = default;
+    ~GpuMemoryAllocator() = default;
+
+    GpuMemoryAllocator(const GpuMemoryAllocator&) = delete;
+    GpuMemoryAllocator& operator=(const GpuMemoryAllocator&) = delete;
+
+    bool init(ID3D12Device* device, IDXGIAdapter3* adapter);
+    void cleanUp();
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> createResource(
+        const D3D12_RESOURCE_DESC& desc,
+        D3D12_HEAP_TYPE heapType,
+        D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+    // The GPU is done with resource once frame completes; resources that were not placed are ignored
+    void release(ID3D12Resource* resource, uint64_t frame);
+
+    // Frees the ranges released at or before lastCompletedFrame; empty pages beyond the first are released
+    void collectGarbage(uint64_t lastCompletedFrame);
+
+    Stats getStats() const;
+
+    static const char* getPoolName(Pool pool);
+
+private:
+    struct HeapPage
+    {
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+        OffsetAllocator ranges;
+    };
+
+    struct Placement
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        Pool pool = Pool::Buffers;
+        HeapPage* page = nullptr;
+        uint64_t offset = 0;
+        uint64_t releaseFrame = 0;
+    };
+
+    static Pool selectPool(const D3D12_RESOURCE_DESC& desc, uint64_t size);
+    static uint64_t getPageSize(Pool pool);
+
+    HeapPage* addPage(Pool pool);
+
+private:
+    mutable std::mutex mutex;
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device;
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter;
+
+    std::vector<std::unique_ptr<HeapPage>> pages[size_t(Pool::Count)];
+    std::unordered_map<ID3D12Resource*, Placement> placements;
+    std::vector<Placement> released;
+
+    uint32_t committedFallbacks = 0;
+};
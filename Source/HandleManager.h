@@ -37,6 +37,8 @@ public:
             nodes[0].link = uint32_t(Capacity);
             nodes[0].gen = 0;
         }
+
+        freeCount = (Capacity > 1) ? uint32_t(Capacity - 1) : 0u;
     }
 
     Handle allocHandle()
@@ -55,6 +57,8 @@ public:
         nodes[idx].link = idx;
         nodes[idx].gen = genCounter;
 
+        --freeCount;
+
         return pack(idx, genCounter);
     }
 
@@ -66,6 +70,8 @@ public:
 
         nodes[idx].link = freeHead;
         freeHead = idx;
+
+        ++freeCount;
     }
 
     bool validHandle(Handle handle) const
@@ -90,19 +96,7 @@ public:
 
     size_t getSize() const { return Capacity; }
 
-    size_t getFreeCount() const
-    {
-        size_t count = 0;
-        uint32_t it = freeHead;
-
-        while (it < Capacity)
-        {
-            ++count;
-            it = nodes[it].link;
-        }
-
-        return count;
-    }
+    size_t getFreeCount() const { return freeCount; }
 
 private:
     static Handle pack(uint32_t index, uint8_t gen)
@@ -123,5 +117,6 @@ private:
 private:
     std::array<Node, Capacity> nodes{};
     uint32_t freeHead = 0;
+    uint32_t freeCount = 0;
     uint8_t genCounter = 0;
 };
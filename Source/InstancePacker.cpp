@@ -0,0 +1,67 @@
+#include "Globals.h"
+#include "InstancePacker.h"
+
+#include "SceneGraph.h"
+
+#include <cmath>
+
+Matrix InstancePacker::computeNormalMatrixSafe(const Matrix& world)
+{
+    Matrix m = world;
+    m._41 = 0.0f; m._42 = 0.0f; m._43 = 0.0f;
+
+    const float det = m.Determinant();
+    if (fabsf(det) < 1e-8f)
+        return Matrix::Identity;
+
+    return m.Invert();
+}
+
+const std::vector<uint32_t>& InstancePacker::update(const SceneGraph& graph, const uint32_t* nodes, uint32_t numInstances,
+    const std::vector<Vector3>& copyOffsets, const Matrix& dequant)
+{
+    const size_t numItems = size_t(numInstances) * copyOffsets.size();
+
+    repacked.clear();
+
+    if (packedVersions.size() != numInstances || itemWorlds.size() != numItems)
+    {
+        packedVersions.clear();
+        itemWorlds.resize(numItems);
+        itemData.resize(numItems);
+    }
+
+    const bool packAll = packedVersions.empty();
+    packedVersions.resize(numInstances);
+
+    for (uint32_t i = 0; i < numInstances; ++i)
+    {
+        const uint32_t version = graph.getWorldVersion(nodes[i]);
+        if (!packAll && packedVersions[i] == version)
+            continue;
+
+        packedVersions[i] = version;
+        repacked.push_back(i);
+
+        // Copies only add a translation: the normal matrix is the same for all of them
+        const Matrix& instanceWorld = graph.getWorld(nodes[i]);
+        const Matrix normalMat = computeNormalMatrixSafe(instanceWorld).Transpose();
+
+        for (size_t copy = 0; copy < copyOffsets.size(); ++copy)
+        {
+            const size_t item = copy * numInstances + i;
+            const Vector3& offset = copyOffsets[copy];
+
+            Matrix world = instanceWorld;
+            world._41 += offset.x;
+            world._42 += offset.y;
+            world._43 += offset.z;
+            itemWorlds[item] = world;
+
+            itemData[item].modelMat = (dequant * world).Transpose();
+            itemData[item].normalMat = normalMat;
+        }
+    }
+
+    return repacked;
+}
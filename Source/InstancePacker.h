@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class SceneGraph;
+
+// Per-item world and shader matrices of a model drawn at several copy offsets, item = copy * numInstances +
+// instance. Each mesh instance remembers the scene graph world version it was packed at, so update() only
+// rebuilds the instances whose node moved (in every copy) and tells the caller which ones, for the data it
+// packs alongside. GPU-free, like RenderQueue.
+class InstancePacker
+{
+public:
+    // One element of the instanced draws' StructuredBuffer (Assignment2.hlsli), transposed for HLSL
+    struct InstanceData
+    {
+        Matrix modelMat;
+        Matrix normalMat;
+    };
+
+public:
+    // Inverse of the world's upper 3x3, identity when it is singular
+    static Matrix computeNormalMatrixSafe(const Matrix& world);
+
+    // Forgets every packed version: the next update() packs all instances (new copies or dequantisation)
+    void invalidate() { packedVersions.clear(); }
+
+    // nodes[i] is the node of mesh instance i in graph, which must be up to date. Instances whose world
+    // version changed are packed; returns them in order (every instance after invalidate or a size change).
+    const std::vector<uint32_t>& update(const SceneGraph& graph, const uint32_t* nodes, uint32_t numInstances,
+        const std::vector<Vector3>& copyOffsets, const Matrix& dequant);
+
+    uint32_t getNumItems() const { return uint32_t(itemWorlds.size()); }
+    const Matrix& getItemWorld(uint32_t item) const { return itemWorlds[item]; }
+    const InstanceData& getItemData(uint32_t item) const { return itemData[item]; }
+
+    // Instances the last update() packed
+    const std::vector<uint32_t>& getRepacked() const { return repacked; }
+
+private:
+    std::vector<uint32_t> packedVersions;   // per mesh instance, empty when nothing is packed
+    std::vector<Matrix> itemWorlds;
+    std::vector<InstanceData> itemData;
+    std::vector<uint32_t> repacked;
+};
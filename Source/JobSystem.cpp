@@ -0,0 +1,292 @@
+#include "Globals.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Which JobSystem queue the current thread owns (0 = owning thread)
+    thread_local const JobSystem* tlsJobSystem = nullptr;
+    thread_local uint32_t tlsQueueIndex = 0;
+}
+
+// ---------------------------------------------------------
+// JobGraph
+// ---------------------------------------------------------
+JobGraph::NodeId JobGraph::addNode(const char* name, std::function<void()> fn, bool mainThreadOnly)
+{
+    auto node = std::make_unique<Node>();
+    node->name = name ? name : "";
+    node->fn = std::move(fn);
+    node->mainThreadOnly = mainThreadOnly;
+
+    nodes.push_back(std::move(node));
+    return NodeId(nodes.size() - 1);
+}
+
+void JobGraph::addEdge(NodeId before, NodeId after)
+{
+    _ASSERTE(before < nodes.size() && after < nodes.size() && before != after);
+
+    std::vector<NodeId>& succ = nodes[before]->successors;
+    if (std::find(succ.begin(), succ.end(), after) != succ.end())
+        return;
+
+    succ.push_back(after);
+    ++nodes[after]->numPredecessors;
+}
+
+void JobGraph::clear()
+{
+    nodes.clear();
+    remaining = 0;
+}
+
+// ---------------------------------------------------------
+// JobSystem
+// ---------------------------------------------------------
+JobSystem::JobSystem(uint32_t numWorkers)
+{
+    ownerThread = std::this_thread::get_id();
+
+    queues.reserve(size_t(numWorkers) + 1);
+    for (uint32_t i = 0; i <= numWorkers; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    workers.reserve(numWorkers);
+    for (uint32_t i = 0; i < numWorkers; ++i)
+        workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+    quit = true;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_all();
+
+    for (std::thread& t : workers)
+        t.join();
+
+    workers.clear();
+}
+
+uint32_t JobSystem::getDefaultWorkerCount()
+{
+    const uint32_t hw = std::thread::hardware_concurrency();
+    return (hw > 1) ? (hw - 1) : 0;
+}
+
+uint32_t JobSystem::currentQueueIndex() const
+{
+    return (tlsJobSystem == this) ? tlsQueueIndex : 0;
+}
+
+void JobSystem::run(JobFn fn, Counter* counter)
+{
+    if (counter)
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.fn = std::move(fn);
+    job.counter = counter;
+
+    push(currentQueueIndex(), std::move(job));
+}
+
+void JobSystem::wait(Counter& counter)
+{
+    const uint32_t queueIndex = currentQueueIndex();
+
+    while (!counter.isDone())
+    {
+        if (!tryRunOne(queueIndex))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn)
+{
+    if (count == 0)
+        return;
+
+    grainSize = std::max(1u, grainSize);
+
+    if (workers.empty() || count <= grainSize)
+    {
+        fn(0, count);
+        return;
+    }
+
+    Counter counter;
+    for (uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        const uint32_t end = std::min(count, begin + grainSize);
+        run([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+
+    wait(counter);
+}
+
+void JobSystem::execute(JobGraph& graph)
+{
+    _ASSERTE(std::this_thread::get_id() == ownerThread);
+
+    const uint32_t numNodes = uint32_t(graph.nodes.size());
+    if (numNodes == 0)
+        return;
+
+    graph.remaining.store(numNodes, std::memory_order_relaxed);
+    for (auto& node : graph.nodes)
+        node->pending.store(node->numPredecessors, std::memory_order_relaxed);
+
+    for (JobGraph::NodeId id = 0; id < numNodes; ++id)
+    {
+        if (graph.nodes[id]->numPredecessors == 0)
+            scheduleNode(graph, id);
+    }
+
+    while (graph.remaining.load(std::memory_order_acquire) != 0)
+    {
+        Job job;
+        bool hasMainJob = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mainOnlyMutex);
+            if (!mainOnlyJobs.empty())
+            {
+                job = std::move(mainOnlyJobs.front());
+                mainOnlyJobs.pop_front();
+                hasMainJob = true;
+            }
+        }
+
+        if (hasMainJob)
+            runJob(job);
+        else if (!tryRunOne(0))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::scheduleNode(JobGraph& graph, JobGraph::NodeId id)
+{
+    Job job;
+    job.fn = [this, &graph, id]()
+        {
+            graph.nodes[id]->fn();
+            completeNode(graph, id);
+        };
+
+    if (graph.nodes[id]->mainThreadOnly)
+    {
+        std::lock_guard<std::mutex> lock(mainOnlyMutex);
+        mainOnlyJobs.push_back(std::move(job));
+        return;
+    }
+
+    push(currentQueueIndex(), std::move(job));
+}
+
+void JobSystem::completeNode(JobGraph& graph, JobGraph::NodeId id)
+{
+    for (JobGraph::NodeId succ : graph.nodes[id]->successors)
+    {
+        if (graph.nodes[succ]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            scheduleNode(graph, succ);
+    }
+
+    graph.remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::push(uint32_t queueIndex, Job&& job)
+{
+    queuedJobs.fetch_add(1, std::memory_order_release);
+
+    {
+        WorkQueue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    if (!workers.empty())
+    {
+        // Taking the lock orders this push against a worker that is about to sleep
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeCondition.notify_one();
+    }
+}
+
+bool JobSystem::popLocal(uint32_t queueIndex, Job& out)
+{
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.jobs.empty())
+        return false;
+
+    out = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(uint32_t thiefIndex, Job& out)
+{
+    const uint32_t numQueues = uint32_t(queues.size());
+
+    for (uint32_t i = 1; i < numQueues; ++i)
+    {
+        WorkQueue& victim = *queues[(thiefIndex + i) % numQueues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (victim.jobs.empty())
+            continue;
+
+        out = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+bool JobSystem::tryRunOne(uint32_t queueIndex)
+{
+    Job job;
+    if (!popLocal(queueIndex, job) && !steal(queueIndex, job))
+        return false;
+
+    runJob(job);
+    return true;
+}
+
+void JobSystem::runJob(Job& job)
+{
+    job.fn();
+
+    if (job.counter)
+        job.counter->value.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(uint32_t queueIndex)
+{
+    tlsJobSystem = this;
+    tlsQueueIndex = queueIndex;
+
+    while (!quit.load(std::memory_order_acquire))
+    {
+        if (tryRunOne(queueIndex))
+            continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]()
+            {
+                return quit.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_acquire) > 0;
+            });
+    }
+}
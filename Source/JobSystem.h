@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Dependency graph of jobs. Built once, executed many times by JobSystem::execute().
+// Nodes flagged mainThreadOnly are only ever run by the thread that calls execute().
+class JobGraph
+{
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId INVALID_NODE = UINT32_MAX;
+
+public:
+    JobGraph() = default;
+    ~JobGraph() = default;
+
+    JobGraph(const JobGraph&) = delete;
+    JobGraph& operator=(const JobGraph&) = delete;
+
+    NodeId addNode(const char* name, std::function<void()> fn, bool mainThreadOnly);
+    void addEdge(NodeId before, NodeId after);
+    void clear();
+
+    size_t getNumNodes() const { return nodes.size(); }
+    const char* getNodeName(NodeId id) const { return nodes[id]->name; }
+
+private:
+    friend class JobSystem;
+
+    struct Node
+    {
+        const char* name = "";
+        std::function<void()> fn;
+        std::vector<NodeId> successors;
+        uint32_t numPredecessors = 0;
+        std::atomic<uint32_t> pending{ 0 };
+        bool mainThreadOnly = false;
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::atomic<uint32_t> remaining{ 0 };
+};
+
+// Work-stealing job scheduler.
+// Every thread (workers + the owning thread) has its own deque: jobs are pushed and popped at the back by the owner
+// (LIFO, warm caches) and stolen from the front by idle threads. The owning thread helps while it waits.
+class JobSystem
+{
+public:
+    using JobFn = std::function<void()>;
+
+    // Outstanding job count. wait() returns once it drops back to zero.
+    class Counter
+    {
+    public:
+        bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> value{ 0 };
+    };
+
+public:
+    // numWorkers == 0 runs everything on the calling thread inside wait()/execute()
+    explicit JobSystem(uint32_t numWorkers);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t getNumWorkers() const { return uint32_t(workers.size()); }
+
+    // Workers plus the owning thread; getThreadIndex() is in [0, getNumThreads()), 0 for the owning thread
+    uint32_t getNumThreads() const { return uint32_t(queues.size()); }
+    uint32_t getThreadIndex() const { return currentQueueIndex(); }
+
+    void run(JobFn fn, Counter* counter = nullptr);
+    void wait(Counter& counter);
+
+    // Splits [0, count) into ranges of at most grainSize elements and runs fn(begin, end) on each.
+    void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn);
+
+    void execute(JobGraph& graph);
+
+    static uint32_t getDefaultWorkerCount();
+
+private:
+    struct Job
+    {
+        JobFn fn;
+        Counter* counter = nullptr;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void workerLoop(uint32_t queueIndex);
+
+    void push(uint32_t queueIndex, Job&& job);
+    bool popLocal(uint32_t queueIndex, Job& out);
+    bool steal(uint32_t thiefIndex, Job& out);
+    bool tryRunOne(uint32_t queueIndex);
+    void runJob(Job& job);
+
+    void scheduleNode(JobGraph& graph, JobGraph::NodeId id);
+    void completeNode(JobGraph& graph, JobGraph::NodeId id);
+
+    uint32_t currentQueueIndex() const;
+
+private:
+    // Queue 0 belongs to the owning (main) thread, queue i + 1 to worker i
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    // Jobs that must run on the owning thread (JobGraph mainThreadOnly nodes)
+    std::mutex mainOnlyMutex;
+    std::deque<Job> mainOnlyJobs;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<uint32_t> queuedJobs{ 0 };
+    std::atomic<bool> quit{ false };
+
+    std::thread::id ownerThread;
+};
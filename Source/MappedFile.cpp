@@ -0,0 +1,86 @@
+#include "Globals.h"
+#include "MappedFile.h"
+
+#include <filesystem>
+#include <utility>
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        file = std::exchange(other.file, INVALID_HANDLE_VALUE);
+        mapping = std::exchange(other.mapping, nullptr);
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+
+    return *this;
+}
+
+bool MappedFile::open(const char* fileName)
+{
+    close();
+
+    if (!fileName)
+        return false;
+
+    file = CreateFileW(std::filesystem::path(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        // Empty files cannot be mapped
+        close();
+        return false;
+    }
+
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        close();
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data)
+    {
+        close();
+        return false;
+    }
+
+    size = size_t(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+
+    if (mapping)
+        CloseHandle(mapping);
+
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    file = INVALID_HANDLE_VALUE;
+    mapping = nullptr;
+    data = nullptr;
+    size = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first touch, so only what is read
+// ends up resident and nothing is copied into a heap buffer.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const char* fileName);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
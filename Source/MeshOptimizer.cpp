@@ -0,0 +1,942 @@
+#include "Globals.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    // Forsyth scoring parameters (https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html)
+    constexpr int   kForsythCacheSize = 32;
+    constexpr float kCacheDecayPower = 1.5f;
+    constexpr float kLastTriScore = 0.75f;
+    constexpr float kValenceBoostScale = 2.0f;
+    constexpr float kValenceBoostPower = 0.5f;
+
+    // Valences above this share the last boost value, which is already small
+    constexpr uint32_t kMaxScoredValence = 32;
+
+    struct ScoreTables
+    {
+        float cache[kForsythCacheSize];
+        float valence[kMaxScoredValence + 1];
+    };
+
+    const ScoreTables& getScoreTables()
+    {
+        static const ScoreTables tables = []()
+            {
+                ScoreTables t = {};
+
+                for (int i = 0; i < kForsythCacheSize; ++i)
+                {
+                    // The three vertices of the last triangle score the same on purpose, whatever their order
+                    t.cache[i] = (i < 3) ? kLastTriScore : std::pow(1.0f - float(i - 3) / float(kForsythCacheSize - 3), kCacheDecayPower);
+                }
+
+                // Boost vertices with few triangles left so they get finished off
+                for (uint32_t v = 1; v <= kMaxScoredValence; ++v)
+                    t.valence[v] = kValenceBoostScale * std::pow(float(v), -kValenceBoostPower);
+
+                return t;
+            }();
+
+        return tables;
+    }
+
+    float vertexScore(int cachePosition, uint32_t remainingValence)
+    {
+        if (remainingValence == 0)
+            return -1.0f;
+
+        const ScoreTables& tables = getScoreTables();
+
+        const float cacheScore = (cachePosition >= 0) ? tables.cache[cachePosition] : 0.0f;
+        return cacheScore + tables.valence[std::min(remainingValence, kMaxScoredValence)];
+    }
+
+    bool indicesInRange(const uint32_t* indices, size_t numIndices, uint32_t numVertices)
+    {
+        for (size_t i = 0; i < numIndices; ++i)
+        {
+            if (indices[i] >= numVertices)
+                return false;
+        }
+        return true;
+    }
+
+    // Triangle indices where the FIFO cache misses all three vertices: nothing is shared with what came before,
+    // so the list can be cut there without hurting the vertex cache
+    void findHardBoundaries(const uint32_t* indices, size_t numTriangles, uint32_t numVertices, std::vector<uint32_t>& clusterStarts)
+    {
+        std::vector<uint32_t> cacheTimestamps(numVertices, 0);
+        uint32_t timestamp = MeshOptimizer::kSimulatedCacheSize + 1;
+
+        clusterStarts.clear();
+
+        for (size_t t = 0; t < numTriangles; ++t)
+        {
+            uint32_t misses = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[t * 3 + k];
+                if (timestamp - cacheTimestamps[v] > MeshOptimizer::kSimulatedCacheSize)
+                {
+                    cacheTimestamps[v] = timestamp++;
+                    ++misses;
+                }
+            }
+
+            if (t == 0 || misses == 3)
+                clusterStarts.push_back(uint32_t(t));
+        }
+    }
+
+    constexpr uint32_t kErrorBuckets = 1u << 16;
+
+    // Sum of area-weighted squared distances to a set of planes (Garland & Heckbert 1997).
+    // Symmetric 4x4 matrix as A (3x3), b and c, plus the total weight so the error is an average.
+    struct Quadric
+    {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double w = 0.0;
+    };
+
+    // Plane n.p + d = 0 with unit n
+    void addPlane(Quadric& q, double nx, double ny, double nz, double d, double weight)
+    {
+        q.a00 += weight * nx * nx; q.a01 += weight * nx * ny; q.a02 += weight * nx * nz;
+        q.a11 += weight * ny * ny; q.a12 += weight * ny * nz; q.a22 += weight * nz * nz;
+        q.b0 += weight * nx * d; q.b1 += weight * ny * d; q.b2 += weight * nz * d;
+        q.c += weight * d * d;
+        q.w += weight;
+    }
+
+    void addQuadric(Quadric& q, const Quadric& r)
+    {
+        q.a00 += r.a00; q.a01 += r.a01; q.a02 += r.a02;
+        q.a11 += r.a11; q.a12 += r.a12; q.a22 += r.a22;
+        q.b0 += r.b0; q.b1 += r.b1; q.b2 += r.b2;
+        q.c += r.c;
+        q.w += r.w;
+    }
+
+    // Mean squared distance from p to the planes of (q + r)
+    double quadricError(const Quadric& q, const Quadric& r, const float* p)
+    {
+        const double x = p[0], y = p[1], z = p[2];
+        const double w = q.w + r.w;
+        if (w <= 0.0)
+            return 0.0;
+
+        const double e =
+            (q.a00 + r.a00) * x * x + (q.a11 + r.a11) * y * y + (q.a22 + r.a22) * z * z +
+            2.0 * ((q.a01 + r.a01) * x * y + (q.a02 + r.a02) * x * z + (q.a12 + r.a12) * y * z) +
+            2.0 * ((q.b0 + r.b0) * x + (q.b1 + r.b1) * y + (q.b2 + r.b2) * z) +
+            (q.c + r.c);
+
+        return std::max(e, 0.0) / w;
+    }
+
+    void triangleNormal(const float* p0, const float* p1, const float* p2, float n[3])
+    {
+        const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    // Bounding sphere from the box centre and normal cone from the unit face normals of one meshlet
+    void computeMeshletBounds(const uint32_t* indices, size_t numIndices, const float* positions, size_t stride, MeshOptimizer::Meshlet& meshlet)
+    {
+        auto position = [&](uint32_t v) { return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * stride); };
+
+        float mn[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float mx[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (size_t i = 0; i < numIndices; ++i)
+        {
+            const float* p = position(indices[i]);
+            for (int c = 0; c < 3; ++c)
+            {
+                mn[c] = std::min(mn[c], p[c]);
+                mx[c] = std::max(mx[c], p[c]);
+            }
+        }
+
+        float radiusSq = 0.0f;
+        for (int c = 0; c < 3; ++c)
+            meshlet.center[c] = (mn[c] + mx[c]) * 0.5f;
+
+        for (size_t i = 0; i < numIndices; ++i)
+        {
+            const float* p = position(indices[i]);
+            const float d[3] = { p[0] - meshlet.center[0], p[1] - meshlet.center[1], p[2] - meshlet.center[2] };
+            radiusSq = std::max(radiusSq, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        }
+        meshlet.radius = std::sqrt(radiusSq);
+
+        std::vector<float> normals;
+        normals.reserve(numIndices);
+        float axis[3] = {};
+
+        for (size_t t = 0; t < numIndices; t += 3)
+        {
+            float n[3];
+            triangleNormal(position(indices[t + 0]), position(indices[t + 1]), position(indices[t + 2]), n);
+
+            const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length <= 0.0f)
+                continue;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                normals.push_back(n[c] / length);
+                axis[c] += n[c] / length;
+            }
+        }
+
+        meshlet.coneCutoff = 1.0f;
+
+        const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        if (axisLength <= 0.0f)
+            return;
+
+        for (int c = 0; c < 3; ++c)
+            meshlet.coneAxis[c] = axis[c] / axisLength;
+
+        float minDot = 1.0f;
+        for (size_t i = 0; i < normals.size(); i += 3)
+        {
+            minDot = std::min(minDot, normals[i] * meshlet.coneAxis[0] + normals[i + 1] * meshlet.coneAxis[1] +
+                normals[i + 2] * meshlet.coneAxis[2]);
+        }
+
+        // A spread of 90 degrees or more can always be seen from somewhere
+        if (minDot > 0.0f)
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+
+    // Triangles around each vertex: adjacency[offsets[v], offsets[v + 1]) are triangle numbers
+    void buildTriangleAdjacency(const uint32_t* indices, size_t numIndices, uint32_t numVertices,
+        std::vector<uint32_t>& offsets, std::vector<uint32_t>& adjacency)
+    {
+        offsets.assign(size_t(numVertices) + 1, 0u);
+        for (size_t i = 0; i < numIndices; ++i)
+            ++offsets[indices[i] + 1];
+        for (uint32_t v = 0; v < numVertices; ++v)
+            offsets[v + 1] += offsets[v];
+
+        adjacency.resize(numIndices);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < numIndices; ++i)
+            adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+    }
+
+    // Vertices that must not move: on an open or non-manifold edge, or sharing their position with
+    // another vertex (UV/normal seams), where moving one copy would tear the surface
+    void findLockedVertices(const uint32_t* indices, size_t numIndices, const float* positions, size_t stride,
+        uint32_t numVertices, std::vector<uint8_t>& locked)
+    {
+        locked.assign(numVertices, 0);
+
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> adjacency;
+        buildTriangleAdjacency(indices, numIndices, numVertices, offsets, adjacency);
+
+        // An edge a->b is interior when a's ring holds it once and its twin b->a once
+        for (size_t t = 0; t < numIndices; t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = indices[t + k];
+                const uint32_t b = indices[t + (k + 1) % 3];
+
+                uint32_t same = 0;
+                uint32_t twin = 0;
+                for (uint32_t i = offsets[a]; i < offsets[a + 1]; ++i)
+                {
+                    const uint32_t* tri = &indices[size_t(adjacency[i]) * 3];
+                    for (int e = 0; e < 3; ++e)
+                    {
+                        same += (tri[e] == a && tri[(e + 1) % 3] == b) ? 1u : 0u;
+                        twin += (tri[e] == b && tri[(e + 1) % 3] == a) ? 1u : 0u;
+                    }
+                }
+
+                if (same != 1 || twin != 1)
+                    locked[a] = locked[b] = 1;
+            }
+        }
+
+        auto position = [&](uint32_t v) { return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * stride); };
+
+        // Open addressing on the position bits; the first vertex seen at a position owns the slot
+        size_t tableSize = 1;
+        while (tableSize < size_t(numVertices) * 2)
+            tableSize *= 2;
+
+        std::vector<uint32_t> table(tableSize, UINT32_MAX);
+        for (uint32_t v = 0; v < numVertices; ++v)
+        {
+            uint32_t bits[3];
+            memcpy(bits, position(v), sizeof(bits));
+
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (uint32_t b : bits)
+                h = (h ^ b) * 0x100000001b3ull;
+
+            for (size_t slot = size_t(h) & (tableSize - 1);; slot = (slot + 1) & (tableSize - 1))
+            {
+                if (table[slot] == UINT32_MAX)
+                {
+                    table[slot] = v;
+                    break;
+                }
+
+                if (memcmp(position(table[slot]), bits, sizeof(bits)) == 0)
+                {
+                    locked[table[slot]] = locked[v] = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t numIndices, uint32_t numVertices, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (!indices || numIndices % 3 != 0 || !indicesInRange(indices, numIndices, numVertices))
+        return stats;
+
+    stats.numTriangles = uint32_t(numIndices / 3);
+
+    // FIFO: a vertex is resident while fewer than cacheSize misses happened since it was loaded
+    std::vector<uint32_t> cacheTimestamps(numVertices, 0);
+    std::vector<uint8_t> referenced(numVertices, 0);
+    uint32_t timestamp = cacheSize + 1;
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        const uint32_t v = indices[i];
+
+        if (timestamp - cacheTimestamps[v] > cacheSize)
+        {
+            cacheTimestamps[v] = timestamp++;
+            ++stats.numTransforms;
+        }
+
+        if (!referenced[v])
+        {
+            referenced[v] = 1;
+            ++stats.numVertices;
+        }
+    }
+
+    return stats;
+}
+
+bool MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t numIndices, uint32_t numVertices)
+{
+    if (!indices || numIndices % 3 != 0 || !indicesInRange(indices, numIndices, numVertices))
+        return false;
+
+    const uint32_t numTriangles = uint32_t(numIndices / 3);
+    if (numTriangles < 2)
+        return true;
+
+    // Vertex -> triangles adjacency, trimmed as triangles are emitted
+    std::vector<uint32_t> valence(numVertices, 0);
+    for (size_t i = 0; i < numIndices; ++i)
+        ++valence[indices[i]];
+
+    std::vector<uint32_t> adjacencyOffset(size_t(numVertices) + 1, 0);
+    for (uint32_t v = 0; v < numVertices; ++v)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+
+    std::vector<uint32_t> adjacency(numIndices);
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (uint32_t t = 0; t < numTriangles; ++t)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[t * 3 + k];
+                adjacency[fill[v]++] = t;
+            }
+        }
+    }
+
+    std::vector<int>   cachePosition(numVertices, -1);
+    std::vector<float> vScore(numVertices);
+    for (uint32_t v = 0; v < numVertices; ++v)
+        vScore[v] = vertexScore(-1, valence[v]);
+
+    std::vector<float> tScore(numTriangles);
+    for (uint32_t t = 0; t < numTriangles; ++t)
+        tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+
+    std::vector<uint8_t>  emitted(numTriangles, 0);
+    std::vector<uint32_t> output(numIndices);
+
+    // LRU cache, with room for the three vertices pushed before the overflow is dropped
+    uint32_t cache[kForsythCacheSize + 3];
+    uint32_t cacheCount = 0;
+
+    uint32_t inputCursor = 0;
+    uint32_t bestTriangle = UINT32_MAX;
+
+    for (uint32_t outTriangle = 0; outTriangle < numTriangles; ++outTriangle)
+    {
+        if (bestTriangle == UINT32_MAX)
+        {
+            // Nothing in the cache has triangles left: restart from the next unused triangle in input order
+            while (emitted[inputCursor])
+                ++inputCursor;
+
+            bestTriangle = inputCursor;
+        }
+
+        const uint32_t* tri = &indices[bestTriangle * 3];
+        memcpy(&output[size_t(outTriangle) * 3], tri, sizeof(uint32_t) * 3);
+        emitted[bestTriangle] = 1;
+
+        // Move the triangle's vertices to the front of the cache
+        uint32_t newCache[kForsythCacheSize + 3];
+        uint32_t newCount = 0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t v = tri[k];
+
+            // Degenerate triangles repeat a vertex, it only takes one slot
+            if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                newCache[newCount++] = v;
+
+            // Remove the triangle from the vertex's remaining list
+            uint32_t* begin = &adjacency[adjacencyOffset[v]];
+            uint32_t* end = begin + valence[v];
+            uint32_t* it = std::find(begin, end, bestTriangle);
+            if (it != end)
+            {
+                *it = *(end - 1);
+                --valence[v];
+            }
+        }
+
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                newCache[newCount++] = v;
+        }
+
+        // Vertices falling off the end lose their cache score
+        for (uint32_t i = kForsythCacheSize; i < newCount; ++i)
+            cachePosition[newCache[i]] = -1;
+
+        cacheCount = std::min<uint32_t>(newCount, kForsythCacheSize);
+        memcpy(cache, newCache, sizeof(uint32_t) * cacheCount);
+
+        for (uint32_t i = 0; i < cacheCount; ++i)
+            cachePosition[cache[i]] = int(i);
+
+        // Rescore the vertices whose position or valence changed, and the triangles that use them
+        for (uint32_t i = 0; i < newCount; ++i)
+        {
+            const uint32_t v = newCache[i];
+            const float newScore = vertexScore(cachePosition[v], valence[v]);
+            const float delta = newScore - vScore[v];
+            vScore[v] = newScore;
+
+            if (delta != 0.0f)
+            {
+                for (uint32_t a = 0; a < valence[v]; ++a)
+                    tScore[adjacency[adjacencyOffset[v] + a]] += delta;
+            }
+        }
+
+        // Next triangle: the best one touching the cache
+        bestTriangle = UINT32_MAX;
+        float bestScore = -1.0f;
+
+        for (uint32_t i = 0; i < cacheCount; ++i)
+        {
+            const uint32_t v = cache[i];
+            for (uint32_t a = 0; a < valence[v]; ++a)
+            {
+                const uint32_t t = adjacency[adjacencyOffset[v] + a];
+                if (tScore[t] > bestScore)
+                {
+                    bestScore = tScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+
+    memcpy(indices, output.data(), sizeof(uint32_t) * numIndices);
+    return true;
+}
+
+bool MeshOptimizer::optimizeOverdraw(uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+    uint32_t numVertices, float threshold)
+{
+    if (!indices || !positions || numIndices % 3 != 0 || !indicesInRange(indices, numIndices, numVertices))
+        return false;
+
+    const size_t numTriangles = numIndices / 3;
+    if (numTriangles < 2)
+        return true;
+
+    std::vector<uint32_t> clusterStarts;
+    findHardBoundaries(indices, numTriangles, numVertices, clusterStarts);
+
+    const size_t numClusters = clusterStarts.size();
+    if (numClusters < 2)
+        return true;
+
+    auto position = [&](uint32_t v)
+        {
+            return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + size_t(v) * positionStride);
+        };
+
+    // Area-weighted centroid and normal per cluster, plus the mesh centroid
+    std::vector<float> clusterData(numClusters * 6, 0.0f);
+    float meshCentroid[3] = {};
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < numClusters; ++c)
+    {
+        const size_t begin = clusterStarts[c];
+        const size_t end = (c + 1 < numClusters) ? clusterStarts[c + 1] : numTriangles;
+
+        float* centroid = &clusterData[c * 6];
+        float* normal = centroid + 3;
+        float area = 0.0f;
+
+        for (size_t t = begin; t < end; ++t)
+        {
+            const float* p0 = position(indices[t * 3]);
+            const float* p1 = position(indices[t * 3 + 1]);
+            const float* p2 = position(indices[t * 3 + 2]);
+
+            const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            const float triArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int k = 0; k < 3; ++k)
+            {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * (triArea / 3.0f);
+                normal[k] += n[k];
+            }
+            area += triArea;
+        }
+
+        for (int k = 0; k < 3; ++k)
+            meshCentroid[k] += centroid[k];
+        meshArea += area;
+
+        const float invArea = (area > 0.0f) ? 1.0f / area : 0.0f;
+        for (int k = 0; k < 3; ++k)
+            centroid[k] *= invArea;
+
+        const float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        const float invNormal = (normalLength > 0.0f) ? 1.0f / normalLength : 0.0f;
+        for (int k = 0; k < 3; ++k)
+            normal[k] *= invNormal;
+    }
+
+    const float invMeshArea = (meshArea > 0.0f) ? 1.0f / meshArea : 0.0f;
+    for (int k = 0; k < 3; ++k)
+        meshCentroid[k] *= invMeshArea;
+
+    // Clusters facing away from the centre occlude the rest of the mesh more often: draw them first
+    std::vector<float> sortKey(numClusters);
+    for (size_t c = 0; c < numClusters; ++c)
+    {
+        const float* centroid = &clusterData[c * 6];
+        const float* normal = centroid + 3;
+        sortKey[c] = (centroid[0] - meshCentroid[0]) * normal[0] + (centroid[1] - meshCentroid[1]) * normal[1] + (centroid[2] - meshCentroid[2]) * normal[2];
+    }
+
+    std::vector<uint32_t> order(numClusters);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(numIndices);
+    for (uint32_t c : order)
+    {
+        const size_t begin = clusterStarts[c];
+        const size_t end = (c + 1 < numClusters) ? clusterStarts[c + 1] : numTriangles;
+        output.insert(output.end(), indices + begin * 3, indices + end * 3);
+    }
+
+    const float acmrBefore = analyzeVertexCache(indices, numIndices, numVertices).getAcmr();
+    const float acmrAfter = analyzeVertexCache(output.data(), numIndices, numVertices).getAcmr();
+
+    if (acmrAfter <= acmrBefore * threshold)
+        memcpy(indices, output.data(), sizeof(uint32_t) * numIndices);
+
+    return true;
+}
+
+bool MeshOptimizer::optimizeVertexFetch(void* vertices, uint32_t numVertices, size_t vertexSize, uint32_t* indices, size_t numIndices)
+{
+    if (!vertices || !indices || !indicesInRange(indices, numIndices, numVertices))
+        return false;
+
+    std::vector<uint32_t> remap(numVertices, UINT32_MAX);
+    uint32_t next = 0;
+
+    for (size_t i = 0; i < numIndices; ++i)
+    {
+        uint32_t& target = remap[indices[i]];
+        if (target == UINT32_MAX)
+            target = next++;
+
+        indices[i] = target;
+    }
+
+    for (uint32_t v = 0; v < numVertices; ++v)
+    {
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(vertices);
+    std::vector<uint8_t> reordered(size_t(numVertices) * vertexSize);
+    for (uint32_t v = 0; v < numVertices; ++v)
+        memcpy(&reordered[size_t(remap[v]) * vertexSize], src + size_t(v) * vertexSize, vertexSize);
+
+    memcpy(vertices, reordered.data(), reordered.size());
+    return true;
+}
+
+bool MeshOptimizer::splitByVertexLimit(const uint32_t* indices, size_t numIndices, uint32_t numVertices, uint32_t maxVertices,
+    std::vector<MeshPart>& parts)
+{
+    parts.clear();
+
+    if (!indices || numIndices % 3 != 0 || maxVertices < 3 || !indicesInRange(indices, numIndices, numVertices))
+        return false;
+
+    std::vector<uint32_t> remap(numVertices, UINT32_MAX);
+    MeshPart part;
+
+    auto flush = [&]()
+        {
+            for (uint32_t v : part.vertices)
+                remap[v] = UINT32_MAX;
+
+            parts.push_back(std::move(part));
+            part = {};
+        };
+
+    for (size_t t = 0; t < numIndices; t += 3)
+    {
+        const uint32_t a = indices[t + 0];
+        const uint32_t b = indices[t + 1];
+        const uint32_t c = indices[t + 2];
+
+        const uint32_t added = (remap[a] == UINT32_MAX ? 1u : 0u) +
+            (remap[b] == UINT32_MAX && b != a ? 1u : 0u) +
+            (remap[c] == UINT32_MAX && c != a && c != b ? 1u : 0u);
+
+        if (part.vertices.size() + added > maxVertices)
+            flush();
+
+        for (uint32_t v : { a, b, c })
+        {
+            if (remap[v] == UINT32_MAX)
+            {
+                remap[v] = uint32_t(part.vertices.size());
+                part.vertices.push_back(v);
+            }
+
+            part.indices.push_back(remap[v]);
+        }
+    }
+
+    if (!part.indices.empty())
+        flush();
+
+    return true;
+}
+
+size_t MeshOptimizer::simplify(uint32_t* destination, const uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+    uint32_t numVertices, size_t targetIndexCount, float targetError, float* resultError)
+{
+    if (resultError)
+        *resultError = 0.0f;
+
+    if (!destination || !indices || !positions || numIndices % 3 != 0 || !indicesInRange(indices, numIndices, numVertices))
+        return 0;
+
+    auto position = [&](uint32_t v) { return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionStride); };
+
+    std::vector<uint32_t> result(indices, indices + numIndices);
+
+    std::vector<uint8_t> locked;
+    findLockedVertices(indices, numIndices, positions, positionStride, numVertices, locked);
+
+    std::vector<Quadric> quadrics(numVertices);
+    for (size_t t = 0; t < numIndices; t += 3)
+    {
+        const float* p0 = position(indices[t + 0]);
+        float n[3];
+        triangleNormal(p0, position(indices[t + 1]), position(indices[t + 2]), n);
+
+        const double length = std::sqrt(double(n[0]) * n[0] + double(n[1]) * n[1] + double(n[2]) * n[2]);
+        if (length <= 0.0)
+            continue;
+
+        const double nx = n[0] / length, ny = n[1] / length, nz = n[2] / length;
+        const double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+
+        // Weighted by area so small triangles do not pin big flat regions
+        for (int k = 0; k < 3; ++k)
+            addPlane(quadrics[indices[t + k]], nx, ny, nz, d, length * 0.5);
+    }
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double   error;
+    };
+
+    const double maxError = double(targetError) * double(targetError);
+    double worstError = 0.0;
+
+    std::vector<Collapse> candidates;
+    std::vector<uint32_t> order;        // candidates, cheapest first
+    std::vector<uint16_t> keys;
+    std::vector<uint32_t> histogram(kErrorBuckets + 1);
+    std::vector<uint32_t> collapseTo(numVertices);
+    std::vector<uint8_t> touched(numVertices);
+    std::vector<uint32_t> adjacencyOffsets;
+    std::vector<uint32_t> adjacency;
+
+    // Each pass collapses a set of independent edges, cheapest first, then rewrites the list
+    while (result.size() > targetIndexCount)
+    {
+        const size_t numTriangles = result.size() / 3;
+
+        buildTriangleAdjacency(result.data(), result.size(), numVertices, adjacencyOffsets, adjacency);
+
+        // Each interior edge shows up as (a, b) in one triangle and (b, a) in the other: keep one
+        candidates.clear();
+        candidates.reserve(result.size());
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t a = result[t + k];
+                const uint32_t b = result[t + (k + 1) % 3];
+                if (a >= b || (locked[a] && locked[b]))
+                    continue;
+
+                const double errorAB = locked[a] ? DBL_MAX : quadricError(quadrics[a], quadrics[b], position(b));
+                const double errorBA = locked[b] ? DBL_MAX : quadricError(quadrics[a], quadrics[b], position(a));
+
+                const Collapse collapse = (errorAB <= errorBA) ? Collapse{ a, b, errorAB } : Collapse{ b, a, errorBA };
+                if (collapse.error <= maxError)
+                    candidates.push_back(collapse);
+            }
+        }
+
+        // Counting sort on the top 16 bits of the float error (non-negative floats order like their bits):
+        // exponent plus 7 mantissa bits is plenty to pick the cheap collapses first
+        keys.resize(candidates.size());
+        std::fill(histogram.begin(), histogram.end(), 0u);
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            const float error = float(candidates[i].error);
+            uint32_t bits;
+            memcpy(&bits, &error, sizeof(bits));
+
+            keys[i] = uint16_t(bits >> 16);
+            ++histogram[keys[i] + 1];
+        }
+
+        for (uint32_t k = 0; k < kErrorBuckets; ++k)
+            histogram[k + 1] += histogram[k];
+
+        order.resize(candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i)
+            order[histogram[keys[i]]++] = uint32_t(i);
+
+        std::iota(collapseTo.begin(), collapseTo.end(), 0u);
+        std::fill(touched.begin(), touched.end(), uint8_t(0));
+
+        const size_t trianglesToRemove = numTriangles - targetIndexCount / 3;
+        size_t removed = 0;
+        size_t numCollapses = 0;
+
+        for (uint32_t candidate : order)
+        {
+            const Collapse& collapse = candidates[candidate];
+            if (removed >= trianglesToRemove)
+                break;
+
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // Reject collapses that flip a triangle around the vertex that moves
+            const float* target = position(collapse.to);
+            bool flips = false;
+            size_t collapsed = 0;
+
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !flips; ++a)
+            {
+                const uint32_t* tri = &result[size_t(adjacency[a]) * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+                {
+                    ++collapsed;
+                    continue;
+                }
+
+                const float* p[3];
+                const float* moved[3];
+                for (int k = 0; k < 3; ++k)
+                {
+                    p[k] = position(tri[k]);
+                    moved[k] = (tri[k] == collapse.from) ? target : p[k];
+                }
+
+                float before[3], after[3];
+                triangleNormal(p[0], p[1], p[2], before);
+                triangleNormal(moved[0], moved[1], moved[2], after);
+
+                flips = (before[0] * after[0] + before[1] * after[1] + before[2] * after[2]) <= 0.0f;
+            }
+
+            if (flips)
+                continue;
+
+            collapseTo[collapse.from] = collapse.to;
+            addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+            worstError = std::max(worstError, collapse.error);
+
+            // The whole one-ring changes shape: keep it out of the rest of this pass
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; ++a)
+            {
+                const uint32_t* tri = &result[size_t(adjacency[a]) * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+            }
+
+            removed += collapsed;
+            ++numCollapses;
+        }
+
+        if (numCollapses == 0)
+            break;
+
+        size_t write = 0;
+        for (size_t t = 0; t < result.size(); t += 3)
+        {
+            const uint32_t a = collapseTo[result[t + 0]];
+            const uint32_t b = collapseTo[result[t + 1]];
+            const uint32_t c = collapseTo[result[t + 2]];
+
+            if (a == b || b == c || a == c)
+                continue;
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (resultError)
+        *resultError = float(std::sqrt(worstError));
+
+    std::copy(result.begin(), result.end(), destination);
+    return result.size();
+}
+
+bool MeshOptimizer::buildMeshlets(const uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+    uint32_t numVertices, std::vector<Meshlet>& meshlets, uint32_t maxVertices, uint32_t maxTriangles)
+{
+    meshlets.clear();
+
+    if (!indices || !positions || numIndices % 3 != 0 || maxVertices < 3 || maxTriangles == 0 ||
+        !indicesInRange(indices, numIndices, numVertices))
+        return false;
+
+    // Number of the meshlet that last used each vertex
+    std::vector<uint32_t> usedBy(numVertices, UINT32_MAX);
+    uint32_t meshletVertices = 0;
+    size_t start = 0;
+
+    auto finish = [&](size_t end)
+        {
+            Meshlet meshlet;
+            meshlet.firstIndex = uint32_t(start);
+            meshlet.numIndices = uint32_t(end - start);
+            computeMeshletBounds(indices + start, end - start, positions, positionStride, meshlet);
+
+            meshlets.push_back(meshlet);
+            start = end;
+            meshletVertices = 0;
+        };
+
+    for (size_t t = 0; t < numIndices; t += 3)
+    {
+        auto countNew = [&](uint32_t current)
+            {
+                const uint32_t a = indices[t + 0];
+                const uint32_t b = indices[t + 1];
+                const uint32_t c = indices[t + 2];
+
+                return (usedBy[a] != current ? 1u : 0u) + (usedBy[b] != current && b != a ? 1u : 0u) +
+                    (usedBy[c] != current && c != a && c != b ? 1u : 0u);
+            };
+
+        if (meshletVertices + countNew(uint32_t(meshlets.size())) > maxVertices || (t - start) / 3 >= maxTriangles)
+            finish(t);
+
+        const uint32_t current = uint32_t(meshlets.size());
+        meshletVertices += countNew(current);
+
+        for (int k = 0; k < 3; ++k)
+            usedBy[indices[t + k]] = current;
+    }
+
+    if (start < numIndices)
+        finish(numIndices);
+
+    return true;
+}
+
+bool MeshOptimizer::isMeshletCulled(const Meshlet& meshlet, const float planes[6][4], const float* eye)
+{
+    const float* c = meshlet.center;
+
+    for (int p = 0; p < 6; ++p)
+    {
+        if (planes[p][0] * c[0] + planes[p][1] * c[1] + planes[p][2] * c[2] + planes[p][3] < -meshlet.radius)
+            return true;
+    }
+
+    if (!eye)
+        return false;
+
+    const float d[3] = { c[0] - eye[0], c[1] - eye[1], c[2] - eye[2] };
+    const float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+    return d[0] * meshlet.coneAxis[0] + d[1] * meshlet.coneAxis[1] + d[2] * meshlet.coneAxis[2] >=
+        meshlet.coneCutoff * distance + meshlet.radius;
+}
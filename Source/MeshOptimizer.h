@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Import-time triangle list optimisations, all in place on 32-bit indexed triangle lists.
+// Run in this order: optimizeVertexCache, optimizeOverdraw, optimizeVertexFetch.
+class MeshOptimizer
+{
+public:
+    // Size of the FIFO post-transform cache assumed by analyzeVertexCache and optimizeOverdraw
+    static constexpr uint32_t kSimulatedCacheSize = 16;
+
+    // Meshlet limits (the usual mesh shader budget: 64 vertices, 126 primitives rounded down to a multiple of 4)
+    static constexpr uint32_t kMeshletMaxVertices = 64;
+    static constexpr uint32_t kMeshletMaxTriangles = 124;
+
+    // Vertices a 16-bit index buffer can address; 0xFFFF is left out since it is the strip cut value
+    static constexpr uint32_t kMax16BitVertices = 0xFFFF;
+
+    // Result of running a triangle list through a simulated FIFO post-transform vertex cache
+    struct VertexCacheStats
+    {
+        uint32_t numTriangles = 0;
+        uint32_t numVertices = 0;   // referenced by the indices
+        uint32_t numTransforms = 0; // cache misses
+
+        // Average cache miss ratio: transforms per triangle (0.5 is ideal for big grids, 3 is no reuse)
+        float getAcmr() const { return numTriangles ? float(numTransforms) / float(numTriangles) : 0.0f; }
+        // Average transform to vertex ratio: 1 is ideal
+        float getAtvr() const { return numVertices ? float(numTransforms) / float(numVertices) : 0.0f; }
+    };
+
+    // Run of consecutive triangles of an index list, with culling bounds in mesh space
+    struct Meshlet
+    {
+        uint32_t firstIndex = 0;
+        uint32_t numIndices = 0;
+        float center[3] = {};      // bounding sphere
+        float radius = 0.0f;
+        float coneAxis[3] = {};    // normal cone: every triangle faces away from eye when
+        float coneCutoff = 1.0f;   // dot(center - eye, axis) >= cutoff * |center - eye| + radius (never at 1)
+    };
+
+    // One piece of a triangle list split by splitByVertexLimit
+    struct MeshPart
+    {
+        std::vector<uint32_t> vertices; // source vertex of each part vertex, in first-use order
+        std::vector<uint32_t> indices;  // into vertices
+    };
+
+public:
+    static VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t numIndices, uint32_t numVertices,
+        uint32_t cacheSize = kSimulatedCacheSize);
+
+    // Forsyth's linear-speed vertex cache optimisation. Returns false (indices untouched) on invalid input.
+    static bool optimizeVertexCache(uint32_t* indices, size_t numIndices, uint32_t numVertices);
+
+    // Reorders clusters of the cache-optimised list so outward-facing ones are drawn first.
+    // The new order is kept only if its ACMR stays within threshold times the input's.
+    static bool optimizeOverdraw(uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+        uint32_t numVertices, float threshold = 1.05f);
+
+    // Reorders vertices (vertexSize bytes each) by first use and rewrites the indices to match.
+    // Unreferenced vertices are moved to the end.
+    static bool optimizeVertexFetch(void* vertices, uint32_t numVertices, size_t vertexSize, uint32_t* indices, size_t numIndices);
+
+    // Quadric error metric edge collapse over positions only (Garland & Heckbert). Writes the simplified list
+    // to destination (room for numIndices, may alias indices) and returns its index count. Stops once at most
+    // targetIndexCount indices remain or when the next collapse would move the surface by more than targetError
+    // (position units). Vertices on open edges or attribute seams are locked; the vertex buffer is reused as is.
+    static size_t simplify(uint32_t* destination, const uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+        uint32_t numVertices, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+    // Cuts the triangle list, in order, into runs that each reference at most maxVertices vertices,
+    // so a cache-optimised list stays cache-optimised. Vertices shared across a cut are duplicated.
+    static bool splitByVertexLimit(const uint32_t* indices, size_t numIndices, uint32_t numVertices, uint32_t maxVertices,
+        std::vector<MeshPart>& parts);
+
+    // Cuts the triangle list, in order, into meshlets of at most maxVertices distinct vertices and maxTriangles
+    // triangles. Run after optimizeVertexCache so consecutive triangles are also close in space.
+    static bool buildMeshlets(const uint32_t* indices, size_t numIndices, const float* positions, size_t positionStride,
+        uint32_t numVertices, std::vector<Meshlet>& meshlets,
+        uint32_t maxVertices = kMeshletMaxVertices, uint32_t maxTriangles = kMeshletMaxTriangles);
+
+    // True when the meshlet is outside one of the planes (ax + by + cz + d >= 0 inside, normalised, mesh space)
+    // or all its triangles face away from eye (mesh space; null skips the cone test)
+    static bool isMeshletCulled(const Meshlet& meshlet, const float planes[6][4], const float* eye);
+};
@@ -2,6 +2,18 @@
 
 #include "Globals.h"
 
+#include <vector>
+
+// Per-frame stages driven by Application::update(), in this order
+enum class ModuleStage : uint8_t
+{
+    Update = 0,
+    PreRender,
+    Render,
+    PostRender,
+    Count
+};
+
 class Module
 {
 public:
@@ -40,4 +52,18 @@ public:
 	{ 
 		return true; 
 	}
+
+    // Stages returning true may run on a job worker, in parallel with the other modules of the same stage,
+    // so they must not touch input, ImGui or another module's state. Main thread stages keep the module list
+    // order between themselves.
+    virtual bool canRunOnWorker(ModuleStage /*stage*/) const
+    {
+        return false;
+    }
+
+    // Modules whose same stage must be finished before this module's stage starts. A main thread module
+    // may only name worker modules or main thread modules earlier in the module list.
+    virtual void getStageDependencies(ModuleStage /*stage*/, std::vector<const Module*>& /*deps*/) const
+    {
+    }
 };
@@ -2,6 +2,7 @@
 #include "ModuleCamera.h"
 
 #include "Application.h"
+#include "FrustumCuller.h"
 #include "Keyboard.h"
 #include "Mouse.h"
 #include "imgui.h"
@@ -353,3 +354,9 @@ float ModuleCamera::clampf(float v, float lo, float hi)
 {
     return (v < lo) ? lo : (v > hi) ? hi : v;
 }
+
+// ---------------------------------------------------------
+void ModuleCamera::extractFrustumPlanes(const Matrix& viewProj, Vector4 planes[6])
+{
+    FrustumCuller::extractPlanes(viewProj, planes);
+}
@@ -32,6 +32,12 @@ public:
     const Matrix& getViewMatrix() const { return view; }
     const Matrix& getProjectionMatrix() const { return proj; }
 
+    // --- Frustum ---
+    // Normalised planes (ax + by + cz + d >= 0 inside) in the space viewProj starts from:
+    // view * proj gives world space, world * view * proj the local space of an object
+    static void extractFrustumPlanes(const Matrix& viewProj, Vector4 planes[6]);
+    void getFrustumPlanes(const Matrix& world, Vector4 planes[6]) const { extractFrustumPlanes(world * view * proj, planes); }
+
     // --- Basis ---
     Vector3 front() const;
     Vector3 right() const;
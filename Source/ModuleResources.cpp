@@ -84,26 +84,17 @@ bool ModuleResources::init()
     if (!m_device || !m_queue)
         return false;
 
-    HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_allocator));
-    if (FAILED(hr)) return false;
+    ComPtr<IDXGIAdapter3> adapter;
+    if (IDXGIFactory6* factory = d3d->getFactory())
+        factory->EnumAdapterByLuid(m_device->GetAdapterLuid(), IID_PPV_ARGS(&adapter));
 
-    hr = m_device->CreateCommandList(
-        0,
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_allocator.Get(),
-        nullptr,
-        IID_PPV_ARGS(&m_cmdList));
-    if (FAILED(hr)) return false;
-
-    m_cmdList->Close();
-
-    hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
-    if (FAILED(hr)) return false;
+    if (!m_memory.init(m_device.Get(), adapter.Get()))
+        return false;
 
-    m_fenceValue = 0;
+    if (!m_uploads.init(m_device.Get(), kStagingBytes))
+        return false;
 
-    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!m_fenceEvent) return false;
+    m_lastUploadTicket = 0;
 
     deferred.clear();
     return true;
@@ -112,21 +103,23 @@ bool ModuleResources::init()
 void ModuleResources::preRender()
 {
     collectGarbage();
+    flushUploads();
+}
+
+void ModuleResources::flushUploads()
+{
+    m_uploads.submit();
+    m_uploads.gpuWait(m_queue.Get());
 }
 
 bool ModuleResources::cleanUp()
 {
-    deferred.clear();
+    // Waits for in-flight copies before the staging memory goes away
+    m_uploads.cleanUp();
 
-    if (m_fenceEvent)
-    {
-        CloseHandle(m_fenceEvent);
-        m_fenceEvent = nullptr;
-    }
+    deferred.clear();
+    m_memory.cleanUp();
 
-    m_fence.Reset();
-    m_cmdList.Reset();
-    m_allocator.Reset();
     m_queue.Reset();
     m_device.Reset();
 
@@ -141,6 +134,7 @@ void ModuleResources::deferRelease(ComPtr<ID3D12Resource>& resource)
     D3D12Module* d3d = app ? app->getD3D12Module() : nullptr;
     if (!d3d)
     {
+        m_memory.release(resource.Get(), 0);
         resource.Reset();
         return;
     }
@@ -148,6 +142,7 @@ void ModuleResources::deferRelease(ComPtr<ID3D12Resource>& resource)
     DeferredResource dr;
     dr.resource = resource;
     dr.frame = d3d->getCurrentFrame();
+    m_memory.release(resource.Get(), dr.frame);
     deferred.push_back(std::move(dr));
 
     resource.Reset();
@@ -173,6 +168,8 @@ void ModuleResources::collectGarbage()
             ++i;
         }
     }
+
+    m_memory.collectGarbage(completed);
 }
 
 ComPtr<ID3D12Resource> ModuleResources::createUploadBuffer(
@@ -243,67 +240,26 @@ ComPtr<ID3D12Resource> ModuleResources::createDefaultBuffer(
     if (!m_device || !m_queue || !cpuData || dataSize == 0)
         return nullptr;
 
-    std::wstring uploadName;
-    if (debugNameW && debugNameW[0] != L'\0')
-    {
-        uploadName = debugNameW;
-        uploadName += L"_UPLOAD";
-    }
-
-    ComPtr<ID3D12Resource> uploadBuffer = createUploadBuffer(
-        cpuData,
-        dataSize,
-        uploadName.empty() ? nullptr : uploadName.c_str());
-
-    if (!uploadBuffer)
-        return nullptr;
-
-    ComPtr<ID3D12Resource> defaultBuffer;
-
     CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(dataSize);
-    CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
 
-    HRESULT hr = m_device->CreateCommittedResource(
-        &defaultHeap,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_COMMON,
-        nullptr,
-        IID_PPV_ARGS(&defaultBuffer));
+    ComPtr<ID3D12Resource> defaultBuffer = m_memory.createResource(
+        bufferDesc,
+        D3D12_HEAP_TYPE_DEFAULT,
+        D3D12_RESOURCE_STATE_COMMON);
 
-    if (FAILED(hr))
+    if (!defaultBuffer)
         return nullptr;
 
     setDebugName(defaultBuffer.Get(), debugNameW);
 
-    m_allocator->Reset();
-    m_cmdList->Reset(m_allocator.Get(), nullptr);
-
-    m_cmdList->CopyResource(defaultBuffer.Get(), uploadBuffer.Get());
-    m_cmdList->Close();
-
-    ID3D12CommandList* lists[] = { m_cmdList.Get() };
-    m_queue->ExecuteCommandLists(1, lists);
+    const UploadTicket ticket = m_uploads.uploadBuffer(defaultBuffer.Get(), cpuData, dataSize);
+    if (ticket == 0)
+        return nullptr;
 
-    FlushCopyQueue();
+    m_lastUploadTicket = ticket;
     return defaultBuffer;
 }
 
-void ModuleResources::FlushCopyQueue()
-{
-    if (!m_queue || !m_fence || !m_fenceEvent)
-        return;
-
-    const UINT64 fenceToWait = ++m_fenceValue;
-    m_queue->Signal(m_fence.Get(), fenceToWait);
-
-    if (m_fence->GetCompletedValue() < fenceToWait)
-    {
-        m_fence->SetEventOnCompletion(fenceToWait, m_fenceEvent);
-        WaitForSingleObject(m_fenceEvent, INFINITE);
-    }
-}
-
 ComPtr<ID3D12Resource> ModuleResources::createTextureFromFile(
     const std::wstring& filePath,
     const wchar_t* debugName)
@@ -344,19 +300,14 @@ ComPtr<ID3D12Resource> ModuleResources::createTextureFromFile(
         static_cast<UINT16>(meta.mipLevels)
     );
 
-    CD3DX12_HEAP_PROPERTIES defaultHeap(D3D12_HEAP_TYPE_DEFAULT);
-
-    ComPtr<ID3D12Resource> texture;
-    HRESULT hr = m_device->CreateCommittedResource(
-        &defaultHeap,
-        D3D12_HEAP_FLAG_NONE,
-        &texDesc,
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        nullptr,
-        IID_PPV_ARGS(&texture)
+    // COMMON: the copy queue promotes it to COPY_DEST and the draw queue to PIXEL_SHADER_RESOURCE
+    ComPtr<ID3D12Resource> texture = m_memory.createResource(
+        texDesc,
+        D3D12_HEAP_TYPE_DEFAULT,
+        D3D12_RESOURCE_STATE_COMMON
     );
 
-    if (FAILED(hr))
+    if (!texture)
         return nullptr;
 
     if (debugName && debugName[0] != L'\0')
@@ -383,59 +334,16 @@ ComPtr<ID3D12Resource> ModuleResources::createTextureFromFile(
         }
     }
 
-    const UINT64 uploadSize = GetRequiredIntermediateSize(
+    const UploadTicket ticket = m_uploads.uploadTexture(
         texture.Get(),
-        0,
+        subresources.data(),
         static_cast<UINT>(subresources.size())
     );
 
-    CD3DX12_HEAP_PROPERTIES uploadHeap(D3D12_HEAP_TYPE_UPLOAD);
-    CD3DX12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadSize);
-
-    ComPtr<ID3D12Resource> staging;
-    hr = m_device->CreateCommittedResource(
-        &uploadHeap,
-        D3D12_HEAP_FLAG_NONE,
-        &uploadDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&staging)
-    );
-
-    if (FAILED(hr))
+    if (ticket == 0)
         return nullptr;
 
-    {
-        std::wstring stagingName = L"TextureUpload_";
-        stagingName += (debugName && debugName[0] != L'\0') ? debugName : filePath.c_str();
-        setDebugName(staging.Get(), stagingName.c_str());
-    }
-
-    m_allocator->Reset();
-    m_cmdList->Reset(m_allocator.Get(), nullptr);
-
-    UpdateSubresources(
-        m_cmdList.Get(),
-        texture.Get(),
-        staging.Get(),
-        0, 0,
-        static_cast<UINT>(subresources.size()),
-        subresources.data()
-    );
-
-    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-        texture.Get(),
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
-    );
-    m_cmdList->ResourceBarrier(1, &barrier);
-
-    m_cmdList->Close();
-
-    ID3D12CommandList* lists[] = { m_cmdList.Get() };
-    m_queue->ExecuteCommandLists(1, lists);
-
-    FlushCopyQueue();
+    m_lastUploadTicket = ticket;
     return texture;
 }
 
@@ -459,8 +367,6 @@ ComPtr<ID3D12Resource> ModuleResources::createRenderTarget(
     clear.Color[2] = clearColor.z;
     clear.Color[3] = clearColor.w;
 
-    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-
     CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(
         format,
         static_cast<UINT64>(width),
@@ -472,17 +378,14 @@ ComPtr<ID3D12Resource> ModuleResources::createRenderTarget(
         D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET
     );
 
-    ComPtr<ID3D12Resource> tex;
-    HRESULT hr = m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &desc,
+    ComPtr<ID3D12Resource> tex = m_memory.createResource(
+        desc,
+        D3D12_HEAP_TYPE_DEFAULT,
         D3D12_RESOURCE_STATE_COMMON,
-        &clear,
-        IID_PPV_ARGS(&tex)
+        &clear
     );
 
-    if (FAILED(hr))
+    if (!tex)
         return nullptr;
 
     setDebugName(tex.Get(), debugName);
@@ -508,8 +411,6 @@ ComPtr<ID3D12Resource> ModuleResources::createDepthStencil(
     clear.DepthStencil.Depth = clearDepth;
     clear.DepthStencil.Stencil = clearStencil;
 
-    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-
     CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(
         format,
         static_cast<UINT64>(width),
@@ -521,17 +422,14 @@ ComPtr<ID3D12Resource> ModuleResources::createDepthStencil(
         D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL | D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE
     );
 
-    ComPtr<ID3D12Resource> tex;
-    HRESULT hr = m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &desc,
+    ComPtr<ID3D12Resource> tex = m_memory.createResource(
+        desc,
+        D3D12_HEAP_TYPE_DEFAULT,
         D3D12_RESOURCE_STATE_DEPTH_WRITE,
-        &clear,
-        IID_PPV_ARGS(&tex)
+        &clear
     );
 
-    if (FAILED(hr))
+    if (!tex)
         return nullptr;
 
     setDebugName(tex.Get(), debugName);
@@ -2,6 +2,8 @@
 
 #include "Module.h"
 #include "Globals.h"
+#include "GpuMemoryAllocator.h"
+#include "UploadManager.h"
 
 #include <string>
 #include <vector>
@@ -65,8 +67,19 @@ public:
     // Deferred release (powerpoint requirement)
     void deferRelease(ComPtr<ID3D12Resource>& resource);
 
+    // Buffers/textures created above are filled asynchronously on the copy queue.
+    // Pending copies are submitted in preRender and the draw queue waits on them on the GPU;
+    // call flushUploads() to use a resource created after preRender in the same frame.
+    // preRender stays on the main thread, after D3D12Module's: the copy queue submit and the draw
+    // queue Wait() then come before any list of the frame is executed on the draw queue.
+    UploadManager& getUploads() { return m_uploads; }
+
+    // DEFAULT-heap buffers, textures and render targets are placed in pooled heaps
+    GpuMemoryAllocator::Stats getMemoryStats() const { return m_memory.getStats(); }
+    UploadTicket getLastUploadTicket() const { return m_lastUploadTicket; }
+    void flushUploads();
+
 private:
-    void FlushCopyQueue();
     void collectGarbage();
 
     static std::wstring utf8ToWString(const char* s);
@@ -85,10 +98,9 @@ private:
     ComPtr<ID3D12Device> m_device;
     ComPtr<ID3D12CommandQueue> m_queue;
 
-    ComPtr<ID3D12CommandAllocator> m_allocator;
-    ComPtr<ID3D12GraphicsCommandList> m_cmdList;
+    static constexpr size_t kStagingBytes = size_t(64) * size_t(1 << 20); // 64 MB
 
-    ComPtr<ID3D12Fence> m_fence;
-    UINT64 m_fenceValue = 0;
-    HANDLE m_fenceEvent = nullptr;
+    GpuMemoryAllocator m_memory;
+    UploadManager m_uploads;
+    UploadTicket m_lastUploadTicket = 0;
 };
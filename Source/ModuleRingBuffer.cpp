@@ -9,7 +9,7 @@
 
 bool ModuleRingBuffer::init()
 {
-    totalMemorySize = alignUp(kDefaultTotalSizeBytes, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    const size_t totalMemorySize = alignUp(kDefaultTotalSizeBytes, kThreadBlockBytes);
 
     D3D12Module* d3d12 = app ? app->getD3D12Module() : nullptr;
     if (!d3d12 || !d3d12->getDevice())
@@ -39,15 +39,10 @@ bool ModuleRingBuffer::init()
     if (FAILED(hr) || !bufferData)
         return false;
 
-    head = 0;
-    tail = 0;
-    totalAllocated = 0;
-
-    for (unsigned i = 0; i < kFramesInFlight; ++i)
-        allocatedInFrame[i] = 0;
+    ring.init(totalMemorySize, kFramesInFlight, kThreadBlockBytes);
 
     // Must match swapchain's current backbuffer index
-    currentFrameIdx = d3d12->getCurrentBackBufferIndex() % kFramesInFlight;
+    ring.beginFrame(d3d12->getCurrentBackBufferIndex() % kFramesInFlight);
 
     return true;
 }
@@ -61,36 +56,19 @@ bool ModuleRingBuffer::cleanUp()
     }
 
     buffer.Reset();
+    ring.reset();
 
-    totalMemorySize = 0;
-    head = 0;
-    tail = 0;
-    totalAllocated = 0;
-
-    for (unsigned i = 0; i < kFramesInFlight; ++i)
-        allocatedInFrame[i] = 0;
-
-    currentFrameIdx = 0;
     return true;
 }
 
 void ModuleRingBuffer::preRender()
 {
     D3D12Module* d3d12 = app ? app->getD3D12Module() : nullptr;
-    if (!d3d12)
+    if (!d3d12 || !buffer)
         return;
 
     // IMPORTANT: call this AFTER D3D12 preRender / fence sync
-    currentFrameIdx = d3d12->getCurrentBackBufferIndex() % kFramesInFlight;
-
-    const size_t reclaimed = allocatedInFrame[currentFrameIdx];
-    if (reclaimed > 0)
-    {
-        tail = (tail + reclaimed) % totalMemorySize;
-
-        totalAllocated = (totalAllocated >= reclaimed) ? (totalAllocated - reclaimed) : 0;
-        allocatedInFrame[currentFrameIdx] = 0;
-    }
+    ring.beginFrame(d3d12->getCurrentBackBufferIndex() % kFramesInFlight);
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS ModuleRingBuffer::allocBufferRaw(const void* data, size_t size)
@@ -102,46 +80,12 @@ D3D12_GPU_VIRTUAL_ADDRESS ModuleRingBuffer::allocBufferRaw(const void* data, siz
     if ((size & (D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1)) != 0)
         return 0;
 
-    if (size > totalMemorySize)
-        return 0;
+    const size_t offset = ring.allocate(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
 
     // Hard out-of-memory
-    if (totalAllocated + size > totalMemorySize)
+    if (offset == RingAllocator::INVALID_OFFSET)
         return 0;
 
-    auto commit = [&](size_t offset) -> D3D12_GPU_VIRTUAL_ADDRESS
-        {
-            std::memcpy(bufferData + offset, data, size);
-            allocatedInFrame[currentFrameIdx] += size;
-            totalAllocated += size;
-            return buffer->GetGPUVirtualAddress() + offset;
-        };
-
-    // Case A: wrapped free space (tail < head) -> try from head to end
-    if (tail < head)
-    {
-        const size_t availableToEnd = totalMemorySize - head;
-        if (availableToEnd >= size)
-        {
-            const D3D12_GPU_VIRTUAL_ADDRESS addr = commit(head);
-            head += size; // may become == totalMemorySize (ok)
-            return addr;
-        }
-
-        // Not enough contiguous space at end, wrap head to 0
-        head = 0;
-    }
-
-    // Now tail >= head (or buffer empty). Compute available contiguous space.
-    const bool empty = (tail == head) && (totalAllocated == 0);
-    const size_t available = empty ? totalMemorySize : (tail - head);
-
-    if (available >= size)
-    {
-        const D3D12_GPU_VIRTUAL_ADDRESS addr = commit(head);
-        head += size; // may become == totalMemorySize (ok)
-        return addr;
-    }
-
-    return 0;
+    std::memcpy(bufferData + offset, data, size);
+    return buffer->GetGPUVirtualAddress() + offset;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Module.h"
+#include "RingAllocator.h"
 
 #include <d3d12.h>
 #include <wrl.h>
@@ -17,6 +18,9 @@ public:
     bool cleanUp() override;
     void preRender() override;
 
+    // preRender only reclaims the retired frame
+    bool canRunOnWorker(ModuleStage stage) const override { return stage == ModuleStage::PreRender; }
+
     template<typename T>
     D3D12_GPU_VIRTUAL_ADDRESS allocBuffer(const T* data)
     {
@@ -33,23 +37,23 @@ public:
         return allocBufferRaw(data, sz);
     }
 
+    size_t getUsedBytes() const { return ring.getUsed(); }
+    size_t getTotalBytes() const { return ring.getCapacity(); }
+
 private:
     static size_t alignUp(size_t v, size_t a) { return (v + (a - 1)) & ~(a - 1); }
+
+    // Thread-safe: workers recording command lists can allocate constants concurrently
     D3D12_GPU_VIRTUAL_ADDRESS allocBufferRaw(const void* data, size_t size);
 
 private:
     static constexpr size_t kDefaultTotalSizeBytes = size_t(10) * size_t(1 << 20); // 10 MB
+    static constexpr size_t kThreadBlockBytes = size_t(64) * size_t(1 << 10);     // 64 KB per-thread blocks
 
     uint8_t* bufferData = nullptr;
     Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
 
-    size_t totalMemorySize = 0;
-    size_t head = 0; // next free write position
-    size_t tail = 0; // reclaimed up to here
+    RingAllocator ring;
 
     static constexpr unsigned kFramesInFlight = 2; // must match swapchain buffer count
-    size_t allocatedInFrame[kFramesInFlight] = {};
-    size_t totalAllocated = 0;
-
-    unsigned currentFrameIdx = 0;
 };
@@ -7,7 +7,7 @@
 
 ModuleShaderDescriptors::~ModuleShaderDescriptors()
 {
-    handles.forceCollectGarbage();
+    handles.forceCollectGarbage([this](uint32_t h) { releaseRange(h); });
     _ASSERTE(handles.getFreeCount() == handles.getSize());
 }
 
@@ -33,6 +33,8 @@ bool ModuleShaderDescriptors::init()
     gpuStart = heap->GetGPUDescriptorHandleForHeapStart();
 
     refCounts.fill(0);
+    tableSizes.fill(0);
+    ranges.reset();
     return true;
 }
 
@@ -40,7 +42,7 @@ bool ModuleShaderDescriptors::cleanUp()
 {
     // We may still have ShaderTableDesc objects being destroyed AFTER cleanUp(),
     // so refCounts MUST remain valid. Do NOT reset them here.
-    handles.forceCollectGarbage();
+    handles.forceCollectGarbage([this](uint32_t h) { releaseRange(h); });
 
     heap.Reset();
     cpuStart = {};
@@ -57,12 +59,46 @@ void ModuleShaderDescriptors::preRender()
     collectGarbage();
 }
 
-ShaderTableDesc ModuleShaderDescriptors::allocTable()
+ShaderTableDesc ModuleShaderDescriptors::allocTable(uint32_t numDescriptors)
 {
+    _ASSERTE(numDescriptors > 0);
+
+    const uint32_t offset = ranges.allocate(numDescriptors);
+    if (offset == BuddyAllocator::INVALID_OFFSET)
+    {
+        LOG("ModuleShaderDescriptors: out of descriptors (requested %u)", numDescriptors);
+        return ShaderTableDesc();
+    }
+
     const uint32_t h = alloc();
-    _ASSERTE(handles.validHandle(h));
+    if (!handles.validHandle(h))
+    {
+        // Out of table handles: give the range back, or it stays taken for good
+        ranges.free(offset);
+        LOG("ModuleShaderDescriptors: out of table handles (%u tables)", NUM_TABLES);
+        return ShaderTableDesc();
+    }
+
+    const uint32_t index = indexFromHandle(h);
+    tableOffsets[index] = offset;
+    tableSizes[index] = numDescriptors;
+
+    return ShaderTableDesc(h, &refCounts[index], numDescriptors);
+}
+
+uint32_t ModuleShaderDescriptors::getTableSize(uint32_t handle) const
+{
+    return isValid(handle) ? tableSizes[indexFromHandle(handle)] : 0u;
+}
+
+void ModuleShaderDescriptors::releaseRange(uint32_t handle)
+{
+    const uint32_t index = indexFromHandle(handle);
+    if (tableSizes[index] == 0)
+        return;
 
-    return ShaderTableDesc(h, &refCounts[indexFromHandle(h)]);
+    ranges.free(tableOffsets[index]);
+    tableSizes[index] = 0;
 }
 
 void ModuleShaderDescriptors::deferRelease(uint32_t handle)
@@ -75,6 +111,7 @@ void ModuleShaderDescriptors::deferRelease(uint32_t handle)
     D3D12Module* d3d12 = app ? app->getD3D12Module() : nullptr;
     if (!d3d12)
     {
+        releaseRange(handle);
         handles.freeHandle(handle);
         return;
     }
@@ -87,27 +124,25 @@ void ModuleShaderDescriptors::collectGarbage()
     D3D12Module* d3d12 = app->getD3D12Module();
     _ASSERTE(d3d12);
 
-    handles.collectGarbage(d3d12->getLastCompletedFrame());
+    handles.collectGarbage(d3d12->getLastCompletedFrame(), [this](uint32_t h) { releaseRange(h); });
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE ModuleShaderDescriptors::getCPUHandle(uint32_t handle, uint8_t slot) const
+uint32_t ModuleShaderDescriptors::linearIndex(uint32_t handle, uint32_t slot) const
 {
-    _ASSERTE(slot < DESCRIPTORS_PER_TABLE);
     _ASSERTE(isValid(handle));
 
     const uint32_t tableIndex = indexFromHandle(handle);
-    const uint32_t linearIndex = tableIndex * DESCRIPTORS_PER_TABLE + uint32_t(slot);
+    _ASSERTE(slot < tableSizes[tableIndex]);
 
-    return CD3DX12_CPU_DESCRIPTOR_HANDLE(cpuStart, int(linearIndex), int(descriptorSize));
+    return tableOffsets[tableIndex] + slot;
 }
 
-D3D12_GPU_DESCRIPTOR_HANDLE ModuleShaderDescriptors::getGPUHandle(uint32_t handle, uint8_t slot) const
+D3D12_CPU_DESCRIPTOR_HANDLE ModuleShaderDescriptors::getCPUHandle(uint32_t handle, uint32_t slot) const
 {
-    _ASSERTE(slot < DESCRIPTORS_PER_TABLE);
-    _ASSERTE(isValid(handle));
-
-    const uint32_t tableIndex = indexFromHandle(handle);
-    const uint32_t linearIndex = tableIndex * DESCRIPTORS_PER_TABLE + uint32_t(slot);
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(cpuStart, int(linearIndex(handle, slot)), int(descriptorSize));
+}
 
-    return CD3DX12_GPU_DESCRIPTOR_HANDLE(gpuStart, int(linearIndex), int(descriptorSize));
+D3D12_GPU_DESCRIPTOR_HANDLE ModuleShaderDescriptors::getGPUHandle(uint32_t handle, uint32_t slot) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(gpuStart, int(linearIndex(handle, slot)), int(descriptorSize));
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Module.h"
+#include "BuddyAllocator.h"
 #include "DeferredFreeHandleManager.h"
 #include "ShaderTableDesc.h"
 
@@ -24,9 +25,22 @@ public:
 
     void preRender() override;
 
+    // preRender only collects garbage
+    bool canRunOnWorker(ModuleStage stage) const override { return stage == ModuleStage::PreRender; }
+
     ID3D12DescriptorHeap* getHeap() const { return heap.Get(); }
 
-    ShaderTableDesc allocTable();
+    // Bindless: the whole heap bound as one unbounded SRV array, indexed with ShaderTableDesc::getHeapIndex()
+    D3D12_GPU_DESCRIPTOR_HANDLE getBindlessTableGPU() const { return gpuStart; }
+
+    // Tables are contiguous descriptor ranges of any size (rounded up to a power of two internally).
+    // numDescriptors is every slot the caller writes: ShaderTableDesc asserts each slot against it.
+    ShaderTableDesc allocTable(uint32_t numDescriptors);
+
+    uint32_t getTableSize(uint32_t handle) const;
+
+    // Heap occupancy / fragmentation
+    BuddyAllocator::Stats getStats() const { return ranges.getStats(); }
 
 private:
     uint32_t alloc() { return handles.allocHandle(); }
@@ -34,25 +48,32 @@ private:
 
     void deferRelease(uint32_t handle);
     void collectGarbage();
+    void releaseRange(uint32_t handle);
 
     bool isValid(uint32_t handle) const { return handles.validHandle(handle); }
     uint32_t indexFromHandle(uint32_t handle) const { return handles.indexFromHandle(handle); }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(uint32_t handle, uint8_t slot) const;
-    D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(uint32_t handle, uint8_t slot) const;
+    uint32_t linearIndex(uint32_t handle, uint32_t slot) const;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(uint32_t handle, uint32_t slot) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(uint32_t handle, uint32_t slot) const;
 
 private:
     static constexpr uint32_t NUM_TABLES = 4096;
-    static constexpr uint32_t DESCRIPTORS_PER_TABLE = 8;
-    static constexpr uint32_t NUM_DESCRIPTORS = NUM_TABLES * DESCRIPTORS_PER_TABLE;
+    static constexpr uint32_t NUM_DESCRIPTORS = 32768;
 
     ComPtr<ID3D12DescriptorHeap> heap;
 
     DeferredFreeHandleManager<NUM_TABLES> handles;
+    BuddyAllocator ranges{ NUM_DESCRIPTORS };
 
     D3D12_CPU_DESCRIPTOR_HANDLE cpuStart{ 0 };
     D3D12_GPU_DESCRIPTOR_HANDLE gpuStart{ 0 };
     uint32_t descriptorSize = 0;
 
     std::array<uint32_t, NUM_TABLES> refCounts{};
+
+    // Descriptor range owned by each table index
+    std::array<uint32_t, NUM_TABLES> tableOffsets{};
+    std::array<uint32_t, NUM_TABLES> tableSizes{};
 };
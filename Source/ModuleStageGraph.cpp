@@ -0,0 +1,89 @@
+#include "Globals.h"
+#include "ModuleStageGraph.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+    const char* const kStageNames[] = { "Update", "PreRender", "Render", "PostRender" };
+}
+
+void runModuleStage(Module* module, ModuleStage stage)
+{
+    switch (stage)
+    {
+    case ModuleStage::Update:     module->update(); break;
+    case ModuleStage::PreRender:  module->preRender(); break;
+    case ModuleStage::Render:     module->render(); break;
+    case ModuleStage::PostRender: module->postRender(); break;
+    default: break;
+    }
+}
+
+void buildModuleStageGraph(JobGraph& graph, ModuleStage stage, const std::vector<Module*>& modules, Module* framing)
+{
+    const char* name = kStageNames[uint32_t(stage)];
+    const bool framed = framing && stage != ModuleStage::Update;
+
+    std::vector<JobGraph::NodeId> nodeOf(modules.size(), JobGraph::INVALID_NODE);
+    JobGraph::NodeId prevMain = JobGraph::INVALID_NODE;
+
+    for (size_t i = 0; i < modules.size(); ++i)
+    {
+        Module* m = modules[i];
+        if (framed && m == framing)
+            continue;
+
+        const bool mainOnly = !m->canRunOnWorker(stage);
+        nodeOf[i] = graph.addNode(name, [m, stage]() { runModuleStage(m, stage); }, mainOnly);
+
+        if (mainOnly)
+        {
+            if (prevMain != JobGraph::INVALID_NODE)
+                graph.addEdge(prevMain, nodeOf[i]);
+            prevMain = nodeOf[i];
+        }
+    }
+
+    std::vector<const Module*> deps;
+    for (size_t i = 0; i < modules.size(); ++i)
+    {
+        if (nodeOf[i] == JobGraph::INVALID_NODE)
+            continue;
+
+        deps.clear();
+        modules[i]->getStageDependencies(stage, deps);
+
+        for (const Module* dep : deps)
+        {
+            auto it = std::find(modules.begin(), modules.end(), dep);
+            if (it == modules.end())
+                continue;
+
+            const size_t depIndex = size_t(it - modules.begin());
+            const JobGraph::NodeId depNode = nodeOf[depIndex];
+            if (depNode == JobGraph::INVALID_NODE || depNode == nodeOf[i])
+                continue;
+
+            // A later main thread module would close a cycle with the chain
+            _ASSERTE(modules[i]->canRunOnWorker(stage) || dep->canRunOnWorker(stage) || depIndex < i);
+            graph.addEdge(depNode, nodeOf[i]);
+        }
+    }
+
+    if (framed && (stage == ModuleStage::PreRender || stage == ModuleStage::PostRender))
+    {
+        const JobGraph::NodeId numModuleNodes = JobGraph::NodeId(graph.getNumNodes());
+        const JobGraph::NodeId framingNode = graph.addNode(name, [framing, stage]() { runModuleStage(framing, stage); }, true);
+
+        for (JobGraph::NodeId id = 0; id < numModuleNodes; ++id)
+        {
+            if (stage == ModuleStage::PreRender)
+                graph.addEdge(framingNode, id);
+            else
+                graph.addEdge(id, framingNode);
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Module.h"
+
+class JobGraph;
+
+void runModuleStage(Module* module, ModuleStage stage);
+
+// Builds the job graph of one stage:
+// - main thread modules are chained in module list order (same order as the old serial loop),
+// - every module waits for the modules it names in getStageDependencies(),
+// - framing (D3D12Module) runs its preRender before and its postRender after every other module of
+//   the stage, and is left out of the other stages except Update.
+void buildModuleStageGraph(JobGraph& graph, ModuleStage stage, const std::vector<Module*>& modules, Module* framing);
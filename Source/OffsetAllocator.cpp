@@ -0,0 +1,128 @@
+#include "Globals.h"
+#include "OffsetAllocator.h"
+
+#include <algorithm>
+
+void OffsetAllocator::init(uint64_t newCapacity)
+{
+    capacity = newCapacity;
+    usedBytes = 0;
+
+    freeByOffset.clear();
+    freeBySize.clear();
+    allocations.clear();
+
+    if (capacity > 0)
+        insertFree(0, capacity);
+}
+
+uint64_t OffsetAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || size > capacity)
+        return INVALID_OFFSET;
+
+    _ASSERTE(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    // Best fit: smallest free range that still fits once aligned
+    for (auto it = freeBySize.lower_bound(size); it != freeBySize.end(); ++it)
+    {
+        const uint64_t blockOffset = it->second;
+        const uint64_t blockSize = it->first;
+        const uint64_t aligned = (blockOffset + alignment - 1) & ~(alignment - 1);
+
+        if (aligned + size > blockOffset + blockSize)
+            continue;
+
+        eraseFree(freeByOffset.find(blockOffset));
+
+        if (aligned > blockOffset)
+            insertFree(blockOffset, aligned - blockOffset);
+
+        const uint64_t end = aligned + size;
+        if (end < blockOffset + blockSize)
+            insertFree(end, blockOffset + blockSize - end);
+
+        allocations.emplace(aligned, size);
+        usedBytes += size;
+        return aligned;
+    }
+
+    return INVALID_OFFSET;
+}
+
+void OffsetAllocator::free(uint64_t offset)
+{
+    auto alloc = allocations.find(offset);
+    _ASSERTE(alloc != allocations.end() && "Freeing an unallocated range");
+    if (alloc == allocations.end())
+        return;
+
+    uint64_t start = offset;
+    uint64_t end = offset + alloc->second;
+
+    usedBytes -= alloc->second;
+    allocations.erase(alloc);
+
+    // Merge with the following free range
+    auto next = freeByOffset.lower_bound(end);
+    if (next != freeByOffset.end() && next->first == end)
+    {
+        end += next->second;
+        next = std::next(next);
+        eraseFree(std::prev(next));
+    }
+
+    // Merge with the preceding free range
+    if (next != freeByOffset.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start)
+        {
+            start = prev->first;
+            eraseFree(prev);
+        }
+    }
+
+    insertFree(start, end - start);
+}
+
+OffsetAllocator::Stats OffsetAllocator::getStats() const
+{
+    Stats stats;
+    stats.capacity = capacity;
+    stats.usedBytes = usedBytes;
+    stats.numAllocations = uint32_t(allocations.size());
+    stats.numFreeBlocks = uint32_t(freeByOffset.size());
+
+    for (const auto& [offset, size] : freeByOffset)
+        stats.freeBytes += size;
+
+    if (!freeBySize.empty())
+        stats.largestFreeBlock = freeBySize.rbegin()->first;
+
+    if (stats.freeBytes > 0)
+        stats.externalFragmentation = 1.0f - float(double(stats.largestFreeBlock) / double(stats.freeBytes));
+
+    return stats;
+}
+
+void OffsetAllocator::insertFree(uint64_t offset, uint64_t size)
+{
+    freeByOffset.emplace(offset, size);
+    freeBySize.emplace(size, offset);
+}
+
+void OffsetAllocator::eraseFree(std::map<uint64_t, uint64_t>::iterator it)
+{
+    auto range = freeBySize.equal_range(it->second);
+    for (auto s = range.first; s != range.second; ++s)
+    {
+        if (s->second == it->first)
+        {
+            freeBySize.erase(s);
+            break;
+        }
+    }
+
+    freeByOffset.erase(it);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+// General purpose range allocator over [0, capacity): best-fit on free ranges, any alignment, neighbours
+// are coalesced on free. Works on offsets only (no D3D12 types) so it can manage heap pages or plain memory.
+class OffsetAllocator
+{
+public:
+    static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    struct Stats
+    {
+        uint64_t capacity = 0;
+        uint64_t usedBytes = 0;
+        uint64_t freeBytes = 0;
+        uint64_t largestFreeBlock = 0;
+        uint32_t numAllocations = 0;
+        uint32_t numFreeBlocks = 0;
+
+        // 1 - largestFreeBlock / freeBytes
+        float externalFragmentation = 0.0f;
+    };
+
+public:
+    OffsetAllocator() = default;
+    explicit OffsetAllocator(uint64_t capacity) { init(capacity); }
+
+    void init(uint64_t capacity);
+
+    uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+    void free(uint64_t offset);
+
+    bool isEmpty() const { return allocations.empty(); }
+    uint64_t getCapacity() const { return capacity; }
+    uint64_t getUsedBytes() const { return usedBytes; }
+
+    Stats getStats() const;
+
+private:
+    void insertFree(uint64_t offset, uint64_t size);
+    void eraseFree(std::map<uint64_t, uint64_t>::iterator it);
+
+private:
+    uint64_t capacity = 0;
+    uint64_t usedBytes = 0;
+
+    std::map<uint64_t, uint64_t>      freeByOffset;  // offset -> size
+    std::multimap<uint64_t, uint64_t> freeBySize;    // size -> offset
+
+    std::unordered_map<uint64_t, uint64_t> allocations;  // offset -> size
+};
@@ -0,0 +1,68 @@
+#include "Globals.h"
+#include "PackedGeometry.h"
+
+void packGeometry(const std::vector<BasicMesh>& meshes, BasicMesh::VertexFormat format, const Vector3& boundsMin,
+    const Vector3& boundsMax, PackedGeometry& out)
+{
+    out = {};
+
+    size_t totalVertices = 0;
+    size_t totalIndices = 0;
+    bool fits16 = true;
+
+    for (const BasicMesh& mesh : meshes)
+    {
+        totalVertices += mesh.getNumVertices();
+        totalIndices += mesh.getNumIndices() + mesh.getLodIndices().size();
+
+        // Indices are relative to the mesh base vertex, so 16 bits is a per-mesh limit.
+        // BasicModel::loadMeshes splits bigger meshes; non-indexed ones never read the index buffer.
+        fits16 = fits16 && (mesh.getNumIndices() == 0 || mesh.getNumVertices() <= MeshOptimizer::kMax16BitVertices);
+    }
+
+    const uint32_t indexSize = fits16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    out.use16BitIndices = fits16;
+
+    out.vertexStride = BasicMesh::getVertexStride(format);
+    out.vertices.resize(totalVertices * out.vertexStride);
+    out.indices.resize(totalIndices * indexSize);
+
+    out.baseVertices.resize(meshes.size());
+    out.firstIndices.resize(meshes.size());
+
+    uint32_t vertexCursor = 0;
+    uint32_t indexCursor = 0;
+
+    for (size_t m = 0; m < meshes.size(); ++m)
+    {
+        const BasicMesh& mesh = meshes[m];
+
+        out.baseVertices[m] = vertexCursor;
+        out.firstIndices[m] = indexCursor;
+
+        if (mesh.getNumVertices() > 0)
+        {
+            BasicMesh::packVertices(mesh.getVertices(), mesh.getNumVertices(), format,
+                boundsMin, boundsMax, &out.vertices[size_t(vertexCursor) * out.vertexStride]);
+        }
+
+        // Level 0 first, then the coarser levels (BasicMesh::Lod::firstIndex counts from the mesh's first index)
+        auto copyIndices = [&](const uint32_t* src, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (fits16)
+                        reinterpret_cast<uint16_t*>(out.indices.data())[indexCursor + i] = uint16_t(src[i]);
+                    else
+                        reinterpret_cast<uint32_t*>(out.indices.data())[indexCursor + i] = src[i];
+                }
+
+                indexCursor += uint32_t(count);
+            };
+
+        copyIndices(mesh.getIndices(), mesh.getNumIndices());
+        copyIndices(mesh.getLodIndices().data(), mesh.getLodIndices().size());
+
+        vertexCursor += mesh.getNumVertices();
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "BasicMesh.h"
+
+#include <vector>
+#include <cstdint>
+
+// CPU copy of a model's shared vertex/index buffers, as uploaded and as cooked: one vertex buffer and
+// one index buffer for every mesh of the model, however many primitives it has
+struct PackedGeometry
+{
+    std::vector<uint8_t>  vertices;     // vertexStride bytes each, in the model's vertex format
+    uint32_t vertexStride = 0;
+    std::vector<uint8_t>  indices;
+    std::vector<uint32_t> baseVertices;
+    std::vector<uint32_t> firstIndices;
+    bool use16BitIndices = false;
+};
+
+// Packs meshes back to back in format (quantized positions span boundsMin..boundsMax). Each mesh's LOD indices
+// follow its level 0 indices. Indices are 16-bit only when every indexed mesh fits kMax16BitVertices.
+void packGeometry(const std::vector<BasicMesh>& meshes, BasicMesh::VertexFormat format, const Vector3& boundsMin,
+    const Vector3& boundsMax, PackedGeometry& out);
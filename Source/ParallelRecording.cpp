@@ -0,0 +1,83 @@
+#include "Globals.h"
+#include "ParallelRecording.h"
+
+#include <algorithm>
+
+uint32_t partitionDraws(uint32_t numDraws, uint32_t maxChunks, uint32_t minDrawsPerChunk, std::vector<DrawRange>& out)
+{
+    out.clear();
+
+    if (numDraws == 0)
+        return 0;
+
+    maxChunks = std::max(1u, maxChunks);
+    minDrawsPerChunk = std::max(1u, minDrawsPerChunk);
+
+    const uint32_t numChunks = std::clamp(numDraws / minDrawsPerChunk, 1u, maxChunks);
+
+    // The first 'extra' chunks take one more draw so sizes differ by one at most
+    const uint32_t base = numDraws / numChunks;
+    const uint32_t extra = numDraws % numChunks;
+
+    out.reserve(numChunks);
+
+    uint32_t begin = 0;
+    for (uint32_t i = 0; i < numChunks; ++i)
+    {
+        const uint32_t count = base + (i < extra ? 1u : 0u);
+        out.push_back(DrawRange{ begin, begin + count });
+        begin += count;
+    }
+
+    _ASSERTE(begin == numDraws);
+    return numChunks;
+}
+
+void CommandListRecycler::init(uint32_t numSlots)
+{
+    inFlight.assign(std::max(1u, numSlots), {});
+    freeList.clear();
+
+    currentSlot = 0;
+    numLists = 0;
+}
+
+void CommandListRecycler::beginFrame(uint32_t slot)
+{
+    _ASSERTE(slot < inFlight.size());
+
+    currentSlot = slot;
+
+    std::vector<uint32_t>& done = inFlight[slot];
+    freeList.insert(freeList.end(), done.begin(), done.end());
+    done.clear();
+}
+
+uint32_t CommandListRecycler::acquire(bool& isNew)
+{
+    uint32_t index = 0;
+
+    if (!freeList.empty())
+    {
+        index = freeList.back();
+        freeList.pop_back();
+        isNew = false;
+    }
+    else
+    {
+        index = numLists++;
+        isNew = true;
+    }
+
+    inFlight[currentSlot].push_back(index);
+    return index;
+}
+
+CommandListRecycler::Stats CommandListRecycler::getStats() const
+{
+    Stats stats;
+    stats.numLists = numLists;
+    stats.numFree = uint32_t(freeList.size());
+    stats.numAcquired = uint32_t(inFlight[currentSlot].size());
+    return stats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// GPU-free bookkeeping behind CommandListPool, kept apart so it can be exercised without a device.
+
+// Half-open range of draws [begin, end) recorded into one command list
+struct DrawRange
+{
+    uint32_t begin = 0;
+    uint32_t end = 0;
+
+    uint32_t size() const { return end - begin; }
+};
+
+// Splits numDraws into at most maxChunks balanced ranges of at least minDrawsPerChunk draws each
+// (a single range when there are fewer draws than that). Ranges are in draw order. Returns the range count.
+uint32_t partitionDraws(uint32_t numDraws, uint32_t maxChunks, uint32_t minDrawsPerChunk, std::vector<DrawRange>& out);
+
+// Hands out command list indices. A list acquired while a frame slot is current goes back to the free
+// list the next time that slot begins, i.e. once the GPU is done with the frame that submitted it.
+// Not thread-safe: CommandListPool serialises access.
+class CommandListRecycler
+{
+public:
+    struct Stats
+    {
+        uint32_t numLists = 0;      // created so far
+        uint32_t numFree = 0;
+        uint32_t numAcquired = 0;   // in the current slot
+    };
+
+public:
+    CommandListRecycler() = default;
+
+    void init(uint32_t numSlots);
+
+    void beginFrame(uint32_t slot);
+
+    // Returns a list index; isNew is set when the caller has to create the list for that index
+    uint32_t acquire(bool& isNew);
+
+    uint32_t getNumLists() const { return numLists; }
+    Stats getStats() const;
+
+private:
+    std::vector<std::vector<uint32_t>> inFlight;  // per slot
+    std::vector<uint32_t> freeList;
+
+    uint32_t currentSlot = 0;
+    uint32_t numLists = 0;
+};
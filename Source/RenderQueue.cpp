@@ -0,0 +1,89 @@
+#include "Globals.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kRadixBits = 8;
+    constexpr uint32_t kRadixSize = 1u << kRadixBits;
+    constexpr uint32_t kRadixPasses = 64 / kRadixBits;
+
+    uint64_t clampField(uint32_t value, uint32_t bits)
+    {
+        const uint32_t maxValue = (1u << bits) - 1u;
+        return uint64_t(std::min(value, maxValue));
+    }
+}
+
+uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+{
+    // Non-negative floats sort like their bit patterns: keep the top kDepthBits of the 31 non-sign bits
+    uint32_t depthBits = 0;
+    if (depth > 0.0f)
+    {
+        memcpy(&depthBits, &depth, sizeof(depthBits));
+        depthBits >>= 31 - kDepthBits;
+    }
+
+    uint64_t key = clampField(pass, kPassBits);
+    key = (key << kPipelineBits) | clampField(pipeline, kPipelineBits);
+    key = (key << kMaterialBits) | clampField(material, kMaterialBits);
+    key = (key << kMeshBits) | clampField(mesh, kMeshBits);
+    key = (key << kDepthBits) | clampField(depthBits, kDepthBits);
+
+    return key;
+}
+
+void RenderQueue::reserve(uint32_t count)
+{
+    items.reserve(count);
+    scratch.reserve(count);
+}
+
+uint32_t RenderQueue::sort()
+{
+    const size_t count = items.size();
+    if (count < 2)
+        return 0;
+
+    // Every digit's histogram in one read of the keys
+    static_assert(kRadixPasses * kRadixBits == 64, "digits must cover the key");
+    std::vector<uint32_t> histograms(size_t(kRadixPasses) * kRadixSize, 0u);
+
+    for (const Item& item : items)
+    {
+        for (uint32_t pass = 0; pass < kRadixPasses; ++pass)
+            ++histograms[pass * kRadixSize + (uint32_t(item.key >> (pass * kRadixBits)) & (kRadixSize - 1u))];
+    }
+
+    scratch.resize(count);
+
+    uint32_t numPasses = 0;
+    for (uint32_t pass = 0; pass < kRadixPasses; ++pass)
+    {
+        uint32_t* histogram = &histograms[pass * kRadixSize];
+
+        // All keys share this digit: the pass would not move anything
+        const uint32_t digit = uint32_t(items[0].key >> (pass * kRadixBits)) & (kRadixSize - 1u);
+        if (histogram[digit] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < kRadixSize; ++d)
+        {
+            const uint32_t bucket = histogram[d];
+            histogram[d] = offset;
+            offset += bucket;
+        }
+
+        for (const Item& item : items)
+            scratch[histogram[uint32_t(item.key >> (pass * kRadixBits)) & (kRadixSize - 1u)]++] = item;
+
+        items.swap(scratch);
+        ++numPasses;
+    }
+
+    return numPasses;
+}
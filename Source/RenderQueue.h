@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Draws packed into 64-bit sort keys, most significant field first:
+//   pass (4) | pipeline (8) | material (16) | mesh (16) | depth (20)
+// Sorting the keys groups draws that share the expensive state, and inside a group orders them
+// front to back. The payload is the caller's index of the draw. GPU-free, like ParallelRecording.
+class RenderQueue
+{
+public:
+    static constexpr uint32_t kPassBits = 4;
+    static constexpr uint32_t kPipelineBits = 8;
+    static constexpr uint32_t kMaterialBits = 16;
+    static constexpr uint32_t kMeshBits = 16;
+    static constexpr uint32_t kDepthBits = 20;
+
+    struct Item
+    {
+        uint64_t key = 0;
+        uint32_t payload = 0;
+    };
+
+public:
+    // Fields wider than their bits are clamped; depth is the view distance (>= 0), larger is further
+    static uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+    static uint32_t getMaterial(uint64_t key) { return uint32_t(key >> (kMeshBits + kDepthBits)) & ((1u << kMaterialBits) - 1u); }
+    static uint32_t getMesh(uint64_t key) { return uint32_t(key >> kDepthBits) & ((1u << kMeshBits) - 1u); }
+
+    void clear() { items.clear(); }
+    void reserve(uint32_t count);
+    void push(uint64_t key, uint32_t payload) { items.push_back({ key, payload }); }
+
+    // Stable LSD radix sort, 8 bits per pass; passes where every key has the same digit are skipped.
+    // Returns the passes done.
+    uint32_t sort();
+
+    uint32_t size() const { return uint32_t(items.size()); }
+    const Item& operator[](uint32_t index) const { return items[index]; }
+    const std::vector<Item>& getItems() const { return items; }
+
+private:
+    std::vector<Item> items;
+    std::vector<Item> scratch;
+};
@@ -0,0 +1,148 @@
+#include "Globals.h"
+#include "RenderStateCache.h"
+
+void RenderStateCache::Stats::add(const Stats& other)
+{
+    pipelineChanges += other.pipelineChanges;
+    rootChanges += other.rootChanges;
+    tableChanges += other.tableChanges;
+    inputAssemblerChanges += other.inputAssemblerChanges;
+    redundant += other.redundant;
+}
+
+void RenderStateCache::begin(ID3D12GraphicsCommandList* newCommandList, ID3D12PipelineState* initialState, bool newSkipRedundant)
+{
+    commandList = newCommandList;
+    skipRedundant = newSkipRedundant;
+
+    pipelineState = initialState;
+    rootSignature = nullptr;
+
+    for (uint32_t i = 0; i < kMaxRootParameters; ++i)
+    {
+        rootKinds[i] = RootKind::Unset;
+        rootValues[i] = 0;
+    }
+
+    topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    hasVertexBuffer = false;
+    hasIndexBuffer = false;
+
+    stats = Stats();
+}
+
+void RenderStateCache::setPipelineState(ID3D12PipelineState* newPipelineState)
+{
+    if (newPipelineState == pipelineState)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return;
+    }
+
+    pipelineState = newPipelineState;
+    commandList->SetPipelineState(newPipelineState);
+    ++stats.pipelineChanges;
+}
+
+void RenderStateCache::setRootSignature(ID3D12RootSignature* newRootSignature)
+{
+    if (newRootSignature == rootSignature)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return;
+    }
+
+    rootSignature = newRootSignature;
+    for (uint32_t i = 0; i < kMaxRootParameters; ++i)
+        rootKinds[i] = RootKind::Unset;
+
+    commandList->SetGraphicsRootSignature(newRootSignature);
+    ++stats.rootChanges;
+}
+
+bool RenderStateCache::changeRoot(uint32_t parameter, RootKind kind, uint64_t value)
+{
+    _ASSERTE(parameter < kMaxRootParameters);
+
+    if (rootKinds[parameter] == kind && rootValues[parameter] == value)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return false;
+    }
+
+    rootKinds[parameter] = kind;
+    rootValues[parameter] = value;
+    ++stats.rootChanges;
+
+    return true;
+}
+
+void RenderStateCache::setConstantBufferView(uint32_t parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    if (changeRoot(parameter, RootKind::Cbv, address))
+        commandList->SetGraphicsRootConstantBufferView(parameter, address);
+}
+
+void RenderStateCache::setShaderResourceView(uint32_t parameter, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+    if (changeRoot(parameter, RootKind::Srv, address))
+        commandList->SetGraphicsRootShaderResourceView(parameter, address);
+}
+
+void RenderStateCache::setDescriptorTable(uint32_t parameter, D3D12_GPU_DESCRIPTOR_HANDLE handle)
+{
+    if (changeRoot(parameter, RootKind::Table, handle.ptr))
+    {
+        commandList->SetGraphicsRootDescriptorTable(parameter, handle);
+        ++stats.tableChanges;
+    }
+}
+
+void RenderStateCache::setPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY newTopology)
+{
+    if (newTopology == topology)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return;
+    }
+
+    topology = newTopology;
+    commandList->IASetPrimitiveTopology(newTopology);
+    ++stats.inputAssemblerChanges;
+}
+
+void RenderStateCache::setVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+    if (hasVertexBuffer && view.BufferLocation == vertexBuffer.BufferLocation &&
+        view.SizeInBytes == vertexBuffer.SizeInBytes && view.StrideInBytes == vertexBuffer.StrideInBytes)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return;
+    }
+
+    vertexBuffer = view;
+    hasVertexBuffer = true;
+    commandList->IASetVertexBuffers(0, 1, &view);
+    ++stats.inputAssemblerChanges;
+}
+
+void RenderStateCache::setIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+    if (hasIndexBuffer && view.BufferLocation == indexBuffer.BufferLocation &&
+        view.SizeInBytes == indexBuffer.SizeInBytes && view.Format == indexBuffer.Format)
+    {
+        ++stats.redundant;
+        if (skipRedundant)
+            return;
+    }
+
+    indexBuffer = view;
+    hasIndexBuffer = true;
+    commandList->IASetIndexBuffer(&view);
+    ++stats.inputAssemblerChanges;
+}
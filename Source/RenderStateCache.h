@@ -0,0 +1,69 @@
+#pragma once
+
+#include <d3d12.h>
+
+#include <cstdint>
+
+// Remembers what was last bound on one command list and drops the calls that would set the same
+// pipeline, root argument or input assembler state again. With skipping disabled every call goes
+// through but is still classified, so both modes report how much of the state was redundant.
+// Bind through the cache only: anything set on the list directly is unknown to it.
+class RenderStateCache
+{
+public:
+    static constexpr uint32_t kMaxRootParameters = 16;
+
+    struct Stats
+    {
+        uint32_t pipelineChanges = 0;
+        uint32_t rootChanges = 0;        // every root argument, descriptor tables included
+        uint32_t tableChanges = 0;
+        uint32_t inputAssemblerChanges = 0;
+        uint32_t redundant = 0;          // calls that would not have changed anything
+
+        void add(const Stats& other);
+    };
+
+public:
+    // Forgets everything bound so far; call once per command list, with the pipeline it was reset with
+    void begin(ID3D12GraphicsCommandList* commandList, ID3D12PipelineState* initialState, bool skipRedundant = true);
+
+    void setPipelineState(ID3D12PipelineState* pipelineState);
+    // A new root signature invalidates every root argument
+    void setRootSignature(ID3D12RootSignature* rootSignature);
+
+    void setConstantBufferView(uint32_t parameter, D3D12_GPU_VIRTUAL_ADDRESS address);
+    void setShaderResourceView(uint32_t parameter, D3D12_GPU_VIRTUAL_ADDRESS address);
+    void setDescriptorTable(uint32_t parameter, D3D12_GPU_DESCRIPTOR_HANDLE handle);
+
+    void setPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+    void setVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view);
+    void setIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view);
+
+    ID3D12GraphicsCommandList* getCommandList() const { return commandList; }
+    const Stats& getStats() const { return stats; }
+
+private:
+    enum class RootKind : uint8_t { Unset, Cbv, Srv, Table };
+
+    // Returns true when the call has to be made
+    bool changeRoot(uint32_t parameter, RootKind kind, uint64_t value);
+
+private:
+    ID3D12GraphicsCommandList* commandList = nullptr;
+    bool skipRedundant = true;
+
+    ID3D12PipelineState* pipelineState = nullptr;
+    ID3D12RootSignature* rootSignature = nullptr;
+
+    RootKind rootKinds[kMaxRootParameters] = {};
+    uint64_t rootValues[kMaxRootParameters] = {};
+
+    D3D12_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    D3D12_VERTEX_BUFFER_VIEW vertexBuffer = {};
+    D3D12_INDEX_BUFFER_VIEW indexBuffer = {};
+    bool hasVertexBuffer = false;
+    bool hasIndexBuffer = false;
+
+    Stats stats;
+};
@@ -165,7 +165,7 @@ void RenderTexture::createDescriptors()
 
     rtvDesc = targetDescs->createRT(texture.Get());
 
-    srvDesc = shaderDescs->allocTable();
+    srvDesc = shaderDescs->allocTable(1);
     srvDesc.createTextureSRV((msaa && autoResolveMSAA && resolved) ? resolved.Get() : texture.Get());
 
     if (depthTexture && depthFormat != DXGI_FORMAT_UNKNOWN)
@@ -238,23 +238,45 @@ void RenderTexture::setRenderTargetAndClear(ID3D12GraphicsCommandList* cmdList)
     if (!cmdList || !rtvDesc)
         return;
 
+    bindRenderTarget(cmdList);
+
     D3D12_CPU_DESCRIPTOR_HANDLE rtv = rtvDesc.getCPUHandle();
+    cmdList->ClearRenderTargetView(rtv, reinterpret_cast<const float*>(&clearColour), 0, nullptr);
 
-    if (!depthTexture || depthFormat == DXGI_FORMAT_UNKNOWN || !dsvDesc)
-    {
-        cmdList->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
-        cmdList->ClearRenderTargetView(rtv, reinterpret_cast<const float*>(&clearColour), 0, nullptr);
-    }
-    else
+    if (depthTexture && depthFormat != DXGI_FORMAT_UNKNOWN && dsvDesc)
     {
         D3D12_CPU_DESCRIPTOR_HANDLE dsv = dsvDesc.getCPUHandle();
-        cmdList->OMSetRenderTargets(1, &rtv, FALSE, &dsv);
-        cmdList->ClearRenderTargetView(rtv, reinterpret_cast<const float*>(&clearColour), 0, nullptr);
         cmdList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, clearDepth, 0, 0, nullptr);
     }
+}
+
+void RenderTexture::bindRenderTarget(ID3D12GraphicsCommandList* cmdList) const
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE dsv{ 0 };
+    if (depthTexture && depthFormat != DXGI_FORMAT_UNKNOWN && dsvDesc)
+        dsv = dsvDesc.getCPUHandle();
+
+    bindRenderTarget(cmdList, dsv);
+}
+
+void RenderTexture::bindRenderTarget(ID3D12GraphicsCommandList* cmdList, D3D12_CPU_DESCRIPTOR_HANDLE dsv) const
+{
+    if (!cmdList || !rtvDesc)
+        return;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv = rtvDesc.getCPUHandle();
+    cmdList->OMSetRenderTargets(1, &rtv, FALSE, dsv.ptr ? &dsv : nullptr);
 
     D3D12_VIEWPORT vp{ 0.0f, 0.0f, float(width), float(height), 0.0f, 1.0f };
     D3D12_RECT sc{ 0, 0, LONG(width), LONG(height) };
     cmdList->RSSetViewports(1, &vp);
     cmdList->RSSetScissorRects(1, &sc);
 }
+
+void RenderTexture::clearRenderTarget(ID3D12GraphicsCommandList* cmdList) const
+{
+    if (!cmdList || !rtvDesc)
+        return;
+
+    cmdList->ClearRenderTargetView(rtvDesc.getCPUHandle(), reinterpret_cast<const float*>(&clearColour), 0, nullptr);
+}
@@ -35,6 +35,16 @@ public:
     void beginRender(ID3D12GraphicsCommandList* cmdList);
     void endRender(ID3D12GraphicsCommandList* cmdList);
 
+    // Binds RTV/DSV, viewport and scissor without transitions or clears (extra lists between begin/endRender)
+    void bindRenderTarget(ID3D12GraphicsCommandList* cmdList) const;
+    // Same with a depth buffer owned by someone else (a FrameGraph transient); dsv 0: none
+    void bindRenderTarget(ID3D12GraphicsCommandList* cmdList, D3D12_CPU_DESCRIPTOR_HANDLE dsv) const;
+    void clearRenderTarget(ID3D12GraphicsCommandList* cmdList) const;
+
+    // For a FrameGraph import, which transitions the texture instead of begin/endRender
+    ID3D12Resource* getTexture() const { return texture.Get(); }
+    D3D12_RESOURCE_STATES& getTextureState() { return textureState; }
+
     uint32_t getWidth() const { return width; }
     uint32_t getHeight() const { return height; }
 
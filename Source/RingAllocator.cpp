@@ -0,0 +1,124 @@
+#include "Globals.h"
+#include "RingAllocator.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Shared by every RingAllocator so an epoch value is never reused, even by a new allocator at the same address
+    std::atomic<uint64_t> gEpochCounter{ 0 };
+
+    struct ThreadBlock
+    {
+        const RingAllocator* owner = nullptr;
+        uint64_t epoch = 0;
+        uint64_t cur = 0;
+        uint64_t end = 0;
+    };
+
+    thread_local ThreadBlock tlsBlock;
+
+    inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+void RingAllocator::init(size_t newCapacity, uint32_t newNumFrames, size_t newBlockSize)
+{
+    _ASSERTE(newNumFrames > 0 && newNumFrames <= kMaxFrames);
+    _ASSERTE(newBlockSize > 0 && newCapacity % newBlockSize == 0);
+
+    capacity = newCapacity;
+    numFrames = newNumFrames;
+    blockSize = newBlockSize;
+
+    reset();
+}
+
+void RingAllocator::reset()
+{
+    head.store(0, std::memory_order_relaxed);
+    tail = 0;
+    sharedAllocs.store(0, std::memory_order_relaxed);
+
+    for (uint64_t& end : frameEnd)
+        end = 0;
+
+    currentSlot = 0;
+    epoch.store(gEpochCounter.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void RingAllocator::beginFrame(uint32_t frameSlot)
+{
+    _ASSERTE(frameSlot < numFrames);
+
+    frameEnd[currentSlot] = head.load(std::memory_order_acquire);
+    currentSlot = frameSlot;
+
+    // The GPU is done with the last frame that used this slot
+    tail = std::max(tail, frameEnd[frameSlot]);
+
+    epoch.store(gEpochCounter.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+size_t RingAllocator::allocate(size_t size, size_t alignment)
+{
+    if (capacity == 0 || size == 0 || size > capacity)
+        return INVALID_OFFSET;
+
+    _ASSERTE(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= blockSize);
+
+    // Big requests would waste most of a block: go straight to the shared head
+    if (size > blockSize / 2)
+    {
+        const uint64_t start = allocateShared(size, alignment);
+        return (start == UINT64_MAX) ? INVALID_OFFSET : size_t(start % capacity);
+    }
+
+    ThreadBlock& block = tlsBlock;
+    const uint64_t currentEpoch = epoch.load(std::memory_order_acquire);
+
+    if (block.owner != this || block.epoch != currentEpoch)
+        block = { this, currentEpoch, 0, 0 };
+
+    uint64_t start = AlignUp(block.cur, alignment);
+    if (block.end == 0 || start + size > block.end)
+    {
+        const uint64_t blockStart = allocateShared(blockSize, alignment);
+        if (blockStart == UINT64_MAX)
+            return INVALID_OFFSET;
+
+        block.cur = blockStart;
+        block.end = blockStart + blockSize;
+        start = blockStart;
+    }
+
+    block.cur = start + size;
+    return size_t(start % capacity);
+}
+
+uint64_t RingAllocator::allocateShared(size_t size, size_t alignment)
+{
+    uint64_t cur = head.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        uint64_t start = AlignUp(cur, alignment);
+
+        // Never straddle the end of the ring: skip to the next lap
+        const uint64_t inRing = start % capacity;
+        if (inRing + size > capacity)
+            start += capacity - inRing;
+
+        const uint64_t end = start + size;
+        if (end - tail > capacity)
+            return UINT64_MAX;
+
+        if (head.compare_exchange_weak(cur, end, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            sharedAllocs.fetch_add(1, std::memory_order_relaxed);
+            return start;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Frame-based ring suballocator working on offsets only (no GPU types), so it can back an upload heap or plain memory.
+// The head is a virtual, ever-growing offset advanced with a CAS: any thread can allocate concurrently.
+// Small requests are served from per-thread blocks carved from the ring, so most allocations touch no atomics.
+// beginFrame() must not run concurrently with allocate(): it reclaims the frame slot the GPU has finished with
+// and invalidates every thread's current block.
+class RingAllocator
+{
+public:
+    static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+    static constexpr uint32_t kMaxFrames = 8;
+
+    RingAllocator() = default;
+    RingAllocator(const RingAllocator&) = delete;
+    RingAllocator& operator=(const RingAllocator&) = delete;
+
+    void init(size_t capacity, uint32_t numFrames, size_t blockSize);
+    void reset();
+
+    // Thread-safe. size and alignment must be powers-of-two friendly (alignment <= blockSize)
+    size_t allocate(size_t size, size_t alignment);
+
+    // Closes the previous frame and reclaims everything allocated the last time frameSlot was used
+    void beginFrame(uint32_t frameSlot);
+
+    size_t getCapacity() const { return capacity; }
+    size_t getBlockSize() const { return blockSize; }
+    size_t getUsed() const { return size_t(head.load(std::memory_order_relaxed) - tail); }
+
+    // Allocations that hit the shared head (block refills + oversized requests) since init
+    uint64_t getSharedAllocCount() const { return sharedAllocs.load(std::memory_order_relaxed); }
+
+private:
+    uint64_t allocateShared(size_t size, size_t alignment);
+
+private:
+    size_t capacity = 0;
+    size_t blockSize = 0;
+    uint32_t numFrames = 0;
+
+    std::atomic<uint64_t> head{ 0 };   // virtual offset, wraps by capacity
+    uint64_t tail = 0;                 // everything below is reusable
+    std::atomic<uint64_t> epoch{ 1 };  // bumped per frame, invalidates thread blocks
+    std::atomic<uint64_t> sharedAllocs{ 0 };
+
+    uint64_t frameEnd[kMaxFrames] = {};
+    uint32_t currentSlot = 0;
+};
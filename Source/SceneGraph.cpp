@@ -0,0 +1,317 @@
+#include "Globals.h"
+#include "SceneGraph.h"
+
+#include "tiny_gltf.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // S * R * T without the two matrix products: scale the rotation rows, then set the translation row
+    Matrix composeLocal(const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+    {
+        Matrix m = Matrix::CreateFromQuaternion(rotation);
+        m._11 *= scale.x; m._12 *= scale.x; m._13 *= scale.x;
+        m._21 *= scale.y; m._22 *= scale.y; m._23 *= scale.y;
+        m._31 *= scale.z; m._32 *= scale.z; m._33 *= scale.z;
+        m._41 = translation.x; m._42 = translation.y; m._43 = translation.z;
+
+        return m;
+    }
+
+    // glTF nodes carry either TRS or a column-major matrix, which reads as our row-vector matrix as is.
+    // Returns false, with matrix set, when the matrix does not survive decomposition (shear, projection).
+    bool getGltfLocal(const tinygltf::Node& node, Vector3& translation, Quaternion& rotation, Vector3& scale, Matrix& matrix)
+    {
+        translation = Vector3::Zero;
+        rotation = Quaternion::Identity;
+        scale = Vector3::One;
+
+        if (node.matrix.size() == 16)
+        {
+            float m[16];
+            for (int i = 0; i < 16; ++i)
+                m[i] = float(node.matrix[i]);
+
+            matrix = Matrix(m);
+            if (!matrix.Decompose(scale, rotation, translation))
+                return false;
+
+            // Relative to the largest element, so large translations do not hide a small shear
+            const Matrix recomposed = composeLocal(translation, rotation, scale);
+
+            float largest = 1.0f;
+            float error = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                largest = std::max(largest, std::fabs(m[i]));
+                error = std::max(error, std::fabs((&recomposed._11)[i] - m[i]));
+            }
+
+            return error <= largest * 1e-5f;
+        }
+
+        if (node.translation.size() == 3)
+            translation = Vector3(float(node.translation[0]), float(node.translation[1]), float(node.translation[2]));
+        if (node.rotation.size() == 4)
+            rotation = Quaternion(float(node.rotation[0]), float(node.rotation[1]), float(node.rotation[2]), float(node.rotation[3]));
+        if (node.scale.size() == 3)
+            scale = Vector3(float(node.scale[0]), float(node.scale[1]), float(node.scale[2]));
+
+        return true;
+    }
+
+    // Depth-first with an explicit stack, so a long chain of nodes can not overflow the call stack.
+    // Children are pushed last to first to come out in glTF order, which keeps the graph in preorder.
+    void importGltfNode(SceneGraph& graph, const tinygltf::Model& model, int rootIndex, int32_t rootParent, std::vector<uint8_t>& visited)
+    {
+        std::vector<std::pair<int, int32_t>> stack;
+        stack.emplace_back(rootIndex, rootParent);
+
+        while (!stack.empty())
+        {
+            const auto [nodeIndex, parent] = stack.back();
+            stack.pop_back();
+
+            if (nodeIndex < 0 || nodeIndex >= int(model.nodes.size()) || visited[nodeIndex])
+                continue;
+
+            visited[nodeIndex] = 1;
+
+            const tinygltf::Node& node = model.nodes[nodeIndex];
+
+            Vector3 translation, scale;
+            Quaternion rotation;
+            Matrix matrix;
+            const int32_t mesh = node.mesh >= 0 ? int32_t(node.mesh) : SceneGraph::kNoMesh;
+
+            const uint32_t index = getGltfLocal(node, translation, rotation, scale, matrix) ?
+                graph.addNode(parent, translation, rotation, scale, mesh) : graph.addNode(parent, matrix, mesh);
+
+            for (auto child = node.children.rbegin(); child != node.children.rend(); ++child)
+                stack.emplace_back(*child, int32_t(index));
+        }
+    }
+}
+
+void SceneGraph::clear()
+{
+    parents.clear();
+    subtreeEnds.clear();
+    meshes.clear();
+    translations.clear();
+    rotations.clear();
+    scales.clear();
+    worlds.clear();
+    worldVersions.clear();
+    localMatrixIndices.clear();
+    localMatrices.clear();
+    localMatrixNodes.clear();
+    dirty.clear();
+    dirtyRoots.clear();
+}
+
+void SceneGraph::reserve(uint32_t count)
+{
+    parents.reserve(count);
+    subtreeEnds.reserve(count);
+    meshes.reserve(count);
+    translations.reserve(count);
+    rotations.reserve(count);
+    scales.reserve(count);
+    worlds.reserve(count);
+    worldVersions.reserve(count);
+    localMatrixIndices.reserve(count);
+    dirty.reserve(count);
+}
+
+uint32_t SceneGraph::addNode(int32_t parent, const Vector3& translation, const Quaternion& rotation, const Vector3& scale, int32_t mesh)
+{
+    const uint32_t index = size();
+
+    // Preorder: only the subtrees on the path to the last node are still open
+    _ASSERTE(parent == kNoParent || (parent >= 0 && uint32_t(parent) < index && subtreeEnds[parent] == index));
+
+    parents.push_back(parent);
+    subtreeEnds.push_back(index + 1);
+    meshes.push_back(mesh);
+    translations.push_back(translation);
+    rotations.push_back(rotation);
+    scales.push_back(scale);
+    worlds.push_back(Matrix::Identity);
+    worldVersions.push_back(0);
+    localMatrixIndices.push_back(-1);
+    dirty.push_back(0);
+
+    for (int32_t p = parent; p != kNoParent; p = parents[p])
+        subtreeEnds[p] = index + 1;
+
+    markDirty(index);
+
+    return index;
+}
+
+uint32_t SceneGraph::addNode(int32_t parent, const Matrix& local, int32_t mesh)
+{
+    Vector3 translation, scale;
+    Quaternion rotation;
+    if (!Matrix(local).Decompose(scale, rotation, translation))
+    {
+        translation = local.Translation();
+        rotation = Quaternion::Identity;
+        scale = Vector3::One;
+    }
+
+    const uint32_t index = addNode(parent, translation, rotation, scale, mesh);
+
+    localMatrixIndices[index] = int32_t(localMatrices.size());
+    localMatrices.push_back(local);
+    localMatrixNodes.push_back(index);
+
+    return index;
+}
+
+void SceneGraph::importGltf(const tinygltf::Model& model, int32_t parent)
+{
+    std::vector<uint8_t> visited(model.nodes.size(), 0);
+
+    const int sceneIndex = (model.defaultScene >= 0) ? model.defaultScene : (model.scenes.empty() ? -1 : 0);
+
+    if (sceneIndex >= 0 && sceneIndex < int(model.scenes.size()))
+    {
+        for (int root : model.scenes[sceneIndex].nodes)
+            importGltfNode(*this, model, root, parent, visited);
+        return;
+    }
+
+    // No scene: every node nobody lists as a child is a root
+    std::vector<uint8_t> isChild(model.nodes.size(), 0);
+    for (const tinygltf::Node& node : model.nodes)
+    {
+        for (int child : node.children)
+        {
+            if (child >= 0 && child < int(isChild.size()))
+                isChild[child] = 1;
+        }
+    }
+
+    for (int i = 0; i < int(model.nodes.size()); ++i)
+    {
+        if (!isChild[i])
+            importGltfNode(*this, model, i, parent, visited);
+    }
+}
+
+void SceneGraph::setTranslation(uint32_t node, const Vector3& translation)
+{
+    translations[node] = translation;
+    removeLocalMatrix(node);
+    markDirty(node);
+}
+
+void SceneGraph::setRotation(uint32_t node, const Quaternion& rotation)
+{
+    rotations[node] = rotation;
+    removeLocalMatrix(node);
+    markDirty(node);
+}
+
+void SceneGraph::setScale(uint32_t node, const Vector3& scale)
+{
+    scales[node] = scale;
+    removeLocalMatrix(node);
+    markDirty(node);
+}
+
+void SceneGraph::setLocal(uint32_t node, const Vector3& translation, const Quaternion& rotation, const Vector3& scale)
+{
+    translations[node] = translation;
+    rotations[node] = rotation;
+    scales[node] = scale;
+    removeLocalMatrix(node);
+    markDirty(node);
+}
+
+Matrix SceneGraph::getLocalMatrix(uint32_t node) const
+{
+    if (localMatrixIndices[node] >= 0)
+        return localMatrices[localMatrixIndices[node]];
+
+    return composeLocal(translations[node], rotations[node], scales[node]);
+}
+
+void SceneGraph::removeLocalMatrix(uint32_t node)
+{
+    const int32_t slot = localMatrixIndices[node];
+    if (slot < 0)
+        return;
+
+    // Move the last matrix into the freed slot so the array stays packed
+    const uint32_t last = uint32_t(localMatrices.size()) - 1;
+    if (uint32_t(slot) != last)
+    {
+        localMatrices[slot] = localMatrices[last];
+        localMatrixNodes[slot] = localMatrixNodes[last];
+        localMatrixIndices[localMatrixNodes[slot]] = slot;
+    }
+
+    localMatrices.pop_back();
+    localMatrixNodes.pop_back();
+    localMatrixIndices[node] = -1;
+}
+
+void SceneGraph::markDirty(uint32_t node)
+{
+    if (dirty[node])
+        return;
+
+    dirty[node] = 1;
+    dirtyRoots.push_back(node);
+}
+
+void SceneGraph::updateRange(uint32_t begin, uint32_t end)
+{
+    // Parents come first, so each world is built from one that is already up to date
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const int32_t parent = parents[i];
+        worlds[i] = (parent == kNoParent) ? getLocalMatrix(i) : getLocalMatrix(i) * worlds[parent];
+        worldVersions[i] = worldVersion;
+        dirty[i] = 0;
+    }
+}
+
+uint32_t SceneGraph::update()
+{
+    if (dirtyRoots.empty())
+        return 0;
+
+    // In node order a dirty node inside an earlier dirty subtree is covered by it
+    std::sort(dirtyRoots.begin(), dirtyRoots.end());
+    ++worldVersion;
+
+    uint32_t numUpdated = 0;
+    uint32_t coveredEnd = 0;
+
+    for (uint32_t root : dirtyRoots)
+    {
+        if (root < coveredEnd)
+            continue;
+
+        coveredEnd = subtreeEnds[root];
+        updateRange(root, coveredEnd);
+        numUpdated += coveredEnd - root;
+    }
+
+    dirtyRoots.clear();
+
+    return numUpdated;
+}
+
+void SceneGraph::updateAll()
+{
+    ++worldVersion;
+    updateRange(0, size());
+    dirtyRoots.clear();
+}
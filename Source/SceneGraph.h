@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace tinygltf { class Model; }
+
+// Node hierarchy as structure-of-arrays in depth-first preorder: every parent comes before its children
+// and each subtree is the contiguous range [node, getSubtreeEnd(node)). Changing a local transform marks
+// the node as a dirty root; update() then recomputes world matrices in one linear pass per dirty subtree
+// and never visits clean parts of the graph.
+class SceneGraph
+{
+public:
+    static constexpr int32_t kNoParent = -1;
+    static constexpr int32_t kNoMesh = -1;
+
+public:
+    void clear();
+    void reserve(uint32_t count);
+
+    // Appends in preorder: parent is kNoParent, the last node or one of its ancestors. Returns the node index.
+    // mesh is an opaque index for the owner (BasicModel stores the glTF mesh).
+    uint32_t addNode(int32_t parent, const Vector3& translation, const Quaternion& rotation, const Vector3& scale, int32_t mesh = kNoMesh);
+    // Node with a fixed local matrix, for transforms TRS cannot hold (a sheared glTF matrix). The TRS getters
+    // return its decomposition; setting any of them turns the node back into a TRS node.
+    uint32_t addNode(int32_t parent, const Matrix& local, int32_t mesh = kNoMesh);
+
+    // Nodes of the default glTF scene (every parentless node without one) under parent, depth-first.
+    // A node matrix that does not decompose into TRS is kept as is (see addNode).
+    void importGltf(const tinygltf::Model& model, int32_t parent);
+
+    uint32_t size() const { return uint32_t(parents.size()); }
+
+    int32_t getParent(uint32_t node) const { return parents[node]; }
+    uint32_t getSubtreeEnd(uint32_t node) const { return subtreeEnds[node]; }
+    int32_t getMesh(uint32_t node) const { return meshes[node]; }
+
+    const Vector3& getTranslation(uint32_t node) const { return translations[node]; }
+    const Quaternion& getRotation(uint32_t node) const { return rotations[node]; }
+    const Vector3& getScale(uint32_t node) const { return scales[node]; }
+    bool hasLocalMatrix(uint32_t node) const { return localMatrixIndices[node] >= 0; }
+    uint32_t getNumLocalMatrices() const { return uint32_t(localMatrices.size()); }
+
+    void setTranslation(uint32_t node, const Vector3& translation);
+    void setRotation(uint32_t node, const Quaternion& rotation);
+    void setScale(uint32_t node, const Vector3& scale);
+    void setLocal(uint32_t node, const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
+
+    Matrix getLocalMatrix(uint32_t node) const;
+
+    // Valid after update()
+    const Matrix& getWorld(uint32_t node) const { return worlds[node]; }
+    // Changes whenever update() recomputes the node's world. Never reused, not even across clear(), so a
+    // cache keyed by it (InstancePacker) sees every node of a new graph as changed.
+    uint32_t getWorldVersion(uint32_t node) const { return worldVersions[node]; }
+    bool isDirty() const { return !dirtyRoots.empty(); }
+
+    // Recomputes the world matrices under every dirty node; returns how many nodes were visited
+    uint32_t update();
+    // Every node, ignoring the dirty bits (reference for update())
+    void updateAll();
+
+private:
+    void removeLocalMatrix(uint32_t node);
+    void markDirty(uint32_t node);
+    void updateRange(uint32_t begin, uint32_t end);
+
+private:
+    std::vector<int32_t>    parents;
+    std::vector<uint32_t>   subtreeEnds;
+    std::vector<int32_t>    meshes;
+
+    std::vector<Vector3>    translations;
+    std::vector<Quaternion> rotations;
+    std::vector<Vector3>    scales;
+    std::vector<Matrix>     worlds;
+    std::vector<uint32_t>   worldVersions;
+
+    // Index into localMatrices, -1 for TRS nodes; the few matrix nodes keep the SoA arrays small
+    std::vector<int32_t>    localMatrixIndices;
+    std::vector<Matrix>     localMatrices;
+    std::vector<uint32_t>   localMatrixNodes;   // owner of each localMatrices entry
+
+    std::vector<uint8_t>    dirty;        // set while the node waits in dirtyRoots
+    std::vector<uint32_t>   dirtyRoots;
+
+    uint32_t worldVersion = 0;            // last one handed out by update()
+};
@@ -15,20 +15,22 @@ namespace
     }
 }
 
-ShaderTableDesc::ShaderTableDesc(uint32_t h, uint32_t* rc) : handle(h), refCount(rc)
+ShaderTableDesc::ShaderTableDesc(uint32_t h, uint32_t* rc, uint32_t n) : handle(h), refCount(rc), size(n)
 {
+    _ASSERTE(!h || n > 0);
     addRef();
 }
 
-ShaderTableDesc::ShaderTableDesc(const ShaderTableDesc& other) : handle(other.handle), refCount(other.refCount)
+ShaderTableDesc::ShaderTableDesc(const ShaderTableDesc& other) : handle(other.handle), refCount(other.refCount), size(other.size)
 {
     addRef();
 }
 
-ShaderTableDesc::ShaderTableDesc(ShaderTableDesc&& other) noexcept : handle(other.handle), refCount(other.refCount)
+ShaderTableDesc::ShaderTableDesc(ShaderTableDesc&& other) noexcept : handle(other.handle), refCount(other.refCount), size(other.size)
 {
     other.handle = 0;
     other.refCount = nullptr;
+    other.size = 0;
 }
 
 ShaderTableDesc::~ShaderTableDesc()
@@ -43,6 +45,7 @@ ShaderTableDesc& ShaderTableDesc::operator=(const ShaderTableDesc& other)
         release();
         handle = other.handle;
         refCount = other.refCount;
+        size = other.size;
         addRef();
     }
     return *this;
@@ -55,8 +58,10 @@ ShaderTableDesc& ShaderTableDesc::operator=(ShaderTableDesc&& other) noexcept
         release();
         handle = other.handle;
         refCount = other.refCount;
+        size = other.size;
         other.handle = 0;
         other.refCount = nullptr;
+        other.size = 0;
     }
     return *this;
 }
@@ -75,6 +80,7 @@ void ShaderTableDesc::release()
 
     handle = 0;
     refCount = nullptr;
+    size = 0;
 
     if (!h || !rc)
         return;
@@ -99,7 +105,7 @@ void ShaderTableDesc::addRef()
         ++(*refCount);
 }
 
-void ShaderTableDesc::createCBV(ID3D12Resource* resource, uint8_t slot)
+void ShaderTableDesc::createCBV(ID3D12Resource* resource, uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -107,7 +113,7 @@ void ShaderTableDesc::createCBV(ID3D12Resource* resource, uint8_t slot)
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     D3D12_CONSTANT_BUFFER_VIEW_DESC viewDesc = {};
     if (resource)
@@ -122,7 +128,7 @@ void ShaderTableDesc::createCBV(ID3D12Resource* resource, uint8_t slot)
     device->CreateConstantBufferView(&viewDesc, descriptors->getCPUHandle(handle, slot));
 }
 
-void ShaderTableDesc::createTextureSRV(ID3D12Resource* resource, uint8_t slot)
+void ShaderTableDesc::createTextureSRV(ID3D12Resource* resource, uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -130,7 +136,7 @@ void ShaderTableDesc::createTextureSRV(ID3D12Resource* resource, uint8_t slot)
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     if (!resource)
     {
@@ -141,7 +147,7 @@ void ShaderTableDesc::createTextureSRV(ID3D12Resource* resource, uint8_t slot)
     device->CreateShaderResourceView(resource, nullptr, descriptors->getCPUHandle(handle, slot));
 }
 
-void ShaderTableDesc::createTexture2DSRV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint8_t slot)
+void ShaderTableDesc::createTexture2DSRV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -149,7 +155,7 @@ void ShaderTableDesc::createTexture2DSRV(ID3D12Resource* resource, uint32_t arra
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     if (!resource)
     {
@@ -173,7 +179,7 @@ void ShaderTableDesc::createTexture2DSRV(ID3D12Resource* resource, uint32_t arra
     device->CreateShaderResourceView(resource, &viewDesc, descriptors->getCPUHandle(handle, slot));
 }
 
-void ShaderTableDesc::createTexture2DUAV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint8_t slot)
+void ShaderTableDesc::createTexture2DUAV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -181,7 +187,7 @@ void ShaderTableDesc::createTexture2DUAV(ID3D12Resource* resource, uint32_t arra
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     if (!resource)
         return;
@@ -199,7 +205,7 @@ void ShaderTableDesc::createTexture2DUAV(ID3D12Resource* resource, uint32_t arra
     device->CreateUnorderedAccessView(resource, nullptr, &viewDesc, descriptors->getCPUHandle(handle, slot));
 }
 
-void ShaderTableDesc::createCubeTextureSRV(ID3D12Resource* resource, uint8_t slot)
+void ShaderTableDesc::createCubeTextureSRV(ID3D12Resource* resource, uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -207,7 +213,7 @@ void ShaderTableDesc::createCubeTextureSRV(ID3D12Resource* resource, uint8_t slo
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     if (!resource)
     {
@@ -226,7 +232,7 @@ void ShaderTableDesc::createCubeTextureSRV(ID3D12Resource* resource, uint8_t slo
     device->CreateShaderResourceView(resource, &srvDesc, descriptors->getCPUHandle(handle, slot));
 }
 
-void ShaderTableDesc::createNullTexture2DSRV(uint8_t slot)
+void ShaderTableDesc::createNullTexture2DSRV(uint32_t slot)
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     D3D12Module* d3d12 = app->getD3D12Module();
@@ -234,7 +240,7 @@ void ShaderTableDesc::createNullTexture2DSRV(uint8_t slot)
 
     _ASSERTE(descriptors && device);
     _ASSERTE(descriptors->isValid(handle));
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
 
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -247,18 +253,26 @@ void ShaderTableDesc::createNullTexture2DSRV(uint8_t slot)
     device->CreateShaderResourceView(nullptr, &srvDesc, descriptors->getCPUHandle(handle, slot));
 }
 
-D3D12_GPU_DESCRIPTOR_HANDLE ShaderTableDesc::getGPUHandle(uint8_t slot) const
+D3D12_GPU_DESCRIPTOR_HANDLE ShaderTableDesc::getGPUHandle(uint32_t slot) const
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     _ASSERTE(descriptors);
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
     return descriptors->getGPUHandle(handle, slot);
 }
 
-D3D12_CPU_DESCRIPTOR_HANDLE ShaderTableDesc::getCPUHandle(uint8_t slot) const
+D3D12_CPU_DESCRIPTOR_HANDLE ShaderTableDesc::getCPUHandle(uint32_t slot) const
 {
     ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
     _ASSERTE(descriptors);
-    _ASSERTE(slot < ModuleShaderDescriptors::DESCRIPTORS_PER_TABLE);
+    _ASSERTE(slot < size);
     return descriptors->getCPUHandle(handle, slot);
 }
+
+uint32_t ShaderTableDesc::getHeapIndex(uint32_t slot) const
+{
+    ModuleShaderDescriptors* descriptors = app->getShaderDescriptors();
+    _ASSERTE(descriptors);
+    _ASSERTE(slot < size);
+    return descriptors->linearIndex(handle, slot);
+}
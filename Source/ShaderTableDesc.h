@@ -9,10 +9,11 @@ class ShaderTableDesc
 {
     uint32_t  handle = 0;
     uint32_t* refCount = nullptr;
+    uint32_t  size = 0;
 
 public:
     ShaderTableDesc() = default;
-    ShaderTableDesc(uint32_t handle, uint32_t* refCount);
+    ShaderTableDesc(uint32_t handle, uint32_t* refCount, uint32_t size);
     ShaderTableDesc(const ShaderTableDesc& other);
     ShaderTableDesc(ShaderTableDesc&& other) noexcept;
     ~ShaderTableDesc();
@@ -22,15 +23,21 @@ public:
 
     explicit operator bool() const;
 
-    void createCBV(ID3D12Resource* resource, uint8_t slot = 0);
-    void createTextureSRV(ID3D12Resource* resource, uint8_t slot = 0);
-    void createTexture2DSRV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint8_t slot = 0);
-    void createTexture2DUAV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint8_t slot = 0);
-    void createCubeTextureSRV(ID3D12Resource* resource, uint8_t slot = 0);
-    void createNullTexture2DSRV(uint8_t slot = 0);
+    // Number of descriptors in the table
+    uint32_t getSize() const { return size; }
 
-    D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(uint8_t slot = 0) const;
-    D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(uint8_t slot = 0) const;
+    void createCBV(ID3D12Resource* resource, uint32_t slot = 0);
+    void createTextureSRV(ID3D12Resource* resource, uint32_t slot = 0);
+    void createTexture2DSRV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint32_t slot = 0);
+    void createTexture2DUAV(ID3D12Resource* resource, uint32_t arraySlice, uint32_t mipSlice, uint32_t slot = 0);
+    void createCubeTextureSRV(ID3D12Resource* resource, uint32_t slot = 0);
+    void createNullTexture2DSRV(uint32_t slot = 0);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE getGPUHandle(uint32_t slot = 0) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE getCPUHandle(uint32_t slot = 0) const;
+
+    // Absolute descriptor index in the shader heap (for bindless access)
+    uint32_t getHeapIndex(uint32_t slot = 0) const;
 
     void reset() { release(); }
 
@@ -0,0 +1,180 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "AccessorTranscoder.h"
+#include "gltf_utils.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    constexpr int kComponentTypes[] =
+    {
+        TINYGLTF_COMPONENT_TYPE_BYTE,
+        TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+        TINYGLTF_COMPONENT_TYPE_SHORT,
+        TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+        TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
+        TINYGLTF_COMPONENT_TYPE_FLOAT,
+    };
+
+    // BasicMesh::Vertex is 48 bytes; an odd stride keeps the SIMD paths from relying on it
+    constexpr size_t kDstStride = 44;
+}
+
+// Every component type, component count, normalisation and destination width, over padded source strides and
+// counts that are not a multiple of the SIMD width: the output bytes, untouched padding included, must match
+TEST(AccessorTranscoderMatchesScalar)
+{
+    std::mt19937 rng(1);
+    uint32_t mismatches = 0;
+    uint32_t failed = 0;
+
+    for (int componentType : kComponentTypes)
+    {
+        for (uint32_t numComponents = 1; numComponents <= 4; ++numComponents)
+        {
+            for (bool normalized : { false, true })
+            {
+                for (uint32_t dstComponents = 1; dstComponents <= 4; ++dstComponents)
+                {
+                    const size_t componentSize = getAccessorComponentSize(componentType);
+                    const size_t srcStride = componentSize * numComponents + (rng() % 3) * 4;
+                    const size_t count = 1 + rng() % 257;
+
+                    std::vector<uint8_t> src(srcStride * count);
+                    for (uint8_t& byte : src)
+                        byte = uint8_t(rng());
+
+                    // Random bytes would give NaNs, which compare unequal to themselves
+                    if (componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
+                    {
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            for (uint32_t c = 0; c < numComponents; ++c)
+                            {
+                                const float value = float(int(rng() % 20000) - 10000) / 7.0f;
+                                memcpy(&src[i * srcStride + c * 4], &value, 4);
+                            }
+                        }
+                    }
+
+                    std::vector<uint8_t> simd(kDstStride * count + 16, 0xAB);
+                    std::vector<uint8_t> scalar = simd;
+
+                    const AccessorFormat format{ componentType, numComponents, normalized };
+                    const bool simdOk = transcodeToFloat(reinterpret_cast<float*>(simd.data()), kDstStride, dstComponents,
+                        src.data(), srcStride, format, count);
+                    const bool scalarOk = transcodeToFloatScalar(reinterpret_cast<float*>(scalar.data()), kDstStride, dstComponents,
+                        src.data(), srcStride, format, count);
+
+                    failed += (simdOk && scalarOk) ? 0 : 1;
+                    mismatches += simd == scalar ? 0 : 1;
+                }
+            }
+        }
+    }
+
+    CHECK(failed == 0);
+    CHECK(mismatches == 0);
+}
+
+// The glTF rules at the ends of the ranges: snorm clamps -128 to -1, unorm max is exactly 1, plain integers convert as is
+TEST(AccessorTranscoderNormalization)
+{
+    float out[2] = {};
+
+    const int8_t snorm8[2] = { -128, 127 };
+    CHECK(transcodeToFloat(out, 4, 1, reinterpret_cast<const uint8_t*>(snorm8), 1, { TINYGLTF_COMPONENT_TYPE_BYTE, 1, true }, 2));
+    CHECK(out[0] == -1.0f && out[1] == 1.0f);
+
+    const uint16_t unorm16[1] = { 65535 };
+    CHECK(transcodeToFloat(out, 4, 1, reinterpret_cast<const uint8_t*>(unorm16), 2, { TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 1, true }, 1));
+    CHECK(out[0] == 1.0f);
+
+    const int16_t quantized[1] = { -300 };
+    CHECK(transcodeToFloat(out, 4, 1, reinterpret_cast<const uint8_t*>(quantized), 2, { TINYGLTF_COMPONENT_TYPE_SHORT, 1, false }, 1));
+    CHECK(out[0] == -300.0f);
+
+    // Unknown component types are refused
+    CHECK(!transcodeToFloat(out, 4, 1, reinterpret_cast<const uint8_t*>(quantized), 2, { 0, 1, false }, 1));
+}
+
+TEST(AccessorTranscoderIndices)
+{
+    std::mt19937 rng(2);
+    uint32_t mismatches = 0;
+
+    for (int componentType : { TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT })
+    {
+        for (size_t count : { 0, 1, 7, 8, 15, 16, 17, 100, 1001 })
+        {
+            const size_t componentSize = getAccessorComponentSize(componentType);
+
+            std::vector<uint8_t> src(componentSize * count + 1);
+            for (uint8_t& byte : src)
+                byte = uint8_t(rng());
+
+            std::vector<uint32_t> widened(count);
+            std::vector<uint32_t> expected(count);
+
+            CHECK(transcodeIndices(widened.data(), src.data(), componentSize, componentType, count));
+
+            for (size_t i = 0; i < count; ++i)
+                memcpy(&expected[i], &src[i * componentSize], componentSize);
+
+            mismatches += widened == expected ? 0 : 1;
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+// Source megabytes per second, scalar reference against transcodeToFloat, for the layouts glTF exporters write
+BENCHMARK(AccessorTranscoderThroughput)
+{
+    struct Layout
+    {
+        const char* name;
+        AccessorFormat format;
+        size_t srcStride;
+    };
+
+    const Layout layouts[] =
+    {
+        { "float3", { TINYGLTF_COMPONENT_TYPE_FLOAT, 3, false }, 12 },
+        { "float2", { TINYGLTF_COMPONENT_TYPE_FLOAT, 2, false }, 8 },
+        { "unorm16x2", { TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, 2, true }, 4 },
+        { "snorm8x4", { TINYGLTF_COMPONENT_TYPE_BYTE, 4, true }, 4 },
+        { "int16x3", { TINYGLTF_COMPONENT_TYPE_SHORT, 3, false }, 8 },
+    };
+
+    constexpr size_t kCount = 1u << 18;
+    constexpr uint32_t kPasses = 10;
+
+    for (const Layout& layout : layouts)
+    {
+        std::vector<uint8_t> src(layout.srcStride * kCount, 1);
+        std::vector<uint8_t> dst(kDstStride * kCount);
+
+        double mbPerSecond[2] = {};
+        for (uint32_t simd = 0; simd < 2; ++simd)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (uint32_t pass = 0; pass < kPasses; ++pass)
+            {
+                (simd ? transcodeToFloat : transcodeToFloatScalar)(reinterpret_cast<float*>(dst.data()), kDstStride,
+                    layout.format.numComponents, src.data(), layout.srcStride, layout.format, kCount);
+            }
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / kPasses;
+            mbPerSecond[simd] = double(src.size()) / (1024.0 * 1024.0) / seconds;
+        }
+
+        printf("  %-10s: scalar %7.1f MB/s, simd %7.1f MB/s, %.2fx\n", layout.name, mbPerSecond[0], mbPerSecond[1],
+            mbPerSecond[1] / mbPerSecond[0]);
+    }
+}
@@ -0,0 +1,449 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "BuddyAllocator.h"
+#include "OffsetAllocator.h"
+#include "RingAllocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <random>
+#include <thread>
+
+// Random allocations against a map of live blocks: blocks are aligned to their size and never overlap,
+// and the stats add up while blocks are live
+TEST(BuddyAllocatorOccupancy)
+{
+    constexpr uint32_t kCapacity = 1024;
+
+    BuddyAllocator buddy(kCapacity);
+    std::map<uint32_t, uint32_t> live;   // offset -> requested size
+    std::mt19937 rng(1);
+
+    uint32_t overlaps = 0;
+    uint32_t misaligned = 0;
+    uint32_t badStats = 0;
+
+    for (uint32_t it = 0; it < 100000; ++it)
+    {
+        if (live.empty() || rng() % 2)
+        {
+            const uint32_t size = 1 + rng() % 40;
+            const uint32_t offset = buddy.allocate(size);
+            if (offset == BuddyAllocator::INVALID_OFFSET)
+                continue;
+
+            const uint32_t blockSize = BuddyAllocator::roundUpPow2(size);
+            misaligned += offset % blockSize != 0 ? 1 : 0;
+
+            auto next = live.lower_bound(offset);
+            if (next != live.end() && offset + blockSize > next->first)
+                ++overlaps;
+            if (next != live.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + BuddyAllocator::roundUpPow2(prev->second) > offset)
+                    ++overlaps;
+            }
+
+            live[offset] = size;
+        }
+        else
+        {
+            auto victim = live.begin();
+            std::advance(victim, rng() % live.size());
+            buddy.free(victim->first);
+            live.erase(victim);
+        }
+
+        if (it % 1000 == 0)
+        {
+            uint32_t allocated = 0;
+            uint32_t requested = 0;
+            for (const auto& [offset, size] : live)
+            {
+                allocated += BuddyAllocator::roundUpPow2(size);
+                requested += size;
+            }
+
+            const BuddyAllocator::Stats stats = buddy.getStats();
+            const bool ok = stats.numAllocations == live.size() && stats.allocatedUnits == allocated &&
+                stats.requestedUnits == requested && stats.allocatedUnits + stats.freeUnits == kCapacity &&
+                stats.largestFreeBlock <= stats.freeUnits &&
+                std::abs(stats.occupancy - float(allocated) / kCapacity) < 1e-4f;
+            badStats += ok ? 0 : 1;
+        }
+    }
+
+    CHECK(overlaps == 0);
+    CHECK(misaligned == 0);
+    CHECK(badStats == 0);
+
+    // Everything merges back into one block
+    for (const auto& [offset, size] : live)
+        buddy.free(offset);
+
+    const BuddyAllocator::Stats stats = buddy.getStats();
+    CHECK(stats.numAllocations == 0);
+    CHECK(stats.freeUnits == kCapacity);
+    CHECK(stats.numFreeBlocks == 1);
+    CHECK(stats.largestFreeBlock == kCapacity);
+    CHECK(stats.externalFragmentation == 0.0f);
+}
+
+// Known layout: rounding and a hole between two live blocks show up in the fragmentation figures
+TEST(BuddyAllocatorFragmentation)
+{
+    BuddyAllocator buddy(16);
+
+    const uint32_t a = buddy.allocate(3);    // 4 units
+    const uint32_t b = buddy.allocate(4);
+    const uint32_t c = buddy.allocate(4);
+    REQUIRE(a != BuddyAllocator::INVALID_OFFSET && b != BuddyAllocator::INVALID_OFFSET && c != BuddyAllocator::INVALID_OFFSET);
+
+    CHECK(buddy.getBlockSize(a) == 4);
+    CHECK(buddy.getRequestedSize(a) == 3);
+
+    buddy.free(b);
+
+    // Free: b's 4 units and the last 4 units, which are not buddies of each other
+    const BuddyAllocator::Stats stats = buddy.getStats();
+    CHECK(stats.allocatedUnits == 8);
+    CHECK(stats.requestedUnits == 7);
+    CHECK(stats.freeUnits == 8);
+    CHECK(stats.numFreeBlocks == 2);
+    CHECK(stats.largestFreeBlock == 4);
+    CHECK(std::abs(stats.internalFragmentation - 1.0f / 8.0f) < 1e-6f);
+    CHECK(std::abs(stats.externalFragmentation - 0.5f) < 1e-6f);
+    CHECK(std::abs(stats.occupancy - 0.5f) < 1e-6f);
+
+    // 8 units fit in total but not in one block
+    CHECK(buddy.allocate(8) == BuddyAllocator::INVALID_OFFSET);
+
+    buddy.free(a);
+    buddy.free(c);
+    CHECK(buddy.allocate(16) == 0);
+}
+
+// Random sizes and alignments against a map of live ranges, as GpuMemoryAllocator places resources in a
+// page: ranges are aligned, inside the capacity and never overlap, and free ranges coalesce back into one
+TEST(OffsetAllocatorPlacement)
+{
+    constexpr uint64_t kCapacity = 64ull << 20;
+
+    OffsetAllocator allocator(kCapacity);
+    std::map<uint64_t, uint64_t> live;   // offset -> size
+    std::mt19937 rng(3);
+
+    uint32_t overlaps = 0;
+    uint32_t misaligned = 0;
+    uint32_t outOfBounds = 0;
+    uint32_t badStats = 0;
+
+    for (uint32_t it = 0; it < 50000; ++it)
+    {
+        if (live.empty() || rng() % 2)
+        {
+            const uint64_t alignment = 1ull << (rng() % 17);
+            const uint64_t size = 1 + rng() % (256u << 10);
+            const uint64_t offset = allocator.allocate(size, alignment);
+            if (offset == OffsetAllocator::INVALID_OFFSET)
+                continue;
+
+            misaligned += offset % alignment != 0 ? 1 : 0;
+            outOfBounds += offset + size > kCapacity ? 1 : 0;
+
+            auto next = live.lower_bound(offset);
+            if (next != live.end() && offset + size > next->first)
+                ++overlaps;
+            if (next != live.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second > offset)
+                    ++overlaps;
+            }
+
+            live[offset] = size;
+        }
+        else
+        {
+            auto victim = live.begin();
+            std::advance(victim, rng() % live.size());
+            allocator.free(victim->first);
+            live.erase(victim);
+        }
+
+        if (it % 1000 == 0)
+        {
+            uint64_t used = 0;
+            for (const auto& [offset, size] : live)
+                used += size;
+
+            // Alignment padding stays in the free ranges
+            const OffsetAllocator::Stats stats = allocator.getStats();
+            const bool ok = stats.numAllocations == live.size() && stats.usedBytes == used &&
+                stats.usedBytes + stats.freeBytes == kCapacity && stats.largestFreeBlock <= stats.freeBytes;
+            badStats += ok ? 0 : 1;
+        }
+    }
+
+    CHECK(overlaps == 0);
+    CHECK(misaligned == 0);
+    CHECK(outOfBounds == 0);
+    CHECK(badStats == 0);
+
+    for (const auto& [offset, size] : live)
+        allocator.free(offset);
+
+    const OffsetAllocator::Stats stats = allocator.getStats();
+    CHECK(allocator.isEmpty());
+    CHECK(stats.numFreeBlocks == 1);
+    CHECK(stats.freeBytes == kCapacity);
+    CHECK(stats.externalFragmentation == 0.0f);
+}
+
+// Allocate/free throughput on one heap page of each GpuMemoryAllocator pool, kept about half full. Sizes
+// and alignments are what GetResourceAllocationInfo reports: 64KB units for buffers, 4KB for small textures.
+BENCHMARK(OffsetAllocatorChurn)
+{
+    constexpr uint32_t kOps = 1u << 20;
+
+    struct PoolCase
+    {
+        const char* name;
+        uint64_t pageSize;
+        uint64_t unit;
+        uint32_t maxUnits;
+        uint32_t numLive;
+    };
+
+    const PoolCase cases[] =
+    {
+        { "small buffers", 4ull << 20, 64u << 10, 1, 32 },
+        { "buffers", 64ull << 20, 64u << 10, 16, 64 },
+        { "textures", 64ull << 20, 4u << 10, 256, 64 },
+    };
+
+    for (const PoolCase& poolCase : cases)
+    {
+        OffsetAllocator allocator(poolCase.pageSize);
+        std::vector<uint64_t> live;
+        live.reserve(poolCase.numLive);
+        std::mt19937 rng(5);
+
+        uint32_t failed = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t op = 0; op < kOps; ++op)
+        {
+            if (live.size() < poolCase.numLive)
+            {
+                const uint64_t size = poolCase.unit * (1 + rng() % poolCase.maxUnits);
+                const uint64_t offset = allocator.allocate(size, poolCase.unit);
+                if (offset == OffsetAllocator::INVALID_OFFSET)
+                    ++failed;
+                else
+                    live.push_back(offset);
+            }
+            else
+            {
+                // Random victim, so the free list fragments the way resource lifetimes do
+                const size_t victim = rng() % live.size();
+                allocator.free(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        const OffsetAllocator::Stats stats = allocator.getStats();
+
+        printf("  %-13s: %.1f ns/op, %u failed, %u free blocks, %.1f%% external fragmentation\n", poolCase.name,
+            ms * 1e6 / kOps, failed, stats.numFreeBlocks, stats.externalFragmentation * 100.0f);
+
+        for (uint64_t offset : live)
+            allocator.free(offset);
+        CHECK(allocator.getStats().numFreeBlocks == 1);
+    }
+}
+
+namespace
+{
+    struct RingAllocation
+    {
+        size_t offset = 0;
+        size_t size = 0;
+        uint32_t tag = 0;
+    };
+
+    bool holdsTag(const std::vector<uint32_t>& memory, const RingAllocation& allocation)
+    {
+        for (size_t i = allocation.offset / 4; i < (allocation.offset + allocation.size) / 4; ++i)
+        {
+            if (memory[i] != allocation.tag)
+                return false;
+        }
+        return true;
+    }
+}
+
+// Threads fill every allocation in plain memory with a tag of its own. Whatever another allocation of the
+// frame, or of the next frame while this one is still in flight, wrote over shows up as a wrong tag.
+TEST(RingAllocatorPlainMemory)
+{
+    constexpr size_t kCapacity = 4u << 20;
+    constexpr uint32_t kNumFrames = 2;
+    constexpr uint32_t kThreads = 8;
+    constexpr uint32_t kAllocsPerThread = 200;
+
+    std::vector<uint32_t> memory(kCapacity / 4);
+
+    RingAllocator ring;
+    ring.init(kCapacity, kNumFrames, 16u << 10);
+
+    std::vector<std::vector<RingAllocation>> frames(kNumFrames);
+    uint32_t failedAllocs = 0;
+    uint32_t outOfBounds = 0;
+    uint32_t misaligned = 0;
+    uint32_t overwritten = 0;
+
+    for (uint32_t frame = 0; frame < 64; ++frame)
+    {
+        const uint32_t slot = frame % kNumFrames;
+        ring.beginFrame(slot);
+
+        std::vector<std::vector<RingAllocation>> perThread(kThreads);
+        std::vector<std::thread> threads;
+
+        for (uint32_t t = 0; t < kThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+                {
+                    std::mt19937 rng(frame * kThreads + t);
+
+                    for (uint32_t i = 0; i < kAllocsPerThread; ++i)
+                    {
+                        // Mostly small requests from the thread block, now and then one over half a block
+                        const size_t size = (rng() % 50 == 0) ? size_t(12u << 10) : size_t(16 * (1 + rng() % 64));
+                        const size_t alignment = size_t(16) << (rng() % 5);
+
+                        const size_t offset = ring.allocate(size, alignment);
+                        if (offset == RingAllocator::INVALID_OFFSET)
+                            continue;
+
+                        const uint32_t tag = (frame << 20) | (t << 12) | (i + 1);
+                        perThread[t].push_back(RingAllocation{ offset, size, tag });
+
+                        if (offset % alignment == 0 && offset + size <= kCapacity)
+                            std::fill(memory.begin() + offset / 4, memory.begin() + (offset + size) / 4, tag);
+                    }
+                });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        frames[slot].clear();
+        for (uint32_t t = 0; t < kThreads; ++t)
+        {
+            failedAllocs += kAllocsPerThread - uint32_t(perThread[t].size());
+            frames[slot].insert(frames[slot].end(), perThread[t].begin(), perThread[t].end());
+        }
+
+        for (const RingAllocation& allocation : frames[slot])
+        {
+            outOfBounds += allocation.offset + allocation.size > kCapacity ? 1 : 0;
+            misaligned += allocation.offset % 16 != 0 ? 1 : 0;
+        }
+
+        // This frame and the one still in flight
+        for (const std::vector<RingAllocation>& allocations : frames)
+        {
+            for (const RingAllocation& allocation : allocations)
+                overwritten += holdsTag(memory, allocation) ? 0 : 1;
+        }
+    }
+
+    CHECK(failedAllocs == 0);
+    CHECK(outOfBounds == 0);
+    CHECK(misaligned == 0);
+    CHECK(overwritten == 0);
+    CHECK(ring.getSharedAllocCount() < 64ull * kThreads * kAllocsPerThread / 4);
+}
+
+// A frame bigger than the ring fails instead of overwriting the frame in flight, and succeeds again once
+// that frame is reclaimed
+TEST(RingAllocatorExhaustion)
+{
+    RingAllocator ring;
+    ring.init(64u << 10, 2, 4u << 10);
+    ring.beginFrame(0);
+
+    uint32_t frame0 = 0;
+    while (ring.allocate(1024, 16) != RingAllocator::INVALID_OFFSET)
+        ++frame0;
+
+    CHECK(frame0 == 64);
+    CHECK(ring.getUsed() == (64u << 10));
+
+    ring.beginFrame(1);
+    CHECK(ring.allocate(1024, 16) == RingAllocator::INVALID_OFFSET);
+
+    // Slot 0 again: its memory is free
+    ring.beginFrame(0);
+    CHECK(ring.allocate(1024, 16) != RingAllocator::INVALID_OFFSET);
+}
+
+// Allocation throughput from 1 to 16 threads, per-thread blocks against a block size of one allocation
+// (every request then goes through the shared CAS head)
+BENCHMARK(RingAllocatorContention)
+{
+    constexpr size_t kCapacity = 64u << 20;
+    constexpr uint32_t kAllocsPerFrame = 1u << 16;
+    constexpr uint32_t kFrames = 16;
+
+    for (size_t blockSize : { size_t(64u << 10), size_t(256) })
+    {
+        RingAllocator ring;
+        ring.init(kCapacity, 2, blockSize);
+
+        for (uint32_t numThreads = 1; numThreads <= 16; numThreads *= 2)
+        {
+            std::atomic<uint32_t> failed{ 0 };
+            const uint64_t sharedBefore = ring.getSharedAllocCount();
+            const auto start = std::chrono::steady_clock::now();
+
+            for (uint32_t frame = 0; frame < kFrames; ++frame)
+            {
+                ring.beginFrame(frame % 2);
+
+                std::vector<std::thread> threads;
+                for (uint32_t t = 0; t < numThreads; ++t)
+                {
+                    threads.emplace_back([&]()
+                        {
+                            for (uint32_t i = 0; i < kAllocsPerFrame / numThreads; ++i)
+                            {
+                                if (ring.allocate(256, 256) == RingAllocator::INVALID_OFFSET)
+                                    failed.fetch_add(1, std::memory_order_relaxed);
+                            }
+                        });
+                }
+
+                for (std::thread& thread : threads)
+                    thread.join();
+            }
+
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const double numAllocs = double(kAllocsPerFrame) * kFrames;
+
+            printf("  block %6zu, %2u threads: %.1f ns/alloc, %llu shared allocs\n", blockSize, numThreads,
+                ms * 1e6 / numAllocs, (unsigned long long)(ring.getSharedAllocCount() - sharedBefore));
+
+            CHECK(failed.load() == 0);
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "CookedModel.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    constexpr uint32_t kVertexStride = 20;
+
+    // Two glTF meshes (the second cut in two parts), three nodes, LODs, meshlets and every string section in use
+    void buildContents(CookedModel::Contents& contents, std::vector<uint8_t>& vertices, std::vector<uint8_t>& indices)
+    {
+        contents = {};
+        contents.sourceHash = 0x0123456789abcdefull;
+        contents.flags = CookedModel::FLAG_16BIT_INDICES | CookedModel::FLAG_HAS_BOUNDS | CookedModel::FLAG_PACKED_VERTICES;
+        contents.vertexStride = kVertexStride;
+
+        const float boundsMin[3] = { -1.0f, -2.0f, -3.0f };
+        const float boundsMax[3] = { 1.0f, 2.0f, 3.0f };
+        memcpy(contents.boundsMin, boundsMin, sizeof(boundsMin));
+        memcpy(contents.boundsMax, boundsMax, sizeof(boundsMax));
+        contents.boundsRadius = 3.75f;
+
+        const uint32_t numVertices[3] = { 40, 100, 7 };
+        const uint32_t numIndices[3] = { 60, 180, 9 };
+
+        uint32_t baseVertex = 0;
+        uint32_t firstIndex = 0;
+        for (uint32_t m = 0; m < 3; ++m)
+        {
+            CookedModel::Mesh& mesh = contents.meshes.emplace_back();
+            mesh.name = "mesh" + std::to_string(m);
+            mesh.materialIndex = m == 2 ? -1 : int32_t(m);
+            mesh.numVertices = numVertices[m];
+            mesh.numIndices = numIndices[m];
+            mesh.baseVertex = baseVertex;
+            mesh.firstIndex = firstIndex;
+            mesh.boundsMax[0] = float(m + 1);
+
+            // One coarser level after level 0
+            if (m < 2)
+                mesh.lods.push_back(CookedModel::Lod{ numIndices[m], numIndices[m] / 3, 0.01f * float(m + 1) });
+
+            MeshOptimizer::Meshlet meshlet;
+            meshlet.numIndices = numIndices[m];
+            meshlet.radius = 0.5f;
+            meshlet.coneCutoff = 0.25f;
+            mesh.meshlets.push_back(meshlet);
+
+            baseVertex += numVertices[m];
+            firstIndex += numIndices[m] + (m < 2 ? numIndices[m] / 3 : 0);
+        }
+
+        contents.meshGroupOffsets = { 0, 1, 3 };
+
+        CookedModel::Node root;
+        root.mesh = 0;
+        root.translation[1] = 5.0f;
+        contents.nodes.push_back(root);
+
+        CookedModel::Node child;
+        child.parent = 0;
+        child.mesh = 1;
+        child.hasMatrix = 1;
+        for (uint32_t i = 0; i < 16; ++i)
+            child.matrix[i] = float(i) * 0.5f;
+        contents.nodes.push_back(child);
+
+        CookedModel::Node sibling;
+        sibling.scale[2] = 4.0f;
+        contents.nodes.push_back(sibling);
+
+        contents.materials.resize(2);
+        contents.materials[0].name = "stone";
+        contents.materials[0].diffuseTexture = "textures/stone.png";
+        contents.materials[1].name = "glass";
+        contents.materials[1].baseColour[3] = 0.25f;
+
+        contents.dependencies = { "model.bin" };
+
+        vertices.resize(size_t(baseVertex) * kVertexStride);
+        for (size_t i = 0; i < vertices.size(); ++i)
+            vertices[i] = uint8_t(i * 7 + 3);
+
+        indices.resize(size_t(firstIndex) * sizeof(uint16_t));
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i] = uint8_t(i % 7);
+
+        contents.vertices = vertices.data();
+        contents.vertexBytes = vertices.size();
+        contents.indices = indices.data();
+        contents.indexBytes = indices.size();
+    }
+
+    bool sameMeshes(const CookedModel::Contents& a, const CookedModel::Contents& b)
+    {
+        if (a.meshes.size() != b.meshes.size())
+            return false;
+
+        for (size_t i = 0; i < a.meshes.size(); ++i)
+        {
+            const CookedModel::Mesh& x = a.meshes[i];
+            const CookedModel::Mesh& y = b.meshes[i];
+
+            if (x.name != y.name || x.materialIndex != y.materialIndex || x.numVertices != y.numVertices || x.numIndices != y.numIndices ||
+                x.baseVertex != y.baseVertex || x.firstIndex != y.firstIndex || memcmp(x.boundsMin, y.boundsMin, sizeof(x.boundsMin)) != 0 ||
+                memcmp(x.boundsMax, y.boundsMax, sizeof(x.boundsMax)) != 0 || x.lods.size() != y.lods.size() || x.meshlets.size() != y.meshlets.size())
+                return false;
+
+            if ((!x.lods.empty() && memcmp(x.lods.data(), y.lods.data(), sizeof(CookedModel::Lod) * x.lods.size()) != 0) ||
+                (!x.meshlets.empty() && memcmp(x.meshlets.data(), y.meshlets.data(), sizeof(MeshOptimizer::Meshlet) * x.meshlets.size()) != 0))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool sameMaterials(const CookedModel::Contents& a, const CookedModel::Contents& b)
+    {
+        if (a.materials.size() != b.materials.size())
+            return false;
+
+        for (size_t i = 0; i < a.materials.size(); ++i)
+        {
+            if (a.materials[i].name != b.materials[i].name || a.materials[i].diffuseTexture != b.materials[i].diffuseTexture ||
+                memcmp(a.materials[i].baseColour, b.materials[i].baseColour, sizeof(a.materials[i].baseColour)) != 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream(path, std::ios::binary) << text;
+    }
+}
+
+// Everything written comes back bit for bit, and writing what was read gives the same blob
+TEST(CookedModelRoundTrip)
+{
+    CookedModel::Contents contents;
+    std::vector<uint8_t> vertices, indices;
+    buildContents(contents, vertices, indices);
+
+    std::vector<uint8_t> blob;
+    CookedModel::write(contents, blob);
+
+    CookedModel::Contents read;
+    REQUIRE(CookedModel::read(blob.data(), blob.size(), kVertexStride, read));
+
+    CHECK(read.sourceHash == contents.sourceHash && read.flags == contents.flags && read.vertexStride == contents.vertexStride);
+    CHECK(memcmp(read.boundsMin, contents.boundsMin, sizeof(read.boundsMin)) == 0 &&
+        memcmp(read.boundsMax, contents.boundsMax, sizeof(read.boundsMax)) == 0 &&
+        memcmp(read.boundsCenter, contents.boundsCenter, sizeof(read.boundsCenter)) == 0 && read.boundsRadius == contents.boundsRadius);
+
+    CHECK(sameMeshes(read, contents));
+    CHECK(read.nodes.size() == contents.nodes.size() &&
+        memcmp(read.nodes.data(), contents.nodes.data(), sizeof(CookedModel::Node) * contents.nodes.size()) == 0);
+    CHECK(read.meshGroupOffsets == contents.meshGroupOffsets);
+    CHECK(sameMaterials(read, contents));
+    CHECK(read.dependencies == contents.dependencies);
+
+    // Views into the blob, 16-byte aligned so they can be used in place
+    CHECK(read.vertexBytes == vertices.size() && memcmp(read.vertices, vertices.data(), vertices.size()) == 0);
+    CHECK(read.indexBytes == indices.size() && memcmp(read.indices, indices.data(), indices.size()) == 0);
+    CHECK((read.vertices - blob.data()) % 16 == 0 && (read.indices - blob.data()) % 16 == 0);
+
+    std::vector<uint8_t> rewritten;
+    CookedModel::write(read, rewritten);
+    CHECK(rewritten == blob);
+}
+
+// Blobs from another version, for another vertex stride, or cut short are refused
+TEST(CookedModelRejectsInvalid)
+{
+    CookedModel::Contents contents;
+    std::vector<uint8_t> vertices, indices;
+    buildContents(contents, vertices, indices);
+
+    std::vector<uint8_t> blob;
+    CookedModel::write(contents, blob);
+
+    CookedModel::Contents read;
+    REQUIRE(CookedModel::read(blob.data(), blob.size(), kVertexStride, read));
+    CHECK(!CookedModel::read(blob.data(), blob.size(), kVertexStride + 4, read));
+
+    // Header: magic, then version
+    for (uint32_t version : { CookedModel::VERSION - 1, CookedModel::VERSION + 1 })
+    {
+        std::vector<uint8_t> patched = blob;
+        memcpy(&patched[4], &version, sizeof(version));
+        CHECK(!CookedModel::read(patched.data(), patched.size(), kVertexStride, read));
+    }
+
+    std::vector<uint8_t> patched = blob;
+    patched[0] ^= 0xff;
+    CHECK(!CookedModel::read(patched.data(), patched.size(), kVertexStride, read));
+
+    // The index data ends the blob, so every shorter length loses part of a section
+    uint32_t accepted = 0;
+    for (size_t size = 0; size < blob.size(); ++size)
+    {
+        const std::vector<uint8_t> truncated(blob.begin(), blob.begin() + size);
+        accepted += CookedModel::read(truncated.data(), truncated.size(), kVertexStride, read) ? 1 : 0;
+    }
+
+    CHECK(accepted == 0);
+    CHECK(!CookedModel::read(nullptr, 0, kVertexStride, read));
+}
+
+// A blob is current only while the glTF and every dependency still hash to what it was cooked from
+TEST(CookedModelSourceHash)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "CookedModelTests";
+    std::filesystem::create_directories(dir);
+
+    const std::string source = (dir / "model.gltf").string();
+    writeFile(source, "{ \"asset\": { \"version\": \"2.0\" } }");
+    writeFile(dir / "model.bin", "0123456789");
+
+    CookedModel::Contents contents;
+    std::vector<uint8_t> vertices, indices;
+    buildContents(contents, vertices, indices);
+
+    bool ok = false;
+    contents.sourceHash = CookedModel::hashSources(source.c_str(), contents.dependencies, ok);
+    REQUIRE(ok);
+
+    std::vector<uint8_t> blob;
+    CookedModel::write(contents, blob);
+
+    CookedModel::Contents read;
+    REQUIRE(CookedModel::read(blob.data(), blob.size(), kVertexStride, read));
+    CHECK(CookedModel::isCurrent(source.c_str(), read));
+
+    // A stored hash that does not match
+    CookedModel::Contents wrongHash = read;
+    wrongHash.sourceHash ^= 1;
+    CHECK(!CookedModel::isCurrent(source.c_str(), wrongHash));
+
+    // Same size, one byte changed, in the dependency and then in the glTF
+    writeFile(dir / "model.bin", "0123456780");
+    CHECK(!CookedModel::isCurrent(source.c_str(), read));
+    writeFile(dir / "model.bin", "0123456789");
+    CHECK(CookedModel::isCurrent(source.c_str(), read));
+
+    writeFile(source, "{ \"asset\": { \"version\": \"2.1\" } }");
+    CHECK(!CookedModel::isCurrent(source.c_str(), read));
+
+    // A missing dependency can not be verified
+    writeFile(source, "{ \"asset\": { \"version\": \"2.0\" } }");
+    std::filesystem::remove(dir / "model.bin");
+    CHECK(!CookedModel::isCurrent(source.c_str(), read));
+
+    std::filesystem::remove_all(dir);
+}
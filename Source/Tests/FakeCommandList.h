@@ -0,0 +1,143 @@
+#pragma once
+
+#include <d3d12.h>
+
+#include <cstdint>
+
+// A command list that only counts what it is asked to record, so code that binds and draws through
+// ID3D12GraphicsCommandList can be checked and timed without a device. Calls the renderer does not
+// make on the draw path do nothing; the object is not reference counted and lives on the stack.
+class FakeCommandList final : public ID3D12GraphicsCommandList
+{
+public:
+    enum Call : uint32_t
+    {
+        PipelineState,
+        RootSignature,
+        RootConstantBuffer,
+        RootShaderResource,
+        RootDescriptorTable,
+        PrimitiveTopology,
+        VertexBuffers,
+        IndexBuffer,
+        DescriptorHeaps,
+        Draw,
+        CallCount
+    };
+
+    uint32_t calls[CallCount] = {};
+    uint64_t instances = 0;            // summed over every draw
+    uint64_t indices = 0;              // per instance, summed over the indexed draws
+
+    // Last values seen, for checks on what actually reached the list
+    ID3D12PipelineState* pipelineState = nullptr;
+    ID3D12RootSignature* rootSignature = nullptr;
+    uint64_t rootValues[16] = {};
+
+public:
+    void clear() { *this = FakeCommandList(); }
+
+    uint32_t count(Call call) const { return calls[call]; }
+    uint32_t rootArguments() const { return calls[RootConstantBuffer] + calls[RootShaderResource] + calls[RootDescriptorTable]; }
+    uint32_t stateCalls() const
+    {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < Draw; ++i)
+            total += calls[i];
+        return total;
+    }
+
+    // IUnknown / ID3D12Object / ID3D12DeviceChild / ID3D12CommandList
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override { *object = nullptr; return E_NOINTERFACE; }
+    ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+    ULONG STDMETHODCALLTYPE Release() override { return 1; }
+    HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+    HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void** device) override { *device = nullptr; return E_NOTIMPL; }
+    D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GetType() override { return D3D12_COMMAND_LIST_TYPE_DIRECT; }
+
+    // Counted
+    void STDMETHODCALLTYPE SetPipelineState(ID3D12PipelineState* state) override { pipelineState = state; ++calls[PipelineState]; }
+    void STDMETHODCALLTYPE SetGraphicsRootSignature(ID3D12RootSignature* signature) override { rootSignature = signature; ++calls[RootSignature]; }
+    void STDMETHODCALLTYPE SetGraphicsRootConstantBufferView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address) override
+    {
+        setRoot(parameter, address);
+        ++calls[RootConstantBuffer];
+    }
+    void STDMETHODCALLTYPE SetGraphicsRootShaderResourceView(UINT parameter, D3D12_GPU_VIRTUAL_ADDRESS address) override
+    {
+        setRoot(parameter, address);
+        ++calls[RootShaderResource];
+    }
+    void STDMETHODCALLTYPE SetGraphicsRootDescriptorTable(UINT parameter, D3D12_GPU_DESCRIPTOR_HANDLE handle) override
+    {
+        setRoot(parameter, handle.ptr);
+        ++calls[RootDescriptorTable];
+    }
+    void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY) override { ++calls[PrimitiveTopology]; }
+    void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, const D3D12_VERTEX_BUFFER_VIEW*) override { ++calls[VertexBuffers]; }
+    void STDMETHODCALLTYPE IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW*) override { ++calls[IndexBuffer]; }
+    void STDMETHODCALLTYPE SetDescriptorHeaps(UINT, ID3D12DescriptorHeap* const*) override { ++calls[DescriptorHeaps]; }
+    void STDMETHODCALLTYPE DrawInstanced(UINT, UINT instanceCount, UINT, UINT) override
+    {
+        instances += instanceCount;
+        ++calls[Draw];
+    }
+    void STDMETHODCALLTYPE DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT, INT, UINT) override
+    {
+        indices += indexCount;
+        instances += instanceCount;
+        ++calls[Draw];
+    }
+
+    // Ignored
+    HRESULT STDMETHODCALLTYPE Close() override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE Reset(ID3D12CommandAllocator*, ID3D12PipelineState* state) override { clear(); pipelineState = state; return S_OK; }
+    void STDMETHODCALLTYPE ClearState(ID3D12PipelineState*) override {}
+    void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) override {}
+    void STDMETHODCALLTYPE CopyBufferRegion(ID3D12Resource*, UINT64, ID3D12Resource*, UINT64, UINT64) override {}
+    void STDMETHODCALLTYPE CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION*, UINT, UINT, UINT, const D3D12_TEXTURE_COPY_LOCATION*, const D3D12_BOX*) override {}
+    void STDMETHODCALLTYPE CopyResource(ID3D12Resource*, ID3D12Resource*) override {}
+    void STDMETHODCALLTYPE CopyTiles(ID3D12Resource*, const D3D12_TILED_RESOURCE_COORDINATE*, const D3D12_TILE_REGION_SIZE*, ID3D12Resource*, UINT64, D3D12_TILE_COPY_FLAGS) override {}
+    void STDMETHODCALLTYPE ResolveSubresource(ID3D12Resource*, UINT, ID3D12Resource*, UINT, DXGI_FORMAT) override {}
+    void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D12_VIEWPORT*) override {}
+    void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D12_RECT*) override {}
+    void STDMETHODCALLTYPE OMSetBlendFactor(const FLOAT[4]) override {}
+    void STDMETHODCALLTYPE OMSetStencilRef(UINT) override {}
+    void STDMETHODCALLTYPE ResourceBarrier(UINT, const D3D12_RESOURCE_BARRIER*) override {}
+    void STDMETHODCALLTYPE ExecuteBundle(ID3D12GraphicsCommandList*) override {}
+    void STDMETHODCALLTYPE SetComputeRootSignature(ID3D12RootSignature*) override {}
+    void STDMETHODCALLTYPE SetComputeRootDescriptorTable(UINT, D3D12_GPU_DESCRIPTOR_HANDLE) override {}
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstant(UINT, UINT, UINT) override {}
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstant(UINT, UINT, UINT) override {}
+    void STDMETHODCALLTYPE SetComputeRoot32BitConstants(UINT, UINT, const void*, UINT) override {}
+    void STDMETHODCALLTYPE SetGraphicsRoot32BitConstants(UINT, UINT, const void*, UINT) override {}
+    void STDMETHODCALLTYPE SetComputeRootConstantBufferView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {}
+    void STDMETHODCALLTYPE SetComputeRootShaderResourceView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {}
+    void STDMETHODCALLTYPE SetComputeRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {}
+    void STDMETHODCALLTYPE SetGraphicsRootUnorderedAccessView(UINT, D3D12_GPU_VIRTUAL_ADDRESS) override {}
+    void STDMETHODCALLTYPE SOSetTargets(UINT, UINT, const D3D12_STREAM_OUTPUT_BUFFER_VIEW*) override {}
+    void STDMETHODCALLTYPE OMSetRenderTargets(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, BOOL, const D3D12_CPU_DESCRIPTOR_HANDLE*) override {}
+    void STDMETHODCALLTYPE ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CLEAR_FLAGS, FLOAT, UINT8, UINT, const D3D12_RECT*) override {}
+    void STDMETHODCALLTYPE ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE, const FLOAT[4], UINT, const D3D12_RECT*) override {}
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource*, const UINT[4], UINT, const D3D12_RECT*) override {}
+    void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, ID3D12Resource*, const FLOAT[4], UINT, const D3D12_RECT*) override {}
+    void STDMETHODCALLTYPE DiscardResource(ID3D12Resource*, const D3D12_DISCARD_REGION*) override {}
+    void STDMETHODCALLTYPE BeginQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT) override {}
+    void STDMETHODCALLTYPE EndQuery(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT) override {}
+    void STDMETHODCALLTYPE ResolveQueryData(ID3D12QueryHeap*, D3D12_QUERY_TYPE, UINT, UINT, ID3D12Resource*, UINT64) override {}
+    void STDMETHODCALLTYPE SetPredication(ID3D12Resource*, UINT64, D3D12_PREDICATION_OP) override {}
+    void STDMETHODCALLTYPE SetMarker(UINT, const void*, UINT) override {}
+    void STDMETHODCALLTYPE BeginEvent(UINT, const void*, UINT) override {}
+    void STDMETHODCALLTYPE EndEvent() override {}
+    void STDMETHODCALLTYPE ExecuteIndirect(ID3D12CommandSignature*, UINT, ID3D12Resource*, UINT64, ID3D12Resource*, UINT64) override {}
+
+private:
+    void setRoot(UINT parameter, uint64_t value)
+    {
+        if (parameter < 16)
+            rootValues[parameter] = value;
+    }
+};
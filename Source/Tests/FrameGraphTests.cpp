@@ -0,0 +1,265 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+
+namespace
+{
+    FrameGraph::TextureDesc makeColourDesc()
+    {
+        FrameGraph::TextureDesc desc;
+        desc.width = 256;
+        desc.height = 256;
+        return desc;
+    }
+
+    FrameGraph::TextureDesc makeDepthDesc()
+    {
+        FrameGraph::TextureDesc desc = makeColourDesc();
+        desc.format = DXGI_FORMAT_D32_FLOAT;
+        desc.flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+        return desc;
+    }
+
+    // describe() against the golden list, printing both when they differ
+    bool matchesGolden(const FrameGraph& graph, const char* expected)
+    {
+        const std::string got = graph.describe();
+        if (got == expected)
+            return true;
+
+        printf("  got:\n%s  expected:\n%s", got.c_str(), expected);
+        return false;
+    }
+}
+
+// ~FrameGraph destroys the descriptors of its placed resources, which live in the Application modules.
+// The tests never realize a graph, so there are none to free.
+RenderTargetDesc::~RenderTargetDesc() {}
+DepthStencilDesc::~DepthStencilDesc() {}
+
+// Nothing reads Unused, and the transient Depth is only written: its pass stays for the colour it writes
+TEST(FrameGraphCulling)
+{
+    D3D12_RESOURCE_STATES backBufferState = D3D12_RESOURCE_STATE_PRESENT;
+
+    FrameGraph graph;
+    const FrameGraph::ResourceHandle backBuffer = graph.importResource("BackBuffer", nullptr, backBufferState);
+    graph.setFinalState(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+    const FrameGraph::ResourceHandle colour = graph.createTexture("Colour", makeColourDesc());
+    const FrameGraph::ResourceHandle depth = graph.createTexture("Depth", makeDepthDesc());
+    const FrameGraph::ResourceHandle unused = graph.createTexture("Unused", makeColourDesc());
+
+    const uint32_t scene = graph.addPass("Scene", nullptr);
+    graph.write(scene, colour, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.write(scene, depth, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    graph.read(scene, depth, D3D12_RESOURCE_STATE_DEPTH_READ);
+
+    const uint32_t debug = graph.addPass("Unused", nullptr);
+    graph.read(debug, colour, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(debug, unused, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    const uint32_t ui = graph.addPass("UI", nullptr);
+    graph.read(ui, colour, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(ui, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    REQUIRE(graph.compile());
+    CHECK(matchesGolden(graph,
+        "Scene\n"
+        "Unused (culled)\n"
+        "UI\n"
+        "  BackBuffer: COMMON -> RENDER_TARGET\n"
+        "  Colour: RENDER_TARGET -> PIXEL_SHADER_RESOURCE\n"
+        "final\n"
+        "  BackBuffer: RENDER_TARGET -> COMMON\n"));
+
+    CHECK(graph.isCulled(debug) && !graph.isCulled(scene) && !graph.isCulled(ui));
+    CHECK(graph.getStats().culledPasses == 1);
+    CHECK(graph.getStats().transients == 2);
+}
+
+// A is dead before C is born, so C takes A's memory
+TEST(FrameGraphAliasing)
+{
+    D3D12_RESOURCE_STATES backBufferState = D3D12_RESOURCE_STATE_PRESENT;
+
+    FrameGraph graph;
+    const FrameGraph::ResourceHandle backBuffer = graph.importResource("BackBuffer", nullptr, backBufferState);
+    graph.setFinalState(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+    const FrameGraph::ResourceHandle a = graph.createTexture("A", makeColourDesc());
+    const FrameGraph::ResourceHandle b = graph.createTexture("B", makeColourDesc());
+    const FrameGraph::ResourceHandle c = graph.createTexture("C", makeColourDesc());
+
+    const uint32_t p0 = graph.addPass("P0", nullptr);
+    graph.write(p0, a, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    const uint32_t p1 = graph.addPass("P1", nullptr);
+    graph.read(p1, a, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(p1, b, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    const uint32_t p2 = graph.addPass("P2", nullptr);
+    graph.read(p2, b, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(p2, c, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    const uint32_t p3 = graph.addPass("P3", nullptr);
+    graph.read(p3, c, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(p3, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    REQUIRE(graph.compile());
+    CHECK(matchesGolden(graph,
+        "P0\n"
+        "  alias * -> A\n"
+        "P1\n"
+        "  A: RENDER_TARGET -> PIXEL_SHADER_RESOURCE\n"
+        "P2\n"
+        "  alias A -> C\n"
+        "  B: RENDER_TARGET -> PIXEL_SHADER_RESOURCE\n"
+        "P3\n"
+        "  BackBuffer: COMMON -> RENDER_TARGET\n"
+        "  C: RENDER_TARGET -> PIXEL_SHADER_RESOURCE\n"
+        "final\n"
+        "  BackBuffer: RENDER_TARGET -> COMMON\n"));
+
+    const FrameGraph::Stats& stats = graph.getStats();
+    CHECK(graph.getHeapOffset(a) == graph.getHeapOffset(c));
+    CHECK(graph.getHeapOffset(b) != graph.getHeapOffset(a));
+    CHECK(stats.heapBytes * 3 == stats.unaliasedBytes * 2);
+    CHECK(stats.aliasingBarriers == 2);
+}
+
+// Unordered access writes wait for each other; the reads that follow share one transition
+TEST(FrameGraphUavAndReadMerging)
+{
+    FrameGraph::TextureDesc uavDesc = makeColourDesc();
+    uavDesc.flags = D3D12_RESOURCE_FLAGS(D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+    FrameGraph graph;
+    const FrameGraph::ResourceHandle target = graph.createTexture("T", uavDesc);
+
+    const uint32_t w0 = graph.addPass("W0", nullptr);
+    graph.write(w0, target, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    const uint32_t w1 = graph.addPass("W1", nullptr);
+    graph.read(w1, target, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    graph.write(w1, target, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    const uint32_t r0 = graph.addPass("R0", nullptr);
+    graph.read(r0, target, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.setSideEffect(r0);
+    const uint32_t r1 = graph.addPass("R1", nullptr);
+    graph.read(r1, target, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    graph.setSideEffect(r1);
+    const uint32_t w2 = graph.addPass("W2", nullptr);
+    graph.write(w2, target, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    REQUIRE(graph.compile());
+    CHECK(matchesGolden(graph,
+        "W0\n"
+        "W1\n"
+        "  uav T\n"
+        "R0\n"
+        "  T: UNORDERED_ACCESS -> NON_PIXEL_SHADER_RESOURCE|PIXEL_SHADER_RESOURCE\n"
+        "R1\n"
+        "W2 (culled)\n"
+        "final\n"));
+}
+
+// MSAA resolve into an import left readable by the pixel shader
+TEST(FrameGraphResolve)
+{
+    D3D12_RESOURCE_STATES resolvedState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+    FrameGraph::TextureDesc msaaDesc = makeColourDesc();
+    msaaDesc.sampleCount = 4;
+
+    FrameGraph graph;
+    const FrameGraph::ResourceHandle resolved = graph.importResource("Resolved", nullptr, resolvedState);
+    graph.setFinalState(resolved, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    const FrameGraph::ResourceHandle msaa = graph.createTexture("MSAA", msaaDesc);
+
+    const uint32_t scene = graph.addPass("Scene", nullptr);
+    graph.write(scene, msaa, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.addResolvePass("Resolve", msaa, resolved, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+    REQUIRE(graph.compile());
+    CHECK(matchesGolden(graph,
+        "Scene\n"
+        "Resolve\n"
+        "  Resolved: PIXEL_SHADER_RESOURCE -> RESOLVE_DEST\n"
+        "  MSAA: RENDER_TARGET -> RESOLVE_SOURCE\n"
+        "final\n"
+        "  Resolved: RESOLVE_DEST -> PIXEL_SHADER_RESOURCE\n"));
+
+    CHECK(graph.getHeapOffset(msaa) == 0);
+    CHECK(graph.getStats().heapBytes == D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+}
+
+// Random graph of 200 passes over 1080p render targets and depth buffers, compile time only
+BENCHMARK(FrameGraphCompile200)
+{
+    constexpr uint32_t kPasses = 200;
+    constexpr uint32_t kRuns = 100;
+
+    std::mt19937 rng(1234);
+
+    D3D12_RESOURCE_STATES backBufferState = D3D12_RESOURCE_STATE_PRESENT;
+
+    FrameGraph graph;
+    const FrameGraph::ResourceHandle backBuffer = graph.importResource("BackBuffer", nullptr, backBufferState);
+    graph.setFinalState(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+
+    const DXGI_FORMAT colourFormats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R11G11B10_FLOAT };
+
+    // Every pass writes a target of its own (a depth buffer one in four), reads the last target and up to
+    // two more of the eight before it. One pass in ten is a debug view nobody reads: culled.
+    std::vector<FrameGraph::ResourceHandle> readable;
+    readable.reserve(kPasses);
+
+    for (uint32_t i = 0; i < kPasses; ++i)
+    {
+        const bool depth = (i % 4u) == 3u;
+        const bool unread = (i % 10u) == 9u;
+
+        FrameGraph::TextureDesc desc;
+        desc.width = 1920;
+        desc.height = 1080;
+        desc.format = depth ? DXGI_FORMAT_D32_FLOAT : colourFormats[rng() % 3u];
+        desc.flags = depth ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+        const FrameGraph::ResourceHandle target = graph.createTexture(("Target" + std::to_string(i)).c_str(), desc);
+        const uint32_t pass = graph.addPass(("Pass" + std::to_string(i)).c_str(), nullptr);
+
+        const uint32_t numReadable = uint32_t(readable.size());
+        if (numReadable > 0)
+        {
+            graph.read(pass, readable.back(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+            const uint32_t numReads = uint32_t(rng() % 3u);
+            for (uint32_t r = 0; r < numReads; ++r)
+                graph.read(pass, readable[numReadable - 1u - uint32_t(rng() % std::min(numReadable, 8u))], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        }
+
+        graph.write(pass, target, depth ? D3D12_RESOURCE_STATE_DEPTH_WRITE : D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+        if (!unread)
+            readable.push_back(target);
+    }
+
+    const uint32_t present = graph.addPass("Present", nullptr);
+    for (size_t i = readable.size() > 4 ? readable.size() - 4 : 0; i < readable.size(); ++i)
+        graph.read(present, readable[i], D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    graph.write(present, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t run = 0; run < kRuns; ++run)
+        CHECK(graph.compile());
+    const double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kRuns;
+
+    const FrameGraph::Stats& stats = graph.getStats();
+    CHECK(stats.culledPasses == kPasses / 10);
+    CHECK(stats.heapBytes < stats.unaliasedBytes);
+
+    printf("  %u passes (%u culled): compile %.3f ms, %u barriers in %u batches (%u aliasing), heap %.1f MB of %.1f MB\n",
+        stats.passes, stats.culledPasses, compileMs, stats.barriers, stats.batches, stats.aliasingBarriers,
+        double(stats.heapBytes) / (1024.0 * 1024.0), double(stats.unaliasedBytes) / (1024.0 * 1024.0));
+}
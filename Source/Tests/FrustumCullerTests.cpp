@@ -0,0 +1,210 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "FrustumCuller.h"
+
+#include <DirectXCollision.h>
+
+#include <chrono>
+#include <random>
+
+namespace
+{
+    struct Camera
+    {
+        Matrix view;
+        Matrix proj;
+        Vector4 planes[6];
+    };
+
+    Camera makeCamera(const Vector3& eye, const Vector3& target, float fovY, float aspect, float nearPlane, float farPlane)
+    {
+        Camera camera;
+        camera.view = Matrix::CreateLookAt(eye, target, Vector3::Up);
+        camera.proj = Matrix::CreatePerspectiveFieldOfView(fovY, aspect, nearPlane, farPlane);
+        FrustumCuller::extractPlanes(camera.view * camera.proj, camera.planes);
+        return camera;
+    }
+
+    // Cameras inside the random bounds, looking along and across the axes, narrow and wide
+    std::vector<Camera> makeCameras()
+    {
+        return
+        {
+            makeCamera(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), 1.0f, 16.0f / 9.0f, 0.1f, 200.0f),
+            makeCamera(Vector3(5.0f, 2.0f, -3.0f), Vector3(40.0f, -10.0f, 20.0f), 0.4f, 1.0f, 1.0f, 60.0f),
+            makeCamera(Vector3(-20.0f, 30.0f, 10.0f), Vector3(0.0f, 0.0f, 0.0f), 2.0f, 2.5f, 0.05f, 500.0f),
+            makeCamera(Vector3(0.0f, 0.0f, 90.0f), Vector3(0.0f, 0.0f, 200.0f), 1.2f, 1.0f, 0.1f, 50.0f),
+        };
+    }
+
+    // DirectXMath frustums look down +Z: build one from the projection slopes and turn it to -Z (right-handed view)
+    DirectX::BoundingFrustum makeReferenceFrustum(const Camera& camera)
+    {
+        const Matrix& proj = camera.proj;
+        const float nearPlane = proj._43 / proj._33;
+        const float farPlane = proj._43 / (proj._33 + 1.0f);
+        const float rightSlope = 1.0f / proj._11;
+        const float topSlope = 1.0f / proj._22;
+
+        DirectX::BoundingFrustum local(Vector3::Zero, Quaternion::Identity, rightSlope, -rightSlope, topSlope, -topSlope, nearPlane, farPlane);
+        DirectX::BoundingFrustum frustum;
+        local.Transform(frustum, Matrix::CreateRotationY(DirectX::XM_PI) * camera.view.Invert());
+        return frustum;
+    }
+
+    // Even indices: a sphere and its bounding cube, so sphere and box agree. Odd ones: a scaled, rotated box
+    // through setBounds, which also gives the circumsphere.
+    void fillRandomBounds(FrustumCuller& culler, uint32_t count, std::mt19937& rng, std::vector<DirectX::BoundingSphere>* spheres)
+    {
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+        std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+
+        culler.resize(count);
+        if (spheres)
+            spheres->assign(count, DirectX::BoundingSphere());
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const Vector3 center(position(rng), position(rng), position(rng));
+
+            if (i % 2 == 0 || spheres)
+            {
+                const float r = size(rng);
+                culler.setBounds(i, center, r, center, Vector3(r, r, r));
+                if (spheres)
+                    (*spheres)[i] = DirectX::BoundingSphere(center, r);
+            }
+            else
+            {
+                const Matrix world = Matrix::CreateScale(size(rng), size(rng), size(rng)) *
+                    Matrix::CreateFromYawPitchRoll(angle(rng), angle(rng), angle(rng)) * Matrix::CreateTranslation(center);
+                culler.setBounds(i, Vector3(-1.0f, -0.5f, -2.0f), Vector3(1.0f, 1.5f, 0.5f), world);
+            }
+        }
+    }
+}
+
+// The SSE path returns exactly the scalar list, in order, for counts around the 4-wide blocks and several frusta;
+// padding lanes are never reported
+TEST(FrustumCullerMatchesScalar)
+{
+    std::mt19937 rng(1234);
+    const std::vector<Camera> cameras = makeCameras();
+
+    uint32_t mismatches = 0;
+    uint32_t outOfRange = 0;
+    uint32_t numVisible = 0;
+
+    for (uint32_t count : { 0u, 1u, 3u, 4u, 5u, 7u, 8u, 1001u, 100003u })
+    {
+        FrustumCuller culler;
+        fillRandomBounds(culler, count, rng, nullptr);
+
+        for (const Camera& camera : cameras)
+        {
+            std::vector<uint32_t> sse, scalar;
+            culler.cull(camera.planes, sse);
+            culler.cullScalar(camera.planes, scalar);
+
+            mismatches += sse == scalar ? 0 : 1;
+            for (uint32_t index : sse)
+                outOfRange += index < count ? 0 : 1;
+
+            numVisible += uint32_t(sse.size());
+        }
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(outOfRange == 0);
+    CHECK(numVisible > 0);
+
+    // Camera 0 sits at the origin looking down -Z with the near plane at 0.1: bounds straddling it stay visible,
+    // bounds behind the camera are culled, by both paths
+    FrustumCuller culler;
+    culler.resize(2);
+    culler.setBounds(0, Vector3(0.0f, 0.0f, -0.1f), 0.05f, Vector3(0.0f, 0.0f, -0.1f), Vector3(0.05f, 0.05f, 0.05f));
+    culler.setBounds(1, Vector3(0.0f, 0.0f, 0.5f), 0.1f, Vector3(0.0f, 0.0f, 0.5f), Vector3(0.1f, 0.1f, 0.1f));
+
+    std::vector<uint32_t> visible;
+    CHECK(culler.cull(cameras[0].planes, visible) == 1 && visible[0] == 0);
+    CHECK(culler.cullScalar(cameras[0].planes, visible) == 1 && visible[0] == 0);
+}
+
+// The plane test is conservative: every sphere DirectX::BoundingFrustum keeps is kept. Corner cases it rejects
+// may stay visible.
+TEST(FrustumCullerConservative)
+{
+    std::mt19937 rng(99);
+    const std::vector<Camera> cameras = makeCameras();
+
+    FrustumCuller culler;
+    std::vector<DirectX::BoundingSphere> spheres;
+    fillRandomBounds(culler, 200000, rng, &spheres);
+
+    uint32_t missed = 0;
+
+    for (const Camera& camera : cameras)
+    {
+        const DirectX::BoundingFrustum frustum = makeReferenceFrustum(camera);
+
+        std::vector<uint32_t> visible;
+        culler.cull(camera.planes, visible);
+
+        std::vector<uint8_t> kept(spheres.size(), 0);
+        for (uint32_t index : visible)
+            kept[index] = 1;
+
+        uint32_t numReference = 0;
+        for (size_t i = 0; i < spheres.size(); ++i)
+        {
+            const bool reference = frustum.Intersects(spheres[i]);
+            numReference += reference ? 1 : 0;
+            missed += (reference && !kept[i]) ? 1 : 0;
+        }
+
+        printf("  %u of %zu visible, BoundingFrustum %u\n", uint32_t(visible.size()), spheres.size(), numReference);
+    }
+
+    CHECK(missed == 0);
+}
+
+// A million bounds around the camera: SSE path, scalar path and BoundingFrustum against the spheres
+BENCHMARK(FrustumCuller1M)
+{
+    constexpr uint32_t kBounds = 1000000;
+
+    std::mt19937 rng(1234);
+    FrustumCuller culler;
+    std::vector<DirectX::BoundingSphere> spheres;
+    fillRandomBounds(culler, kBounds, rng, &spheres);
+
+    const Camera camera = makeCameras()[0];
+
+    std::vector<uint32_t> visible;
+    visible.reserve(kBounds);
+
+    auto time = [](auto&& function)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+    uint32_t numVisible = 0;
+    const double sseMs = time([&]() { numVisible = culler.cull(camera.planes, visible); });
+    const double scalarMs = time([&]() { culler.cullScalar(camera.planes, visible); });
+
+    const DirectX::BoundingFrustum frustum = makeReferenceFrustum(camera);
+
+    uint32_t numReference = 0;
+    const double referenceMs = time([&]()
+        {
+            for (const DirectX::BoundingSphere& sphere : spheres)
+                numReference += frustum.Intersects(sphere) ? 1 : 0;
+        });
+
+    printf("  %u bounds, %u visible: SSE %.2f ms, scalar %.2f ms (%.2fx), BoundingFrustum %.2f ms (%u visible)\n",
+        kBounds, numVisible, sseMs, scalarMs, scalarMs / sseMs, referenceMs, numReference);
+}
@@ -0,0 +1,201 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "GltfFile.h"
+
+#include "json.hpp"
+
+#include <psapi.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // Per primitive: float3 positions and normals, float2 uvs, then 16-bit indices
+    constexpr uint32_t kVertexBytes = 32;
+
+    size_t getWorkingSet()
+    {
+        PROCESS_MEMORY_COUNTERS counters = {};
+        return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+    }
+
+    // Writes the same scene twice, as name.glb (JSON and BIN chunks) and as name.gltf with an external name.bin
+    void writeScene(const std::filesystem::path& dir, const std::string& name, uint32_t numPrimitives, uint32_t numVertices)
+    {
+        const uint32_t numIndices = numVertices * 3;
+        const size_t vertexBytes = size_t(numVertices) * kVertexBytes;
+        const size_t primitiveBytes = vertexBytes + size_t(numIndices) * sizeof(uint16_t);
+        const size_t binBytes = primitiveBytes * numPrimitives;
+
+        nlohmann::json doc;
+        doc["asset"]["version"] = "2.0";
+        doc["scene"] = 0;
+        doc["scenes"] = nlohmann::json::array({ { { "nodes", nlohmann::json::array() } } });
+
+        nlohmann::json views = nlohmann::json::array();
+        nlohmann::json accessors = nlohmann::json::array();
+        nlohmann::json meshes = nlohmann::json::array();
+
+        for (uint32_t p = 0; p < numPrimitives; ++p)
+        {
+            const size_t base = primitiveBytes * p;
+            const size_t view = views.size();
+
+            views.push_back({ { "buffer", 0 }, { "byteOffset", base }, { "byteLength", vertexBytes }, { "byteStride", kVertexBytes } });
+            views.push_back({ { "buffer", 0 }, { "byteOffset", base + vertexBytes }, { "byteLength", primitiveBytes - vertexBytes } });
+
+            const size_t accessor = accessors.size();
+            accessors.push_back({ { "bufferView", view }, { "byteOffset", 0 }, { "componentType", 5126 }, { "count", numVertices }, { "type", "VEC3" },
+                { "min", { 0.0, 0.0, 0.0 } }, { "max", { 1.0, 1.0, 1.0 } } });
+            accessors.push_back({ { "bufferView", view }, { "byteOffset", 12 }, { "componentType", 5126 }, { "count", numVertices }, { "type", "VEC3" } });
+            accessors.push_back({ { "bufferView", view }, { "byteOffset", 24 }, { "componentType", 5126 }, { "count", numVertices }, { "type", "VEC2" } });
+            accessors.push_back({ { "bufferView", view + 1 }, { "componentType", 5123 }, { "count", numIndices }, { "type", "SCALAR" } });
+
+            meshes.push_back({ { "primitives", { { { "attributes", { { "POSITION", accessor }, { "NORMAL", accessor + 1 }, { "TEXCOORD_0", accessor + 2 } } },
+                { "indices", accessor + 3 } } } } });
+
+            doc["scenes"][0]["nodes"].push_back(p);
+            doc["nodes"].push_back({ { "mesh", p } });
+        }
+
+        doc["bufferViews"] = views;
+        doc["accessors"] = accessors;
+        doc["meshes"] = meshes;
+        doc["buffers"] = nlohmann::json::array({ { { "byteLength", binBytes } } });
+
+        // One primitive's worth of data, repeated: the loader never looks at the values
+        std::vector<uint8_t> primitive(primitiveBytes);
+        for (uint32_t v = 0; v < numVertices; ++v)
+        {
+            const float vertex[8] = { float(v % 97) / 97.0f, float(v % 89) / 89.0f, float(v % 83) / 83.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f };
+            memcpy(&primitive[size_t(v) * kVertexBytes], vertex, sizeof(vertex));
+        }
+        for (uint32_t i = 0; i < numIndices; ++i)
+        {
+            const uint16_t index = uint16_t((i / 3 + i % 3) % numVertices);
+            memcpy(&primitive[vertexBytes + size_t(i) * sizeof(uint16_t)], &index, sizeof(index));
+        }
+
+        auto writeBin = [&](std::ofstream& out)
+            {
+                for (uint32_t p = 0; p < numPrimitives; ++p)
+                    out.write(reinterpret_cast<const char*>(primitive.data()), std::streamsize(primitive.size()));
+            };
+
+        // GLB: 12-byte header, JSON chunk padded with spaces, BIN chunk (every size here is already a multiple of 4)
+        std::string json = doc.dump();
+        json.resize(alignUp(json.size(), 4), ' ');
+
+        const uint32_t header[5] = { 0x46546C67, 2, uint32_t(12 + 8 + json.size() + 8 + binBytes), uint32_t(json.size()), 0x4E4F534A };
+        const uint32_t binHeader[2] = { uint32_t(binBytes), 0x004E4942 };
+
+        std::ofstream glb(dir / (name + ".glb"), std::ios::binary);
+        glb.write(reinterpret_cast<const char*>(header), sizeof(header));
+        glb.write(json.data(), std::streamsize(json.size()));
+        glb.write(reinterpret_cast<const char*>(binHeader), sizeof(binHeader));
+        writeBin(glb);
+
+        doc["buffers"][0]["uri"] = name + ".bin";
+
+        std::ofstream gltf(dir / (name + ".gltf"), std::ios::binary);
+        gltf << doc.dump();
+
+        std::ofstream bin(dir / (name + ".bin"), std::ios::binary);
+        writeBin(bin);
+    }
+
+    // Touches every cache line of every buffer, as decoding the accessors would
+    uint64_t readBuffers(const GltfFile& file)
+    {
+        uint64_t sum = 0;
+        for (const GltfBufferSpan& buffer : file.getBuffers())
+        {
+            for (size_t i = 0; i < buffer.size; i += 64)
+                sum += buffer.data[i];
+        }
+
+        return sum;
+    }
+}
+
+// The .glb and its .gltf + .bin twin give the same buffers, mapped with zeroCopy and copied without
+TEST(GltfFileZeroCopyMatchesCopied)
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "GltfFileTests";
+    std::filesystem::create_directories(dir);
+    writeScene(dir, "small", 8, 300);
+
+    std::vector<uint8_t> reference;
+
+    for (const char* extension : { ".glb", ".gltf" })
+    {
+        for (bool zeroCopy : { true, false })
+        {
+            GltfFile file;
+            std::string error, warning;
+            REQUIRE(file.load((dir / (std::string("small") + extension)).string().c_str(), zeroCopy, error, warning));
+
+            const GltfFile::Stats& stats = file.getStats();
+            CHECK(stats.binary == (std::string(extension) == ".glb"));
+            CHECK(stats.zeroCopy == zeroCopy);
+            CHECK((stats.mappedBufferBytes > 0) == zeroCopy && (stats.copiedBufferBytes > 0) == !zeroCopy);
+            CHECK(file.getModel().meshes.size() == 8 && file.getModel().accessors.size() == 32);
+
+            REQUIRE(file.getBuffers().size() == 1);
+            const GltfBufferSpan& buffer = file.getBuffers()[0];
+            if (reference.empty())
+                reference.assign(buffer.data, buffer.data + buffer.size);
+
+            CHECK(buffer.size == reference.size() && memcmp(buffer.data, reference.data(), reference.size()) == 0);
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+// Loading a large scene: the mapped .glb (or .bin) against tinygltf's copy. Working set is sampled after the load
+// and again after every buffer byte was read, as the accessor decode does.
+BENCHMARK(GltfFileLoad)
+{
+    constexpr uint32_t kPrimitives = 2000;
+    constexpr uint32_t kVertices = 2000;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "GltfFileBench";
+    std::filesystem::create_directories(dir);
+    writeScene(dir, "large", kPrimitives, kVertices);
+
+    for (const char* extension : { ".glb", ".gltf" })
+    {
+        for (bool zeroCopy : { true, false })
+        {
+            const std::string fileName = (dir / (std::string("large") + extension)).string();
+            const size_t workingSetStart = getWorkingSet();
+
+            GltfFile file;
+            std::string error, warning;
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool loaded = file.load(fileName.c_str(), zeroCopy, error, warning);
+            const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const size_t workingSetLoaded = getWorkingSet();
+
+            REQUIRE(loaded);
+            const uint64_t checksum = readBuffers(file);
+            const double readMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const size_t workingSetRead = getWorkingSet();
+
+            CHECK(checksum != 0);
+
+            const GltfFile::Stats& stats = file.getStats();
+            printf("  %-5s %-9s %.1f MB: load %.1f ms, +read %.1f ms, working set +%.1f MB after load, +%.1f MB after read\n",
+                extension, zeroCopy ? "zero-copy" : "copied", double(stats.mappedBufferBytes + stats.copiedBufferBytes) / (1024.0 * 1024.0),
+                loadMs, readMs - loadMs, (double(workingSetLoaded) - double(workingSetStart)) / (1024.0 * 1024.0),
+                (double(workingSetRead) - double(workingSetStart)) / (1024.0 * 1024.0));
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+}
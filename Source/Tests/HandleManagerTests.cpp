@@ -0,0 +1,258 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "HandleManager.h"
+#include "ConcurrentHandleManager.h"
+#include "DeferredFreeHandleManager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    constexpr size_t kCapacity = 4096;
+    constexpr uint32_t kThreads = 8;
+    constexpr uint32_t kMaxLivePerThread = 400;   // kThreads * this stays under the capacity
+
+    // Frames the GPU runs behind the CPU, as with FRAMES_IN_FLIGHT
+    constexpr uint64_t kFrameLatency = 2;
+
+    // Alloc/free pairs in batches of kBatch, so the free list is pushed and popped in runs
+    template <typename AllocFn, typename FreeFn>
+    double runChurn(uint32_t numThreads, uint32_t opsPerThread, AllocFn&& allocFn, FreeFn&& freeFn)
+    {
+        constexpr uint32_t kBatch = 64;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&]()
+                {
+                    uint32_t handles[kBatch];
+                    for (uint32_t op = 0; op < opsPerThread; op += kBatch)
+                    {
+                        for (uint32_t i = 0; i < kBatch; ++i)
+                            handles[i] = allocFn();
+                        for (uint32_t i = 0; i < kBatch; ++i)
+                            freeFn(handles[i]);
+                    }
+                });
+        }
+
+        for (std::thread& thread : threads)
+            thread.join();
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ms * 1e6 / (double(numThreads) * opsPerThread);
+    }
+}
+
+TEST(HandleManagerFreeCount)
+{
+    static HandleManager<64> manager;
+
+    CHECK(manager.getFreeCount() == 63);
+
+    const uint32_t handle = manager.allocHandle();
+    CHECK(manager.validHandle(handle));
+    CHECK(manager.getFreeCount() == 62);
+
+    manager.freeHandle(handle);
+    CHECK(!manager.validHandle(handle));
+    CHECK(manager.getFreeCount() == 63);
+
+    // The slot comes back with a new generation: the old handle stays invalid
+    const uint32_t again = manager.allocHandle();
+    CHECK(manager.indexFromHandle(again) == (handle & 0x00FFFFFFu));
+    CHECK(again != handle);
+    CHECK(!manager.validHandle(handle));
+    manager.freeHandle(again);
+}
+
+// Every thread allocates up to kMaxLivePerThread handles, then frees them all, over and over. An owner flag
+// per index catches two threads holding the same slot.
+TEST(ConcurrentHandleManagerStress)
+{
+    static ConcurrentHandleManager<kCapacity> manager;
+    static std::atomic<uint8_t> owned[kCapacity];
+
+    constexpr uint32_t kIterations = 200000;
+
+    std::atomic<uint32_t> invalidAllocs{ 0 };
+    std::atomic<uint32_t> doubleAllocs{ 0 };
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&]()
+            {
+                std::vector<uint32_t> handles;
+                handles.reserve(kMaxLivePerThread);
+
+                for (uint32_t it = 0; it < kIterations; ++it)
+                {
+                    if (handles.size() < kMaxLivePerThread)
+                    {
+                        const uint32_t handle = manager.allocHandle();
+                        if (!manager.validHandle(handle))
+                            invalidAllocs.fetch_add(1, std::memory_order_relaxed);
+                        else if (owned[manager.indexFromHandle(handle)].exchange(1) != 0)
+                            doubleAllocs.fetch_add(1, std::memory_order_relaxed);
+
+                        handles.push_back(handle);
+                        continue;
+                    }
+
+                    for (uint32_t handle : handles)
+                    {
+                        owned[handle & 0x00FFFFFFu].store(0);
+                        manager.freeHandle(handle);
+                    }
+
+                    handles.clear();
+                }
+
+                for (uint32_t handle : handles)
+                {
+                    owned[handle & 0x00FFFFFFu].store(0);
+                    manager.freeHandle(handle);
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    CHECK(invalidAllocs.load() == 0);
+    CHECK(doubleAllocs.load() == 0);
+    CHECK(manager.getFreeCount() == kCapacity - 1);
+
+    // Once the threads are done, a freed handle must stop validating
+    const uint32_t handle = manager.allocHandle();
+    CHECK(manager.validHandle(handle));
+    manager.freeHandle(handle);
+    CHECK(!manager.validHandle(handle));
+}
+
+// Lock-free alloc/free against the single-threaded HandleManager behind a mutex, 1 to kThreads threads
+BENCHMARK(ConcurrentHandleManagerBench)
+{
+    static ConcurrentHandleManager<kCapacity> concurrent;
+    static HandleManager<kCapacity> locked;
+    static std::mutex mutex;
+
+    constexpr uint32_t kOpsPerThread = 1u << 20;
+
+    for (uint32_t numThreads = 1; numThreads <= kThreads; numThreads *= 2)
+    {
+        const double lockFreeNs = runChurn(numThreads, kOpsPerThread,
+            []() { return concurrent.allocHandle(); },
+            [](uint32_t handle) { concurrent.freeHandle(handle); });
+
+        const double mutexNs = runChurn(numThreads, kOpsPerThread,
+            []() { std::lock_guard<std::mutex> lock(mutex); return locked.allocHandle(); },
+            [](uint32_t handle) { std::lock_guard<std::mutex> lock(mutex); locked.freeHandle(handle); });
+
+        printf("  %u threads: lock-free %.1f ns/op, mutex %.1f ns/op\n", numThreads, lockFreeNs, mutexNs);
+    }
+
+    CHECK(concurrent.getFreeCount() == kCapacity - 1);
+    CHECK(locked.getFreeCount() == kCapacity - 1);
+}
+
+// Handles retired at frame f come back once f completes, never earlier, each exactly once
+TEST(DeferredFreeHandleManagerRetirement)
+{
+    static DeferredFreeHandleManager<kCapacity> manager;
+    static uint64_t retiredAt[kCapacity];
+
+    constexpr uint32_t kPerFrame = 100;
+
+    uint32_t early = 0;
+    uint32_t notPending = 0;
+    uint32_t maxPending = 0;
+
+    std::vector<uint32_t> live;
+
+    for (uint64_t frame = 1; frame < 2000; ++frame)
+    {
+        for (uint32_t i = 0; i < kPerFrame; ++i)
+            live.push_back(manager.allocHandle());
+
+        for (uint32_t i = 0; i < kPerFrame; ++i)
+        {
+            const uint32_t handle = live.back();
+            live.pop_back();
+
+            retiredAt[manager.indexFromHandle(handle)] = frame;
+            manager.deferRelease(handle, frame);
+
+            // A second release of the same handle in the same frame is ignored
+            if (i % 7 == 0)
+                manager.deferRelease(handle, frame);
+        }
+
+        if (frame > kFrameLatency)
+        {
+            const uint64_t completed = frame - kFrameLatency;
+            manager.collectGarbage(completed, [&](uint32_t handle)
+                {
+                    const uint32_t index = handle & 0x00FFFFFFu;
+                    early += retiredAt[index] > completed ? 1 : 0;
+                    notPending += retiredAt[index] == 0 ? 1 : 0;
+                    retiredAt[index] = 0;
+                });
+        }
+
+        maxPending = std::max(maxPending, uint32_t(manager.getPendingCount()));
+    }
+
+    CHECK(early == 0);
+    CHECK(notPending == 0);
+    CHECK(maxPending <= kPerFrame * (kFrameLatency + 1));
+
+    manager.forceCollectGarbage();
+    CHECK(manager.getPendingCount() == 0);
+    CHECK(manager.getFreeCount() == kCapacity - 1);
+}
+
+// ModuleShaderDescriptors capacity, churned at frame rates far over 100k handles per second
+BENCHMARK(DeferredFreeHandleManagerChurn)
+{
+    static DeferredFreeHandleManager<kCapacity> manager;
+
+    constexpr uint32_t kPerFrame = 1000;
+    constexpr uint64_t kFrames = 2000;
+
+    std::vector<uint32_t> live;
+    live.reserve(kPerFrame);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t frame = 1; frame <= kFrames; ++frame)
+    {
+        for (uint32_t i = 0; i < kPerFrame; ++i)
+            live.push_back(manager.allocHandle());
+
+        for (uint32_t handle : live)
+            manager.deferRelease(handle, frame);
+        live.clear();
+
+        if (frame > kFrameLatency)
+            manager.collectGarbage(frame - kFrameLatency);
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const double numHandles = double(kPerFrame) * kFrames;
+
+    printf("  %.0f handles in %.2f ms: %.1f ns per alloc+defer+collect, %.1fM handles/s\n",
+        numHandles, ms, ms * 1e6 / numHandles, numHandles / ms / 1000.0);
+
+    manager.forceCollectGarbage();
+    CHECK(manager.getFreeCount() == kCapacity - 1);
+}
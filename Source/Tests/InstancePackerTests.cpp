@@ -0,0 +1,172 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "InstancePacker.h"
+#include "SceneGraph.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    // Root, then numGroups group nodes with numLeaves leaves each: the leaves are the mesh instances
+    void buildScene(SceneGraph& graph, std::vector<uint32_t>& leaves, uint32_t numGroups, uint32_t numLeaves)
+    {
+        graph.clear();
+        leaves.clear();
+
+        const uint32_t root = graph.addNode(SceneGraph::kNoParent, Vector3::Zero, Quaternion::Identity, Vector3(0.01f, 0.01f, 0.01f));
+        for (uint32_t g = 0; g < numGroups; ++g)
+        {
+            const uint32_t group = graph.addNode(int32_t(root), Vector3(float(g) * 100.0f, 0.0f, 0.0f),
+                Quaternion::CreateFromYawPitchRoll(0.1f * float(g), 0.0f, 0.0f), Vector3::One);
+
+            for (uint32_t l = 0; l < numLeaves; ++l)
+            {
+                leaves.push_back(graph.addNode(int32_t(group), Vector3(0.0f, 0.0f, float(l) * 50.0f), Quaternion::Identity,
+                    Vector3(1.0f, 2.0f, 1.0f), int32_t(l)));
+            }
+        }
+
+        graph.update();
+    }
+
+    std::vector<Vector3> makeCopies(uint32_t count)
+    {
+        std::vector<Vector3> copies;
+        for (uint32_t c = 0; c < count; ++c)
+            copies.push_back(Vector3(0.0f, 0.0f, float(c) * 4.0f));
+
+        return copies;
+    }
+
+    // What the packer must hold for one item, built the long way
+    bool itemMatches(const InstancePacker& packer, uint32_t item, const SceneGraph& graph, uint32_t node, const Vector3& offset, const Matrix& dequant)
+    {
+        const Matrix world = graph.getWorld(node) * Matrix::CreateTranslation(offset);
+        const InstancePacker::InstanceData& data = packer.getItemData(item);
+
+        return packer.getItemWorld(item) == world && data.modelMat == (dequant * world).Transpose() &&
+            data.normalMat == InstancePacker::computeNormalMatrixSafe(graph.getWorld(node)).Transpose();
+    }
+}
+
+// Moving one node repacks the instances under it, in every copy, and leaves every other item as it was
+TEST(InstancePackerRepacksMovedNode)
+{
+    constexpr uint32_t kGroups = 10;
+    constexpr uint32_t kLeaves = 5;
+    constexpr uint32_t kInstances = kGroups * kLeaves;
+
+    SceneGraph graph;
+    std::vector<uint32_t> leaves;
+    buildScene(graph, leaves, kGroups, kLeaves);
+
+    const std::vector<Vector3> copies = makeCopies(3);
+    const Matrix dequant = Matrix::CreateScale(2.0f);
+
+    InstancePacker packer;
+    CHECK(packer.update(graph, leaves.data(), kInstances, copies, dequant).size() == kInstances);
+    REQUIRE(packer.getNumItems() == kInstances * 3);
+
+    uint32_t mismatches = 0;
+    for (uint32_t item = 0; item < packer.getNumItems(); ++item)
+        mismatches += itemMatches(packer, item, graph, leaves[item % kInstances], copies[item / kInstances], dequant) ? 0 : 1;
+    CHECK(mismatches == 0);
+
+    // Nothing moved
+    CHECK(packer.update(graph, leaves.data(), kInstances, copies, dequant).empty());
+
+    std::vector<InstancePacker::InstanceData> before(packer.getNumItems());
+    for (uint32_t item = 0; item < packer.getNumItems(); ++item)
+        before[item] = packer.getItemData(item);
+
+    graph.setTranslation(leaves[17], Vector3(1.0f, 2.0f, 3.0f));
+    graph.update();
+
+    const std::vector<uint32_t> repacked = packer.update(graph, leaves.data(), kInstances, copies, dequant);
+    CHECK(repacked == std::vector<uint32_t>{ 17 });
+
+    uint32_t changedOthers = 0;
+    uint32_t wrongMoved = 0;
+    for (uint32_t item = 0; item < packer.getNumItems(); ++item)
+    {
+        const bool moved = item % kInstances == 17;
+        const bool same = memcmp(&before[item], &packer.getItemData(item), sizeof(InstancePacker::InstanceData)) == 0;
+
+        if (moved)
+            wrongMoved += (!same && itemMatches(packer, item, graph, leaves[17], copies[item / kInstances], dequant)) ? 0 : 1;
+        else
+            changedOthers += same ? 0 : 1;
+    }
+
+    CHECK(wrongMoved == 0);
+    CHECK(changedOthers == 0);
+
+    // A group node carries its leaves along
+    graph.setRotation(uint32_t(graph.getParent(leaves[15])), Quaternion::CreateFromYawPitchRoll(0.5f, 0.0f, 0.0f));
+    graph.update();
+    CHECK(packer.update(graph, leaves.data(), kInstances, copies, dequant) == (std::vector<uint32_t>{ 15, 16, 17, 18, 19 }));
+
+    // Invalidated, or with another number of copies, everything is packed again
+    packer.invalidate();
+    CHECK(packer.update(graph, leaves.data(), kInstances, copies, dequant).size() == kInstances);
+
+    const std::vector<Vector3> fewer = makeCopies(2);
+    CHECK(packer.update(graph, leaves.data(), kInstances, fewer, dequant).size() == kInstances);
+    CHECK(packer.getNumItems() == kInstances * 2);
+
+    // A rebuilt graph hands out new versions even where the nodes look the same
+    buildScene(graph, leaves, kGroups, kLeaves);
+    CHECK(packer.update(graph, leaves.data(), kInstances, fewer, dequant).size() == kInstances);
+}
+
+// Packing 10k instances in 4 copies each frame while a few nodes move: keyed by world version against
+// repacking everything, as Assignment2Module's instance cache toggle does
+BENCHMARK(InstancePackerCache)
+{
+    constexpr uint32_t kGroups = 100;
+    constexpr uint32_t kLeaves = 100;
+    constexpr uint32_t kInstances = kGroups * kLeaves;
+    constexpr uint32_t kFrames = 100;
+
+    SceneGraph graph;
+    std::vector<uint32_t> leaves;
+    buildScene(graph, leaves, kGroups, kLeaves);
+
+    const std::vector<Vector3> copies = makeCopies(4);
+    const Matrix dequant = Matrix::CreateScale(1.0f / 1024.0f);
+
+    for (uint32_t movedPerFrame : { 1u, 100u })
+    {
+        for (bool cached : { true, false })
+        {
+            std::mt19937 rng(5);
+            InstancePacker packer;
+            packer.update(graph, leaves.data(), kInstances, copies, dequant);
+
+            double ms = 0.0;
+            uint64_t repacked = 0;
+
+            for (uint32_t frame = 0; frame < kFrames; ++frame)
+            {
+                for (uint32_t m = 0; m < movedPerFrame; ++m)
+                    graph.setTranslation(leaves[rng() % kInstances], Vector3(float(frame), 0.0f, float(m)));
+                graph.update();
+
+                const auto start = std::chrono::steady_clock::now();
+                if (!cached)
+                    packer.invalidate();
+                repacked += packer.update(graph, leaves.data(), kInstances, copies, dequant).size();
+                ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            CHECK(cached ? repacked <= uint64_t(movedPerFrame) * kFrames : repacked == uint64_t(kInstances) * kFrames);
+
+            printf("  %u items, %3u nodes moved per frame, %-8s %.3f ms, %.0f instances repacked per frame\n",
+                kInstances * uint32_t(copies.size()), movedPerFrame, cached ? "cached" : "repacked", ms / kFrames,
+                double(repacked) / kFrames);
+        }
+    }
+}
@@ -0,0 +1,287 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "JobSystem.h"
+#include "ModuleStageGraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    // Stand-in for a module: fixed arithmetic in every stage, so the same work runs whatever thread picks it up
+    class SyntheticModule : public Module
+    {
+    public:
+        SyntheticModule(uint32_t workPerStage, bool onWorker) : workPerStage(workPerStage), onWorker(onWorker) {}
+
+        void update() override { runStage(); }
+        void preRender() override { runStage(); }
+        void render() override { runStage(); }
+        void postRender() override { runStage(); }
+        bool canRunOnWorker(ModuleStage /*stage*/) const override { return onWorker; }
+
+        double getResult() const { return result; }
+
+    private:
+        void runStage()
+        {
+            double x = result;
+            for (uint32_t i = 0; i < workPerStage; ++i)
+                x = std::sqrt(x + double(i));
+            result = x;
+        }
+
+        uint32_t workPerStage = 0;
+        bool onWorker = false;
+        double result = 0.0;
+    };
+
+    // Every stage appends the module's id to the log; main thread stages also note when they ran elsewhere
+    struct StageLog
+    {
+        std::mutex mutex;
+        std::vector<int> order;
+        std::atomic<uint32_t> offMainThread{ 0 };
+        std::thread::id caller = std::this_thread::get_id();
+    };
+
+    class RecordingModule : public Module
+    {
+    public:
+        RecordingModule(StageLog& log, int id, bool onWorker, uint32_t spin = 0) : log(log), id(id), onWorker(onWorker), spin(spin) {}
+
+        void update() override { record(); }
+        void preRender() override { record(); }
+        void render() override { record(); }
+        void postRender() override { record(); }
+        bool canRunOnWorker(ModuleStage /*stage*/) const override { return onWorker; }
+
+        void getStageDependencies(ModuleStage /*stage*/, std::vector<const Module*>& deps) const override
+        {
+            deps.insert(deps.end(), dependsOn.begin(), dependsOn.end());
+        }
+
+        std::vector<const Module*> dependsOn;
+
+    private:
+        void record()
+        {
+            // Keeps a dependency busy long enough for an unordered dependent to overtake it
+            volatile uint32_t sink = 0;
+            for (uint32_t i = 0; i < spin; ++i)
+                sink += i;
+
+            if (!onWorker && std::this_thread::get_id() != log.caller)
+                log.offMainThread.fetch_add(1);
+
+            std::lock_guard<std::mutex> lock(log.mutex);
+            log.order.push_back(id);
+        }
+
+        StageLog& log;
+        int id = 0;
+        bool onWorker = false;
+        uint32_t spin = 0;
+    };
+
+    size_t positionOf(const std::vector<int>& order, int id)
+    {
+        return size_t(std::find(order.begin(), order.end(), id) - order.begin());
+    }
+}
+
+// Graphs from buildModuleStageGraph: main thread modules run on the thread calling execute() in list order,
+// the framing module first in PreRender, last in PostRender, in the list in Update and not at all in Render
+TEST(ModuleStageGraphOrder)
+{
+    constexpr int kFramingId = -1;
+    constexpr int kWorkerId = 100;
+    constexpr int kMainModules = 4;
+    constexpr int kWorkerModules = 8;
+
+    for (uint32_t numWorkers : { 0u, 1u, 3u, 7u })
+    {
+        JobSystem jobs(numWorkers);
+        StageLog log;
+
+        std::vector<std::unique_ptr<RecordingModule>> owned;
+        std::vector<Module*> modules;
+
+        owned.push_back(std::make_unique<RecordingModule>(log, kFramingId, false));
+        Module* framing = owned.back().get();
+        modules.push_back(framing);
+
+        for (int i = 0; i < kMainModules + kWorkerModules; ++i)
+        {
+            const bool onWorker = (i % 3) != 0;
+            owned.push_back(std::make_unique<RecordingModule>(log, onWorker ? kWorkerId : i, onWorker));
+            modules.push_back(owned.back().get());
+        }
+
+        uint32_t badOrders = 0;
+        for (uint32_t s = 0; s < uint32_t(ModuleStage::Count); ++s)
+        {
+            const ModuleStage stage = ModuleStage(s);
+
+            JobGraph graph;
+            buildModuleStageGraph(graph, stage, modules, framing);
+
+            for (uint32_t frame = 0; frame < 200; ++frame)
+            {
+                log.order.clear();
+                jobs.execute(graph);
+
+                std::vector<int> mainOrder;
+                for (int id : log.order)
+                {
+                    if (id != kWorkerId && id != kFramingId)
+                        mainOrder.push_back(id);
+                }
+
+                const size_t framingRuns = size_t(std::count(log.order.begin(), log.order.end(), kFramingId));
+                bool ok = log.order.size() == modules.size() - (stage == ModuleStage::Render ? 1 : 0);
+                ok = ok && framingRuns == (stage == ModuleStage::Render ? 0u : 1u);
+                ok = ok && mainOrder.size() == size_t(kMainModules) && std::is_sorted(mainOrder.begin(), mainOrder.end());
+                if (stage == ModuleStage::PreRender)
+                    ok = ok && log.order.front() == kFramingId;
+                if (stage == ModuleStage::PostRender)
+                    ok = ok && log.order.back() == kFramingId;
+
+                badOrders += ok ? 0 : 1;
+            }
+        }
+
+        CHECK(badOrders == 0);
+        CHECK(log.offMainThread.load() == 0);
+    }
+}
+
+// Declared dependencies across modules hold: a worker module after another worker module, and a main
+// thread module after a worker one. The dependencies spin, so without the edges the others overtake them.
+TEST(ModuleStageGraphDependencies)
+{
+    enum : int { kSlowWorker = 1, kAfterSlowWorker, kMain, kMainAfterWorker, kFreeWorker };
+
+    for (uint32_t numWorkers : { 0u, 1u, 3u })
+    {
+        JobSystem jobs(numWorkers);
+        StageLog log;
+
+        RecordingModule slowWorker(log, kSlowWorker, true, 200000);
+        RecordingModule afterSlowWorker(log, kAfterSlowWorker, true);
+        RecordingModule main(log, kMain, false);
+        RecordingModule mainAfterWorker(log, kMainAfterWorker, false);
+        RecordingModule freeWorker(log, kFreeWorker, true, 200000);
+
+        afterSlowWorker.dependsOn.push_back(&slowWorker);
+        mainAfterWorker.dependsOn.push_back(&freeWorker);
+
+        // Dependents listed first, so list order alone would not give the right one
+        const std::vector<Module*> modules = { &afterSlowWorker, &mainAfterWorker, &main, &slowWorker, &freeWorker };
+
+        JobGraph graph;
+        buildModuleStageGraph(graph, ModuleStage::Render, modules, nullptr);
+
+        uint32_t badOrders = 0;
+        for (uint32_t frame = 0; frame < 200; ++frame)
+        {
+            log.order.clear();
+            jobs.execute(graph);
+
+            const bool ok = log.order.size() == modules.size() &&
+                positionOf(log.order, kSlowWorker) < positionOf(log.order, kAfterSlowWorker) &&
+                positionOf(log.order, kFreeWorker) < positionOf(log.order, kMainAfterWorker);
+            badOrders += ok ? 0 : 1;
+        }
+
+        CHECK(badOrders == 0);
+        CHECK(log.offMainThread.load() == 0);
+    }
+}
+
+// Every index is visited exactly once, also when count is not a multiple of the grain size
+TEST(JobSystemParallelFor)
+{
+    constexpr uint32_t kCount = 100003;
+
+    for (uint32_t numWorkers : { 0u, 1u, 3u, 7u })
+    {
+        JobSystem jobs(numWorkers);
+        std::vector<std::atomic<uint8_t>> visits(kCount);
+
+        jobs.parallelFor(kCount, 64, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                    visits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+
+        uint32_t wrong = 0;
+        for (const std::atomic<uint8_t>& visit : visits)
+            wrong += visit.load() == 1 ? 0 : 1;
+
+        CHECK(wrong == 0);
+    }
+}
+
+// Frame time of a synthetic module list driven through the stage graphs Application builds, from 0 workers
+// (the old serial loop) up to the default worker count. The main thread chain bounds how far it can scale.
+BENCHMARK(JobSystemModuleScaling)
+{
+    constexpr uint32_t kMainModules = 4;
+    constexpr uint32_t kWorkerModules = 12;
+    constexpr uint32_t kFrames = 200;
+
+    std::vector<uint32_t> workerCounts = { 0, 1, 2, 4, 8, 16 };
+    const uint32_t maxWorkers = std::max(1u, JobSystem::getDefaultWorkerCount());
+    workerCounts.erase(std::remove_if(workerCounts.begin(), workerCounts.end(),
+        [maxWorkers](uint32_t count) { return count > maxWorkers; }), workerCounts.end());
+    if (workerCounts.back() != maxWorkers)
+        workerCounts.push_back(maxWorkers);
+
+    double serialMs = 0.0;
+
+    for (uint32_t numWorkers : workerCounts)
+    {
+        std::vector<std::unique_ptr<SyntheticModule>> owned;
+        owned.push_back(std::make_unique<SyntheticModule>(2000, false));
+        for (uint32_t i = 0; i < kMainModules; ++i)
+            owned.push_back(std::make_unique<SyntheticModule>(2000, false));
+        for (uint32_t i = 0; i < kWorkerModules; ++i)
+            owned.push_back(std::make_unique<SyntheticModule>(20000, true));
+
+        std::vector<Module*> modules;
+        for (const auto& module : owned)
+            modules.push_back(module.get());
+
+        JobSystem jobs(numWorkers);
+        JobGraph graphs[uint32_t(ModuleStage::Count)];
+        for (uint32_t s = 0; s < uint32_t(ModuleStage::Count); ++s)
+            buildModuleStageGraph(graphs[s], ModuleStage(s), modules, modules.front());
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t frame = 0; frame < kFrames; ++frame)
+        {
+            for (JobGraph& graph : graphs)
+                jobs.execute(graph);
+        }
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kFrames;
+        if (numWorkers == 0)
+            serialMs = ms;
+
+        printf("  %2u workers: %.3f ms/frame, %.2fx\n", numWorkers, ms, serialMs / ms);
+
+        // Work is the same whatever the schedule: keep the optimiser from dropping it
+        double checksum = 0.0;
+        for (const auto& module : owned)
+            checksum += module->getResult();
+        CHECK(checksum > 0.0);
+    }
+}
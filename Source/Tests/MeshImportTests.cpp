@@ -0,0 +1,483 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "BasicMesh.h"
+#include "PackedGeometry.h"
+#include "JobSystem.h"
+#include "gltf_utils.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t kGridVariants = 16;
+
+    template <typename T>
+    int appendAccessor(tinygltf::Model& model, const std::vector<T>& data, int componentType, int type, size_t count)
+    {
+        std::vector<unsigned char>& bytes = model.buffers[0].data;
+
+        tinygltf::BufferView view;
+        view.buffer = 0;
+        view.byteOffset = bytes.size();
+        view.byteLength = data.size() * sizeof(T);
+
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(data.data());
+        bytes.insert(bytes.end(), src, src + view.byteLength);
+        bytes.resize(alignUp(bytes.size(), 4));
+
+        tinygltf::Accessor accessor;
+        accessor.bufferView = int(model.bufferViews.size());
+        accessor.componentType = componentType;
+        accessor.type = type;
+        accessor.count = count;
+
+        model.bufferViews.push_back(view);
+        model.accessors.push_back(accessor);
+        return int(model.accessors.size()) - 1;
+    }
+
+    // A wavy (n + 1) x (n + 1) grid with every attribute BasicMesh reads, 16-bit indices
+    tinygltf::Primitive appendGrid(tinygltf::Model& model, uint32_t n)
+    {
+        const uint32_t numVertices = (n + 1) * (n + 1);
+
+        std::vector<float> positions, normals, texCoords, tangents;
+        for (uint32_t y = 0; y <= n; ++y)
+        {
+            for (uint32_t x = 0; x <= n; ++x)
+            {
+                const float u = float(x) / float(n);
+                const float v = float(y) / float(n);
+
+                positions.insert(positions.end(), { u, 0.1f * std::sin(u * 6.0f) * std::cos(v * 4.0f), v });
+                normals.insert(normals.end(), { 0.0f, 1.0f, 0.0f });
+                texCoords.insert(texCoords.end(), { u, v });
+                tangents.insert(tangents.end(), { 1.0f, 0.0f, 0.0f, 1.0f });
+            }
+        }
+
+        std::vector<uint16_t> indices;
+        for (uint32_t y = 0; y < n; ++y)
+        {
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                const uint16_t a = uint16_t(y * (n + 1) + x);
+                const uint16_t b = uint16_t(a + 1);
+                const uint16_t c = uint16_t(a + n + 1);
+                const uint16_t d = uint16_t(c + 1);
+                indices.insert(indices.end(), { a, c, d, a, d, b });
+            }
+        }
+
+        tinygltf::Primitive primitive;
+        primitive.attributes["POSITION"] = appendAccessor(model, positions, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, numVertices);
+        primitive.attributes["NORMAL"] = appendAccessor(model, normals, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, numVertices);
+        primitive.attributes["TEXCOORD_0"] = appendAccessor(model, texCoords, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC2, numVertices);
+        primitive.attributes["TANGENT"] = appendAccessor(model, tangents, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC4, numVertices);
+        primitive.indices = appendAccessor(model, indices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT, TINYGLTF_TYPE_SCALAR, indices.size());
+        primitive.mode = TINYGLTF_MODE_TRIANGLES;
+        return primitive;
+    }
+
+    // numVertices points on a line, one triangle per consecutive three: the least data that references them all
+    tinygltf::Primitive appendStrip(tinygltf::Model& model, uint32_t numVertices)
+    {
+        std::vector<float> positions;
+        for (uint32_t i = 0; i < numVertices; ++i)
+            positions.insert(positions.end(), { float(i) / float(numVertices), float(i % 2), 0.0f });
+
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i + 2 < numVertices; ++i)
+            indices.insert(indices.end(), { i, i + 1, i + 2 });
+
+        tinygltf::Primitive primitive;
+        primitive.attributes["POSITION"] = appendAccessor(model, positions, TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC3, numVertices);
+        primitive.indices = appendAccessor(model, indices, TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TYPE_SCALAR, indices.size());
+        primitive.mode = TINYGLTF_MODE_TRIANGLES;
+        return primitive;
+    }
+
+    // numPrimitives primitives over kGridVariants grids of 4x4 to 19x19 quads, ten per mesh. Primitives share the
+    // accessors of their grid, which keeps the buffer small; the decode work is the same.
+    void buildSyntheticModel(uint32_t numPrimitives, tinygltf::Model& model, GltfBuffers& buffers)
+    {
+        model = tinygltf::Model();
+        model.buffers.resize(1);
+
+        std::vector<tinygltf::Primitive> grids;
+        for (uint32_t v = 0; v < kGridVariants; ++v)
+            grids.push_back(appendGrid(model, 4 + v));
+
+        for (uint32_t p = 0; p < numPrimitives; ++p)
+        {
+            if (p % 10 == 0)
+                model.meshes.emplace_back().name = "synthetic";
+
+            model.meshes.back().primitives.push_back(grids[p % kGridVariants]);
+        }
+
+        buffers.assign(1, GltfBufferSpan{ model.buffers[0].data.data(), model.buffers[0].data.size() });
+    }
+
+    // BasicModel::loadMeshes without the device: one importPrimitive per primitive, fanned out when jobs has workers
+    void importAll(const tinygltf::Model& model, const GltfBuffers& buffers, JobSystem& jobs, std::vector<BasicMesh>& meshes,
+        std::vector<std::vector<BasicMesh>>& parts, std::vector<BasicMesh::ImportStats>& stats)
+    {
+        std::vector<std::pair<const tinygltf::Mesh*, const tinygltf::Primitive*>> primitives;
+        for (const tinygltf::Mesh& mesh : model.meshes)
+        {
+            for (const tinygltf::Primitive& primitive : mesh.primitives)
+                primitives.emplace_back(&mesh, &primitive);
+        }
+
+        const uint32_t numPrimitives = uint32_t(primitives.size());
+        meshes.clear();
+        meshes.resize(numPrimitives);
+        parts.clear();
+        parts.resize(numPrimitives);
+        stats.assign(numPrimitives, {});
+
+        auto decode = [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                    meshes[i].importPrimitive(model, buffers, *primitives[i].first, *primitives[i].second, true, parts[i], stats[i]);
+            };
+
+        if (jobs.getNumWorkers() > 0)
+            jobs.parallelFor(numPrimitives, std::max(1u, numPrimitives / (jobs.getNumThreads() * 4)), decode);
+        else
+            decode(0, numPrimitives);
+    }
+
+    bool sameMesh(const BasicMesh& a, const BasicMesh& b)
+    {
+        if (a.getNumVertices() != b.getNumVertices() || a.getNumIndices() != b.getNumIndices() ||
+            a.getLodIndices() != b.getLodIndices() || a.getMeshlets().size() != b.getMeshlets().size())
+            return false;
+
+        return std::equal(a.getIndices(), a.getIndices() + a.getNumIndices(), b.getIndices()) &&
+            memcmp(a.getVertices(), b.getVertices(), sizeof(BasicMesh::Vertex) * a.getNumVertices()) == 0;
+    }
+}
+
+// Attributes and indices come through as written, and the grids get LODs and meshlets
+TEST(MeshImportDecode)
+{
+    tinygltf::Model model;
+    GltfBuffers buffers;
+    buildSyntheticModel(kGridVariants, model, buffers);
+
+    JobSystem jobs(0);
+    std::vector<BasicMesh> meshes;
+    std::vector<std::vector<BasicMesh>> parts;
+    std::vector<BasicMesh::ImportStats> stats;
+    importAll(model, buffers, jobs, meshes, parts, stats);
+
+    uint32_t badCounts = 0;
+    uint32_t badVertices = 0;
+    uint32_t missingLods = 0;
+
+    for (uint32_t v = 0; v < kGridVariants; ++v)
+    {
+        const uint32_t n = 4 + v;
+        const BasicMesh& mesh = meshes[v];
+
+        badCounts += (mesh.getNumVertices() != (n + 1) * (n + 1) || mesh.getNumIndices() != n * n * 6 ||
+            !parts[v].empty() || mesh.getMeshlets().empty()) ? 1 : 0;
+
+        // optimize() reorders vertices: check every one lies on the grid with its attributes intact
+        for (uint32_t i = 0; i < mesh.getNumVertices(); ++i)
+        {
+            const BasicMesh::Vertex& vertex = mesh.getVertices()[i];
+            const float u = vertex.position.x;
+            const float w = vertex.position.z;
+
+            const bool ok = std::abs(vertex.position.y - 0.1f * std::sin(u * 6.0f) * std::cos(w * 4.0f)) < 1e-5f &&
+                vertex.texCoord0.x == u && vertex.texCoord0.y == w && vertex.normal.y == 1.0f && vertex.tangent.w == 1.0f;
+            badVertices += ok ? 0 : 1;
+        }
+
+        // Over kMinLodTriangles every grid has at least one coarser level
+        if (n * n * 2 >= 128)
+            missingLods += stats[v].numLods == 0 ? 1 : 0;
+    }
+
+    CHECK(badCounts == 0);
+    CHECK(badVertices == 0);
+    CHECK(missingLods == 0);
+}
+
+// A grid of 65536 vertices comes out in two 16-bit parts holding every triangle, each with its own LODs and
+// meshlets; one of 65025 is kept whole
+TEST(MeshImportSplit)
+{
+    for (uint32_t n : { 254u, 255u })
+    {
+        tinygltf::Model model;
+        model.buffers.resize(1);
+        model.meshes.emplace_back().primitives.push_back(appendGrid(model, n));
+
+        const GltfBuffers buffers(1, GltfBufferSpan{ model.buffers[0].data.data(), model.buffers[0].data.size() });
+
+        BasicMesh mesh;
+        std::vector<BasicMesh> parts;
+        BasicMesh::ImportStats stats;
+        mesh.importPrimitive(model, buffers, model.meshes[0], model.meshes[0].primitives[0], true, parts, stats);
+
+        const uint32_t numVertices = (n + 1) * (n + 1);
+        REQUIRE(mesh.getNumVertices() == numVertices);
+        CHECK(parts.size() == (numVertices > MeshOptimizer::kMax16BitVertices ? 2 : 0));
+
+        uint32_t numIndices = 0;
+        for (const BasicMesh& part : parts)
+        {
+            CHECK(part.getNumVertices() <= MeshOptimizer::kMax16BitVertices);
+            // The cut leaves the last part a sliver, too small to simplify
+            CHECK(part.getNumIndices() < 128 * 3 || part.getNumLods() > 1);
+            CHECK(!part.getMeshlets().empty());
+            numIndices += part.getNumIndices();
+        }
+
+        CHECK(parts.empty() || numIndices == mesh.getNumIndices());
+
+        // split() itself leaves the chains to the caller, even when the source has them
+        if (!parts.empty())
+        {
+            REQUIRE(mesh.buildLods() > 0);
+            REQUIRE(mesh.split(MeshOptimizer::kMax16BitVertices, parts));
+
+            for (const BasicMesh& part : parts)
+                CHECK(part.getNumLods() == 1 && part.getMeshlets().empty());
+        }
+    }
+}
+
+// Decoding is per primitive: a parallel import gives the same meshes as a serial one
+TEST(MeshImportParallelMatchesSerial)
+{
+    tinygltf::Model model;
+    GltfBuffers buffers;
+    buildSyntheticModel(200, model, buffers);
+
+    JobSystem serialJobs(0);
+    std::vector<BasicMesh> serial;
+    std::vector<std::vector<BasicMesh>> serialParts;
+    std::vector<BasicMesh::ImportStats> serialStats;
+    importAll(model, buffers, serialJobs, serial, serialParts, serialStats);
+
+    JobSystem jobs(3);
+    std::vector<BasicMesh> parallel;
+    std::vector<std::vector<BasicMesh>> parallelParts;
+    std::vector<BasicMesh::ImportStats> parallelStats;
+    importAll(model, buffers, jobs, parallel, parallelParts, parallelStats);
+
+    REQUIRE(serial.size() == parallel.size());
+
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < serial.size(); ++i)
+    {
+        mismatches += (sameMesh(serial[i], parallel[i]) && serialStats[i].numLods == parallelStats[i].numLods &&
+            serialStats[i].cacheAfter.numTransforms == parallelStats[i].cacheAfter.numTransforms) ? 0 : 1;
+    }
+
+    CHECK(mismatches == 0);
+}
+
+// Every primitive of a model lands in one vertex and one index buffer, back to back, with each mesh's indices
+// still relative to its own base vertex. Indices stay 16-bit until one indexed mesh has more than 65535 vertices.
+TEST(PackGeometryMultiPrimitive)
+{
+    tinygltf::Model model;
+    GltfBuffers buffers;
+    buildSyntheticModel(40, model, buffers);
+
+    JobSystem jobs(0);
+    std::vector<std::vector<BasicMesh>> parts;
+    std::vector<BasicMesh::ImportStats> stats;
+
+    const Vector3 boundsMin(0.0f, -0.1f, 0.0f);
+    const Vector3 boundsMax(1.0f, 0.1f, 1.0f);
+
+    // The imported grids (with LOD indices after level 0) alone, then with one more mesh loaded whole
+    // (BasicMesh::load does not split) right at and just over the 16-bit limit
+    for (uint32_t bigVertices : { 0u, MeshOptimizer::kMax16BitVertices, MeshOptimizer::kMax16BitVertices + 1 })
+    {
+        std::vector<BasicMesh> modelMeshes;
+        importAll(model, buffers, jobs, modelMeshes, parts, stats);
+
+        tinygltf::Model big;
+        if (bigVertices > 0)
+        {
+            big.buffers.resize(1);
+            big.meshes.emplace_back().primitives.push_back(appendStrip(big, bigVertices));
+
+            const GltfBuffers bigBuffers(1, GltfBufferSpan{ big.buffers[0].data.data(), big.buffers[0].data.size() });
+            modelMeshes.emplace_back().load(big, bigBuffers, big.meshes[0], big.meshes[0].primitives[0]);
+            REQUIRE(modelMeshes.back().getNumVertices() == bigVertices);
+        }
+
+        const bool expect16 = bigVertices <= MeshOptimizer::kMax16BitVertices;
+
+        for (BasicMesh::VertexFormat format : { BasicMesh::VertexFormat::Full, BasicMesh::VertexFormat::PackedQuantized })
+        {
+            PackedGeometry packed;
+            packGeometry(modelMeshes, format, boundsMin, boundsMax, packed);
+
+            const uint32_t stride = BasicMesh::getVertexStride(format);
+
+            CHECK(packed.use16BitIndices == expect16);
+            CHECK(packed.vertexStride == stride);
+            REQUIRE(packed.baseVertices.size() == modelMeshes.size() && packed.firstIndices.size() == modelMeshes.size());
+
+            size_t totalVertices = 0;
+            size_t totalIndices = 0;
+            uint32_t badOffsets = 0;
+            uint32_t badVertices = 0;
+            uint32_t badIndices = 0;
+            std::vector<uint8_t> expected;
+
+            for (size_t m = 0; m < modelMeshes.size(); ++m)
+            {
+                const BasicMesh& mesh = modelMeshes[m];
+                badOffsets += (packed.baseVertices[m] == totalVertices && packed.firstIndices[m] == totalIndices) ? 0 : 1;
+
+                expected.resize(size_t(mesh.getNumVertices()) * stride);
+                BasicMesh::packVertices(mesh.getVertices(), mesh.getNumVertices(), format, boundsMin, boundsMax, expected.data());
+                badVertices += memcmp(&packed.vertices[totalVertices * stride], expected.data(), expected.size()) == 0 ? 0 : 1;
+
+                std::vector<uint32_t> indices(mesh.getIndices(), mesh.getIndices() + mesh.getNumIndices());
+                indices.insert(indices.end(), mesh.getLodIndices().begin(), mesh.getLodIndices().end());
+
+                for (size_t i = 0; i < indices.size(); ++i)
+                {
+                    const size_t at = totalIndices + i;
+                    const uint32_t index = expect16 ? reinterpret_cast<const uint16_t*>(packed.indices.data())[at] :
+                        reinterpret_cast<const uint32_t*>(packed.indices.data())[at];
+                    badIndices += index == indices[i] ? 0 : 1;
+                }
+
+                totalVertices += mesh.getNumVertices();
+                totalIndices += indices.size();
+            }
+
+            // Two uploads for the whole model, and these two buffers hold every byte of it
+            CHECK(packed.vertices.size() == totalVertices * stride);
+            CHECK(packed.indices.size() == totalIndices * (expect16 ? 2 : 4));
+            CHECK(badOffsets == 0);
+            CHECK(badVertices == 0);
+            CHECK(badIndices == 0);
+        }
+    }
+}
+
+// Primitives per second importing a synthetic 10k-primitive glTF, from 0 workers up to the default count
+BENCHMARK(MeshImport10k)
+{
+    constexpr uint32_t kPrimitives = 10000;
+
+    tinygltf::Model model;
+    GltfBuffers buffers;
+    buildSyntheticModel(kPrimitives, model, buffers);
+
+    std::vector<uint32_t> workerCounts = { 0, 1, 2, 4, 8, 16 };
+    const uint32_t maxWorkers = std::max(1u, JobSystem::getDefaultWorkerCount());
+    workerCounts.erase(std::remove_if(workerCounts.begin(), workerCounts.end(),
+        [maxWorkers](uint32_t count) { return count > maxWorkers; }), workerCounts.end());
+    if (workerCounts.back() != maxWorkers)
+        workerCounts.push_back(maxWorkers);
+
+    double serialMs = 0.0;
+
+    for (uint32_t numWorkers : workerCounts)
+    {
+        JobSystem jobs(numWorkers);
+        std::vector<BasicMesh> meshes;
+        std::vector<std::vector<BasicMesh>> parts;
+        std::vector<BasicMesh::ImportStats> stats;
+
+        const auto start = std::chrono::steady_clock::now();
+        importAll(model, buffers, jobs, meshes, parts, stats);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (numWorkers == 0)
+            serialMs = ms;
+
+        uint32_t numLods = 0;
+        for (const BasicMesh::ImportStats& primitiveStats : stats)
+            numLods += primitiveStats.numLods;
+
+        printf("  %2u workers: %.1f ms, %.0f primitives/s, %.2fx, %u LODs\n", numWorkers, ms,
+            kPrimitives * 1000.0 / ms, serialMs / ms, numLods);
+
+        CHECK(meshes.size() == kPrimitives);
+    }
+}
+
+// Simplification speed of the LOD chain on a 250x250 grid, then the level BasicMesh::selectLod picks for a 20 m
+// patch of it from near to far, as Assignment2Module does per instance, with the triangles that saves
+BENCHMARK(MeshLodDistanceSweep)
+{
+    constexpr uint32_t kRuns = 5;
+    constexpr float kViewportHeight = 1080.0f;
+    constexpr float kErrorPixels = 1.0f;
+
+    tinygltf::Model model;
+    model.buffers.resize(1);
+    model.meshes.emplace_back().primitives.push_back(appendGrid(model, 250));
+    const GltfBuffers buffers(1, GltfBufferSpan{ model.buffers[0].data.data(), model.buffers[0].data.size() });
+
+    BasicMesh mesh;
+    std::vector<BasicMesh> parts;
+    BasicMesh::ImportStats stats;
+    mesh.importPrimitive(model, buffers, model.meshes[0], model.meshes[0].primitives[0], true, parts, stats);
+    REQUIRE(parts.empty());
+
+    double ms = 0.0;
+    for (uint32_t run = 0; run < kRuns; ++run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        mesh.buildLods();
+        ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const uint32_t fullTriangles = mesh.getNumIndices() / 3;
+    const float maxError = BasicMesh::kMaxLodRelativeError * (mesh.getBoundsMax() - mesh.getBoundsMin()).Length() * 0.5f;
+    REQUIRE(mesh.getNumLods() > 1);
+
+    printf("  buildLods: %.2f ms for %u triangles (%.1f M triangles/s)\n", ms / kRuns, fullTriangles, fullTriangles * kRuns / (ms * 1000.0));
+    for (uint32_t lod = 0; lod < mesh.getNumLods(); ++lod)
+    {
+        printf("    LOD %u: %6u triangles, error %.5f\n", lod, mesh.getLodNumIndices(lod) / 3, mesh.getLodError(lod));
+        CHECK(mesh.getLodError(lod) <= maxError);
+        CHECK(lod == 0 || mesh.getLodNumIndices(lod) < mesh.getLodNumIndices(lod - 1));
+    }
+
+    const Matrix world = Matrix::CreateScale(20.0f);
+    const Matrix proj = Matrix::CreatePerspectiveFieldOfView(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 5000.0f);
+    const Vector3 center(10.0f, 0.0f, 10.0f);
+
+    uint32_t previousLod = 0;
+    for (float distance : { 5.0f, 15.0f, 18.0f, 22.0f, 26.0f, 30.0f, 60.0f, 250.0f, 1000.0f })
+    {
+        const Vector3 eye = center + Vector3(0.0f, 0.5f, 1.0f) * (distance / Vector3(0.0f, 0.5f, 1.0f).Length());
+        const Matrix view = Matrix::CreateLookAt(eye, center, Vector3(0.0f, 1.0f, 0.0f));
+
+        const float pixelsPerUnit = mesh.getPixelsPerUnit(world, view, proj, kViewportHeight);
+        const uint32_t lod = mesh.selectLod(pixelsPerUnit, kErrorPixels);
+        const uint32_t triangles = mesh.getLodNumIndices(lod) / 3;
+
+        printf("  %6.0f m: %8.1f px/unit, LOD %u, %6u triangles drawn, %5.1f%% saved\n", distance,
+            pixelsPerUnit == FLT_MAX ? -1.0f : pixelsPerUnit, lod, triangles, 100.0 * (1.0 - double(triangles) / fullTriangles));
+
+        // Further away never picks a finer level
+        CHECK(lod >= previousLod);
+        previousLod = lod;
+    }
+
+    CHECK(previousLod == mesh.getNumLods() - 1);
+}
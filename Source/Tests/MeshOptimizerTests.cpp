@@ -0,0 +1,614 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <random>
+
+namespace
+{
+    struct Grid
+    {
+        uint32_t numVertices = 0;
+        std::vector<float> positions;   // xyz
+        std::vector<uint32_t> indices;
+    };
+
+    // n x n quads over a wavy surface, triangles wound counter-clockwise seen from +z
+    Grid makeGrid(uint32_t n)
+    {
+        Grid grid;
+        grid.numVertices = (n + 1) * (n + 1);
+
+        for (uint32_t y = 0; y <= n; ++y)
+        {
+            for (uint32_t x = 0; x <= n; ++x)
+                grid.positions.insert(grid.positions.end(), { float(x), float(y), 0.3f * std::sin(float(x) * 0.3f) });
+        }
+
+        for (uint32_t y = 0; y < n; ++y)
+        {
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                const uint32_t a = y * (n + 1) + x;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + n + 1;
+                const uint32_t d = c + 1;
+                grid.indices.insert(grid.indices.end(), { a, b, c, b, d, c });
+            }
+        }
+
+        return grid;
+    }
+
+    void shuffleTriangles(std::vector<uint32_t>& indices, std::mt19937& rng)
+    {
+        for (size_t t = indices.size() / 3 - 1; t > 0; --t)
+        {
+            const size_t other = rng() % (t + 1);
+            std::swap_ranges(indices.begin() + t * 3, indices.begin() + t * 3 + 3, indices.begin() + other * 3);
+        }
+    }
+
+    using Triangle = std::array<float, 9>;
+
+    // Triangles by position, rotated to start at their smallest corner so the winding is kept, then sorted:
+    // equal for two lists that draw the same triangles whatever the vertex and triangle order
+    std::vector<Triangle> canonicalTriangles(const std::vector<uint32_t>& indices, const std::vector<float>& positions)
+    {
+        std::vector<Triangle> triangles;
+        for (size_t t = 0; t < indices.size() / 3; ++t)
+        {
+            Triangle corners;
+            for (uint32_t k = 0; k < 3; ++k)
+                std::copy_n(&positions[indices[t * 3 + k] * 3], 3, corners.begin() + k * 3);
+
+            uint32_t first = 0;
+            for (uint32_t k = 1; k < 3; ++k)
+            {
+                if (std::lexicographical_compare(corners.begin() + k * 3, corners.begin() + k * 3 + 3,
+                    corners.begin() + first * 3, corners.begin() + first * 3 + 3))
+                    first = k;
+            }
+
+            Triangle rotated;
+            for (uint32_t k = 0; k < 3; ++k)
+                std::copy_n(corners.begin() + ((k + first) % 3) * 3, 3, rotated.begin() + k * 3);
+
+            triangles.push_back(rotated);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // Straightforward FIFO post-transform cache, independent of MeshOptimizer's own
+    uint32_t countCacheMisses(const std::vector<uint32_t>& indices, uint32_t cacheSize)
+    {
+        std::deque<uint32_t> cache;
+        uint32_t misses = 0;
+
+        for (uint32_t index : indices)
+        {
+            if (std::find(cache.begin(), cache.end(), index) != cache.end())
+                continue;
+
+            ++misses;
+            cache.push_back(index);
+            if (cache.size() > cacheSize)
+                cache.pop_front();
+        }
+
+        return misses;
+    }
+}
+
+// analyzeVertexCache against a plain FIFO simulation, on hand-checked lists and on random ones
+TEST(VertexCacheSimulator)
+{
+    const std::vector<uint32_t> triangle = { 0, 1, 2 };
+    const MeshOptimizer::VertexCacheStats single = MeshOptimizer::analyzeVertexCache(triangle.data(), triangle.size(), 3);
+    CHECK(single.numTriangles == 1 && single.numVertices == 3 && single.numTransforms == 3);
+    CHECK(single.getAcmr() == 3.0f && single.getAtvr() == 1.0f);
+
+    // A quad shares two vertices
+    const std::vector<uint32_t> quad = { 0, 1, 2, 1, 3, 2 };
+    CHECK(MeshOptimizer::analyzeVertexCache(quad.data(), quad.size(), 4).numTransforms == 4);
+
+    // Round-robin over one vertex more than the cache holds: FIFO misses every time
+    std::vector<uint32_t> thrash;
+    for (uint32_t i = 0; i < 30; ++i)
+    {
+        for (uint32_t v = 0; v < 3; ++v)
+            thrash.push_back((i * 3 + v) % (MeshOptimizer::kSimulatedCacheSize + 1));
+    }
+    CHECK(MeshOptimizer::analyzeVertexCache(thrash.data(), thrash.size(), MeshOptimizer::kSimulatedCacheSize + 1).numTransforms == 90);
+
+    std::mt19937 rng(4);
+    uint32_t mismatches = 0;
+    for (uint32_t run = 0; run < 50; ++run)
+    {
+        const uint32_t numVertices = 8 + rng() % 64;
+        std::vector<uint32_t> indices(3 * (1 + rng() % 200));
+        for (uint32_t& index : indices)
+            index = rng() % numVertices;
+
+        for (uint32_t cacheSize : { 8u, 16u, 32u })
+        {
+            const MeshOptimizer::VertexCacheStats stats = MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), numVertices, cacheSize);
+            mismatches += stats.numTransforms == countCacheMisses(indices, cacheSize) ? 0 : 1;
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+// The full import order on shuffled grids: same triangles with the same winding, better ACMR by the simulator,
+// vertices in first-use order
+TEST(VertexCacheOptimization)
+{
+    std::mt19937 rng(3);
+
+    for (uint32_t n : { 8u, 64u, 200u })
+    {
+        Grid grid = makeGrid(n);
+        shuffleTriangles(grid.indices, rng);
+
+        const std::vector<Triangle> reference = canonicalTriangles(grid.indices, grid.positions);
+        const uint32_t missesBefore = countCacheMisses(grid.indices, MeshOptimizer::kSimulatedCacheSize);
+
+        REQUIRE(MeshOptimizer::optimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.numVertices));
+        const uint32_t missesCache = countCacheMisses(grid.indices, MeshOptimizer::kSimulatedCacheSize);
+
+        REQUIRE(MeshOptimizer::optimizeOverdraw(grid.indices.data(), grid.indices.size(), grid.positions.data(), 12, grid.numVertices));
+        const uint32_t missesOverdraw = countCacheMisses(grid.indices, MeshOptimizer::kSimulatedCacheSize);
+
+        REQUIRE(MeshOptimizer::optimizeVertexFetch(grid.positions.data(), grid.numVertices, 12, grid.indices.data(), grid.indices.size()));
+        const uint32_t missesAfter = countCacheMisses(grid.indices, MeshOptimizer::kSimulatedCacheSize);
+
+        CHECK(canonicalTriangles(grid.indices, grid.positions) == reference);
+
+        const float numTriangles = float(grid.indices.size() / 3);
+        const float acmrBefore = float(missesBefore) / numTriangles;
+        const float acmrAfter = float(missesAfter) / numTriangles;
+
+        printf("  %3ux%-3u ACMR %.3f -> %.3f (overdraw %.3f)\n", n, n, acmrBefore, float(missesCache) / numTriangles,
+            float(missesOverdraw) / numTriangles);
+
+        // Shuffled grids start near 3; Forsyth on a 16 entry FIFO gets under 0.8 on anything but tiny grids
+        CHECK(acmrAfter < acmrBefore);
+        CHECK(n < 64 || acmrAfter < 0.8f);
+
+        // The overdraw pass keeps within its 5% ACMR threshold, the fetch remap does not change the order
+        CHECK(float(missesOverdraw) <= float(missesCache) * 1.05f + 1.0f);
+        CHECK(missesAfter == missesOverdraw);
+
+        // First use of each vertex comes in increasing order
+        uint32_t nextNew = 0;
+        uint32_t outOfOrder = 0;
+        for (uint32_t index : grid.indices)
+        {
+            if (index == nextNew)
+                ++nextNew;
+            else if (index > nextNew)
+                ++outOfOrder;
+        }
+
+        CHECK(outOfOrder == 0);
+        CHECK(nextNew == grid.numVertices);
+    }
+}
+
+// Edge collapse on a wavy grid, with the error budget BasicMesh::buildLods gives a level: indices stay valid,
+// triangles go, the reported error keeps within the budget and the locked open border is still all there
+TEST(SimplifyGrid)
+{
+    constexpr uint32_t n = 64;
+    Grid grid = makeGrid(n);
+
+    // Curved along y as well, or strips along y would collapse for free
+    for (uint32_t v = 0; v < grid.numVertices; ++v)
+        grid.positions[v * 3 + 2] *= std::cos(grid.positions[v * 3 + 1] * 0.25f);
+
+    // Half the box diagonal, as buildLods scales maxRelativeError
+    const float halfDiagonal = 0.5f * std::sqrt(2.0f * float(n * n) + 0.6f * 0.6f);
+
+    size_t previousCount = grid.indices.size();
+
+    for (float maxRelativeError : { 0.0002f, 0.001f, 0.005f })
+    {
+        const float targetError = maxRelativeError * halfDiagonal;
+
+        // No target count: only the error budget stops it
+        std::vector<uint32_t> simplified(grid.indices.size());
+        float resultError = -1.0f;
+        const size_t count = MeshOptimizer::simplify(simplified.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), 12,
+            grid.numVertices, 0, targetError, &resultError);
+        simplified.resize(count);
+
+        printf("  error budget %.3f: %zu -> %zu triangles, error %.4f\n", targetError, grid.indices.size() / 3, count / 3, resultError);
+
+        CHECK(count % 3 == 0);
+        CHECK(count < grid.indices.size());
+        CHECK(resultError >= 0.0f && resultError <= targetError);
+
+        // A larger budget never keeps more
+        CHECK(count <= previousCount);
+        previousCount = count;
+
+        uint32_t outOfRange = 0;
+        uint32_t degenerate = 0;
+        std::vector<bool> used(grid.numVertices, false);
+        for (size_t t = 0; t < count; t += 3)
+        {
+            const uint32_t a = simplified[t], b = simplified[t + 1], c = simplified[t + 2];
+            if (a >= grid.numVertices || b >= grid.numVertices || c >= grid.numVertices)
+            {
+                ++outOfRange;
+                continue;
+            }
+
+            degenerate += (a == b || b == c || a == c) ? 1 : 0;
+            used[a] = used[b] = used[c] = true;
+        }
+
+        CHECK(outOfRange == 0);
+        CHECK(degenerate == 0);
+
+        // Every vertex on the open border is locked, so none of them may be collapsed away
+        uint32_t lostBorder = 0;
+        for (uint32_t y = 0; y <= n; ++y)
+        {
+            for (uint32_t x = 0; x <= n; ++x)
+            {
+                if ((x == 0 || x == n || y == 0 || y == n) && !used[y * (n + 1) + x])
+                    ++lostBorder;
+            }
+        }
+
+        CHECK(lostBorder == 0);
+    }
+
+    // With room to spare the target count is what stops it
+    std::vector<uint32_t> simplified(grid.indices.size());
+    const size_t targetCount = (grid.indices.size() / 4 / 3) * 3;
+    CHECK(MeshOptimizer::simplify(simplified.data(), grid.indices.data(), grid.indices.size(), grid.positions.data(), 12,
+        grid.numVertices, targetCount, halfDiagonal) <= targetCount);
+}
+
+namespace
+{
+    // Part triangles mapped back to source vertices, concatenated in part order
+    std::vector<uint32_t> joinParts(const std::vector<MeshOptimizer::MeshPart>& parts)
+    {
+        std::vector<uint32_t> indices;
+        for (const MeshOptimizer::MeshPart& part : parts)
+        {
+            for (uint32_t index : part.indices)
+                indices.push_back(part.vertices[index]);
+        }
+
+        return indices;
+    }
+}
+
+// Right at the 16-bit limit: 65535 referenced vertices stay in one part, 65536 need two
+TEST(SplitByVertexLimitBoundary)
+{
+    constexpr uint32_t kMax = MeshOptimizer::kMax16BitVertices;
+    std::vector<MeshOptimizer::MeshPart> parts;
+
+    // Separate triangles, so the vertex count is exactly the one asked for
+    for (uint32_t numVertices : { kMax - 3, kMax, kMax + 3 })
+    {
+        std::vector<uint32_t> indices(numVertices);
+        for (uint32_t i = 0; i < numVertices; ++i)
+            indices[i] = i;
+
+        REQUIRE(MeshOptimizer::splitByVertexLimit(indices.data(), indices.size(), numVertices, kMax, parts));
+        CHECK(parts.size() == (numVertices <= kMax ? 1 : 2));
+        CHECK(parts[0].vertices.size() == std::min(numVertices, kMax));
+        CHECK(joinParts(parts) == indices);
+    }
+
+    // 255x255 quads is 65536 vertices; 254x254 is 65025
+    for (uint32_t n : { 254u, 255u })
+    {
+        const Grid grid = makeGrid(n);
+        REQUIRE(MeshOptimizer::splitByVertexLimit(grid.indices.data(), grid.indices.size(), grid.numVertices, kMax, parts));
+        CHECK(parts.size() == (grid.numVertices <= kMax ? 1 : 2));
+
+        for (const MeshOptimizer::MeshPart& part : parts)
+            CHECK(part.vertices.size() <= kMax);
+
+        CHECK(joinParts(parts) == grid.indices);
+    }
+}
+
+// Random lists against small limits: every part fits, is only cut when the next triangle would not, references
+// each of its vertices, and the parts give back the source triangles in order
+TEST(SplitByVertexLimitParts)
+{
+    std::mt19937 rng(6);
+    std::vector<MeshOptimizer::MeshPart> parts;
+
+    uint32_t tooLarge = 0;
+    uint32_t cutEarly = 0;
+    uint32_t unused = 0;
+    uint32_t mismatches = 0;
+
+    for (uint32_t run = 0; run < 200; ++run)
+    {
+        const uint32_t numVertices = 3 + rng() % 100;
+        const uint32_t maxVertices = 3 + rng() % 40;
+
+        // Degenerate triangles included: repeated corners count once
+        std::vector<uint32_t> indices(3 * (1 + rng() % 300));
+        for (uint32_t& index : indices)
+            index = rng() % numVertices;
+
+        REQUIRE(MeshOptimizer::splitByVertexLimit(indices.data(), indices.size(), numVertices, maxVertices, parts));
+
+        for (size_t p = 0; p < parts.size(); ++p)
+        {
+            const MeshOptimizer::MeshPart& part = parts[p];
+            tooLarge += part.vertices.size() > maxVertices ? 1 : 0;
+
+            std::vector<uint8_t> referenced(part.vertices.size(), 0);
+            for (uint32_t index : part.indices)
+                referenced[index] = 1;
+            unused += std::count(referenced.begin(), referenced.end(), 0) ? 1 : 0;
+
+            // The first triangle of the next part must not have fitted in this one
+            if (p + 1 < parts.size())
+            {
+                const MeshOptimizer::MeshPart& next = parts[p + 1];
+                std::vector<uint32_t> merged = part.vertices;
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    const uint32_t v = next.vertices[next.indices[k]];
+                    if (std::find(merged.begin(), merged.end(), v) == merged.end())
+                        merged.push_back(v);
+                }
+
+                cutEarly += merged.size() <= maxVertices ? 1 : 0;
+            }
+        }
+
+        mismatches += joinParts(parts) == indices ? 0 : 1;
+    }
+
+    CHECK(tooLarge == 0);
+    CHECK(cutEarly == 0);
+    CHECK(unused == 0);
+    CHECK(mismatches == 0);
+
+    // Invalid input is refused
+    const std::vector<uint32_t> triangle = { 0, 1, 2 };
+    CHECK(!MeshOptimizer::splitByVertexLimit(triangle.data(), triangle.size(), 3, 2, parts));
+    CHECK(!MeshOptimizer::splitByVertexLimit(triangle.data(), triangle.size(), 2, 16, parts));
+    CHECK(!MeshOptimizer::splitByVertexLimit(triangle.data(), 2, 3, 16, parts));
+}
+
+namespace
+{
+    void cross(const float a[3], const float b[3], float out[3])
+    {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    float dot(const float a[3], const float b[3])
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void normalize(float v[3])
+    {
+        const float length = std::sqrt(dot(v, v));
+        for (uint32_t k = 0; k < 3; ++k)
+            v[k] /= length;
+    }
+
+    // Unit UV sphere, triangles wound counter-clockwise seen from outside, no degenerate ones at the poles
+    Grid makeSphere(uint32_t stacks, uint32_t slices)
+    {
+        constexpr float kPi = 3.14159265358979f;
+
+        Grid sphere;
+        sphere.numVertices = (stacks + 1) * (slices + 1);
+
+        for (uint32_t s = 0; s <= stacks; ++s)
+        {
+            const float theta = kPi * float(s) / float(stacks);
+            for (uint32_t l = 0; l <= slices; ++l)
+            {
+                const float phi = 2.0f * kPi * float(l) / float(slices);
+                sphere.positions.insert(sphere.positions.end(), { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+            }
+        }
+
+        for (uint32_t s = 0; s < stacks; ++s)
+        {
+            for (uint32_t l = 0; l < slices; ++l)
+            {
+                const uint32_t a = s * (slices + 1) + l;
+                const uint32_t b = a + 1;
+                const uint32_t c = a + slices + 1;
+                const uint32_t d = c + 1;
+
+                if (s > 0)
+                    sphere.indices.insert(sphere.indices.end(), { a, b, c });
+                if (s + 1 < stacks)
+                    sphere.indices.insert(sphere.indices.end(), { b, d, c });
+            }
+        }
+
+        return sphere;
+    }
+
+    // Inward-facing frustum planes (ax + by + cz + d >= 0 inside) of a camera at eye looking at target
+    void makeFrustum(const float eye[3], const float target[3], float fovY, float aspect, float planes[6][4])
+    {
+        float forward[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+        normalize(forward);
+
+        const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+        float right[3];
+        cross(forward, worldUp, right);
+        normalize(right);
+
+        float up[3];
+        cross(right, forward, up);
+
+        const float halfY = fovY * 0.5f;
+        const float halfX = std::atan(std::tan(halfY) * aspect);
+
+        auto setPlane = [&](float plane[4], const float side[3], float sideScale, float forwardScale)
+            {
+                for (uint32_t k = 0; k < 3; ++k)
+                    plane[k] = side[k] * sideScale + forward[k] * forwardScale;
+                normalize(plane);
+                plane[3] = -dot(plane, eye);
+            };
+
+        setPlane(planes[0], right, std::cos(halfX), std::sin(halfX));
+        setPlane(planes[1], right, -std::cos(halfX), std::sin(halfX));
+        setPlane(planes[2], up, std::cos(halfY), std::sin(halfY));
+        setPlane(planes[3], up, -std::cos(halfY), std::sin(halfY));
+        setPlane(planes[4], up, 0.0f, 1.0f);
+        planes[4][3] -= 0.1f;
+        setPlane(planes[5], up, 0.0f, -1.0f);
+        planes[5][3] += 100.0f;
+    }
+}
+
+// Meshlets of a cache-optimised sphere cover the list in order within both limits, their spheres hold their
+// vertices, and from a set of camera poses every culled meshlet is really invisible: outside one frustum plane,
+// or all its triangles facing away from the eye
+TEST(MeshletCulling)
+{
+    Grid sphere = makeSphere(48, 96);
+    REQUIRE(MeshOptimizer::optimizeVertexCache(sphere.indices.data(), sphere.indices.size(), sphere.numVertices));
+
+    std::vector<MeshOptimizer::Meshlet> meshlets;
+    REQUIRE(MeshOptimizer::buildMeshlets(sphere.indices.data(), sphere.indices.size(), sphere.positions.data(), 12,
+        sphere.numVertices, meshlets));
+
+    auto position = [&](uint32_t index) { return &sphere.positions[sphere.indices[index] * 3]; };
+
+    uint32_t badRanges = 0;
+    uint32_t overLimits = 0;
+    uint32_t outsideSphere = 0;
+    uint32_t next = 0;
+
+    for (const MeshOptimizer::Meshlet& meshlet : meshlets)
+    {
+        badRanges += (meshlet.firstIndex != next || meshlet.numIndices == 0 || meshlet.numIndices % 3 != 0) ? 1 : 0;
+        next = meshlet.firstIndex + meshlet.numIndices;
+
+        std::vector<uint32_t> distinct(sphere.indices.begin() + meshlet.firstIndex, sphere.indices.begin() + next);
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+        overLimits += (distinct.size() > MeshOptimizer::kMeshletMaxVertices ||
+            meshlet.numIndices / 3 > MeshOptimizer::kMeshletMaxTriangles) ? 1 : 0;
+
+        for (uint32_t i = meshlet.firstIndex; i < next; ++i)
+        {
+            const float* p = position(i);
+            const float d[3] = { p[0] - meshlet.center[0], p[1] - meshlet.center[1], p[2] - meshlet.center[2] };
+            outsideSphere += std::sqrt(dot(d, d)) > meshlet.radius * 1.0001f ? 1 : 0;
+        }
+    }
+
+    CHECK(badRanges == 0 && next == sphere.indices.size());
+    CHECK(overLimits == 0);
+    CHECK(outsideSphere == 0);
+
+    struct Pose
+    {
+        const char* name;
+        float eye[3];
+        float target[3];
+    };
+
+    const Pose poses[] =
+    {
+        { "outside, centred", { 0.0f, 0.5f, 3.0f }, { 0.0f, 0.0f, 0.0f } },
+        { "outside, off to the side", { 0.0f, 0.0f, 3.0f }, { 2.5f, 0.0f, 0.0f } },
+        { "close, grazing", { 1.05f, 0.3f, 0.2f }, { 0.0f, 1.0f, -1.0f } },
+        { "looking away", { 0.0f, 0.0f, 3.0f }, { 0.0f, 0.0f, 6.0f } },
+    };
+
+    const uint32_t numTriangles = uint32_t(sphere.indices.size() / 3);
+    uint32_t wrongFrustum = 0;
+    uint32_t wrongCone = 0;
+
+    for (const Pose& pose : poses)
+    {
+        float planes[6][4];
+        makeFrustum(pose.eye, pose.target, 1.0f, 1.5f, planes);
+
+        uint32_t frustumTriangles = 0;
+        uint32_t coneTriangles = 0;
+
+        for (const MeshOptimizer::Meshlet& meshlet : meshlets)
+        {
+            const uint32_t end = meshlet.firstIndex + meshlet.numIndices;
+
+            if (MeshOptimizer::isMeshletCulled(meshlet, planes, nullptr))
+            {
+                frustumTriangles += meshlet.numIndices / 3;
+
+                // Some single plane has every vertex behind it
+                bool separated = false;
+                for (uint32_t p = 0; p < 6 && !separated; ++p)
+                {
+                    separated = true;
+                    for (uint32_t i = meshlet.firstIndex; i < end && separated; ++i)
+                        separated = dot(planes[p], position(i)) + planes[p][3] < 0.0f;
+                }
+
+                wrongFrustum += separated ? 0 : 1;
+            }
+            else if (MeshOptimizer::isMeshletCulled(meshlet, planes, pose.eye))
+            {
+                coneTriangles += meshlet.numIndices / 3;
+
+                for (uint32_t t = meshlet.firstIndex; t < end; t += 3)
+                {
+                    const float* a = position(t);
+                    const float* b = position(t + 1);
+                    const float* c = position(t + 2);
+                    const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+                    const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+                    const float toTriangle[3] = { a[0] - pose.eye[0], a[1] - pose.eye[1], a[2] - pose.eye[2] };
+
+                    float normal[3];
+                    cross(ab, ac, normal);
+                    wrongCone += dot(normal, toTriangle) < 0.0f ? 1 : 0;
+                }
+            }
+        }
+
+        printf("  %-24s: %5.1f%% frustum culled, %5.1f%% cone culled of %u triangles in %zu meshlets\n", pose.name,
+            100.0f * float(frustumTriangles) / float(numTriangles), 100.0f * float(coneTriangles) / float(numTriangles),
+            numTriangles, meshlets.size());
+
+        // Seen from outside, the far side is mostly backfacing
+        if (&pose == &poses[0])
+            CHECK(coneTriangles > numTriangles / 4);
+
+        if (&pose == &poses[3])
+            CHECK(frustumTriangles == numTriangles);
+    }
+
+    CHECK(wrongFrustum == 0);
+    CHECK(wrongCone == 0);
+}
@@ -0,0 +1,142 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "ParallelRecording.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+// Ranges cover [0, numDraws) in order, differ in size by one at most, respect both limits, and a chunk is
+// only split off when it gets minDrawsPerChunk draws
+TEST(PartitionDraws)
+{
+    std::vector<DrawRange> ranges;
+
+    uint32_t badCount = 0;
+    uint32_t badCoverage = 0;
+    uint32_t unbalanced = 0;
+    uint32_t tooSmall = 0;
+
+    for (uint32_t numDraws = 0; numDraws < 300; ++numDraws)
+    {
+        for (uint32_t maxChunks = 0; maxChunks < 10; ++maxChunks)
+        {
+            for (uint32_t minDraws = 0; minDraws < 20; ++minDraws)
+            {
+                const uint32_t count = partitionDraws(numDraws, maxChunks, minDraws, ranges);
+
+                if (count != ranges.size() || count > std::max(1u, maxChunks) || (numDraws == 0) != (count == 0))
+                {
+                    ++badCount;
+                    continue;
+                }
+
+                uint32_t next = 0;
+                uint32_t smallest = UINT32_MAX;
+                uint32_t largest = 0;
+                for (const DrawRange& range : ranges)
+                {
+                    badCoverage += (range.begin != next || range.end <= range.begin) ? 1 : 0;
+                    next = range.end;
+                    smallest = std::min(smallest, range.size());
+                    largest = std::max(largest, range.size());
+                }
+
+                badCoverage += next != numDraws ? 1 : 0;
+                unbalanced += (count > 0 && largest - smallest > 1) ? 1 : 0;
+                tooSmall += (count > 1 && smallest < minDraws) ? 1 : 0;
+            }
+        }
+    }
+
+    CHECK(badCount == 0);
+    CHECK(badCoverage == 0);
+    CHECK(unbalanced == 0);
+    CHECK(tooSmall == 0);
+
+    CHECK(partitionDraws(1000, 4, 64, ranges) == 4);
+    CHECK(partitionDraws(100, 4, 64, ranges) == 1);
+}
+
+TEST(CommandListRecyclerSlots)
+{
+    CommandListRecycler recycler;
+    recycler.init(2);
+    bool isNew = false;
+
+    recycler.beginFrame(0);
+    CHECK(recycler.acquire(isNew) == 0 && isNew);
+    CHECK(recycler.acquire(isNew) == 1 && isNew);
+
+    // Slot 1 cannot reuse slot 0's lists: that frame may still be on the GPU
+    recycler.beginFrame(1);
+    CHECK(recycler.acquire(isNew) == 2 && isNew);
+    CHECK(recycler.getNumLists() == 3);
+
+    recycler.beginFrame(0);
+    std::set<uint32_t> reused;
+    reused.insert(recycler.acquire(isNew));
+    CHECK(!isNew);
+    reused.insert(recycler.acquire(isNew));
+    CHECK(!isNew);
+    CHECK(reused == std::set<uint32_t>({ 0, 1 }));
+
+    CHECK(recycler.acquire(isNew) == 3 && isNew);
+
+    const CommandListRecycler::Stats stats = recycler.getStats();
+    CHECK(stats.numLists == 4);
+    CHECK(stats.numAcquired == 3);
+    CHECK(stats.numFree == 0);
+}
+
+// Frames cycle through FRAMES_IN_FLIGHT slots with a varying number of chunks: a list is never handed out
+// while a frame still in flight holds it, and the pool stops growing once every slot saw its largest frame
+TEST(CommandListRecyclerInFlight)
+{
+    constexpr uint32_t kSlots = FRAMES_IN_FLIGHT;
+    constexpr uint32_t kMaxLists = 12;
+
+    CommandListRecycler recycler;
+    recycler.init(kSlots);
+
+    std::vector<std::vector<uint32_t>> slotLists(kSlots);
+    std::mt19937 rng(11);
+
+    uint32_t stillInFlight = 0;
+    uint32_t duplicates = 0;
+    uint32_t badNew = 0;
+
+    for (uint32_t frame = 0; frame < 5000; ++frame)
+    {
+        const uint32_t slot = frame % kSlots;
+
+        // This slot's frame completed; the other slots are still in flight
+        recycler.beginFrame(slot);
+        slotLists[slot].clear();
+
+        std::set<uint32_t> inFlight;
+        for (uint32_t other = 0; other < kSlots; ++other)
+            inFlight.insert(slotLists[other].begin(), slotLists[other].end());
+
+        const uint32_t numLists = 1 + rng() % kMaxLists;
+        for (uint32_t i = 0; i < numLists; ++i)
+        {
+            const uint32_t before = recycler.getNumLists();
+
+            bool isNew = false;
+            const uint32_t index = recycler.acquire(isNew);
+
+            stillInFlight += inFlight.count(index) ? 1 : 0;
+            duplicates += std::count(slotLists[slot].begin(), slotLists[slot].end(), index) ? 1 : 0;
+            badNew += isNew != (index == before) ? 1 : 0;
+
+            slotLists[slot].push_back(index);
+        }
+    }
+
+    CHECK(stillInFlight == 0);
+    CHECK(duplicates == 0);
+    CHECK(badNew == 0);
+    CHECK(recycler.getNumLists() <= kSlots * kMaxLists);
+}
@@ -0,0 +1,140 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace
+{
+    // Keys shaped like a scene: few pipelines, more materials and meshes, so many keys share their top digits
+    void fillSceneKeys(RenderQueue& queue, uint32_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> depth(0.1f, 500.0f);
+
+        queue.clear();
+        queue.reserve(count);
+
+        for (uint32_t i = 0; i < count; ++i)
+            queue.push(RenderQueue::makeKey(rng() % 2u, rng() % 4u, rng() % 64u, rng() % 1024u, depth(rng)), i);
+    }
+
+    std::vector<RenderQueue::Item> stableSorted(std::vector<RenderQueue::Item> items)
+    {
+        std::stable_sort(items.begin(), items.end(), [](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+        return items;
+    }
+
+    bool sameOrder(const std::vector<RenderQueue::Item>& a, const std::vector<RenderQueue::Item>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [](const RenderQueue::Item& x, const RenderQueue::Item& y) { return x.key == y.key && x.payload == y.payload; });
+    }
+}
+
+// The radix sort against std::stable_sort: same keys and same payloads, so equal keys keep their push order
+TEST(RenderQueueMatchesStableSort)
+{
+    std::mt19937 rng(1234);
+    RenderQueue queue;
+
+    for (uint32_t count : { 0u, 1u, 2u, 3u, 255u, 256u, 257u, 1000u, 100000u })
+    {
+        fillSceneKeys(queue, count, rng);
+        const std::vector<RenderQueue::Item> expected = stableSorted(queue.getItems());
+
+        queue.sort();
+        CHECK(sameOrder(queue.getItems(), expected));
+    }
+
+    // Few distinct keys: long runs of equal keys are where an unstable sort shows
+    queue.clear();
+    for (uint32_t i = 0; i < 10000; ++i)
+        queue.push(RenderQueue::makeKey(0, rng() % 2u, rng() % 3u, 0, 0.0f), i);
+
+    const std::vector<RenderQueue::Item> expected = stableSorted(queue.getItems());
+    queue.sort();
+    CHECK(sameOrder(queue.getItems(), expected));
+}
+
+// Digits every key shares are skipped, and skipping them does not change the order
+TEST(RenderQueueSkippedPasses)
+{
+    RenderQueue queue;
+
+    for (uint32_t i = 0; i < 100; ++i)
+        queue.push(RenderQueue::makeKey(1, 2, 3, 4, 5.0f), i);
+    CHECK(queue.sort() == 0);
+    for (uint32_t i = 0; i < queue.size(); ++i)
+        CHECK(queue[i].payload == i);
+
+    // Only the mesh field differs, and its 16 bits straddle three 8-bit digits of the key
+    queue.clear();
+    for (uint32_t i = 0; i < 100; ++i)
+        queue.push(RenderQueue::makeKey(0, 0, 0, (i * 37u) % 100u, 0.0f), i);
+
+    const std::vector<RenderQueue::Item> expected = stableSorted(queue.getItems());
+    const uint32_t passes = queue.sort();
+    CHECK(passes > 0 && passes <= 3);
+    CHECK(sameOrder(queue.getItems(), expected));
+}
+
+// Fields sort most significant first, wide values clamp instead of spilling into the next field,
+// and depth grows with distance
+TEST(RenderQueueKeyFields)
+{
+    const uint64_t key = RenderQueue::makeKey(1, 2, 3, 4, 10.0f);
+    CHECK(RenderQueue::getMaterial(key) == 3);
+    CHECK(RenderQueue::getMesh(key) == 4);
+
+    CHECK(RenderQueue::makeKey(1, 0, 0, 0, 0.0f) > RenderQueue::makeKey(0, 255, 65535, 65535, 1e30f));
+    CHECK(RenderQueue::makeKey(0, 1, 0, 0, 0.0f) > RenderQueue::makeKey(0, 0, 65535, 65535, 1e30f));
+    CHECK(RenderQueue::makeKey(0, 0, 1, 0, 0.0f) > RenderQueue::makeKey(0, 0, 0, 65535, 1e30f));
+    CHECK(RenderQueue::makeKey(0, 0, 0, 1, 0.0f) > RenderQueue::makeKey(0, 0, 0, 0, 1e30f));
+
+    CHECK(RenderQueue::getMaterial(RenderQueue::makeKey(0, 0, 100000, 0, 0.0f)) == 65535);
+    CHECK(RenderQueue::getMesh(RenderQueue::makeKey(0, 0, 0, 100000, 0.0f)) == 65535);
+    CHECK(RenderQueue::makeKey(16, 0, 0, 0, 0.0f) == RenderQueue::makeKey(15, 0, 0, 0, 0.0f));
+
+    float previous = 0.0f;
+    for (float depth = 0.01f; depth < 10000.0f; depth *= 1.5f)
+    {
+        CHECK(RenderQueue::makeKey(0, 0, 0, 0, depth) > RenderQueue::makeKey(0, 0, 0, 0, previous));
+        previous = depth;
+    }
+    CHECK(RenderQueue::makeKey(0, 0, 0, 0, -1.0f) == RenderQueue::makeKey(0, 0, 0, 0, 0.0f));
+}
+
+BENCHMARK(RenderQueueSort100k)
+{
+    constexpr uint32_t kItems = 100000;
+    constexpr uint32_t kRuns = 10;
+
+    std::mt19937 rng(1234);
+    RenderQueue queue;
+
+    double radixMs = 0.0;
+    double stdSortMs = 0.0;
+    uint32_t passes = 0;
+
+    for (uint32_t run = 0; run < kRuns; ++run)
+    {
+        fillSceneKeys(queue, kItems, rng);
+        std::vector<RenderQueue::Item> expected = queue.getItems();
+
+        auto start = std::chrono::steady_clock::now();
+        passes = queue.sort();
+        radixMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        std::stable_sort(expected.begin(), expected.end(), [](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+        stdSortMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        CHECK(sameOrder(queue.getItems(), expected));
+    }
+
+    printf("  %u items: radix %.3f ms (%u passes), std::stable_sort %.3f ms, %.2fx\n", kItems, radixMs / kRuns, passes,
+        stdSortMs / kRuns, stdSortMs / radixMs);
+}
@@ -0,0 +1,349 @@
+#include "Globals.h"
+#include "TestFramework.h"
+#include "FakeCommandList.h"
+
+#include "BasicMesh.h"
+#include "RenderQueue.h"
+#include "RenderStateCache.h"
+
+#include <chrono>
+#include <random>
+
+namespace
+{
+    // Stand-ins for the GPU objects Assignment2Module binds: only their identity matters to the cache
+    ID3D12RootSignature* const kRootSignature = reinterpret_cast<ID3D12RootSignature*>(uintptr_t(0x1000));
+
+    constexpr D3D12_GPU_VIRTUAL_ADDRESS kConstantsAddress = 0x100000;
+    constexpr D3D12_GPU_VIRTUAL_ADDRESS kPerInstanceAddress = 0x200000;
+    constexpr uint32_t kPerInstanceStride = 256;
+    constexpr D3D12_GPU_VIRTUAL_ADDRESS kInstanceDataAddress = 0x400000;
+    constexpr uint64_t kDescriptorsBase = 0x300000;
+    constexpr uint64_t kTableStride = 32 * 4;   // one table of diffuse/normal/... per material
+
+    // A model whose meshes share one vertex and one index buffer, and a queue of draws over them
+    struct DrawScene
+    {
+        std::vector<BasicMesh> meshes;
+        std::vector<uint32_t> itemMeshes;
+        RenderQueue queue;
+    };
+
+    void buildScene(DrawScene& scene, uint32_t numMeshes, uint32_t numMaterials, uint32_t numDraws, bool sorted, std::mt19937& rng)
+    {
+        constexpr uint32_t kVertices = 1000;
+        constexpr uint32_t kIndices = 3000;
+
+        const D3D12_VERTEX_BUFFER_VIEW vbView = { 0x10000000, numMeshes * kVertices * 32, 32 };
+        const D3D12_INDEX_BUFFER_VIEW ibView = { 0x20000000, numMeshes * kIndices * 2, DXGI_FORMAT_R16_UINT };
+
+        scene.meshes.resize(numMeshes);
+        for (uint32_t i = 0; i < numMeshes; ++i)
+        {
+            scene.meshes[i].loadPacked("mesh", kVertices, kIndices, int(rng() % numMaterials), Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+            scene.meshes[i].setGeometry(vbView, ibView, i * kVertices, i * kIndices);
+        }
+
+        std::uniform_real_distribution<float> depth(1.0f, 500.0f);
+
+        scene.itemMeshes.resize(numDraws);
+        scene.queue.clear();
+        for (uint32_t i = 0; i < numDraws; ++i)
+        {
+            const uint32_t mesh = rng() % numMeshes;
+            scene.itemMeshes[i] = mesh;
+            scene.queue.push(RenderQueue::makeKey(0, 0, uint32_t(scene.meshes[mesh].getMaterialIndex()), mesh, depth(rng)), i);
+        }
+
+        if (sorted)
+            scene.queue.sort();
+    }
+
+    // Assignment2Module::bindSceneState and recordSceneDraws without the GPU buffers: with bindless textures
+    // table 3 is the whole SRV heap, bound once; otherwise each draw binds its material's table
+    void recordScene(RenderStateCache& state, const DrawScene& scene, bool bindless)
+    {
+        state.setRootSignature(kRootSignature);
+        state.setConstantBufferView(0, kConstantsAddress);
+        state.setConstantBufferView(1, kConstantsAddress + 256);
+        state.setDescriptorTable(4, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase - 64 });
+
+        if (bindless)
+            state.setDescriptorTable(3, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase });
+
+        for (uint32_t queueIdx = 0; queueIdx < scene.queue.size(); ++queueIdx)
+        {
+            const uint32_t itemIdx = scene.queue[queueIdx].payload;
+            const BasicMesh& mesh = scene.meshes[scene.itemMeshes[itemIdx]];
+
+            state.setConstantBufferView(2, kPerInstanceAddress + itemIdx * kPerInstanceStride);
+
+            if (!bindless)
+                state.setDescriptorTable(3, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase + uint64_t(mesh.getMaterialIndex()) * kTableStride });
+
+            mesh.bindGeometry(state);
+            mesh.draw(state.getCommandList(), false);
+        }
+    }
+
+    // One element of the instanced draws' StructuredBuffer, as Assignment2Module::InstanceData
+    struct InstanceData
+    {
+        Matrix modelMat;
+        Matrix normalMat;
+    };
+
+    struct InstanceBatch
+    {
+        uint32_t mesh = 0;
+        uint32_t firstInstance = 0;
+        uint32_t numInstances = 0;
+    };
+
+    // What Assignment2Module does per frame for each path once the items are culled, from the render queue on.
+    // One draw per item: key by material, mesh and depth, sort, then a b2 per item.
+    void recordPerInstanceFrame(RenderStateCache& state, DrawScene& scene, const std::vector<float>& itemDepths)
+    {
+        scene.queue.clear();
+        for (uint32_t i = 0; i < uint32_t(scene.itemMeshes.size()); ++i)
+        {
+            const uint32_t mesh = scene.itemMeshes[i];
+            scene.queue.push(RenderQueue::makeKey(0, 0, uint32_t(scene.meshes[mesh].getMaterialIndex()), mesh, itemDepths[i]), i);
+        }
+        scene.queue.sort();
+
+        recordScene(state, scene, true);
+    }
+
+    // Instanced: prepareMeshDraws' counting sort of the items by mesh with their matrices scattered into batch
+    // order, then buildRenderQueue and recordInstancedDraws over the batches
+    void recordInstancedFrame(RenderStateCache& state, DrawScene& scene, const std::vector<InstanceData>& itemData,
+        std::vector<uint32_t>& batchStarts, std::vector<InstanceBatch>& batches, std::vector<InstanceData>& instanceData)
+    {
+        const uint32_t numMeshes = uint32_t(scene.meshes.size());
+        batchStarts.assign(size_t(numMeshes) + 1, 0u);
+        batches.clear();
+
+        for (uint32_t mesh : scene.itemMeshes)
+            ++batchStarts[mesh + 1];
+
+        for (uint32_t mesh = 0; mesh < numMeshes; ++mesh)
+        {
+            const uint32_t count = batchStarts[mesh + 1];
+            batchStarts[mesh + 1] = batchStarts[mesh] + count;
+
+            if (count > 0)
+                batches.push_back(InstanceBatch{ mesh, batchStarts[mesh], count });
+        }
+
+        instanceData.resize(scene.itemMeshes.size());
+        for (uint32_t i = 0; i < uint32_t(scene.itemMeshes.size()); ++i)
+            instanceData[batchStarts[scene.itemMeshes[i]]++] = itemData[i];
+
+        scene.queue.clear();
+        for (uint32_t batchIdx = 0; batchIdx < uint32_t(batches.size()); ++batchIdx)
+        {
+            const BasicMesh& mesh = scene.meshes[batches[batchIdx].mesh];
+            scene.queue.push(RenderQueue::makeKey(0, 1, uint32_t(mesh.getMaterialIndex()), batches[batchIdx].mesh, 0.0f), batchIdx);
+        }
+        scene.queue.sort();
+
+        state.setRootSignature(kRootSignature);
+        state.setConstantBufferView(0, kConstantsAddress);
+        state.setConstantBufferView(1, kConstantsAddress + 256);
+        state.setDescriptorTable(4, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase - 64 });
+        state.setDescriptorTable(3, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase });
+
+        const D3D12_GPU_VIRTUAL_ADDRESS materialBase = kPerInstanceAddress + scene.itemMeshes.size() * kPerInstanceStride;
+
+        for (uint32_t queueIdx = 0; queueIdx < scene.queue.size(); ++queueIdx)
+        {
+            const InstanceBatch& batch = batches[scene.queue[queueIdx].payload];
+            const BasicMesh& mesh = scene.meshes[batch.mesh];
+
+            state.setConstantBufferView(2, materialBase + uint64_t(mesh.getMaterialIndex()) * kPerInstanceStride);
+            state.setShaderResourceView(5, kInstanceDataAddress + uint64_t(batch.firstInstance) * sizeof(InstanceData));
+
+            mesh.bindGeometry(state);
+            mesh.draw(state.getCommandList(), false, 0, batch.numInstances);
+        }
+    }
+}
+
+// A scripted bind sequence with a redundant repeat after every kind of call. Skipping drops exactly the repeats;
+// without it every call reaches the list. Either way the stats count the same repeats as redundant.
+TEST(RenderStateCacheSkipsRedundant)
+{
+    ID3D12PipelineState* const psoA = reinterpret_cast<ID3D12PipelineState*>(uintptr_t(0x10));
+    ID3D12PipelineState* const psoB = reinterpret_cast<ID3D12PipelineState*>(uintptr_t(0x20));
+    ID3D12RootSignature* const otherSignature = reinterpret_cast<ID3D12RootSignature*>(uintptr_t(0x2000));
+
+    const D3D12_VERTEX_BUFFER_VIEW vb = { 0x10000000, 3200, 32 };
+    const D3D12_VERTEX_BUFFER_VIEW vbStride = { 0x10000000, 3200, 16 };
+    const D3D12_INDEX_BUFFER_VIEW ib = { 0x20000000, 600, DXGI_FORMAT_R16_UINT };
+    const D3D12_INDEX_BUFFER_VIEW ibFormat = { 0x20000000, 600, DXGI_FORMAT_R32_UINT };
+
+    for (bool skip : { true, false })
+    {
+        FakeCommandList commandList;
+        RenderStateCache state;
+        state.begin(&commandList, psoA, skip);
+
+        state.setPipelineState(psoA);                  // what the list was reset with
+        state.setPipelineState(psoB);
+        state.setPipelineState(psoB);
+
+        state.setRootSignature(kRootSignature);
+        state.setRootSignature(kRootSignature);
+
+        state.setConstantBufferView(0, kConstantsAddress);
+        state.setConstantBufferView(0, kConstantsAddress);
+        state.setShaderResourceView(0, kConstantsAddress); // same value, other kind of argument
+        state.setDescriptorTable(1, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase });
+        state.setDescriptorTable(1, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase });
+        state.setConstantBufferView(2, kPerInstanceAddress);
+        state.setConstantBufferView(2, kPerInstanceAddress + kPerInstanceStride);
+
+        state.setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        state.setPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        state.setVertexBuffer(vb);
+        state.setVertexBuffer(vb);
+        state.setVertexBuffer(vbStride);
+        state.setIndexBuffer(ib);
+        state.setIndexBuffer(ib);
+        state.setIndexBuffer(ibFormat);
+
+        // A new root signature forgets the arguments: the same table is set again
+        state.setRootSignature(otherSignature);
+        state.setDescriptorTable(1, D3D12_GPU_DESCRIPTOR_HANDLE{ kDescriptorsBase });
+
+        const RenderStateCache::Stats& stats = state.getStats();
+        CHECK(stats.redundant == 8);
+        CHECK(stats.pipelineChanges == (skip ? 1u : 3u));
+        CHECK(stats.rootChanges == (skip ? 8u : 11u));
+        CHECK(stats.tableChanges == (skip ? 2u : 3u));
+        CHECK(stats.inputAssemblerChanges == (skip ? 5u : 8u));
+
+        CHECK(commandList.count(FakeCommandList::PipelineState) == stats.pipelineChanges);
+        CHECK(commandList.count(FakeCommandList::RootSignature) == (skip ? 2u : 3u));
+        CHECK(commandList.count(FakeCommandList::RootConstantBuffer) == (skip ? 3u : 4u));
+        CHECK(commandList.count(FakeCommandList::RootShaderResource) == 1);
+        CHECK(commandList.count(FakeCommandList::RootDescriptorTable) == stats.tableChanges);
+        CHECK(commandList.count(FakeCommandList::PrimitiveTopology) == (skip ? 1u : 2u));
+        CHECK(commandList.count(FakeCommandList::VertexBuffers) == (skip ? 2u : 3u));
+        CHECK(commandList.count(FakeCommandList::IndexBuffer) == (skip ? 2u : 3u));
+        CHECK(commandList.rootArguments() + commandList.count(FakeCommandList::RootSignature) == stats.rootChanges);
+
+        CHECK(commandList.pipelineState == psoB && commandList.rootSignature == otherSignature);
+        CHECK(commandList.rootValues[0] == kConstantsAddress && commandList.rootValues[2] == kPerInstanceAddress + kPerInstanceStride);
+
+        // begin() starts over: only the pipeline state passed in is known, and the stats restart
+        commandList.clear();
+        state.begin(&commandList, psoB, skip);
+        state.setPipelineState(psoB);
+        state.setRootSignature(otherSignature);
+        state.setVertexBuffer(vb);
+
+        CHECK(state.getStats().redundant == 1 && state.getStats().rootChanges == 1 && state.getStats().inputAssemblerChanges == 1);
+        CHECK(commandList.count(FakeCommandList::PipelineState) == (skip ? 0u : 1u));
+        CHECK(commandList.count(FakeCommandList::RootSignature) == 1 && commandList.count(FakeCommandList::VertexBuffers) == 1);
+    }
+}
+
+// Root argument traffic of the scene pass with per-material descriptor tables against bindless indices,
+// for the queue sorted by material (the default) and left in submission order
+BENCHMARK(RenderStateCacheBindless)
+{
+    constexpr uint32_t kDraws = 10000;
+    constexpr uint32_t kRuns = 20;
+
+    std::mt19937 rng(1234);
+
+    for (bool sorted : { true, false })
+    {
+        DrawScene scene;
+        buildScene(scene, 512, 64, kDraws, sorted, rng);
+
+        for (bool bindless : { false, true })
+        {
+            FakeCommandList commandList;
+            RenderStateCache state;
+            double ms = 0.0;
+
+            for (uint32_t run = 0; run < kRuns; ++run)
+            {
+                commandList.clear();
+
+                const auto start = std::chrono::steady_clock::now();
+                state.begin(&commandList, nullptr);
+                recordScene(state, scene, bindless);
+                ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            const RenderStateCache::Stats& stats = state.getStats();
+            CHECK(commandList.count(FakeCommandList::Draw) == kDraws);
+            CHECK(commandList.rootArguments() + commandList.count(FakeCommandList::RootSignature) == stats.rootChanges);
+
+            printf("  %u draws, %s, %-14s %.3f ms: %u root changes (%u tables), %u redundant skipped\n", kDraws,
+                sorted ? "sorted  " : "unsorted", bindless ? "bindless" : "per-draw table", ms / kRuns,
+                stats.rootChanges, stats.tableChanges, stats.redundant);
+        }
+    }
+}
+
+// The scene pass of 10k copies from the render queue on, one draw per instance against one instanced draw per
+// mesh (the batching and matrix scatter included), as Assignment2Module's useInstancing toggle switches it
+BENCHMARK(RenderQueueInstancing)
+{
+    constexpr uint32_t kInstances = 10000;
+    constexpr uint32_t kMeshes = 100;
+    constexpr uint32_t kRuns = 20;
+
+    std::mt19937 rng(77);
+
+    DrawScene scene;
+    buildScene(scene, kMeshes, 16, kInstances, true, rng);
+
+    std::uniform_real_distribution<float> depth(1.0f, 500.0f);
+    std::vector<float> itemDepths(kInstances);
+    std::vector<InstanceData> itemData(kInstances);
+    for (uint32_t i = 0; i < kInstances; ++i)
+    {
+        itemDepths[i] = depth(rng);
+        itemData[i].modelMat = Matrix::CreateTranslation(Vector3(float(i % 100), 0.0f, float(i / 100)));
+    }
+
+    std::vector<uint32_t> batchStarts;
+    std::vector<InstanceBatch> batches;
+    std::vector<InstanceData> instanceData;
+
+    for (bool instanced : { false, true })
+    {
+        FakeCommandList commandList;
+        RenderStateCache state;
+        double ms = 0.0;
+
+        for (uint32_t run = 0; run < kRuns; ++run)
+        {
+            commandList.clear();
+
+            const auto start = std::chrono::steady_clock::now();
+            state.begin(&commandList, nullptr);
+
+            if (instanced)
+                recordInstancedFrame(state, scene, itemData, batchStarts, batches, instanceData);
+            else
+                recordPerInstanceFrame(state, scene, itemDepths);
+
+            ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        CHECK(commandList.instances == kInstances);
+        CHECK(commandList.count(FakeCommandList::Draw) == (instanced ? kMeshes : kInstances));
+
+        const RenderStateCache::Stats& stats = state.getStats();
+        printf("  %u instances, %-12s %.3f ms: %u draws, %u state calls (%u root changes)\n", kInstances,
+            instanced ? "instanced" : "per instance", ms / kRuns, commandList.count(FakeCommandList::Draw),
+            commandList.stateCalls(), stats.rootChanges);
+    }
+}
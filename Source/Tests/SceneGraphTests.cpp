@@ -0,0 +1,330 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "SceneGraph.h"
+
+#include "tiny_gltf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    // Random depth-first build: each new node climbs up 0-3 levels from the last one before attaching
+    void buildRandomGraph(SceneGraph& graph, uint32_t numNodes, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+        graph.clear();
+        graph.reserve(numNodes);
+
+        std::vector<uint32_t> path;
+        path.push_back(graph.addNode(SceneGraph::kNoParent, Vector3::Zero, Quaternion::Identity, Vector3::One));
+
+        for (uint32_t i = 1; i < numNodes; ++i)
+        {
+            const uint32_t climb = std::min<uint32_t>(rng() % 4u, uint32_t(path.size()) - 1u);
+            path.resize(path.size() - climb);
+
+            const Quaternion rotation = Quaternion::CreateFromYawPitchRoll(offset(rng), offset(rng), offset(rng));
+            path.push_back(graph.addNode(int32_t(path.back()), Vector3(offset(rng), offset(rng), offset(rng)), rotation, Vector3::One));
+        }
+    }
+
+    float maxDifference(const Matrix& a, const Matrix& b)
+    {
+        float error = 0.0f;
+        for (int k = 0; k < 16; ++k)
+            error = std::max(error, std::fabs((&a._11)[k] - (&b._11)[k]));
+
+        return error;
+    }
+
+    // Column-major, as glTF stores it: reads as our row-vector matrix
+    std::vector<double> toGltfMatrix(const Matrix& m)
+    {
+        return std::vector<double>(&m._11, &m._11 + 16);
+    }
+}
+
+// Subtrees are contiguous ranges that hold exactly the descendants of their root
+TEST(SceneGraphPreorder)
+{
+    std::mt19937 rng(5);
+    SceneGraph graph;
+    buildRandomGraph(graph, 2000, rng);
+
+    uint32_t badRanges = 0;
+    for (uint32_t node = 0; node < graph.size(); ++node)
+    {
+        for (uint32_t other = 0; other < graph.size(); ++other)
+        {
+            bool descendant = false;
+            for (int32_t p = graph.getParent(other); p != SceneGraph::kNoParent && !descendant; p = graph.getParent(uint32_t(p)))
+                descendant = uint32_t(p) == node;
+
+            const bool inRange = other > node && other < graph.getSubtreeEnd(node);
+            badRanges += descendant != inRange ? 1 : 0;
+        }
+    }
+
+    CHECK(badRanges == 0);
+}
+
+// Frames of random edits through every setter: the dirty update must reach every moved subtree and give
+// exactly what recomputing every node gives
+TEST(SceneGraphDirtyUpdateMatchesFull)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+    SceneGraph graph;
+    buildRandomGraph(graph, 20000, rng);
+    CHECK(graph.update() == graph.size());
+    CHECK(graph.update() == 0);
+
+    float maxError = 0.0f;
+    uint32_t badCounts = 0;
+
+    for (uint32_t frame = 0; frame < 50; ++frame)
+    {
+        std::vector<uint8_t> moved(graph.size(), 0);
+
+        for (uint32_t d = 0; d < 200; ++d)
+        {
+            const uint32_t node = rng() % graph.size();
+            moved[node] = 1;
+
+            switch (rng() % 4)
+            {
+            case 0: graph.setTranslation(node, graph.getTranslation(node) + Vector3(offset(rng), offset(rng), offset(rng)) * 0.01f); break;
+            case 1: graph.setRotation(node, Quaternion::CreateFromYawPitchRoll(offset(rng), offset(rng), offset(rng))); break;
+            case 2: graph.setScale(node, Vector3(1.0f + offset(rng) * 0.1f, 1.0f, 1.0f)); break;
+            default: graph.setLocal(node, Vector3(offset(rng), 0.0f, 0.0f), Quaternion::Identity, Vector3::One); break;
+            }
+        }
+
+        // Nodes updated: everything under the outermost moved nodes
+        uint32_t expected = 0;
+        for (uint32_t node = 0; node < graph.size();)
+        {
+            if (moved[node])
+            {
+                expected += graph.getSubtreeEnd(node) - node;
+                node = graph.getSubtreeEnd(node);
+            }
+            else
+            {
+                ++node;
+            }
+        }
+
+        badCounts += graph.update() == expected ? 0 : 1;
+
+        SceneGraph reference = graph;
+        reference.updateAll();
+
+        for (uint32_t i = 0; i < graph.size(); ++i)
+            maxError = std::max(maxError, maxDifference(graph.getWorld(i), reference.getWorld(i)));
+    }
+
+    CHECK(badCounts == 0);
+    CHECK(maxError == 0.0f);
+}
+
+// glTF node matrices: a TRS one comes in as TRS, a sheared one is kept as a matrix so the shear reaches the
+// children's worlds, and editing it turns it back into TRS
+TEST(SceneGraphGltfMatrix)
+{
+    const Matrix trs = Matrix::CreateScale(2.0f, 0.5f, 3.0f) * Matrix::CreateFromYawPitchRoll(0.3f, -0.7f, 1.1f) *
+        Matrix::CreateTranslation(Vector3(10.0f, -4.0f, 250.0f));
+    const Matrix mirrored = Matrix::CreateScale(-1.0f, 1.0f, 1.0f) * Matrix::CreateRotationY(0.5f);
+
+    // x picks up 0.5 of y: no scale and rotation give that
+    Matrix shear;
+    shear._21 = 0.5f;
+    const Matrix sheared = shear * Matrix::CreateRotationZ(0.4f) * Matrix::CreateTranslation(Vector3(1.0f, 2.0f, 3.0f));
+
+    const Vector3 childTranslation(0.0f, 1.0f, 0.0f);
+
+    tinygltf::Model model;
+    model.nodes.resize(4);
+    model.nodes[0].matrix = toGltfMatrix(trs);
+    model.nodes[1].matrix = toGltfMatrix(mirrored);
+    model.nodes[2].matrix = toGltfMatrix(sheared);
+    model.nodes[2].children = { 3 };
+    model.nodes[3].translation = { childTranslation.x, childTranslation.y, childTranslation.z };
+    model.nodes[3].mesh = 0;
+
+    SceneGraph graph;
+    graph.importGltf(model, SceneGraph::kNoParent);
+    graph.update();
+    REQUIRE(graph.size() == 4);
+
+    CHECK(!graph.hasLocalMatrix(0));
+    CHECK(maxDifference(graph.getWorld(0), trs) < 1e-3f);
+    CHECK(std::fabs(graph.getScale(0).y - 0.5f) < 1e-5f);
+
+    CHECK(!graph.hasLocalMatrix(1));
+    CHECK(maxDifference(graph.getWorld(1), mirrored) < 1e-5f);
+
+    CHECK(graph.hasLocalMatrix(2));
+    CHECK(graph.getWorld(2) == sheared);
+    CHECK(graph.getParent(3) == 2 && graph.getMesh(3) == 0);
+    CHECK(maxDifference(graph.getWorld(3), Matrix::CreateTranslation(childTranslation) * sheared) < 1e-6f);
+
+    // The child's origin sits one unit up in the sheared frame, so it moved half a unit along x too
+    const Vector3 childOrigin = graph.getWorld(3).Translation();
+    const Vector3 unsheared = Vector3::Transform(childTranslation, Matrix::CreateRotationZ(0.4f) * Matrix::CreateTranslation(Vector3(1.0f, 2.0f, 3.0f)));
+    CHECK((childOrigin - unsheared).Length() > 0.4f);
+
+    graph.setTranslation(2, Vector3::Zero);
+    graph.update();
+    CHECK(!graph.hasLocalMatrix(2));
+    CHECK(graph.getWorld(2).Translation() == Vector3::Zero);
+}
+
+// Matrix nodes turned back into TRS give their slot up, and the nodes still holding a matrix keep their own
+TEST(SceneGraphLocalMatrixRemoval)
+{
+    SceneGraph graph;
+    std::vector<Matrix> locals;
+    std::vector<bool> kept;
+
+    auto addSheared = [&]()
+        {
+            Matrix shear;
+            shear._21 = 0.1f * float(locals.size() + 1);
+            locals.push_back(shear * Matrix::CreateTranslation(Vector3(float(locals.size()), 0.0f, 0.0f)));
+            kept.push_back(true);
+            graph.addNode(SceneGraph::kNoParent, locals.back());
+        };
+
+    // Every node still flagged in kept has its own matrix, the others are TRS
+    auto matches = [&]()
+        {
+            uint32_t wrong = 0;
+            for (uint32_t node = 0; node < graph.size(); ++node)
+                wrong += (graph.hasLocalMatrix(node) != kept[node] || (kept[node] && graph.getLocalMatrix(node) != locals[node])) ? 1 : 0;
+
+            return wrong == 0;
+        };
+
+    for (uint32_t i = 0; i < 5; ++i)
+        addSheared();
+
+    REQUIRE(graph.getNumLocalMatrices() == 5);
+
+    // First, last, middle, then one that already went: each setter, and setLocal, frees exactly one slot.
+    // A new matrix node after each one reuses the freed storage.
+    graph.setTranslation(0, Vector3::Zero);
+    kept[0] = false;
+    CHECK(graph.getNumLocalMatrices() == 4 && matches());
+    addSheared();
+    CHECK(graph.getNumLocalMatrices() == 5 && matches());
+
+    graph.setRotation(4, Quaternion::Identity);
+    kept[4] = false;
+    CHECK(graph.getNumLocalMatrices() == 4 && matches());
+    addSheared();
+    CHECK(graph.getNumLocalMatrices() == 5 && matches());
+
+    graph.setScale(2, Vector3::One);
+    kept[2] = false;
+    CHECK(graph.getNumLocalMatrices() == 4 && matches());
+
+    graph.setLocal(0, Vector3::One, Quaternion::Identity, Vector3::One);
+    CHECK(graph.getNumLocalMatrices() == 4 && matches());
+
+    for (uint32_t node : { 1u, 3u, 5u, 6u })
+        graph.setLocal(node, Vector3::Zero, Quaternion::Identity, Vector3::One);
+    CHECK(graph.getNumLocalMatrices() == 0);
+
+    // Edited back and forth, the array does not grow
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        const uint32_t node = graph.addNode(SceneGraph::kNoParent, locals[i % 5]);
+        graph.setTranslation(node, Vector3::Zero);
+    }
+
+    CHECK(graph.getNumLocalMatrices() == 0);
+}
+
+// Node chains deeper than any call stack import fine, and siblings still come out in glTF order
+TEST(SceneGraphGltfDeepChain)
+{
+    constexpr uint32_t kDepth = 200000;
+
+    tinygltf::Model model;
+    model.nodes.resize(kDepth);
+    for (uint32_t i = 0; i + 1 < kDepth; ++i)
+        model.nodes[i].children = { int(i + 1) };
+    model.nodes[kDepth - 1].mesh = 7;
+
+    SceneGraph graph;
+    graph.importGltf(model, SceneGraph::kNoParent);
+    REQUIRE(graph.size() == kDepth);
+
+    uint32_t badParents = 0;
+    for (uint32_t node = 0; node < kDepth; ++node)
+        badParents += (graph.getParent(node) != int32_t(node) - 1 || graph.getSubtreeEnd(node) != kDepth) ? 1 : 0;
+
+    CHECK(badParents == 0);
+    CHECK(graph.getMesh(kDepth - 1) == 7);
+
+    // 0 -> { 3, 1 }, 3 -> { 2 }: preorder is 0, 3, 2, 1
+    tinygltf::Model tree;
+    tree.nodes.resize(4);
+    tree.nodes[0].children = { 3, 1 };
+    tree.nodes[3].children = { 2 };
+    for (int i = 0; i < 4; ++i)
+        tree.nodes[i].mesh = i;
+
+    graph.clear();
+    graph.importGltf(tree, SceneGraph::kNoParent);
+    REQUIRE(graph.size() == 4);
+    CHECK(graph.getMesh(0) == 0 && graph.getMesh(1) == 3 && graph.getMesh(2) == 2 && graph.getMesh(3) == 1);
+    CHECK(graph.getParent(1) == 0 && graph.getParent(2) == 1 && graph.getParent(3) == 0);
+    CHECK(graph.getSubtreeEnd(1) == 3 && graph.getSubtreeEnd(0) == 4);
+}
+
+// Dirty propagation against recomputing every node, 100k nodes with 1% moved per frame
+BENCHMARK(SceneGraph100k)
+{
+    constexpr uint32_t kNodes = 100000;
+    constexpr uint32_t kFrames = 100;
+    constexpr uint32_t kDirtyPerFrame = kNodes / 100;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+    SceneGraph graph;
+    buildRandomGraph(graph, kNodes, rng);
+    graph.update();
+
+    double dirtyMs = 0.0;
+    uint64_t totalUpdated = 0;
+
+    for (uint32_t frame = 0; frame < kFrames; ++frame)
+    {
+        for (uint32_t d = 0; d < kDirtyPerFrame; ++d)
+        {
+            const uint32_t node = rng() % kNodes;
+            graph.setTranslation(node, graph.getTranslation(node) + Vector3(offset(rng), offset(rng), offset(rng)) * 0.01f);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        totalUpdated += graph.update();
+        dirtyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < kFrames; ++frame)
+        graph.updateAll();
+    const double fullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("  %u dirty per frame: %.0f nodes updated in %.3f ms, full update %.3f ms\n", kDirtyPerFrame,
+        double(totalUpdated) / kFrames, dirtyMs / kFrames, fullMs / kFrames);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Self-registering cases for the CPU side of the engine: no device, no window, no Application.
+// Tests.exe runs every TEST and exits with 1 when a CHECK failed. "Tests.exe --bench" runs the
+// BENCHMARKs as well; any other argument only runs the cases whose name contains it.
+namespace Tests
+{
+    using CaseFn = void (*)();
+
+    struct Case
+    {
+        const char* name = nullptr;
+        CaseFn fn = nullptr;
+        bool benchmark = false;
+    };
+
+    std::vector<Case>& getCases();
+    void fail(const char* file, int line, const char* expression);
+
+    struct Registrar
+    {
+        Registrar(const char* name, CaseFn fn, bool benchmark) { getCases().push_back(Case{ name, fn, benchmark }); }
+    };
+}
+
+#define TEST(name) \
+    static void name(); \
+    static Tests::Registrar name##Registrar(#name, name, false); \
+    static void name()
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static Tests::Registrar name##Registrar(#name, name, true); \
+    static void name()
+
+// CHECK records the failure and carries on; REQUIRE leaves the case, for checks later ones depend on
+#define CHECK(expression) do { if (!(expression)) Tests::fail(__FILE__, __LINE__, #expression); } while (0)
+#define REQUIRE(expression) do { if (!(expression)) { Tests::fail(__FILE__, __LINE__, #expression); return; } } while (0)
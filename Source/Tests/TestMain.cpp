@@ -0,0 +1,90 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstring>
+
+namespace
+{
+    uint32_t numFailures = 0;
+}
+
+std::vector<Tests::Case>& Tests::getCases()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void Tests::fail(const char* file, int line, const char* expression)
+{
+    printf("  %s(%d): failed: %s\n", file, line, expression);
+    ++numFailures;
+}
+
+// The engine's LOG() lines go to the console instead of the debugger output and the UI log
+void log(const char file[], int line, const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    printf("  ");
+    vprintf(format, ap);
+    printf("\n");
+    va_end(ap);
+}
+
+int main(int argc, char** argv)
+{
+    bool runBenchmarks = false;
+    const char* filter = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+            runBenchmarks = true;
+        else
+            filter = argv[i];
+    }
+
+#ifdef _DEBUG
+    // Timings from an unoptimised build say little about the engine
+    if (runBenchmarks)
+        printf("Benchmarks in a Debug build: run the Release one for comparable numbers\n");
+#endif
+
+    // Registration order depends on the link order: tests first, then benchmarks, each by name
+    std::vector<Tests::Case> cases = Tests::getCases();
+    std::sort(cases.begin(), cases.end(), [](const Tests::Case& a, const Tests::Case& b)
+        {
+            if (a.benchmark != b.benchmark)
+                return !a.benchmark;
+            return strcmp(a.name, b.name) < 0;
+        });
+
+    uint32_t numRun = 0;
+    uint32_t numFailed = 0;
+
+    for (const Tests::Case& testCase : cases)
+    {
+        if (testCase.benchmark && !runBenchmarks)
+            continue;
+        if (filter && !strstr(testCase.name, filter))
+            continue;
+
+        printf("[ RUN  ] %s\n", testCase.name);
+        fflush(stdout);
+
+        const uint32_t failuresBefore = numFailures;
+        testCase.fn();
+
+        const bool passed = numFailures == failuresBefore;
+        printf("[ %s ] %s\n", passed ? " OK " : "FAIL", testCase.name);
+
+        ++numRun;
+        numFailed += passed ? 0 : 1;
+    }
+
+    printf("%u cases run, %u failed\n", numRun, numFailed);
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "UploadScheduler.h"
+
+#include <deque>
+#include <random>
+
+namespace
+{
+    // Copy queue stand-in: signalled tickets complete in order, whenever the test says so
+    struct FakeFence
+    {
+        std::deque<uint64_t> pending;
+        uint64_t completed = 0;
+
+        void signal(uint64_t ticket) { pending.push_back(ticket); }
+
+        void completeOldest()
+        {
+            if (pending.empty())
+                return;
+            completed = pending.front();
+            pending.pop_front();
+        }
+    };
+
+    struct StagedUpload
+    {
+        uint64_t ticket = 0;
+        size_t offset = 0;
+        size_t size = 0;
+        uint32_t tag = 0;
+    };
+}
+
+TEST(UploadSchedulerTickets)
+{
+    UploadScheduler scheduler;
+    scheduler.init(1024);
+
+    CHECK(scheduler.allocateStaging(600, 256) == 0);
+    scheduler.addUpload(600);
+
+    // The open batch owns its staging: no room until it retires
+    CHECK(scheduler.allocateStaging(600, 256) == UploadScheduler::INVALID_OFFSET);
+
+    CHECK(scheduler.closeBatch() == 1);
+    CHECK(scheduler.getLastSubmittedTicket() == 1);
+    CHECK(scheduler.getOpenTicket() == 2);
+
+    scheduler.retire(0);
+    CHECK(scheduler.allocateStaging(600, 256) == UploadScheduler::INVALID_OFFSET);
+
+    // Nothing in flight any more: the ring starts over
+    scheduler.retire(1);
+    CHECK(scheduler.getStagingUsed() == 0);
+    CHECK(scheduler.allocateStaging(600, 256) == 0);
+    scheduler.addUpload(600);
+    scheduler.addUpload(10, true);
+
+    CHECK(scheduler.closeBatch() == 2);
+    CHECK(scheduler.closeBatch() == 0);
+
+    const UploadScheduler::Stats& stats = scheduler.getStats();
+    CHECK(stats.submissions == 2);
+    CHECK(stats.uploads == 3);
+    CHECK(stats.bytes == 1210);
+    CHECK(stats.dedicatedStaging == 1);
+    CHECK(stats.lastBatchUploads == 2);
+    CHECK(stats.maxBatchUploads == 2);
+}
+
+// UploadManager's pattern against a fake fence that lags a few batches behind: staging is tagged when
+// written and must still hold the tag when the fence says the copy ran.
+TEST(UploadSchedulerFakeFence)
+{
+    constexpr size_t kCapacity = 1u << 20;
+    constexpr size_t kAlignment = 512;
+
+    UploadScheduler scheduler;
+    scheduler.init(kCapacity);
+
+    FakeFence fence;
+    std::vector<uint32_t> staging(kCapacity / 4);
+    std::deque<StagedUpload> inFlight;
+    std::mt19937 rng(7);
+
+    uint64_t expectedTicket = 1;
+    uint64_t uploads = 0;
+    uint64_t dedicated = 0;
+    uint64_t bytes = 0;
+    uint32_t tag = 0;
+
+    uint32_t badTickets = 0;
+    uint32_t outOfBounds = 0;
+    uint32_t overwritten = 0;
+
+    auto completeOldest = [&]()
+        {
+            fence.completeOldest();
+
+            // The copies of every completed batch read their staging just now
+            while (!inFlight.empty() && inFlight.front().ticket <= fence.completed)
+            {
+                const StagedUpload& upload = inFlight.front();
+                for (size_t i = upload.offset / 4; i < (upload.offset + upload.size) / 4; ++i)
+                {
+                    if (staging[i] != upload.tag)
+                    {
+                        ++overwritten;
+                        break;
+                    }
+                }
+                inFlight.pop_front();
+            }
+        };
+
+    for (uint32_t frame = 0; frame < 2000; ++frame)
+    {
+        const uint32_t numUploads = rng() % 12;
+        for (uint32_t u = 0; u < numUploads; ++u)
+        {
+            const size_t size = 4 * size_t(1 + rng() % (rng() % 8 == 0 ? 65536 : 4096));
+
+            size_t offset = scheduler.allocateStaging(size, kAlignment);
+            if (offset == UploadScheduler::INVALID_OFFSET)
+            {
+                scheduler.retire(fence.completed);
+                offset = scheduler.allocateStaging(size, kAlignment);
+            }
+
+            bytes += size;
+            ++uploads;
+
+            if (offset == UploadScheduler::INVALID_OFFSET)
+            {
+                scheduler.addUpload(size, true);
+                ++dedicated;
+                continue;
+            }
+
+            if (offset % kAlignment != 0 || offset + size > kCapacity)
+            {
+                ++outOfBounds;
+                continue;
+            }
+
+            ++tag;
+            std::fill(staging.begin() + offset / 4, staging.begin() + (offset + size) / 4, tag);
+            inFlight.push_back(StagedUpload{ scheduler.getOpenTicket(), offset, size, tag });
+            scheduler.addUpload(size);
+        }
+
+        // preRender: submit, then the GPU catches up to two batches behind
+        const uint64_t ticket = scheduler.closeBatch();
+        if (ticket != 0)
+        {
+            badTickets += ticket == expectedTicket ? 0 : 1;
+            expectedTicket = ticket + 1;
+            fence.signal(ticket);
+        }
+        else
+        {
+            badTickets += numUploads == 0 ? 0 : 1;
+        }
+
+        while (fence.pending.size() > 2)
+            completeOldest();
+
+        scheduler.retire(fence.completed);
+    }
+
+    while (!fence.pending.empty())
+        completeOldest();
+    scheduler.retire(fence.completed);
+
+    CHECK(badTickets == 0);
+    CHECK(outOfBounds == 0);
+    CHECK(overwritten == 0);
+    CHECK(inFlight.empty());
+    CHECK(scheduler.getStagingUsed() == 0);
+
+    const UploadScheduler::Stats& stats = scheduler.getStats();
+    CHECK(stats.uploads == uploads);
+    CHECK(stats.bytes == bytes);
+    CHECK(stats.dedicatedStaging == dedicated);
+    CHECK(stats.submissions == expectedTicket - 1);
+
+    // The ring mostly serves uploads; only the odd burst spills into dedicated buffers
+    CHECK(dedicated < uploads / 10);
+}
@@ -0,0 +1,231 @@
+#include "Globals.h"
+#include "TestFramework.h"
+
+#include "VertexPacking.h"
+#include "BasicMesh.h"
+
+#include <DirectXPackedVector.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    // atan2 of |a x b| and a . b in double: acos of a dot product near 1 loses the small angles measured here
+    double angleDegrees(const float a[3], const float b[3])
+    {
+        const double cross[3] =
+        {
+            double(a[1]) * b[2] - double(a[2]) * b[1],
+            double(a[2]) * b[0] - double(a[0]) * b[2],
+            double(a[0]) * b[1] - double(a[1]) * b[0],
+        };
+        const double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        const double cosine = double(a[0]) * b[0] + double(a[1]) * b[1] + double(a[2]) * b[2];
+        return std::atan2(sine, cosine) * 180.0 / 3.14159265358979323846;
+    }
+
+    void randomUnitVector(std::mt19937& rng, float v[3])
+    {
+        std::normal_distribution<float> normal;
+
+        float length = 0.0f;
+        do
+        {
+            v[0] = normal(rng);
+            v[1] = normal(rng);
+            v[2] = normal(rng);
+            length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        } while (length < 1e-6f);
+
+        for (uint32_t k = 0; k < 3; ++k)
+            v[k] /= length;
+    }
+}
+
+// Worst encode/decode error over a million random unit vectors, the six axes and the octahedron's folds:
+// normals and tangents within 0.01 degrees, handedness exact, positions within half a 16-bit step
+TEST(VertexPackingError)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-3.0f, 5.0f);
+
+    constexpr float kMin = -3.0f;
+    constexpr float kExtent = 8.0f;
+
+    double maxNormalError = 0.0;
+    double maxTangentError = 0.0;
+    double maxPositionError = 0.0;
+    uint32_t handednessErrors = 0;
+
+    for (uint32_t i = 0; i < 1000000; ++i)
+    {
+        float n[3];
+        if (i < 6)
+        {
+            n[0] = n[1] = n[2] = 0.0f;
+            n[i % 3] = i < 3 ? 1.0f : -1.0f;
+        }
+        else if (i < 14)
+        {
+            // Lower hemisphere diagonals land on the folded corners of the map
+            n[0] = (i & 1) ? 0.57735f : -0.57735f;
+            n[1] = (i & 2) ? 0.57735f : -0.57735f;
+            n[2] = (i & 4) ? 0.57735f : -0.57735f;
+        }
+        else
+        {
+            randomUnitVector(rng, n);
+        }
+
+        int16_t encodedNormal[2];
+        float decodedNormal[3];
+        VertexPacking::encodeOctahedral(n, encodedNormal);
+        VertexPacking::decodeOctahedral(encodedNormal, decodedNormal);
+        maxNormalError = std::max(maxNormalError, angleDegrees(n, decodedNormal));
+
+        const float handedness = (rng() & 1) ? 1.0f : -1.0f;
+        uint16_t encodedTangent[2];
+        float decodedTangent[3];
+        float decodedHandedness = 0.0f;
+        VertexPacking::encodeTangent(n, handedness, encodedTangent);
+        VertexPacking::decodeTangent(encodedTangent, decodedTangent, decodedHandedness);
+        maxTangentError = std::max(maxTangentError, angleDegrees(n, decodedTangent));
+        handednessErrors += decodedHandedness == handedness ? 0 : 1;
+
+        const float p = position(rng);
+        const float decodedPosition = VertexPacking::dequantizeUnorm16(VertexPacking::quantizeUnorm16(p, kMin, kExtent), kMin, kExtent);
+        maxPositionError = std::max(maxPositionError, double(std::abs(decodedPosition - p)));
+    }
+
+    const double positionBound = kExtent / 65535.0 * 0.5;
+    printf("  normal %.5f deg, tangent %.5f deg, position %.3g (half step %.3g)\n", maxNormalError, maxTangentError,
+        maxPositionError, positionBound);
+
+    CHECK(maxNormalError < 0.01);
+    CHECK(maxTangentError < 0.01);
+    CHECK(handednessErrors == 0);
+    CHECK(maxPositionError <= positionBound * 1.01);
+
+    // Out of bounds positions clamp instead of wrapping
+    CHECK(VertexPacking::quantizeUnorm16(kMin - 1.0f, kMin, kExtent) == 0);
+    CHECK(VertexPacking::quantizeUnorm16(kMin + kExtent + 1.0f, kMin, kExtent) == 0xFFFF);
+}
+
+// BasicMesh::packVertices writes what the packed input layouts read: decoding each field gives the source vertex
+// back, positions exactly for Packed and within one 16-bit step of the bounds for PackedQuantized
+TEST(PackedVertexLayouts)
+{
+    CHECK(BasicMesh::getVertexStride(BasicMesh::VertexFormat::Packed) == sizeof(BasicMesh::PackedVertex));
+    CHECK(BasicMesh::getVertexStride(BasicMesh::VertexFormat::PackedQuantized) == sizeof(BasicMesh::QuantizedVertex));
+    CHECK(sizeof(BasicMesh::PackedVertex) == 24 && sizeof(BasicMesh::QuantizedVertex) == 20);
+
+    constexpr size_t kCount = 4096;
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<BasicMesh::Vertex> vertices(kCount);
+    Vector3 boundsMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector3 boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (BasicMesh::Vertex& vertex : vertices)
+    {
+        float n[3];
+        float t[3];
+        randomUnitVector(rng, n);
+        randomUnitVector(rng, t);
+
+        vertex.position = Vector3(unit(rng) * 20.0f - 10.0f, unit(rng) * 4.0f, unit(rng) * 2.0f - 7.0f);
+        vertex.texCoord0 = Vector2(unit(rng), unit(rng));
+        vertex.normal = Vector3(n[0], n[1], n[2]);
+        vertex.tangent = Vector4(t[0], t[1], t[2], (rng() & 1) ? 1.0f : -1.0f);
+
+        boundsMin = Vector3::Min(boundsMin, vertex.position);
+        boundsMax = Vector3::Max(boundsMax, vertex.position);
+    }
+
+    const Vector3 extent = boundsMax - boundsMin;
+    const float quantizedTolerance = std::max(extent.x, std::max(extent.y, extent.z)) / 65535.0f;
+
+    for (BasicMesh::VertexFormat format : { BasicMesh::VertexFormat::Packed, BasicMesh::VertexFormat::PackedQuantized })
+    {
+        const uint32_t stride = BasicMesh::getVertexStride(format);
+        std::vector<uint8_t> packed(kCount * stride);
+        BasicMesh::packVertices(vertices.data(), kCount, format, boundsMin, boundsMax, packed.data());
+
+        uint32_t badPositions = 0;
+        uint32_t badTexCoords = 0;
+        uint32_t badNormals = 0;
+        uint32_t badTangents = 0;
+
+        for (size_t i = 0; i < kCount; ++i)
+        {
+            const BasicMesh::Vertex& source = vertices[i];
+
+            float position[3];
+            uint16_t texCoord0[2];
+            int16_t normal[2];
+            uint16_t tangent[2];
+            float tolerance = 0.0f;
+
+            if (format == BasicMesh::VertexFormat::Packed)
+            {
+                BasicMesh::PackedVertex vertex;
+                memcpy(&vertex, packed.data() + i * stride, sizeof(vertex));
+
+                position[0] = vertex.position.x;
+                position[1] = vertex.position.y;
+                position[2] = vertex.position.z;
+                memcpy(texCoord0, vertex.texCoord0, sizeof(texCoord0));
+                memcpy(normal, vertex.normal, sizeof(normal));
+                memcpy(tangent, vertex.tangent, sizeof(tangent));
+            }
+            else
+            {
+                BasicMesh::QuantizedVertex vertex;
+                memcpy(&vertex, packed.data() + i * stride, sizeof(vertex));
+
+                position[0] = VertexPacking::dequantizeUnorm16(vertex.position[0], boundsMin.x, extent.x);
+                position[1] = VertexPacking::dequantizeUnorm16(vertex.position[1], boundsMin.y, extent.y);
+                position[2] = VertexPacking::dequantizeUnorm16(vertex.position[2], boundsMin.z, extent.z);
+                memcpy(texCoord0, vertex.texCoord0, sizeof(texCoord0));
+                memcpy(normal, vertex.normal, sizeof(normal));
+                memcpy(tangent, vertex.tangent, sizeof(tangent));
+
+                tolerance = quantizedTolerance;
+                badPositions += vertex.position[3] == 0xFFFF ? 0 : 1;
+            }
+
+            badPositions += (std::abs(position[0] - source.position.x) <= tolerance &&
+                std::abs(position[1] - source.position.y) <= tolerance &&
+                std::abs(position[2] - source.position.z) <= tolerance) ? 0 : 1;
+
+            // Half floats keep 11 significant bits: within 2^-11 on [0, 1]
+            badTexCoords += (std::abs(DirectX::PackedVector::XMConvertHalfToFloat(texCoord0[0]) - source.texCoord0.x) <= 1.0f / 2048.0f &&
+                std::abs(DirectX::PackedVector::XMConvertHalfToFloat(texCoord0[1]) - source.texCoord0.y) <= 1.0f / 2048.0f) ? 0 : 1;
+
+            float decodedNormal[3];
+            VertexPacking::decodeOctahedral(normal, decodedNormal);
+            const float sourceNormal[3] = { source.normal.x, source.normal.y, source.normal.z };
+            badNormals += angleDegrees(sourceNormal, decodedNormal) < 0.01 ? 0 : 1;
+
+            float decodedTangent[3];
+            float handedness = 0.0f;
+            VertexPacking::decodeTangent(tangent, decodedTangent, handedness);
+            const float sourceTangent[3] = { source.tangent.x, source.tangent.y, source.tangent.z };
+            badTangents += (angleDegrees(sourceTangent, decodedTangent) < 0.01 && handedness == source.tangent.w) ? 0 : 1;
+        }
+
+        printf("  %s: %u bad positions, %u bad uvs, %u bad normals, %u bad tangents\n", BasicMesh::getVertexFormatName(format),
+            badPositions, badTexCoords, badNormals, badTangents);
+
+        CHECK(badPositions == 0);
+        CHECK(badTexCoords == 0);
+        CHECK(badNormals == 0);
+        CHECK(badTangents == 0);
+    }
+}
@@ -16,6 +16,8 @@ public:
     void update() override;
     bool cleanUp() override { return true; }
 
+    bool canRunOnWorker(ModuleStage stage) const override { return stage == ModuleStage::Update; }
+
     // ---- API de "Game Time" (tipo Unity::Time) ----
     uint64_t getFrameCount() const { return frameCount; }
 
@@ -0,0 +1,345 @@
+#include "Globals.h"
+#include "UploadManager.h"
+
+#include "d3dx12.h"
+
+#include <chrono>
+#include <cstring>
+
+UploadManager::~UploadManager()
+{
+    cleanUp();
+}
+
+bool UploadManager::init(ID3D12Device* newDevice, size_t stagingSize)
+{
+    if (!newDevice)
+        return false;
+
+    device = newDevice;
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+    if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue))))
+        return false;
+
+    queue->SetName(L"Upload Copy Queue");
+
+    CommandAllocator first;
+    if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&first.allocator))))
+        return false;
+
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, first.allocator.Get(), nullptr, IID_PPV_ARGS(&commandList))))
+        return false;
+
+    commandList->Close();
+    allocators.push_back(std::move(first));
+
+    if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+        return false;
+
+    fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!fenceEvent)
+        return false;
+
+    staging = createStaging(stagingSize, reinterpret_cast<void**>(&stagingData));
+    if (!staging)
+        return false;
+
+    staging->SetName(L"Upload Staging Ring");
+
+    scheduler.init(stagingSize);
+    openAllocator = SIZE_MAX;
+    lastGpuWait = 0;
+
+    return true;
+}
+
+void UploadManager::cleanUp()
+{
+    if (queue && fence)
+        waitIdle();
+
+    if (staging && stagingData)
+        staging->Unmap(0, nullptr);
+
+    stagingData = nullptr;
+    staging.Reset();
+
+    dedicated.clear();
+    allocators.clear();
+    openAllocator = SIZE_MAX;
+
+    if (fenceEvent)
+    {
+        CloseHandle(fenceEvent);
+        fenceEvent = nullptr;
+    }
+
+    fence.Reset();
+    commandList.Reset();
+    queue.Reset();
+    device.Reset();
+}
+
+UploadTicket UploadManager::uploadBuffer(ID3D12Resource* dst, const void* data, size_t size)
+{
+    if (!dst || !data || size == 0)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!beginBatch())
+        return 0;
+
+    size_t offset = scheduler.allocateStaging(size, D3D12_STANDARD_MAXIMUM_ELEMENT_ALIGNMENT_BYTE_ALIGNMENT);
+    if (offset == UploadScheduler::INVALID_OFFSET)
+    {
+        retireLocked();
+        offset = scheduler.allocateStaging(size, D3D12_STANDARD_MAXIMUM_ELEMENT_ALIGNMENT_BYTE_ALIGNMENT);
+    }
+
+    if (offset != UploadScheduler::INVALID_OFFSET)
+    {
+        std::memcpy(stagingData + offset, data, size);
+        commandList->CopyBufferRegion(dst, 0, staging.Get(), UINT64(offset), UINT64(size));
+        scheduler.addUpload(size);
+    }
+    else
+    {
+        // Ring full: stage through a buffer of its own instead of waiting
+        void* mapped = nullptr;
+        DedicatedStaging extra;
+        extra.buffer = createStaging(size, &mapped);
+        if (!extra.buffer)
+            return 0;
+
+        std::memcpy(mapped, data, size);
+        extra.buffer->Unmap(0, nullptr);
+
+        commandList->CopyBufferRegion(dst, 0, extra.buffer.Get(), 0, UINT64(size));
+
+        extra.ticket = scheduler.getOpenTicket();
+        dedicated.push_back(std::move(extra));
+        scheduler.addUpload(size, true);
+    }
+
+    return scheduler.getOpenTicket();
+}
+
+UploadTicket UploadManager::uploadTexture(ID3D12Resource* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT numSubresources)
+{
+    if (!dst || !subresources || numSubresources == 0)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!beginBatch())
+        return 0;
+
+    const size_t size = size_t(GetRequiredIntermediateSize(dst, 0, numSubresources));
+
+    size_t offset = scheduler.allocateStaging(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    if (offset == UploadScheduler::INVALID_OFFSET)
+    {
+        retireLocked();
+        offset = scheduler.allocateStaging(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    }
+
+    ID3D12Resource* source = staging.Get();
+    bool isDedicated = false;
+
+    if (offset == UploadScheduler::INVALID_OFFSET)
+    {
+        DedicatedStaging extra;
+        extra.buffer = createStaging(size, nullptr);
+        if (!extra.buffer)
+            return 0;
+
+        extra.ticket = scheduler.getOpenTicket();
+        source = extra.buffer.Get();
+        dedicated.push_back(std::move(extra));
+
+        offset = 0;
+        isDedicated = true;
+    }
+
+    if (UpdateSubresources(commandList.Get(), dst, source, UINT64(offset), 0, numSubresources, subresources) == 0)
+        return 0;
+
+    scheduler.addUpload(size, isDedicated);
+    return scheduler.getOpenTicket();
+}
+
+UploadTicket UploadManager::submit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return submitLocked();
+}
+
+void UploadManager::gpuWait(ID3D12CommandQueue* target)
+{
+    if (!target)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const UploadTicket last = scheduler.getLastSubmittedTicket();
+    if (last > lastGpuWait)
+    {
+        target->Wait(fence.Get(), last);
+        lastGpuWait = last;
+    }
+}
+
+bool UploadManager::isComplete(UploadTicket ticket) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !fence || fence->GetCompletedValue() >= ticket;
+}
+
+void UploadManager::wait(UploadTicket ticket)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!fence || ticket == 0)
+        return;
+
+    if (ticket >= scheduler.getOpenTicket())
+        submitLocked();
+
+    if (ticket > scheduler.getLastSubmittedTicket())
+        return;
+
+    if (fence->GetCompletedValue() < ticket)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        fence->SetEventOnCompletion(ticket, fenceEvent);
+        WaitForSingleObject(fenceEvent, INFINITE);
+
+        scheduler.addStall(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    retireLocked();
+}
+
+void UploadManager::waitIdle()
+{
+    UploadTicket last = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        last = submitLocked();
+    }
+
+    wait(last);
+}
+
+UploadScheduler::Stats UploadManager::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return scheduler.getStats();
+}
+
+bool UploadManager::beginBatch()
+{
+    if (openAllocator != SIZE_MAX)
+        return true;
+
+    if (!commandList)
+        return false;
+
+    const UploadTicket completed = fence->GetCompletedValue();
+
+    size_t index = SIZE_MAX;
+    for (size_t i = 0; i < allocators.size(); ++i)
+    {
+        if (allocators[i].ticket <= completed)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if (index == SIZE_MAX)
+    {
+        CommandAllocator extra;
+        if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&extra.allocator))))
+            return false;
+
+        index = allocators.size();
+        allocators.push_back(std::move(extra));
+    }
+
+    CommandAllocator& entry = allocators[index];
+    entry.allocator->Reset();
+    commandList->Reset(entry.allocator.Get(), nullptr);
+
+    // Busy until the batch it records retires
+    entry.ticket = scheduler.getOpenTicket();
+    openAllocator = index;
+
+    return true;
+}
+
+UploadTicket UploadManager::submitLocked()
+{
+    if (openAllocator == SIZE_MAX)
+        return scheduler.getLastSubmittedTicket();
+
+    commandList->Close();
+    openAllocator = SIZE_MAX;
+
+    const UploadTicket ticket = scheduler.closeBatch();
+    if (ticket == 0)
+        return scheduler.getLastSubmittedTicket();
+
+    ID3D12CommandList* lists[] = { commandList.Get() };
+    queue->ExecuteCommandLists(1, lists);
+    queue->Signal(fence.Get(), ticket);
+
+    retireLocked();
+    return ticket;
+}
+
+void UploadManager::retireLocked()
+{
+    const UploadTicket completed = fence->GetCompletedValue();
+    scheduler.retire(completed);
+
+    for (size_t i = 0; i < dedicated.size();)
+    {
+        if (dedicated[i].ticket <= completed)
+        {
+            dedicated[i] = std::move(dedicated.back());
+            dedicated.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> UploadManager::createStaging(size_t size, void** mapped)
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer))))
+        return nullptr;
+
+    if (mapped)
+    {
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(buffer->Map(0, &readRange, mapped)) || !*mapped)
+            return nullptr;
+    }
+
+    return buffer;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "UploadScheduler.h"
+
+#include <d3d12.h>
+#include <wrl.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using UploadTicket = uint64_t;
+
+// Batches buffer/texture copies on a dedicated COPY queue.
+// Copies are recorded into an open command list and staged in a persistent upload ring; submit() sends the
+// whole batch at once and returns its fence ticket. Nothing waits on the CPU unless wait()/waitIdle() is called:
+// consumers make their queue wait on the copy fence on the GPU (gpuWait).
+class UploadManager
+{
+public:
+    UploadManager() = default;
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    bool init(ID3D12Device* device, size_t stagingSize);
+    void cleanUp();
+
+    // dst must be in COMMON state; it is left in COMMON, ready for implicit promotion on the draw queue
+    UploadTicket uploadBuffer(ID3D12Resource* dst, const void* data, size_t size);
+    UploadTicket uploadTexture(ID3D12Resource* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT numSubresources);
+
+    // Submits the open batch (if any) and returns its ticket, or the last submitted one
+    UploadTicket submit();
+
+    // GPU-side: queue waits for everything submitted so far
+    void gpuWait(ID3D12CommandQueue* queue);
+
+    bool isComplete(UploadTicket ticket) const;
+    void wait(UploadTicket ticket);
+    void waitIdle();
+
+    UploadScheduler::Stats getStats() const;
+
+private:
+    struct CommandAllocator
+    {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        UploadTicket ticket = 0;
+    };
+
+    struct DedicatedStaging
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+        UploadTicket ticket = 0;
+    };
+
+    bool beginBatch();
+    UploadTicket submitLocked();
+    void retireLocked();
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> createStaging(size_t size, void** mapped);
+
+private:
+    mutable std::mutex mutex;
+
+    Microsoft::WRL::ComPtr<ID3D12Device> device;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+    HANDLE fenceEvent = nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> staging;
+    uint8_t* stagingData = nullptr;
+
+    std::vector<CommandAllocator> allocators;
+    std::vector<DedicatedStaging> dedicated;
+    size_t openAllocator = SIZE_MAX;
+
+    UploadTicket lastGpuWait = 0;
+
+    UploadScheduler scheduler;
+};
@@ -0,0 +1,89 @@
+#include "Globals.h"
+#include "UploadScheduler.h"
+
+#include <algorithm>
+
+void UploadScheduler::init(size_t stagingCapacity, uint64_t firstTicket)
+{
+    _ASSERTE(firstTicket > 0);
+
+    capacity = stagingCapacity;
+    head = 0;
+    tail = 0;
+
+    nextTicket = firstTicket;
+    openUploads = 0;
+
+    inFlight.clear();
+    stats = {};
+}
+
+size_t UploadScheduler::allocateStaging(size_t size, size_t alignment)
+{
+    if (capacity == 0 || size == 0 || size > capacity)
+        return INVALID_OFFSET;
+
+    _ASSERTE(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    uint64_t start = (head + alignment - 1) & ~uint64_t(alignment - 1);
+
+    // Never straddle the end of the ring: skip to the next lap
+    const uint64_t inRing = start % capacity;
+    if (inRing + size > capacity)
+        start += capacity - inRing;
+
+    const uint64_t end = start + size;
+    if (end - tail > capacity)
+        return INVALID_OFFSET;
+
+    head = end;
+    return size_t(start % capacity);
+}
+
+void UploadScheduler::addUpload(size_t bytes, bool dedicated)
+{
+    ++openUploads;
+    ++stats.uploads;
+    stats.bytes += bytes;
+
+    if (dedicated)
+        ++stats.dedicatedStaging;
+}
+
+uint64_t UploadScheduler::closeBatch()
+{
+    if (openUploads == 0)
+        return 0;
+
+    const uint64_t ticket = nextTicket++;
+    inFlight.push_back({ ticket, head });
+
+    ++stats.submissions;
+    stats.lastBatchUploads = openUploads;
+    stats.maxBatchUploads = std::max(stats.maxBatchUploads, openUploads);
+
+    openUploads = 0;
+    return ticket;
+}
+
+void UploadScheduler::retire(uint64_t completedTicket)
+{
+    while (!inFlight.empty() && inFlight.front().ticket <= completedTicket)
+    {
+        tail = inFlight.front().end;
+        inFlight.pop_front();
+    }
+
+    // Nothing in flight or open: restart at the beginning of the ring
+    if (inFlight.empty() && openUploads == 0 && head == tail)
+    {
+        head = 0;
+        tail = 0;
+    }
+}
+
+void UploadScheduler::addStall(double ms)
+{
+    ++stats.cpuWaits;
+    stats.stallMs += ms;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Upload bookkeeping without any D3D12 types: staging ring space, batches and fence tickets.
+// A ticket is the fence value the batch signals once its copies are done. Staging space taken while
+// a batch is open is owned by that batch and comes back when retire() sees its ticket completed.
+class UploadScheduler
+{
+public:
+    static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+
+    struct Stats
+    {
+        uint64_t submissions = 0;
+        uint64_t uploads = 0;
+        uint64_t bytes = 0;
+        uint64_t dedicatedStaging = 0;   // uploads that did not fit in the staging ring
+        uint32_t lastBatchUploads = 0;
+        uint32_t maxBatchUploads = 0;
+        uint64_t cpuWaits = 0;
+        double   stallMs = 0.0;
+
+        double getUploadsPerSubmission() const { return submissions ? double(uploads) / double(submissions) : 0.0; }
+    };
+
+public:
+    void init(size_t stagingCapacity, uint64_t firstTicket = 1);
+
+    // Ring space for the open batch; INVALID_OFFSET if it does not fit until older batches retire
+    size_t allocateStaging(size_t size, size_t alignment);
+
+    void addUpload(size_t bytes, bool dedicated = false);
+
+    bool hasOpenBatch() const { return openUploads > 0; }
+    uint64_t getOpenTicket() const { return nextTicket; }
+    uint64_t getLastSubmittedTicket() const { return nextTicket - 1; }
+
+    // Closes the open batch and returns the ticket to signal, or 0 if the batch was empty
+    uint64_t closeBatch();
+
+    // Frees staging of every batch whose ticket is <= completedTicket
+    void retire(uint64_t completedTicket);
+
+    void addStall(double ms);
+
+    size_t getStagingCapacity() const { return capacity; }
+    size_t getStagingUsed() const { return size_t(head - tail); }
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Batch
+    {
+        uint64_t ticket = 0;
+        uint64_t end = 0;   // ring head when the batch was closed
+    };
+
+    size_t capacity = 0;
+    uint64_t head = 0;      // virtual offsets, wrap by capacity
+    uint64_t tail = 0;
+
+    uint64_t nextTicket = 1;
+    uint32_t openUploads = 0;
+
+    std::deque<Batch> inFlight;
+    Stats stats;
+};
@@ -0,0 +1,115 @@
+#include "Globals.h"
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    float signNotZero(float v)
+    {
+        return (v >= 0.0f) ? 1.0f : -1.0f;
+    }
+
+    // Octahedral map in [-1, 1]^2; zero-length input maps to +Z
+    void octahedralFromUnit(const float n[3], float& u, float& v)
+    {
+        const float l1 = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+        if (l1 <= 0.0f)
+        {
+            u = 0.0f;
+            v = 0.0f;
+            return;
+        }
+
+        u = n[0] / l1;
+        v = n[1] / l1;
+
+        if (n[2] < 0.0f)
+        {
+            // Fold the lower hemisphere over the diagonals
+            const float fu = (1.0f - std::fabs(v)) * signNotZero(u);
+            const float fv = (1.0f - std::fabs(u)) * signNotZero(v);
+            u = fu;
+            v = fv;
+        }
+    }
+
+    void unitFromOctahedral(float u, float v, float n[3])
+    {
+        n[0] = u;
+        n[1] = v;
+        n[2] = 1.0f - std::fabs(u) - std::fabs(v);
+
+        const float t = std::clamp(-n[2], 0.0f, 1.0f);
+        n[0] -= t * signNotZero(n[0]);
+        n[1] -= t * signNotZero(n[1]);
+
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        const float invLength = (length > 0.0f) ? 1.0f / length : 0.0f;
+        n[0] *= invLength;
+        n[1] *= invLength;
+        n[2] *= invLength;
+    }
+
+    int16_t toSnorm16(float v)
+    {
+        return int16_t(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    float fromSnorm16(int16_t v)
+    {
+        // D3D snorm: -32768 and -32767 both decode to -1
+        return std::max(float(v) / 32767.0f, -1.0f);
+    }
+
+    uint32_t toUnorm(float v, uint32_t maxValue)
+    {
+        return uint32_t(std::lround(std::clamp(v, 0.0f, 1.0f) * float(maxValue)));
+    }
+}
+
+void VertexPacking::encodeOctahedral(const float n[3], int16_t out[2])
+{
+    float u, v;
+    octahedralFromUnit(n, u, v);
+
+    out[0] = toSnorm16(u);
+    out[1] = toSnorm16(v);
+}
+
+void VertexPacking::decodeOctahedral(const int16_t in[2], float n[3])
+{
+    unitFromOctahedral(fromSnorm16(in[0]), fromSnorm16(in[1]), n);
+}
+
+void VertexPacking::encodeTangent(const float t[3], float handedness, uint16_t out[2])
+{
+    float u, v;
+    octahedralFromUnit(t, u, v);
+
+    out[0] = uint16_t(toUnorm(u * 0.5f + 0.5f, 0xFFFFu));
+    out[1] = uint16_t((toUnorm(v * 0.5f + 0.5f, 0x7FFFu) << 1) | (handedness < 0.0f ? 1u : 0u));
+}
+
+void VertexPacking::decodeTangent(const uint16_t in[2], float t[3], float& handedness)
+{
+    const float u = float(in[0]) / 65535.0f * 2.0f - 1.0f;
+    const float v = float(in[1] >> 1) / 32767.0f * 2.0f - 1.0f;
+
+    unitFromOctahedral(u, v, t);
+    handedness = (in[1] & 1u) ? -1.0f : 1.0f;
+}
+
+uint16_t VertexPacking::quantizeUnorm16(float v, float min, float extent)
+{
+    if (extent <= 0.0f)
+        return 0;
+
+    return uint16_t(toUnorm((v - min) / extent, 0xFFFFu));
+}
+
+float VertexPacking::dequantizeUnorm16(uint16_t q, float min, float extent)
+{
+    return min + (float(q) / 65535.0f) * extent;
+}
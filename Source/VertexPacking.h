@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Scalar encoders used by the packed vertex formats (see BasicMesh::VertexFormat).
+// Each decode mirrors what Assignment2PackedVS.hlsl does with the matching DXGI format.
+class VertexPacking
+{
+public:
+    // Unit vector -> octahedral map, R16G16_SNORM
+    static void encodeOctahedral(const float n[3], int16_t out[2]);
+    static void decodeOctahedral(const int16_t in[2], float n[3]);
+
+    // Unit tangent + handedness -> R16G16_UINT: x = 16-bit unorm octahedral x,
+    // y = 15-bit unorm octahedral y in the high bits, bit 0 set for a negative handedness
+    static void encodeTangent(const float t[3], float handedness, uint16_t out[2]);
+    static void decodeTangent(const uint16_t in[2], float t[3], float& handedness);
+
+    // v in [min, min + extent] -> R16_UNORM
+    static uint16_t quantizeUnorm16(float v, float min, float extent);
+    static float dequantizeUnorm16(uint16_t q, float min, float extent);
+};
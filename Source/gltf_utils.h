@@ -4,6 +4,7 @@
 #include <cstring>
 #include <map>
 #include <memory>
+#include <vector>
 
 #pragma warning(push)
 #pragma warning(disable : 4018)
@@ -11,42 +12,91 @@
 #include "tiny_gltf.h"
 #pragma warning(pop)
 
-inline bool loadAccessorData(uint8_t* data, size_t elemSize, size_t stride, size_t count,
-    const tinygltf::Model& model, int index)
+#include "AccessorTranscoder.h"
+
+// Bytes behind model.buffers[i]: tinygltf's own copy, or a file mapping when GltfFile loaded it zero-copy
+struct GltfBufferSpan
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+using GltfBuffers = std::vector<GltfBufferSpan>;
+
+// Resolves the bytes of count elements of accessor index, checked against the buffer size
+inline bool getAccessorSource(const tinygltf::Model& model, const GltfBuffers& buffers, int index, size_t count,
+    const uint8_t*& source, size_t& sourceStride, AccessorFormat& format)
 {
+    if (index < 0 || size_t(index) >= model.accessors.size())
+        return false;
+
     const tinygltf::Accessor& accessor = model.accessors[index];
-    size_t defaultStride =
-        tinygltf::GetComponentSizeInBytes(accessor.componentType) *
-        tinygltf::GetNumComponentsInType(accessor.type);
-
-    if (count == accessor.count && defaultStride == elemSize)
-    {
-        const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
-        const uint8_t* bufferData = reinterpret_cast<const uint8_t*>(
-            &(model.buffers[view.buffer].data[accessor.byteOffset + view.byteOffset])
-            );
-
-        size_t bufferStride = (view.byteStride == 0) ? defaultStride : view.byteStride;
-
-        for (uint32_t i = 0; i < count; ++i)
-        {
-            memcpy(data, bufferData, elemSize);
-            data += stride;
-            bufferData += bufferStride;
-        }
-        return true;
-    }
-    return false;
+    if (count != accessor.count || accessor.bufferView < 0 || size_t(accessor.bufferView) >= model.bufferViews.size())
+        return false;
+
+    // Matrices carry per-column padding for small component types, they are never vertex attributes here
+    const int numComponents = tinygltf::GetNumComponentsInType(accessor.type);
+    if (accessor.type != TINYGLTF_TYPE_SCALAR && accessor.type != TINYGLTF_TYPE_VEC2 &&
+        accessor.type != TINYGLTF_TYPE_VEC3 && accessor.type != TINYGLTF_TYPE_VEC4)
+        return false;
+
+    const size_t componentSize = getAccessorComponentSize(accessor.componentType);
+    if (componentSize == 0)
+        return false;
+
+    const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+    if (view.buffer < 0 || size_t(view.buffer) >= buffers.size())
+        return false;
+
+    const GltfBufferSpan& buffer = buffers[view.buffer];
+    const size_t elementSize = componentSize * size_t(numComponents);
+    const size_t bufferStride = (view.byteStride == 0) ? elementSize : view.byteStride;
+
+    const size_t start = accessor.byteOffset + view.byteOffset;
+    if (count > 0 && start + (count - 1) * bufferStride + elementSize > buffer.size)
+        return false;
+
+    source = buffer.data + start;
+    sourceStride = bufferStride;
+    format = AccessorFormat{ accessor.componentType, uint32_t(numComponents), accessor.normalized };
+    return true;
+}
+
+// Reads any component type as floats (normalized or quantized attributes), numComponents floats per element
+inline bool loadAccessorFloats(float* data, uint32_t numComponents, size_t stride, size_t count,
+    const tinygltf::Model& model, const GltfBuffers& buffers, int index)
+{
+    const uint8_t* source = nullptr;
+    size_t sourceStride = 0;
+    AccessorFormat format;
+
+    if (!getAccessorSource(model, buffers, index, count, source, sourceStride, format))
+        return false;
+
+    return transcodeToFloat(data, stride, numComponents, source, sourceStride, format, count);
 }
 
-inline bool loadAccessorData(uint8_t* data, size_t elemSize, size_t stride, size_t count,
-    const tinygltf::Model& model,
+inline bool loadAccessorFloats(float* data, uint32_t numComponents, size_t stride, size_t count,
+    const tinygltf::Model& model, const GltfBuffers& buffers,
     const std::map<std::string, int>& attributes,
     const char* accessorName)
 {
     const auto& it = attributes.find(accessorName);
     if (it != attributes.end())
-        return loadAccessorData(data, elemSize, stride, count, model, it->second);
+        return loadAccessorFloats(data, numComponents, stride, count, model, buffers, it->second);
 
     return false;
 }
+
+// Indices of any glTF index type widened to 32 bits
+inline bool loadAccessorIndices(uint32_t* data, size_t count, const tinygltf::Model& model, const GltfBuffers& buffers, int index)
+{
+    const uint8_t* source = nullptr;
+    size_t sourceStride = 0;
+    AccessorFormat format;
+
+    if (!getAccessorSource(model, buffers, index, count, source, sourceStride, format) || format.numComponents != 1)
+        return false;
+
+    return transcodeIndices(data, source, sourceStride, format.componentType, count);
+}